@@ -89,5 +89,42 @@ cpp2::ErrorCode GraphClient::execute(folly::StringPiece stmt,
     return resp.get_error_code();
 }
 
+
+cpp2::ErrorCode GraphClient::executePaged(folly::StringPiece stmt,
+                                          int32_t pageSize,
+                                          cpp2::ExecutionResponse& resp) {
+    if (!client_) {
+        LOG(ERROR) << "Disconnected from the server";
+        return cpp2::ErrorCode::E_DISCONNECTED;
+    }
+
+    try {
+        client_->sync_executePaged(resp, sessionId_, stmt.toString(), pageSize);
+    } catch (const std::exception& ex) {
+        LOG(ERROR) << "Thrift rpc call failed: " << ex.what();
+        return cpp2::ErrorCode::E_RPC_FAILURE;
+    }
+
+    return resp.get_error_code();
+}
+
+
+cpp2::ErrorCode GraphClient::fetchPage(int64_t cursorId,
+                                       cpp2::ExecutionResponse& resp) {
+    if (!client_) {
+        LOG(ERROR) << "Disconnected from the server";
+        return cpp2::ErrorCode::E_DISCONNECTED;
+    }
+
+    try {
+        client_->sync_fetchPage(resp, sessionId_, cursorId);
+    } catch (const std::exception& ex) {
+        LOG(ERROR) << "Thrift rpc call failed: " << ex.what();
+        return cpp2::ErrorCode::E_RPC_FAILURE;
+    }
+
+    return resp.get_error_code();
+}
+
 }  // namespace graph
 }  // namespace nebula
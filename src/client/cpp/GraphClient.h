@@ -26,6 +26,15 @@ public:
     cpp2::ErrorCode execute(folly::StringPiece stmt,
                             cpp2::ExecutionResponse& resp);
 
+    // Only the first `pageSize' rows are returned, `resp.cursor_id' is set if there are more
+    cpp2::ErrorCode executePaged(folly::StringPiece stmt,
+                                 int32_t pageSize,
+                                 cpp2::ExecutionResponse& resp);
+
+    // Fetch the next page of rows of a cursor opened by `executePaged'
+    cpp2::ErrorCode fetchPage(int64_t cursorId,
+                              cpp2::ExecutionResponse& resp);
+
 private:
     std::unique_ptr<cpp2::GraphServiceAsyncClient> client_;
     const std::string addr_;
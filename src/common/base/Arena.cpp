@@ -0,0 +1,46 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include "base/Arena.h"
+
+namespace nebula {
+
+Arena::~Arena() {
+    for (auto& chunk : chunks_) {
+        free(chunk.data);
+    }
+}
+
+
+void* Arena::allocate(size_t size) {
+    // Round up, so that the next allocation is aligned too
+    size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    while (current_ < chunks_.size()) {
+        auto& chunk = chunks_[current_];
+        if (used_ + size <= chunk.size) {
+            char* p = chunk.data + used_;
+            used_ += size;
+            return p;
+        }
+        // The rest of the chunk is wasted until the next reset
+        current_++;
+        used_ = 0;
+    }
+
+    // A large buffer gets a chunk of its own size
+    Chunk chunk;
+    chunk.size = std::max(size, chunkSize_);
+    chunk.data = reinterpret_cast<char*>(malloc(chunk.size));
+    CHECK(chunk.data) << "Out of memory";
+    chunks_.emplace_back(chunk);
+    capacity_ += chunk.size;
+    current_ = chunks_.size() - 1;
+    used_ = size;
+    return chunk.data;
+}
+
+}  // namespace nebula
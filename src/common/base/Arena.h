@@ -0,0 +1,65 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+#ifndef COMMON_BASE_ARENA_H_
+#define COMMON_BASE_ARENA_H_
+
+#include "base/Base.h"
+
+namespace nebula {
+
+/**
+ * A monotonic allocator for the short-lived buffers of one request.
+ *
+ * Memory is carved out of large chunks and never freed one by one. All of it is
+ * released at once by `reset', which keeps the chunks for the next allocations,
+ * so a steady workload stops calling malloc after a while.
+ *
+ * It is not thread-safe, each thread (e.g. each bucket of a request) should own one.
+ */
+class Arena final {
+public:
+    explicit Arena(size_t chunkSize = 4096) : chunkSize_(chunkSize) {}
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Allocate `size' bytes, aligned to the size of a pointer.
+     */
+    void* allocate(size_t size);
+
+    /**
+     * Make all the memory allocated so far available again.
+     * No pointer returned by `allocate' could be used after that.
+     */
+    void reset() {
+        current_ = 0;
+        used_ = 0;
+    }
+
+    // The total bytes of the chunks
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    struct Chunk {
+        char*   data;
+        size_t  size;
+    };
+
+    const size_t            chunkSize_;
+    std::vector<Chunk>      chunks_;
+    // The chunk being allocated from, and the bytes used in it
+    size_t                  current_{0};
+    size_t                  used_{0};
+    size_t                  capacity_{0};
+};
+
+}  // namespace nebula
+
+#endif  // COMMON_BASE_ARENA_H_
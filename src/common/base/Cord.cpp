@@ -6,6 +6,7 @@
 
 #include "base/Base.h"
 #include "base/Cord.h"
+#include "base/Arena.h"
 
 namespace nebula {
 
@@ -16,6 +17,10 @@ Cord::Cord(int32_t blockSize)
 }
 
 
+Cord::Cord(Arena* arena) : arena_(arena) {
+}
+
+
 Cord::~Cord() {
     clear();
 }
@@ -23,7 +28,12 @@ Cord::~Cord() {
 
 void Cord::allocateBlock() {
     DCHECK_EQ(blockPt_, blockContentSize_);
-    char* blk = reinterpret_cast<char*>(malloc(blockSize_ * sizeof(char)));
+    char* blk;
+    if (arena_ != nullptr) {
+        blk = reinterpret_cast<char*>(arena_->allocate(blockSize_ * sizeof(char)));
+    } else {
+        blk = reinterpret_cast<char*>(malloc(blockSize_ * sizeof(char)));
+    }
     CHECK(blk) << "Out of memory";
 
     if (tail_) {
@@ -50,7 +60,8 @@ bool Cord::empty() const noexcept {
 
 
 void Cord::clear() {
-    if (head_) {
+    // The blocks from an arena are released with the arena
+    if (head_ && !arena_) {
         DCHECK(tail_);
 
         // Need to release all blocks
@@ -11,10 +11,14 @@
 
 namespace nebula {
 
+class Arena;
+
 class Cord {
 public:
     Cord() = default;
     explicit Cord(int32_t blockSize);
+    // The blocks are allocated from the arena, which should outlive the cord
+    explicit Cord(Arena* arena);
     virtual ~Cord();
 
     size_t size() const noexcept;
@@ -63,6 +67,7 @@ private:
     const int32_t blockContentSize_ = 1024 - sizeof(char*);
     int32_t blockPt_ = blockContentSize_;
     size_t len_ = 0;
+    Arena* arena_ = nullptr;
 
     char* head_ = nullptr;
     char* tail_ = nullptr;
@@ -0,0 +1,90 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+#ifndef COMMON_BASE_HYPERLOGLOG_H_
+#define COMMON_BASE_HYPERLOGLOG_H_
+
+#include "base/Base.h"
+#include <folly/hash/Hash.h>
+#include "base/MurmurHash2.h"
+
+namespace nebula {
+
+/**
+ * An estimator of the number of distinct values, in a fixed space of 2^precision bytes.
+ *
+ * The standard error is about 1.04 / sqrt(2^precision), i.e. 0.8% with the default precision.
+ * Two estimators of the same precision could be merged, the result is the same as
+ * if all the values had been added to one of them.
+ */
+class HyperLogLog final {
+public:
+    explicit HyperLogLog(uint8_t precision = 14)
+        : precision_(precision)
+        , registers_(1UL << precision, 0) {
+        CHECK(precision >= 4 && precision <= 18);
+    }
+
+    void add(int64_t v) {
+        addHash(folly::hash::twang_mix64(static_cast<uint64_t>(v)));
+    }
+
+    void add(double v) {
+        uint64_t bits;
+        static_assert(sizeof(bits) == sizeof(v), "Unexpected size of double");
+        ::memcpy(&bits, &v, sizeof(bits));
+        addHash(folly::hash::twang_mix64(bits));
+    }
+
+    void add(folly::StringPiece v) {
+        addHash(folly::hash::twang_mix64(MurmurHash2()(v.data(), v.size())));
+    }
+
+    /**
+     * The hash should be well mixed, since its highest bits pick the register.
+     */
+    void addHash(uint64_t hash) {
+        auto index = hash >> (64 - precision_);
+        // Keep a guard bit, so that the rank is at most 64 - precision + 1
+        auto rest = (hash << precision_) | (1UL << (precision_ - 1));
+        auto rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+        if (registers_[index] < rank) {
+            registers_[index] = rank;
+        }
+    }
+
+    void merge(const HyperLogLog& other) {
+        CHECK_EQ(precision_, other.precision_);
+        for (size_t i = 0; i < registers_.size(); i++) {
+            registers_[i] = std::max(registers_[i], other.registers_[i]);
+        }
+    }
+
+    uint64_t estimate() const {
+        double m = registers_.size();
+        double sum = 0;
+        size_t zeros = 0;
+        for (auto r : registers_) {
+            sum += std::ldexp(1.0, -r);
+            if (r == 0) {
+                zeros++;
+            }
+        }
+        double e = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+        if (e <= 2.5 * m && zeros != 0) {
+            // Linear counting is more accurate for the small cardinalities
+            e = m * std::log(m / zeros);
+        }
+        return static_cast<uint64_t>(std::llround(e));
+    }
+
+private:
+    uint8_t                 precision_;
+    std::vector<uint8_t>    registers_;
+};
+
+}  // namespace nebula
+
+#endif  // COMMON_BASE_HYPERLOGLOG_H_
@@ -57,6 +57,14 @@ std::string NebulaKeyUtils::prefix(PartitionID partId, VertexID vId) {
     return key;
 }
 
+// static
+std::string NebulaKeyUtils::prefix(PartitionID partId) {
+    std::string key;
+    key.reserve(sizeof(PartitionID));
+    key.append(reinterpret_cast<const char*>(&partId), sizeof(PartitionID));
+    return key;
+}
+
 // static
 std::string NebulaKeyUtils::prefix(PartitionID partId, VertexID src, EdgeType type,
                                    EdgeRanking ranking, VertexID dst) {
@@ -71,5 +79,24 @@ std::string NebulaKeyUtils::prefix(PartitionID partId, VertexID src, EdgeType ty
     return key;
 }
 
+// static
+std::string NebulaKeyUtils::degreeKey(PartitionID partId, VertexID vId, EdgeType type) {
+    std::string key;
+    key.reserve(kDegreeLen);
+    key.append(degreePrefix(partId))
+       .append(reinterpret_cast<const char*>(&vId), sizeof(VertexID))
+       .append(reinterpret_cast<const char*>(&type), sizeof(EdgeType));
+    return key;
+}
+
+// static
+std::string NebulaKeyUtils::degreePrefix(PartitionID partId) {
+    std::string key;
+    key.reserve(kDegreeLen);
+    key.append(kDegreePrefix)
+       .append(reinterpret_cast<const char*>(&partId), sizeof(PartitionID));
+    return key;
+}
+
 }  // namespace nebula
 
@@ -18,6 +18,9 @@ namespace nebula {
  * EdgeKeyUtils:
  * partId(4) + srcId(8) + edgeType(4) + edgeRank(8) + dstId(8) + version(8)
  *
+ * DegreeKeyUtils:
+ * "__degree__" + partId(4) + vertexId(8) + edgeType(4)
+ *
  * */
 
 /**
@@ -49,9 +52,30 @@ public:
      * */
     static std::string prefix(PartitionID partId, VertexID vId);
 
+    /**
+     * Prefix for all the vertices and edges of the part
+     * */
+    static std::string prefix(PartitionID partId);
+
     static std::string prefix(PartitionID partId, VertexID src, EdgeType type,
                               EdgeRanking ranking, VertexID dst);
 
+    /**
+     * Key of the degree counter of the vertex along edgeType, i.e. the number of
+     * distinct out-edges if edgeType > 0, otherwise the in-edges of -edgeType.
+     * It is a system key, so it is never in the range of any prefix above.
+     * */
+    static std::string degreeKey(PartitionID partId, VertexID vId, EdgeType type);
+
+    /**
+     * Prefix for all the degree counters of the part
+     * */
+    static std::string degreePrefix(PartitionID partId);
+
+    static bool isDegree(const folly::StringPiece& rawKey) {
+        return rawKey.size() == kDegreeLen && rawKey.startsWith(kDegreePrefix);
+    }
+
     static bool isVertex(const folly::StringPiece& rawKey) {
         return rawKey.size() == kVertexLen;
     }
@@ -124,6 +148,10 @@ private:
                                       + sizeof(EdgeType) + sizeof(VertexID)
                                       + sizeof(EdgeRanking) + sizeof(EdgeVersion);
 
+    static constexpr const char* kDegreePrefix = "__degree__";
+    static constexpr int32_t kDegreeLen = 10 + sizeof(PartitionID) + sizeof(VertexID)
+                                        + sizeof(EdgeType);
+
     static const char kSysPrefix = '_';
 };
 
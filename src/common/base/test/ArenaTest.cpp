@@ -0,0 +1,71 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include <gtest/gtest.h>
+#include "base/Arena.h"
+#include "base/Cord.h"
+
+namespace nebula {
+
+TEST(Arena, allocate) {
+    Arena arena(64);
+    EXPECT_EQ(0, arena.capacity());
+
+    auto* p1 = reinterpret_cast<char*>(arena.allocate(10));
+    auto* p2 = reinterpret_cast<char*>(arena.allocate(10));
+    // Aligned and in the same chunk
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p2) % sizeof(void*));
+    EXPECT_EQ(16, p2 - p1);
+    EXPECT_EQ(64, arena.capacity());
+    memset(p1, 'a', 10);
+    memset(p2, 'b', 10);
+    EXPECT_EQ('a', p1[9]);
+
+    // It does not fit in the rest of the chunk
+    arena.allocate(40);
+    EXPECT_EQ(128, arena.capacity());
+
+    // A large buffer gets a chunk of its own size
+    auto* p3 = reinterpret_cast<char*>(arena.allocate(1000));
+    memset(p3, 'c', 1000);
+    EXPECT_EQ(128 + 1000, arena.capacity());
+}
+
+
+TEST(Arena, reset) {
+    Arena arena(64);
+    auto* p1 = arena.allocate(32);
+    arena.allocate(64);
+    auto capacity = arena.capacity();
+
+    // The chunks are reused after a reset
+    for (int i = 0; i < 10; i++) {
+        arena.reset();
+        EXPECT_EQ(p1, arena.allocate(32));
+        arena.allocate(64);
+        EXPECT_EQ(capacity, arena.capacity());
+    }
+}
+
+
+TEST(Arena, cord) {
+    Arena arena;
+    std::string buf;
+    for (int i = 0; i < 100; i++) {
+        buf.append("Hello World!");
+    }
+    for (int i = 0; i < 3; i++) {
+        arena.reset();
+        Cord cord(&arena);
+        cord.write(buf.data(), buf.size());
+        cord << buf;
+        EXPECT_EQ(buf + buf, cord.str());
+    }
+    EXPECT_EQ(4096, arena.capacity());
+}
+
+}  // namespace nebula
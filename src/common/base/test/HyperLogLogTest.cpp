@@ -0,0 +1,53 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include <gtest/gtest.h>
+#include "base/HyperLogLog.h"
+
+namespace nebula {
+
+TEST(HyperLogLog, Estimate) {
+    for (int64_t num : {0L, 1L, 100L, 10000L, 1000000L}) {
+        HyperLogLog hll;
+        for (int64_t i = 0; i < num; i++) {
+            // Duplicated values are counted once
+            hll.add(i);
+            hll.add(i);
+        }
+        auto e = static_cast<double>(hll.estimate());
+        EXPECT_NEAR(num, e, num * 0.03) << "num " << num;
+    }
+}
+
+
+TEST(HyperLogLog, Types) {
+    HyperLogLog hll;
+    for (int32_t i = 0; i < 1000; i++) {
+        hll.add(folly::stringPrintf("value_%d", i % 500));
+        hll.add(static_cast<double>(i % 200) + 0.5);
+    }
+    EXPECT_NEAR(700, hll.estimate(), 21);
+}
+
+
+TEST(HyperLogLog, Merge) {
+    HyperLogLog all;
+    HyperLogLog odd;
+    HyperLogLog even;
+    for (int64_t i = 0; i < 100000; i++) {
+        all.add(i);
+        if (i % 2 == 0) {
+            even.add(i);
+        } else {
+            odd.add(i);
+        }
+    }
+    odd.merge(even);
+    EXPECT_EQ(all.estimate(), odd.estimate());
+}
+
+}  // namespace nebula
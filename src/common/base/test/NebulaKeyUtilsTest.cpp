@@ -31,6 +31,23 @@ TEST(NebulaKeyUtilsTest, SimpleTest) {
     CHECK_EQ(rank, NebulaKeyUtils::getRank(edgeKey));
 }
 
+TEST(NebulaKeyUtilsTest, DegreeKeyTest) {
+    PartitionID partId = 1;
+    VertexID vId = 1001L;
+    EdgeType type = 101;
+
+    auto degreeKey = NebulaKeyUtils::degreeKey(partId, vId, type);
+    CHECK(NebulaKeyUtils::isDegree(degreeKey));
+    CHECK(!NebulaKeyUtils::isDataKey(degreeKey));
+    CHECK(!NebulaKeyUtils::isEdge(degreeKey));
+    CHECK(folly::StringPiece(degreeKey).startsWith(NebulaKeyUtils::degreePrefix(partId)));
+    CHECK(!folly::StringPiece(degreeKey).startsWith(NebulaKeyUtils::prefix(partId, vId, type)));
+    CHECK_NE(degreeKey, NebulaKeyUtils::degreeKey(partId, vId, -type));
+
+    auto edgeKey = NebulaKeyUtils::edgeKey(partId, vId, type, 0, 2001L, 0);
+    CHECK(!NebulaKeyUtils::isDegree(edgeKey));
+}
+
 }  // namespace nebula
 
 
@@ -0,0 +1,688 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include "filter/ExpressionProgram.h"
+#include <folly/small_vector.h>
+
+namespace nebula {
+
+namespace {
+
+template <typename T, typename U, typename R, typename F>
+void binaryLoop(const std::vector<T> &l, const std::vector<U> &r, std::vector<R> *result, F f) {
+    DCHECK_EQ(l.size(), r.size());
+    auto rows = l.size();
+    result->resize(rows);
+    auto *out = result->data();
+    for (size_t i = 0; i < rows; i++) {
+        out[i] = f(l[i], r[i]);
+    }
+}
+
+template <typename T>
+std::vector<double> toDoubles(const std::vector<T> &values) {
+    return std::vector<double>(values.begin(), values.end());
+}
+
+// Check all the divisors before the loop, to keep the loop free of branches.
+Status checkDivisors(const std::vector<int64_t> &dividends,
+                     const std::vector<int64_t> &divisors) {
+    for (size_t i = 0; i < divisors.size(); i++) {
+        auto status = ArithmeticExpression::checkDivisor(dividends[i], divisors[i]);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    return Status::OK();
+}
+
+// Apply the row-wise operator on each row, for the types without a typed loop.
+template <typename F>
+Status genericLoop(const ValueColumn &l, const ValueColumn &r, ValueColumn *result, F f) {
+    DCHECK_EQ(l.size(), r.size());
+    auto rows = l.size();
+    result->reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+        auto value = f(l.at(i), r.at(i));
+        if (!value.ok()) {
+            return value.status();
+        }
+        result->append(value.value());
+    }
+    return Status::OK();
+}
+
+}   // namespace
+
+
+// static
+ValueColumn ValueColumn::repeat(const VariantType &value, size_t rows) {
+    ValueColumn column;
+    switch (value.which()) {
+        case VAR_INT64:
+            column.type_ = kInt;
+            column.ints_.assign(rows, boost::get<int64_t>(value));
+            break;
+        case VAR_DOUBLE:
+            column.type_ = kDouble;
+            column.doubles_.assign(rows, boost::get<double>(value));
+            break;
+        case VAR_BOOL:
+            column.type_ = kBool;
+            column.bools_.assign(rows, boost::get<bool>(value));
+            break;
+        default:
+            column.type_ = kVariant;
+            column.variants_.assign(rows, value);
+    }
+    return column;
+}
+
+
+// static
+ValueColumn ValueColumn::ofInts(std::vector<int64_t> values) {
+    ValueColumn column;
+    column.type_ = kInt;
+    column.ints_ = std::move(values);
+    return column;
+}
+
+
+// static
+ValueColumn ValueColumn::ofDoubles(std::vector<double> values) {
+    ValueColumn column;
+    column.type_ = kDouble;
+    column.doubles_ = std::move(values);
+    return column;
+}
+
+
+// static
+ValueColumn ValueColumn::ofBools(const std::vector<bool> &values) {
+    ValueColumn column;
+    column.type_ = kBool;
+    column.bools_.assign(values.begin(), values.end());
+    return column;
+}
+
+
+ValueColumn ValueColumn::slice(size_t begin, size_t end, const std::vector<uint32_t> *rows) const {
+    DCHECK_LE(begin, end);
+    DCHECK_LE(end, size());
+    auto copy = [&] (const auto &from, auto &to) {
+        if (rows == nullptr) {
+            to.assign(from.begin() + begin, from.begin() + end);
+            return;
+        }
+        to.reserve(rows->size());
+        for (auto row : *rows) {
+            DCHECK_LT(begin + row, end);
+            to.emplace_back(from[begin + row]);
+        }
+    };
+    ValueColumn column;
+    column.type_ = type_;
+    switch (type_) {
+        case kInt:
+            copy(ints_, column.ints_);
+            break;
+        case kDouble:
+            copy(doubles_, column.doubles_);
+            break;
+        case kBool:
+            copy(bools_, column.bools_);
+            break;
+        case kVariant:
+            copy(variants_, column.variants_);
+            break;
+        default:
+            break;
+    }
+    return column;
+}
+
+
+void ValueColumn::append(const VariantType &value) {
+    if (type_ == kEmpty) {
+        switch (value.which()) {
+            case VAR_INT64:
+                type_ = kInt;
+                break;
+            case VAR_DOUBLE:
+                type_ = kDouble;
+                break;
+            case VAR_BOOL:
+                type_ = kBool;
+                break;
+            default:
+                type_ = kVariant;
+        }
+    }
+    switch (type_) {
+        case kInt:
+            if (value.which() == VAR_INT64) {
+                ints_.emplace_back(boost::get<int64_t>(value));
+                return;
+            }
+            break;
+        case kDouble:
+            if (value.which() == VAR_DOUBLE) {
+                doubles_.emplace_back(boost::get<double>(value));
+                return;
+            }
+            break;
+        case kBool:
+            if (value.which() == VAR_BOOL) {
+                bools_.emplace_back(boost::get<bool>(value));
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+    toVariant();
+    variants_.emplace_back(value);
+}
+
+
+VariantType ValueColumn::at(size_t i) const {
+    switch (type_) {
+        case kInt:
+            return ints_[i];
+        case kDouble:
+            return doubles_[i];
+        case kBool:
+            return static_cast<bool>(bools_[i]);
+        case kVariant:
+            return variants_[i];
+        default:
+            LOG(FATAL) << "Access an empty column";
+    }
+}
+
+
+size_t ValueColumn::size() const {
+    switch (type_) {
+        case kInt:
+            return ints_.size();
+        case kDouble:
+            return doubles_.size();
+        case kBool:
+            return bools_.size();
+        case kVariant:
+            return variants_.size();
+        default:
+            return 0;
+    }
+}
+
+
+void ValueColumn::reserve(size_t rows) {
+    // The type is unknown yet, so only the generic storage is reserved.
+    variants_.reserve(rows);
+}
+
+
+void ValueColumn::select(std::vector<uint32_t> *rows) const {
+    rows->clear();
+    auto size = this->size();
+    if (type_ == kBool) {
+        for (size_t i = 0; i < size; i++) {
+            if (bools_[i]) {
+                rows->emplace_back(i);
+            }
+        }
+        return;
+    }
+    for (size_t i = 0; i < size; i++) {
+        if (Expression::asBool(at(i))) {
+            rows->emplace_back(i);
+        }
+    }
+}
+
+
+void ValueColumn::toVariant() {
+    if (type_ == kVariant) {
+        return;
+    }
+    auto size = this->size();
+    std::vector<VariantType> variants;
+    variants.reserve(std::max(size + 1, variants_.capacity()));
+    for (size_t i = 0; i < size; i++) {
+        variants.emplace_back(at(i));
+    }
+    variants_ = std::move(variants);
+    ints_.clear();
+    doubles_.clear();
+    bools_.clear();
+    type_ = kVariant;
+}
+
+
+// static
+StatusOr<std::unique_ptr<ExpressionProgram>>
+ExpressionProgram::compile(const Expression *expr) {
+    std::unique_ptr<ExpressionProgram> program(new ExpressionProgram());
+    auto status = program->emit(expr);
+    if (!status.ok()) {
+        return status;
+    }
+    // Compute the max stack depth, so that eval never reallocates in common cases.
+    size_t depth = 0;
+    for (auto &inst : program->code_) {
+        switch (inst.code) {
+            case kPushConst:
+            case kLoadSlot:
+                program->depth_ = std::max(program->depth_, ++depth);
+                break;
+            case kUnary:
+                break;
+            default:
+                --depth;
+        }
+    }
+    DCHECK_EQ(1UL, depth);
+    return std::move(program);
+}
+
+
+Status ExpressionProgram::emit(const Expression *expr) {
+    switch (expr->kind()) {
+        case Expression::kPrimary: {
+            consts_.emplace_back(static_cast<const PrimaryExpression*>(expr)->value());
+            code_.emplace_back(
+                    Instruction{kPushConst, 0, static_cast<uint32_t>(consts_.size() - 1)});
+            return Status::OK();
+        }
+        case Expression::kEdgeType: {
+            // Keep the same semantic with `EdgeTypeExpression::eval'
+            auto *typeExp = static_cast<const EdgeTypeExpression*>(expr);
+            consts_.emplace_back(*typeExp->alias());
+            code_.emplace_back(
+                    Instruction{kPushConst, 0, static_cast<uint32_t>(consts_.size() - 1)});
+            return Status::OK();
+        }
+        case Expression::kSourceProp:
+        case Expression::kDestProp:
+        case Expression::kAliasProp:
+        case Expression::kEdgeSrcId:
+        case Expression::kEdgeDstId:
+        case Expression::kEdgeRank:
+        case Expression::kVariableProp:
+        case Expression::kInputProp: {
+            auto *propExp = static_cast<const AliasPropertyExpression*>(expr);
+            auto index = addSlot(expr->kind(), *propExp->alias(), *propExp->prop());
+            code_.emplace_back(Instruction{kLoadSlot, 0, index});
+            return Status::OK();
+        }
+        case Expression::kUnary: {
+            auto *unaExp = static_cast<const UnaryExpression*>(expr);
+            auto status = emit(unaExp->operand());
+            if (!status.ok()) {
+                return status;
+            }
+            code_.emplace_back(Instruction{kUnary, static_cast<uint8_t>(unaExp->op()), 0});
+            return Status::OK();
+        }
+        case Expression::kArithmetic: {
+            auto *ariExp = static_cast<const ArithmeticExpression*>(expr);
+            auto status = emit(ariExp->left());
+            if (!status.ok()) {
+                return status;
+            }
+            status = emit(ariExp->right());
+            if (!status.ok()) {
+                return status;
+            }
+            code_.emplace_back(Instruction{kArithmetic, static_cast<uint8_t>(ariExp->op()), 0});
+            return Status::OK();
+        }
+        case Expression::kRelational: {
+            auto *relExp = static_cast<const RelationalExpression*>(expr);
+            auto status = emit(relExp->left());
+            if (!status.ok()) {
+                return status;
+            }
+            status = emit(relExp->right());
+            if (!status.ok()) {
+                return status;
+            }
+            code_.emplace_back(Instruction{kRelational, static_cast<uint8_t>(relExp->op()), 0});
+            return Status::OK();
+        }
+        case Expression::kLogical: {
+            auto *logExp = static_cast<const LogicalExpression*>(expr);
+            auto status = emit(logExp->left());
+            if (!status.ok()) {
+                return status;
+            }
+            status = emit(logExp->right());
+            if (!status.ok()) {
+                return status;
+            }
+            code_.emplace_back(Instruction{kLogical, static_cast<uint8_t>(logExp->op()), 0});
+            return Status::OK();
+        }
+        default:
+            return Status::Error("Expression kind %u could not be compiled",
+                                 static_cast<uint32_t>(expr->kind()));
+    }
+}
+
+
+uint32_t ExpressionProgram::addSlot(Expression::Kind kind,
+                                    const std::string &alias,
+                                    const std::string &prop) {
+    for (uint32_t i = 0; i < slots_.size(); i++) {
+        auto &slot = slots_[i];
+        if (slot.kind == kind && slot.alias == alias && slot.prop == prop) {
+            return i;
+        }
+    }
+    slots_.emplace_back(Slot{kind, alias, prop});
+    return slots_.size() - 1;
+}
+
+
+OptVariantType ExpressionProgram::eval(const SlotValues &values) const {
+    DCHECK_EQ(slots_.size(), values.size());
+    folly::small_vector<VariantType, 8> stack;
+    stack.reserve(depth_);
+    for (auto &inst : code_) {
+        switch (inst.code) {
+            case kPushConst:
+                stack.emplace_back(consts_[inst.index]);
+                break;
+            case kLoadSlot:
+                stack.emplace_back(values[inst.index]);
+                break;
+            case kUnary: {
+                auto result = UnaryExpression::apply(
+                        static_cast<UnaryExpression::Operator>(inst.op), stack.back());
+                if (!result.ok()) {
+                    return result;
+                }
+                stack.back() = std::move(result).value();
+                break;
+            }
+            case kArithmetic:
+            case kRelational:
+            case kLogical: {
+                auto &l = stack[stack.size() - 2];
+                auto &r = stack.back();
+                OptVariantType result;
+                if (inst.code == kArithmetic) {
+                    result = ArithmeticExpression::apply(
+                            static_cast<ArithmeticExpression::Operator>(inst.op), l, r);
+                } else if (inst.code == kRelational) {
+                    result = RelationalExpression::apply(
+                            static_cast<RelationalExpression::Operator>(inst.op), l, r);
+                } else {
+                    result = LogicalExpression::apply(
+                            static_cast<LogicalExpression::Operator>(inst.op), l, r);
+                }
+                if (!result.ok()) {
+                    return result;
+                }
+                stack.pop_back();
+                stack.back() = std::move(result).value();
+                break;
+            }
+        }
+    }
+    DCHECK_EQ(1UL, stack.size());
+    return std::move(stack.back());
+}
+
+
+StatusOr<ValueColumn>
+ExpressionProgram::evalBatch(const std::vector<const ValueColumn*> &columns, size_t rows) const {
+    DCHECK_EQ(slots_.size(), columns.size());
+    std::vector<ValueColumn> stack;
+    stack.reserve(depth_);
+    for (auto &inst : code_) {
+        switch (inst.code) {
+            case kPushConst:
+                stack.emplace_back(ValueColumn::repeat(consts_[inst.index], rows));
+                break;
+            case kLoadSlot:
+                DCHECK_EQ(rows, columns[inst.index]->size());
+                stack.emplace_back(*columns[inst.index]);
+                break;
+            case kUnary: {
+                auto status = unaryBatch(static_cast<UnaryExpression::Operator>(inst.op),
+                                         &stack.back());
+                if (!status.ok()) {
+                    return status;
+                }
+                break;
+            }
+            case kArithmetic:
+            case kRelational:
+            case kLogical: {
+                auto &l = stack[stack.size() - 2];
+                auto &r = stack.back();
+                ValueColumn result;
+                Status status;
+                if (inst.code == kArithmetic) {
+                    status = arithmeticBatch(
+                            static_cast<ArithmeticExpression::Operator>(inst.op), l, r, &result);
+                } else if (inst.code == kRelational) {
+                    status = relationalBatch(
+                            static_cast<RelationalExpression::Operator>(inst.op), l, r, &result);
+                } else {
+                    status = logicalBatch(
+                            static_cast<LogicalExpression::Operator>(inst.op), l, r, &result);
+                }
+                if (!status.ok()) {
+                    return status;
+                }
+                stack.pop_back();
+                stack.back() = std::move(result);
+                break;
+            }
+        }
+    }
+    DCHECK_EQ(1UL, stack.size());
+    return std::move(stack.back());
+}
+
+
+// static
+Status ExpressionProgram::unaryBatch(UnaryExpression::Operator op, ValueColumn *operand) {
+    if (op == UnaryExpression::PLUS) {
+        return Status::OK();
+    }
+    if (op == UnaryExpression::NEGATE && operand->type_ == ValueColumn::kInt) {
+        for (auto &v : operand->ints_) {
+            v = -v;
+        }
+        return Status::OK();
+    }
+    if (op == UnaryExpression::NEGATE && operand->type_ == ValueColumn::kDouble) {
+        for (auto &v : operand->doubles_) {
+            v = -v;
+        }
+        return Status::OK();
+    }
+    if (op == UnaryExpression::NOT && operand->type_ == ValueColumn::kBool) {
+        for (auto &v : operand->bools_) {
+            v = !v;
+        }
+        return Status::OK();
+    }
+    ValueColumn result;
+    auto rows = operand->size();
+    result.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+        auto value = UnaryExpression::apply(op, operand->at(i));
+        if (!value.ok()) {
+            return value.status();
+        }
+        result.append(value.value());
+    }
+    *operand = std::move(result);
+    return Status::OK();
+}
+
+
+// static
+Status ExpressionProgram::arithmeticBatch(ArithmeticExpression::Operator op,
+                                          const ValueColumn &l,
+                                          const ValueColumn &r,
+                                          ValueColumn *result) {
+    if (l.type_ == ValueColumn::kInt && r.type_ == ValueColumn::kInt) {
+        result->type_ = ValueColumn::kInt;
+        auto *out = &result->ints_;
+        switch (op) {
+            case ArithmeticExpression::ADD:
+                binaryLoop(l.ints_, r.ints_, out, [] (int64_t a, int64_t b) { return a + b; });
+                return Status::OK();
+            case ArithmeticExpression::SUB:
+                binaryLoop(l.ints_, r.ints_, out, [] (int64_t a, int64_t b) { return a - b; });
+                return Status::OK();
+            case ArithmeticExpression::MUL:
+                binaryLoop(l.ints_, r.ints_, out, [] (int64_t a, int64_t b) { return a * b; });
+                return Status::OK();
+            case ArithmeticExpression::DIV:
+            case ArithmeticExpression::MOD: {
+                auto status = checkDivisors(l.ints_, r.ints_);
+                if (!status.ok()) {
+                    return status;
+                }
+                if (op == ArithmeticExpression::DIV) {
+                    binaryLoop(l.ints_, r.ints_, out,
+                               [] (int64_t a, int64_t b) { return a / b; });
+                } else {
+                    binaryLoop(l.ints_, r.ints_, out,
+                               [] (int64_t a, int64_t b) { return a % b; });
+                }
+                return Status::OK();
+            }
+        }
+    }
+    auto isNumeric = [] (const ValueColumn &c) {
+        return c.type_ == ValueColumn::kInt || c.type_ == ValueColumn::kDouble;
+    };
+    if (isNumeric(l) && isNumeric(r) && op != ArithmeticExpression::MOD) {
+        // At least one of them is double
+        auto ld = l.type_ == ValueColumn::kDouble ? l.doubles_ : toDoubles(l.ints_);
+        auto rd = r.type_ == ValueColumn::kDouble ? r.doubles_ : toDoubles(r.ints_);
+        result->type_ = ValueColumn::kDouble;
+        auto *out = &result->doubles_;
+        switch (op) {
+            case ArithmeticExpression::ADD:
+                binaryLoop(ld, rd, out, [] (double a, double b) { return a + b; });
+                return Status::OK();
+            case ArithmeticExpression::SUB:
+                binaryLoop(ld, rd, out, [] (double a, double b) { return a - b; });
+                return Status::OK();
+            case ArithmeticExpression::MUL:
+                binaryLoop(ld, rd, out, [] (double a, double b) { return a * b; });
+                return Status::OK();
+            case ArithmeticExpression::DIV:
+                binaryLoop(ld, rd, out, [] (double a, double b) { return a / b; });
+                return Status::OK();
+            default:
+                break;
+        }
+    }
+    return genericLoop(l, r, result, [op] (const VariantType &a, const VariantType &b) {
+        return ArithmeticExpression::apply(op, a, b);
+    });
+}
+
+
+// static
+Status ExpressionProgram::relationalBatch(RelationalExpression::Operator op,
+                                          const ValueColumn &l,
+                                          const ValueColumn &r,
+                                          ValueColumn *result) {
+    // Values of different types are compared by the rules of VariantType, row by row.
+    if (l.type_ == ValueColumn::kInt && r.type_ == ValueColumn::kInt) {
+        result->type_ = ValueColumn::kBool;
+        auto *out = &result->bools_;
+        switch (op) {
+            case RelationalExpression::LT:
+                binaryLoop(l.ints_, r.ints_, out, [] (int64_t a, int64_t b) { return a < b; });
+                return Status::OK();
+            case RelationalExpression::LE:
+                binaryLoop(l.ints_, r.ints_, out, [] (int64_t a, int64_t b) { return a <= b; });
+                return Status::OK();
+            case RelationalExpression::GT:
+                binaryLoop(l.ints_, r.ints_, out, [] (int64_t a, int64_t b) { return a > b; });
+                return Status::OK();
+            case RelationalExpression::GE:
+                binaryLoop(l.ints_, r.ints_, out, [] (int64_t a, int64_t b) { return a >= b; });
+                return Status::OK();
+            case RelationalExpression::EQ:
+                binaryLoop(l.ints_, r.ints_, out, [] (int64_t a, int64_t b) { return a == b; });
+                return Status::OK();
+            case RelationalExpression::NE:
+                binaryLoop(l.ints_, r.ints_, out, [] (int64_t a, int64_t b) { return a != b; });
+                return Status::OK();
+        }
+    }
+    if (l.type_ == ValueColumn::kDouble && r.type_ == ValueColumn::kDouble) {
+        result->type_ = ValueColumn::kBool;
+        auto *out = &result->bools_;
+        switch (op) {
+            case RelationalExpression::LT:
+                binaryLoop(l.doubles_, r.doubles_, out, [] (double a, double b) { return a < b; });
+                return Status::OK();
+            case RelationalExpression::LE:
+                binaryLoop(l.doubles_, r.doubles_, out,
+                           [] (double a, double b) { return a <= b; });
+                return Status::OK();
+            case RelationalExpression::GT:
+                binaryLoop(l.doubles_, r.doubles_, out, [] (double a, double b) { return a > b; });
+                return Status::OK();
+            case RelationalExpression::GE:
+                binaryLoop(l.doubles_, r.doubles_, out,
+                           [] (double a, double b) { return a >= b; });
+                return Status::OK();
+            case RelationalExpression::EQ:
+                binaryLoop(l.doubles_, r.doubles_, out, [] (double a, double b) {
+                    return Expression::almostEqual(a, b);
+                });
+                return Status::OK();
+            case RelationalExpression::NE:
+                binaryLoop(l.doubles_, r.doubles_, out, [] (double a, double b) {
+                    return !Expression::almostEqual(a, b);
+                });
+                return Status::OK();
+        }
+    }
+    return genericLoop(l, r, result, [op] (const VariantType &a, const VariantType &b) {
+        return RelationalExpression::apply(op, a, b);
+    });
+}
+
+
+// static
+Status ExpressionProgram::logicalBatch(LogicalExpression::Operator op,
+                                       const ValueColumn &l,
+                                       const ValueColumn &r,
+                                       ValueColumn *result) {
+    if (l.type_ == ValueColumn::kBool && r.type_ == ValueColumn::kBool) {
+        result->type_ = ValueColumn::kBool;
+        if (op == LogicalExpression::AND) {
+            binaryLoop(l.bools_, r.bools_, &result->bools_,
+                       [] (uint8_t a, uint8_t b) -> uint8_t { return a & b; });
+        } else {
+            binaryLoop(l.bools_, r.bools_, &result->bools_,
+                       [] (uint8_t a, uint8_t b) -> uint8_t { return a | b; });
+        }
+        return Status::OK();
+    }
+    return genericLoop(l, r, result, [op] (const VariantType &a, const VariantType &b) {
+        return LogicalExpression::apply(op, a, b);
+    });
+}
+
+}   // namespace nebula
@@ -0,0 +1,172 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+#ifndef COMMON_FILTER_EXPRESSIONPROGRAM_H_
+#define COMMON_FILTER_EXPRESSIONPROGRAM_H_
+
+#include "base/Base.h"
+#include "base/StatusOr.h"
+#include "filter/Expressions.h"
+
+namespace nebula {
+
+/**
+ * Values of one slot, or of one intermediate result, over a batch of rows.
+ *
+ * Values are kept in a typed vector as long as all of them share the same type,
+ * so that operators on integers, doubles and booleans run in tight loops over plain arrays.
+ * Strings and mixed types fall back to a vector of VariantType.
+ */
+class ValueColumn final {
+public:
+    enum Type : uint8_t {
+        kEmpty,
+        kInt,
+        kDouble,
+        kBool,
+        kVariant,
+    };
+
+    static ValueColumn repeat(const VariantType &value, size_t rows);
+
+    /**
+     * Build a column upon the values decoded at once, e.g. by ColumnReader.
+     */
+    static ValueColumn ofInts(std::vector<int64_t> values);
+    static ValueColumn ofDoubles(std::vector<double> values);
+    static ValueColumn ofBools(const std::vector<bool> &values);
+
+    /**
+     * Copy the rows [begin, end), or only the given ones of them if `rows' is not null,
+     * which are relative to `begin'.
+     */
+    ValueColumn slice(size_t begin, size_t end, const std::vector<uint32_t> *rows) const;
+
+    void append(const VariantType &value);
+
+    VariantType at(size_t i) const;
+
+    size_t size() const;
+
+    Type type() const {
+        return type_;
+    }
+
+    void reserve(size_t rows);
+
+    /**
+     * Collect the index of the rows whose value is true.
+     */
+    void select(std::vector<uint32_t> *rows) const;
+
+private:
+    friend class ExpressionProgram;
+
+    void toVariant();
+
+private:
+    Type                                        type_{kEmpty};
+    std::vector<int64_t>                        ints_;
+    std::vector<double>                         doubles_;
+    std::vector<uint8_t>                        bools_;
+    std::vector<VariantType>                    variants_;
+};
+
+
+/**
+ * A flat, postfix form of an expression tree.
+ *
+ * Every property referenced by the expression is turned into a slot, which is resolved
+ * by the caller once (e.g. to a field index of a schema) and then filled for each row.
+ * Evaluation is a loop over the instructions on a small value stack, so there are
+ * no virtual calls and no std::function getters on the hot path.
+ *
+ * A program is immutable once compiled, so it could be shared among threads.
+ */
+class ExpressionProgram final {
+public:
+    struct Slot {
+        Expression::Kind    kind;
+        std::string         alias;
+        std::string         prop;
+    };
+
+    using SlotValues = std::vector<VariantType>;
+
+    /**
+     * Compile the expression tree into a program.
+     * Function calls and type castings are not supported yet, the caller should
+     * fall back to `Expression::eval' when it returns an error.
+     */
+    static StatusOr<std::unique_ptr<ExpressionProgram>> compile(const Expression *expr);
+
+    const std::vector<Slot>& slots() const {
+        return slots_;
+    }
+
+    /**
+     * Evaluate the program, `values' should be filled in the order of `slots()'.
+     */
+    OptVariantType eval(const SlotValues &values) const;
+
+    /**
+     * Evaluate the program over a batch of `rows' rows, one instruction at a time.
+     * `columns' should be in the order of `slots()', each of which holds `rows' values.
+     */
+    StatusOr<ValueColumn> evalBatch(const std::vector<const ValueColumn*> &columns,
+                                    size_t rows) const;
+
+private:
+    enum OpCode : uint8_t {
+        kPushConst,
+        kLoadSlot,
+        kUnary,
+        kArithmetic,
+        kRelational,
+        kLogical,
+    };
+
+    struct Instruction {
+        OpCode      code;
+        // Operator of the unary or binary instruction
+        uint8_t     op;
+        // Index into consts_ or slots
+        uint32_t    index;
+    };
+
+    ExpressionProgram() = default;
+
+    Status emit(const Expression *expr);
+
+    uint32_t addSlot(Expression::Kind kind, const std::string &alias, const std::string &prop);
+
+    static Status unaryBatch(UnaryExpression::Operator op, ValueColumn *operand);
+
+    static Status arithmeticBatch(ArithmeticExpression::Operator op,
+                                  const ValueColumn &l,
+                                  const ValueColumn &r,
+                                  ValueColumn *result);
+
+    static Status relationalBatch(RelationalExpression::Operator op,
+                                  const ValueColumn &l,
+                                  const ValueColumn &r,
+                                  ValueColumn *result);
+
+    static Status logicalBatch(LogicalExpression::Operator op,
+                               const ValueColumn &l,
+                               const ValueColumn &r,
+                               ValueColumn *result);
+
+private:
+    std::vector<Instruction>                    code_;
+    std::vector<VariantType>                    consts_;
+    std::vector<Slot>                           slots_;
+    // The max depth of the value stack
+    size_t                                      depth_{0};
+};
+
+}   // namespace nebula
+
+#endif  // COMMON_FILTER_EXPRESSIONPROGRAM_H_
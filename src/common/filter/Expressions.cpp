@@ -81,7 +81,7 @@ std::unique_ptr<Expression> Expression::makeExpr(uint8_t kind) {
 
 
 // static
-std::string Expression::encode(Expression *expr) noexcept {
+std::string Expression::encode(const Expression *expr) noexcept {
     Cord cord(1024);
     expr->encode(cord);
     return cord.str();
@@ -654,22 +654,27 @@ std::string UnaryExpression::toString() const {
 
 OptVariantType UnaryExpression::eval() const {
     auto value = operand_->eval();
-    if (value.ok()) {
-        if (op_ == PLUS) {
-            return value;
-        } else if (op_ == NEGATE) {
-            if (isInt(value.value())) {
-                return OptVariantType(-asInt(value.value()));
-            } else if (isDouble(value.value())) {
-                return OptVariantType(-asDouble(value.value()));
-            }
-        } else {
-            return OptVariantType(!asBool(value.value()));
+    if (!value.ok()) {
+        return value;
+    }
+    return apply(op_, value.value());
+}
+
+OptVariantType UnaryExpression::apply(Operator op, const VariantType &value) {
+    if (op == PLUS) {
+        return value;
+    } else if (op == NEGATE) {
+        if (isInt(value)) {
+            return OptVariantType(-asInt(value));
+        } else if (isDouble(value)) {
+            return OptVariantType(-asDouble(value));
         }
+    } else {
+        return OptVariantType(!asBool(value));
     }
 
     return OptVariantType(Status::Error(folly::sformat(
-        "attempt to perform unary arithmetic on a {}", value.value().type().name())));
+        "attempt to perform unary arithmetic on a {}", value.type().name())));
 }
 
 Status UnaryExpression::prepare() {
@@ -798,10 +803,13 @@ OptVariantType ArithmeticExpression::eval() const {
         return right;
     }
 
-    auto l = left.value();
-    auto r = right.value();
+    return apply(op_, left.value(), right.value());
+}
 
-    switch (op_) {
+OptVariantType ArithmeticExpression::apply(Operator op,
+                                           const VariantType &l,
+                                           const VariantType &r) {
+    switch (op) {
         case ADD:
             if (isArithmetic(l) && isArithmetic(r)) {
                 if (isDouble(l) || isDouble(r)) {
@@ -835,11 +843,19 @@ OptVariantType ArithmeticExpression::eval() const {
                 if (isDouble(l) || isDouble(r)) {
                     return OptVariantType(asDouble(l) / asDouble(r));
                 }
+                auto status = checkDivisor(asInt(l), asInt(r));
+                if (!status.ok()) {
+                    return OptVariantType(std::move(status));
+                }
                 return OptVariantType(asInt(l) / asInt(r));
             }
             break;
         case MOD:
             if (isInt(l) && isInt(r)) {
+                auto status = checkDivisor(asInt(l), asInt(r));
+                if (!status.ok()) {
+                    return OptVariantType(std::move(status));
+                }
                 return OptVariantType(asInt(l) % asInt(r));
             }
             break;
@@ -851,6 +867,18 @@ OptVariantType ArithmeticExpression::eval() const {
         "attempt to perform arithmetic on {} with {}", l.type().name(), r.type().name())));
 }
 
+// static
+Status ArithmeticExpression::checkDivisor(int64_t dividend, int64_t divisor) {
+    if (divisor == 0) {
+        return Status::Error("Division by zero");
+    }
+    // The quotient overflows, which traps just like dividing by zero
+    if (divisor == -1 && dividend == std::numeric_limits<int64_t>::min()) {
+        return Status::Error("Division overflow");
+    }
+    return Status::OK();
+}
+
 Status ArithmeticExpression::prepare() {
     auto status = left_->prepare();
     if (!status.ok()) {
@@ -928,9 +956,13 @@ OptVariantType RelationalExpression::eval() const {
         return right;
     }
 
-    auto l = left.value();
-    auto r = right.value();
-    switch (op_) {
+    return apply(op_, left.value(), right.value());
+}
+
+OptVariantType RelationalExpression::apply(Operator op,
+                                           const VariantType &l,
+                                           const VariantType &r) {
+    switch (op) {
         case LT:
             return OptVariantType(l < r);
         case LE:
@@ -1025,16 +1057,22 @@ OptVariantType LogicalExpression::eval() const {
         return right;
     }
 
-    if (op_ == AND) {
-        if (!asBool(left.value())) {
+    return apply(op_, left.value(), right.value());
+}
+
+OptVariantType LogicalExpression::apply(Operator op,
+                                        const VariantType &l,
+                                        const VariantType &r) {
+    if (op == AND) {
+        if (!asBool(l)) {
             return OptVariantType(false);
         }
-        return OptVariantType(asBool(right.value()));
+        return OptVariantType(asBool(r));
     } else {
-        if (asBool(left.value())) {
+        if (asBool(l)) {
             return OptVariantType(true);
         }
-        return OptVariantType(asBool(right.value()));
+        return OptVariantType(asBool(r));
     }
 }
 
@@ -141,7 +141,7 @@ public:
      *
      * We assume the same byte order on both sides of the buffer
      */
-    static std::string encode(Expression *expr) noexcept;
+    static std::string encode(const Expression *expr) noexcept;
 
     /**
      * To decode an expression from a byte buffer.
@@ -452,6 +452,8 @@ class EdgeTypeExpression final : public AliasPropertyExpression {
 public:
     EdgeTypeExpression() {
         kind_ = kEdgeType;
+        ref_.reset(new std::string(""));
+        prop_.reset(new std::string("_type"));
     }
 
     explicit EdgeTypeExpression(std::string *alias) {
@@ -477,6 +479,8 @@ class EdgeSrcIdExpression final : public AliasPropertyExpression {
 public:
     EdgeSrcIdExpression() {
         kind_ = kEdgeSrcId;
+        ref_.reset(new std::string(""));
+        prop_.reset(new std::string("_src"));
     }
 
     explicit EdgeSrcIdExpression(std::string *alias) {
@@ -502,6 +506,8 @@ class EdgeDstIdExpression final : public AliasPropertyExpression {
 public:
     EdgeDstIdExpression() {
         kind_ = kEdgeDstId;
+        ref_.reset(new std::string(""));
+        prop_.reset(new std::string("_dst"));
     }
 
     explicit EdgeDstIdExpression(std::string *alias) {
@@ -527,6 +533,8 @@ class EdgeRankExpression final : public AliasPropertyExpression {
 public:
     EdgeRankExpression() {
         kind_ = kEdgeRank;
+        ref_.reset(new std::string(""));
+        prop_.reset(new std::string("_rank"));
     }
 
     explicit EdgeRankExpression(std::string *alias) {
@@ -605,6 +613,10 @@ public:
 
     Status MUST_USE_RESULT prepare() override;
 
+    const VariantType& value() const {
+        return operand_;
+    }
+
 private:
     void encode(Cord &cord) const override;
 
@@ -699,6 +711,16 @@ public:
         operand_->setContext(context);
     }
 
+    /**
+     * Apply the operator on an already evaluated operand.
+     * It is shared by the tree-walking `eval' and the compiled `ExpressionProgram'.
+     */
+    static OptVariantType apply(Operator op, const VariantType &value);
+
+    Operator op() const {
+        return op_;
+    }
+
     const Expression* operand() const {
         return operand_.get();
     }
@@ -788,6 +810,17 @@ public:
         right_->setContext(context);
     }
 
+    static OptVariantType apply(Operator op, const VariantType &l, const VariantType &r);
+
+    /**
+     * Check the integer divisor of `/' and `%', which would trap the process otherwise.
+     */
+    static Status checkDivisor(int64_t dividend, int64_t divisor);
+
+    Operator op() const {
+        return op_;
+    }
+
     const Expression* left() const {
         return left_.get();
     }
@@ -839,6 +872,12 @@ public:
         right_->setContext(context);
     }
 
+    static OptVariantType apply(Operator op, const VariantType &l, const VariantType &r);
+
+    Operator op() const {
+        return op_;
+    }
+
     const Expression* left() const {
         return left_.get();
     }
@@ -891,6 +930,12 @@ public:
         right_->setContext(context);
     }
 
+    Operator op() const {
+        return op_;
+    }
+
+    static OptVariantType apply(Operator op, const VariantType &l, const VariantType &r);
+
     const Expression* left() const {
         return left_.get();
     }
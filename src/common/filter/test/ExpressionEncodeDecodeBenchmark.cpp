@@ -6,9 +6,15 @@
 #include "base/Base.h"
 #include <folly/Benchmark.h>
 #include "filter/Expressions.h"
+#include "filter/ExpressionProgram.h"
 #include "parser/GQLParser.h"
 
 using nebula::Expression;
+using nebula::ExpressionContext;
+using nebula::ExpressionProgram;
+using nebula::OptVariantType;
+using nebula::ValueColumn;
+using nebula::VariantType;
 using nebula::GQLParser;
 using nebula::SequentialSentences;
 using nebula::GoSentence;
@@ -70,6 +76,113 @@ size_t Decode(size_t iters, std::string query) {
     return iters * ops;
 }
 
+static const std::unordered_map<std::string, VariantType> kProps = {
+    {"prop1", 1L}, {"prop2", 2L}, {"prop3", 3L}, {"prop4", 4L}, {"prop5", 5L}, {"prop6", 5L},
+};
+
+size_t EvalTree(size_t iters, std::string query) {
+    constexpr size_t ops = 1000000UL;
+
+    query = "GO FROM 1 AS p OVER q WHERE " + query;
+    std::unique_ptr<Expression> expr;
+    auto ctx = std::make_unique<ExpressionContext>();
+    BENCHMARK_SUSPEND {
+        GQLParser parser;
+        auto result = parser.parse(query);
+        if (!result.ok()) {
+             return 0;
+        }
+        expr = std::move(Expression::decode(
+                    Expression::encode(getFilterExpr(result.value().get())))).value();
+        ctx->getters().getAliasProp = [] (const std::string&,
+                                          const std::string &prop) -> OptVariantType {
+            return kProps.find(prop)->second;
+        };
+        expr->setContext(ctx.get());
+    }
+
+    auto i = 0UL;
+    while (i++ < ops * iters) {
+        auto value = expr->eval();
+        folly::doNotOptimizeAway(i);
+        folly::doNotOptimizeAway(value);
+    }
+
+    return iters * ops;
+}
+
+size_t EvalProgram(size_t iters, std::string query) {
+    constexpr size_t ops = 1000000UL;
+
+    query = "GO FROM 1 AS p OVER q WHERE " + query;
+    std::unique_ptr<ExpressionProgram> program;
+    std::vector<const VariantType*> sources;
+    ExpressionProgram::SlotValues values;
+    BENCHMARK_SUSPEND {
+        GQLParser parser;
+        auto result = parser.parse(query);
+        if (!result.ok()) {
+             return 0;
+        }
+        program = std::move(ExpressionProgram::compile(
+                    getFilterExpr(result.value().get()))).value();
+        // Resolve each slot once, just like resolving a field index within a schema
+        for (auto &slot : program->slots()) {
+            sources.emplace_back(&kProps.find(slot.prop)->second);
+        }
+        values.resize(sources.size());
+    }
+
+    auto i = 0UL;
+    while (i++ < ops * iters) {
+        for (auto j = 0u; j < sources.size(); j++) {
+            values[j] = *sources[j];
+        }
+        auto value = program->eval(values);
+        folly::doNotOptimizeAway(i);
+        folly::doNotOptimizeAway(value);
+    }
+
+    return iters * ops;
+}
+
+// Each batch holds the values of all the edges of a vertex
+size_t EvalBatch(size_t iters, std::string query) {
+    constexpr size_t ops = 1000000UL;
+    constexpr size_t rows = 1000UL;
+
+    query = "GO FROM 1 AS p OVER q WHERE " + query;
+    std::unique_ptr<ExpressionProgram> program;
+    std::vector<ValueColumn> columns;
+    std::vector<const ValueColumn*> inputs;
+    BENCHMARK_SUSPEND {
+        GQLParser parser;
+        auto result = parser.parse(query);
+        if (!result.ok()) {
+             return 0;
+        }
+        program = std::move(ExpressionProgram::compile(
+                    getFilterExpr(result.value().get()))).value();
+        columns.resize(program->slots().size());
+        for (auto i = 0u; i < columns.size(); i++) {
+            auto &value = kProps.find(program->slots()[i].prop)->second;
+            for (auto row = 0UL; row < rows; row++) {
+                columns[i].append(value);
+            }
+            inputs.emplace_back(&columns[i]);
+        }
+    }
+
+    auto i = 0UL;
+    while (i++ < ops / rows * iters) {
+        auto value = program->evalBatch(inputs, rows);
+        folly::doNotOptimizeAway(i);
+        folly::doNotOptimizeAway(value);
+    }
+
+    return iters * ops;
+}
+
 auto simpleQuery =  "123 + 123 - 123 * 123 / 123";
 auto complexQuery =  "alias.prop1 + alias.prop2 * alias.prop3 > alias.prop4 && "
                      "alias.prop5 == alias.prop6";
@@ -82,6 +195,15 @@ BENCHMARK_DRAW_LINE();
 BENCHMARK_NAMED_PARAM_MULTI(Decode, Simple, simpleQuery);
 BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(Decode, Complex, complexQuery);
 
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM_MULTI(EvalTree, Simple, simpleQuery);
+BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(EvalProgram, Simple, simpleQuery);
+BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(EvalBatch, Simple, simpleQuery);
+BENCHMARK_NAMED_PARAM_MULTI(EvalTree, Complex, complexQuery);
+BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(EvalProgram, Complex, complexQuery);
+BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(EvalBatch, Complex, complexQuery);
+
 int
 main(int argc, char **argv) {
     gflags::ParseCommandLineFlags(&argc, &argv, true);
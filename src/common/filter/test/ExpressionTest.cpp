@@ -7,6 +7,7 @@
 #include "base/Base.h"
 #include <gtest/gtest.h>
 #include "filter/FunctionManager.h"
+#include "filter/ExpressionProgram.h"
 #include "parser/GQLParser.h"
 #include "parser/SequentialSentences.h"
 
@@ -651,7 +652,237 @@ TEST_F(ExpressionTest, InvalidExpressionTest) {
     TEST_EXPR(1.0 % "a");
     TEST_EXPR(-"A");
     TEST_EXPR(TRUE + FALSE);
+    TEST_EXPR(1 / 0);
+    TEST_EXPR(1 % 0);
+    TEST_EXPR(1 / (2 - 2));
 #undef TEST_EXPR
 }
 
+
+TEST_F(ExpressionTest, CompiledProgram) {
+    GQLParser parser;
+    std::unordered_map<std::string, VariantType> props = {
+        {"name", std::string("Tony Parker")},
+        {"age", 36L},
+        {"likeness", 95L},
+        {"weight", 97.5},
+        {"_dst", 101L},
+        {"_rank", 0L},
+    };
+    auto getProp = [&] (const std::string &prop) -> OptVariantType {
+        auto it = props.find(prop);
+        if (it == props.end()) {
+            return Status::Error("Prop `%s' not found", prop.c_str());
+        }
+        return it->second;
+    };
+    auto ctx = std::make_unique<ExpressionContext>();
+    ctx->getters().getInputProp = getProp;
+    ctx->getters().getSrcTagProp = [&] (auto &, auto &prop) { return getProp(prop); };
+    ctx->getters().getDstTagProp = [&] (auto &, auto &prop) { return getProp(prop); };
+    ctx->getters().getAliasProp = [&] (auto &, auto &prop) { return getProp(prop); };
+#define TEST_EXPR(expr_arg)                                                 \
+    do {                                                                    \
+        std::string query = "GO FROM 1 OVER like WHERE " expr_arg;          \
+        auto parsed = parser.parse(query);                                  \
+        ASSERT_TRUE(parsed.ok()) << parsed.status();                        \
+        auto *expr = getFilterExpr(parsed.value().get());                   \
+        ASSERT_NE(nullptr, expr);                                           \
+        expr->setContext(ctx.get());                                        \
+        auto expected = expr->eval();                                       \
+        auto program = ExpressionProgram::compile(expr);                    \
+        ASSERT_TRUE(program.ok()) << program.status();                      \
+        auto &slots = program.value()->slots();                             \
+        ExpressionProgram::SlotValues values;                               \
+        for (auto &slot : slots) {                                          \
+            values.emplace_back(getProp(slot.prop).value());                \
+        }                                                                   \
+        auto actual = program.value()->eval(values);                        \
+        ASSERT_EQ(expected.ok(), actual.ok()) << expr->toString();          \
+        if (expected.ok()) {                                                \
+            ASSERT_EQ(expected.value(), actual.value()) << expr->toString(); \
+        }                                                                   \
+    } while (false)
+
+    TEST_EXPR("like.likeness >= 90");
+    TEST_EXPR("like.likeness >= 90 && $^.person.age > 40");
+    TEST_EXPR("like.likeness >= 90 || $^.person.age > 40");
+    TEST_EXPR("$$.person.name == \"Tony Parker\" && like._dst != 100");
+    TEST_EXPR("$-.age * 2 + like.likeness - 1 == 166");
+    TEST_EXPR("$-.weight / 2 > $-.age % 7");
+    TEST_EXPR("!(like.likeness > 90) || -$-.age < -30");
+    TEST_EXPR("like._rank == 0 && like._type == \"like\"");
+    TEST_EXPR("$-.age + $-.age + $-.age == 108");
+    TEST_EXPR("$-.name + 1 > 0");
+    TEST_EXPR("-$-.name");
+#undef TEST_EXPR
+
+    // The same prop is referenced by only one slot
+    {
+        auto parsed = parser.parse("GO FROM 1 OVER like WHERE $-.age > 1 && $-.age < 100");
+        ASSERT_TRUE(parsed.ok()) << parsed.status();
+        auto program = ExpressionProgram::compile(getFilterExpr(parsed.value().get()));
+        ASSERT_TRUE(program.ok()) << program.status();
+        ASSERT_EQ(1UL, program.value()->slots().size());
+        ASSERT_EQ(Expression::kInputProp, program.value()->slots()[0].kind);
+    }
+    // Function calls are evaluated by tree
+    {
+        auto parsed = parser.parse("GO FROM 1 OVER like WHERE abs($-.age) > 1");
+        ASSERT_TRUE(parsed.ok()) << parsed.status();
+        auto program = ExpressionProgram::compile(getFilterExpr(parsed.value().get()));
+        ASSERT_FALSE(program.ok());
+    }
+}
+
+
+TEST_F(ExpressionTest, BatchEvaluation) {
+    GQLParser parser;
+    // Each prop is a column of 4 rows, some of which have mixed types.
+    std::unordered_map<std::string, std::vector<VariantType>> props = {
+        {"age", {36L, 42L, 19L, 33L}},
+        {"likeness", {95L, 80L, 99L, 90L}},
+        {"weight", {97.5, 110.0, 80.25, 90.0}},
+        {"score", {1L, 2.5, 3L, true}},
+        {"name", {std::string("Tony"), std::string("Tim"),
+                  std::string("Manu"), std::string("Tony")}},
+        {"married", {true, false, false, true}},
+    };
+    constexpr size_t kRows = 4;
+#define TEST_EXPR(expr_arg)                                                 \
+    do {                                                                    \
+        std::string query = "GO FROM 1 OVER like WHERE " expr_arg;          \
+        auto parsed = parser.parse(query);                                  \
+        ASSERT_TRUE(parsed.ok()) << parsed.status();                        \
+        auto *expr = getFilterExpr(parsed.value().get());                   \
+        ASSERT_NE(nullptr, expr);                                           \
+        auto program = ExpressionProgram::compile(expr);                    \
+        ASSERT_TRUE(program.ok()) << program.status();                      \
+        auto &slots = program.value()->slots();                             \
+        std::vector<ValueColumn> columns(slots.size());                     \
+        for (auto i = 0u; i < slots.size(); i++) {                          \
+            for (auto &v : props[slots[i].prop]) {                          \
+                columns[i].append(v);                                       \
+            }                                                               \
+        }                                                                   \
+        std::vector<const ValueColumn*> inputs;                             \
+        for (auto &column : columns) {                                      \
+            inputs.emplace_back(&column);                                   \
+        }                                                                   \
+        auto batch = program.value()->evalBatch(inputs, kRows);             \
+        ASSERT_TRUE(batch.ok()) << batch.status();                          \
+        ASSERT_EQ(kRows, batch.value().size());                             \
+        for (auto row = 0u; row < kRows; row++) {                           \
+            ExpressionProgram::SlotValues values;                           \
+            for (auto &slot : slots) {                                      \
+                values.emplace_back(props[slot.prop][row]);                 \
+            }                                                               \
+            auto expected = program.value()->eval(values);                  \
+            ASSERT_TRUE(expected.ok()) << expected.status();                \
+            ASSERT_EQ(expected.value(), batch.value().at(row))              \
+                << expr->toString() << ", row " << row;                     \
+        }                                                                   \
+    } while (false)
+
+    TEST_EXPR("like.likeness >= 90");
+    TEST_EXPR("like.likeness >= 90 && $^.person.age > 30");
+    TEST_EXPR("like.likeness < 90 || !$^.person.married");
+    TEST_EXPR("$^.person.age * 2 + like.likeness - 1");
+    TEST_EXPR("$^.person.age / 2 + like.likeness % 7");
+    TEST_EXPR("$^.person.weight / 2 > $^.person.age");
+    TEST_EXPR("$^.person.weight == 90.0 || $^.person.weight != 110.0");
+    TEST_EXPR("-$^.person.weight + 100");
+    TEST_EXPR("$^.person.age + $^.person.weight");
+    TEST_EXPR("$^.person.name == \"Tony\" && $^.person.age > 35");
+    TEST_EXPR("$^.person.name + \"!\"");
+    TEST_EXPR("$^.person.score > 1 || like.likeness > 98");
+    TEST_EXPR("like.likeness > 90 && 3.14");
+    TEST_EXPR("true");
+#undef TEST_EXPR
+
+    // Rows selected by the filter
+    {
+        auto parsed = parser.parse("GO FROM 1 OVER like WHERE like.likeness >= 90");
+        ASSERT_TRUE(parsed.ok()) << parsed.status();
+        auto program = ExpressionProgram::compile(getFilterExpr(parsed.value().get()));
+        ASSERT_TRUE(program.ok()) << program.status();
+        ValueColumn column;
+        for (auto &v : props["likeness"]) {
+            column.append(v);
+        }
+        ASSERT_EQ(ValueColumn::kInt, column.type());
+        auto result = program.value()->evalBatch({&column}, kRows);
+        ASSERT_TRUE(result.ok()) << result.status();
+        ASSERT_EQ(ValueColumn::kBool, result.value().type());
+        std::vector<uint32_t> selected;
+        result.value().select(&selected);
+        std::vector<uint32_t> expected = {0, 2, 3};
+        ASSERT_EQ(expected, selected);
+    }
+    // Errors are reported as the row by row evaluation does
+    {
+        auto parsed = parser.parse("GO FROM 1 OVER like WHERE $^.person.name - 1");
+        ASSERT_TRUE(parsed.ok()) << parsed.status();
+        auto program = ExpressionProgram::compile(getFilterExpr(parsed.value().get()));
+        ASSERT_TRUE(program.ok()) << program.status();
+        ValueColumn column;
+        for (auto &v : props["name"]) {
+            column.append(v);
+        }
+        ASSERT_EQ(ValueColumn::kVariant, column.type());
+        ASSERT_FALSE(program.value()->evalBatch({&column}, kRows).ok());
+    }
+    // Dividing by zero fails the batch instead of trapping
+    for (auto *op : {"/", "%"}) {
+        auto query = folly::stringPrintf("GO FROM 1 OVER like WHERE like.likeness %s $-.age",
+                                         op);
+        auto parsed = parser.parse(query);
+        ASSERT_TRUE(parsed.ok()) << parsed.status();
+        auto program = ExpressionProgram::compile(getFilterExpr(parsed.value().get()));
+        ASSERT_TRUE(program.ok()) << program.status();
+        ValueColumn likeness;
+        ValueColumn age;
+        for (auto i = 0u; i < kRows; i++) {
+            likeness.append(props["likeness"][i]);
+            age.append(i == 2 ? 0L : boost::get<int64_t>(props["age"][i]));
+        }
+        ASSERT_EQ(ValueColumn::kInt, age.type());
+        std::vector<const ValueColumn*> inputs;
+        for (auto &slot : program.value()->slots()) {
+            inputs.emplace_back(slot.prop == "age" ? &age : &likeness);
+        }
+        ASSERT_FALSE(program.value()->evalBatch(inputs, kRows).ok());
+    }
+}
+
+
+TEST_F(ExpressionTest, SliceColumn) {
+    auto ints = ValueColumn::ofInts({1, 2, 3, 4, 5});
+    ASSERT_EQ(ValueColumn::kInt, ints.type());
+    auto slice = ints.slice(1, 4, nullptr);
+    ASSERT_EQ(ValueColumn::kInt, slice.type());
+    ASSERT_EQ(3, slice.size());
+    ASSERT_EQ(2L, boost::get<int64_t>(slice.at(0)));
+    ASSERT_EQ(4L, boost::get<int64_t>(slice.at(2)));
+
+    // The selected rows are relative to the beginning of the slice
+    std::vector<uint32_t> rows = {0, 2};
+    auto bools = ValueColumn::ofBools({true, false, true, false});
+    slice = bools.slice(1, 4, &rows);
+    ASSERT_EQ(ValueColumn::kBool, slice.type());
+    ASSERT_EQ(2, slice.size());
+    ASSERT_FALSE(boost::get<bool>(slice.at(0)));
+    ASSERT_FALSE(boost::get<bool>(slice.at(1)));
+
+    ValueColumn strings;
+    for (auto *str : {"a", "b", "c"}) {
+        strings.append(std::string(str));
+    }
+    slice = strings.slice(0, 3, &rows);
+    ASSERT_EQ(ValueColumn::kVariant, slice.type());
+    ASSERT_EQ("a", boost::get<std::string>(slice.at(0)));
+    ASSERT_EQ("c", boost::get<std::string>(slice.at(1)));
+}
+
+
 }   // namespace nebula
@@ -0,0 +1,164 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include "dataman/ColumnReader.h"
+#include "dataman/ColumnWriter.h"
+
+namespace nebula {
+
+using cpp2::SupportedType;
+
+// static
+std::unique_ptr<ColumnReader> ColumnReader::getColumnReader(SupportedType type,
+                                                            folly::StringPiece values,
+                                                            folly::StringPiece offsets) {
+    auto width = ColumnWriter::valueWidth(type);
+    size_t size = 0;
+    if (width > 0) {
+        if (values.size() % width != 0) {
+            LOG(ERROR) << "The size of the values does not fit the type";
+            return nullptr;
+        }
+        size = values.size() / width;
+    } else {
+        if (offsets.size() % sizeof(uint32_t) != 0) {
+            LOG(ERROR) << "The size of the offsets is invalid";
+            return nullptr;
+        }
+        size = offsets.size() / sizeof(uint32_t);
+    }
+
+    std::unique_ptr<ColumnReader> reader(new ColumnReader(type, values, offsets, size));
+    if (width == 0) {
+        // The offsets should not decrease, nor exceed the values
+        uint32_t prev = 0;
+        for (size_t i = 0; i < size; i++) {
+            auto end = reader->endOffset(i);
+            if (end < prev || end > values.size()) {
+                LOG(ERROR) << "The offset of the string " << i << " is invalid";
+                return nullptr;
+            }
+            prev = end;
+        }
+    }
+    return reader;
+}
+
+
+uint32_t ColumnReader::endOffset(size_t i) const {
+    uint32_t end;
+    memcpy(&end, offsets_.data() + i * sizeof(uint32_t), sizeof(end));
+    return end;
+}
+
+
+bool ColumnReader::getBool(size_t i) const {
+    DCHECK(type_ == SupportedType::BOOL);
+    DCHECK_LT(i, size_);
+    return values_[i] != 0;
+}
+
+
+int64_t ColumnReader::getInt(size_t i) const {
+    DCHECK(type_ == SupportedType::INT
+            || type_ == SupportedType::VID
+            || type_ == SupportedType::TIMESTAMP);
+    DCHECK_LT(i, size_);
+    int64_t v;
+    memcpy(&v, values_.data() + i * sizeof(int64_t), sizeof(v));
+    return v;
+}
+
+
+double ColumnReader::getDouble(size_t i) const {
+    DCHECK_LT(i, size_);
+    if (type_ == SupportedType::FLOAT) {
+        float v;
+        memcpy(&v, values_.data() + i * sizeof(float), sizeof(v));
+        return v;
+    }
+    DCHECK(type_ == SupportedType::DOUBLE);
+    double v;
+    memcpy(&v, values_.data() + i * sizeof(double), sizeof(v));
+    return v;
+}
+
+
+folly::StringPiece ColumnReader::getString(size_t i) const {
+    DCHECK(type_ == SupportedType::STRING);
+    DCHECK_LT(i, size_);
+    uint32_t begin = i == 0 ? 0 : endOffset(i - 1);
+    return values_.subpiece(begin, endOffset(i) - begin);
+}
+
+
+VariantType ColumnReader::getValue(size_t i) const {
+    switch (type_) {
+        case SupportedType::BOOL:
+            return getBool(i);
+        case SupportedType::INT:
+        case SupportedType::VID:
+        case SupportedType::TIMESTAMP:
+            return getInt(i);
+        case SupportedType::FLOAT:
+        case SupportedType::DOUBLE:
+            return getDouble(i);
+        case SupportedType::STRING:
+            return getString(i).str();
+        default:
+            LOG(FATAL) << "Unsupported column type " << static_cast<int32_t>(type_);
+            return VariantType();
+    }
+}
+
+
+bool ColumnReader::decodeBools(std::vector<bool>* out) const {
+    if (type_ != SupportedType::BOOL) {
+        return false;
+    }
+    out->resize(size_);
+    for (size_t i = 0; i < size_; i++) {
+        (*out)[i] = values_[i] != 0;
+    }
+    return true;
+}
+
+
+bool ColumnReader::decodeInts(std::vector<int64_t>* out) const {
+    if (type_ != SupportedType::INT
+            && type_ != SupportedType::VID
+            && type_ != SupportedType::TIMESTAMP) {
+        return false;
+    }
+    // The values are in the layout of the array already
+    out->resize(size_);
+    if (size_ > 0) {
+        memcpy(out->data(), values_.data(), size_ * sizeof(int64_t));
+    }
+    return true;
+}
+
+
+bool ColumnReader::decodeDoubles(std::vector<double>* out) const {
+    if (type_ == SupportedType::DOUBLE) {
+        out->resize(size_);
+        if (size_ > 0) {
+            memcpy(out->data(), values_.data(), size_ * sizeof(double));
+        }
+        return true;
+    }
+    if (type_ == SupportedType::FLOAT) {
+        out->resize(size_);
+        for (size_t i = 0; i < size_; i++) {
+            (*out)[i] = getDouble(i);
+        }
+        return true;
+    }
+    return false;
+}
+
+}  // namespace nebula
@@ -0,0 +1,77 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef DATAMAN_COLUMNREADER_H_
+#define DATAMAN_COLUMNREADER_H_
+
+#include "base/Base.h"
+#include "interface/gen-cpp2/common_types.h"
+
+namespace nebula {
+
+/**
+ * It decodes the values of one column encoded by ColumnWriter.
+ *
+ * The reader does not own the data, so the buffers should outlive it.
+ */
+class ColumnReader final {
+public:
+    // It returns nullptr when the data corrupts
+    static std::unique_ptr<ColumnReader> getColumnReader(cpp2::SupportedType type,
+                                                         folly::StringPiece values,
+                                                         folly::StringPiece offsets);
+
+    cpp2::SupportedType type() const {
+        return type_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    /**
+     * Accessors of the i-th value, `i' should be less than size(),
+     * and the type should match the type of the column.
+     */
+    bool getBool(size_t i) const;
+    // For INT, VID and TIMESTAMP
+    int64_t getInt(size_t i) const;
+    // For FLOAT and DOUBLE
+    double getDouble(size_t i) const;
+    folly::StringPiece getString(size_t i) const;
+
+    // Get the i-th value of any type
+    VariantType getValue(size_t i) const;
+
+    /**
+     * Decode all the values into a typed array at once.
+     * They return false when the type does not match.
+     */
+    bool decodeBools(std::vector<bool>* out) const;
+    bool decodeInts(std::vector<int64_t>* out) const;
+    bool decodeDoubles(std::vector<double>* out) const;
+
+private:
+    ColumnReader(cpp2::SupportedType type,
+                 folly::StringPiece values,
+                 folly::StringPiece offsets,
+                 size_t size)
+        : type_(type)
+        , values_(values)
+        , offsets_(offsets)
+        , size_(size) {}
+
+    uint32_t endOffset(size_t i) const;
+
+private:
+    cpp2::SupportedType type_;
+    folly::StringPiece values_;
+    folly::StringPiece offsets_;
+    size_t size_;
+};
+
+}  // namespace nebula
+#endif  // DATAMAN_COLUMNREADER_H_
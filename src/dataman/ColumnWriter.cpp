@@ -0,0 +1,143 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include "dataman/ColumnWriter.h"
+
+namespace nebula {
+
+using cpp2::SupportedType;
+
+// static
+int32_t ColumnWriter::valueWidth(SupportedType type) {
+    switch (type) {
+        case SupportedType::BOOL:
+            return sizeof(bool);
+        case SupportedType::FLOAT:
+            return sizeof(float);
+        case SupportedType::INT:
+        case SupportedType::VID:
+        case SupportedType::TIMESTAMP:
+            return sizeof(int64_t);
+        case SupportedType::DOUBLE:
+            return sizeof(double);
+        case SupportedType::STRING:
+            return 0;
+        default:
+            LOG(FATAL) << "Unsupported column type " << static_cast<int32_t>(type);
+            return 0;
+    }
+}
+
+
+ColumnWriter::ColumnWriter(SupportedType type)
+        : type_(type)
+        , width_(valueWidth(type)) {
+}
+
+
+void ColumnWriter::appendBool(bool v) {
+    if (type_ != SupportedType::BOOL) {
+        LOG(ERROR) << "Incompatible value type \"bool\"";
+        appendDefault();
+        return;
+    }
+    appendFixed(v);
+}
+
+
+void ColumnWriter::appendInt(int64_t v) {
+    switch (type_) {
+        case SupportedType::INT:
+        case SupportedType::VID:
+        case SupportedType::TIMESTAMP:
+            appendFixed(v);
+            break;
+        default:
+            LOG(ERROR) << "Incompatible value type \"int\"";
+            appendDefault();
+            break;
+    }
+}
+
+
+void ColumnWriter::appendDouble(double v) {
+    switch (type_) {
+        case SupportedType::FLOAT:
+            appendFixed(static_cast<float>(v));
+            break;
+        case SupportedType::DOUBLE:
+            appendFixed(v);
+            break;
+        default:
+            LOG(ERROR) << "Incompatible value type \"double\"";
+            appendDefault();
+            break;
+    }
+}
+
+
+void ColumnWriter::appendString(folly::StringPiece v) {
+    if (type_ != SupportedType::STRING) {
+        LOG(ERROR) << "Incompatible value type \"string\"";
+        appendDefault();
+        return;
+    }
+    values_.append(v.begin(), v.size());
+    uint32_t end = values_.size();
+    offsets_.append(reinterpret_cast<const char*>(&end), sizeof(end));
+    size_++;
+}
+
+
+void ColumnWriter::appendDefault() {
+    if (width_ == 0) {
+        uint32_t end = values_.size();
+        offsets_.append(reinterpret_cast<const char*>(&end), sizeof(end));
+    } else {
+        values_.append(width_, '\0');
+    }
+    size_++;
+}
+
+
+void ColumnWriter::append(const ColumnWriter& rhs) {
+    CHECK(type_ == rhs.type_) << "The columns are of different types";
+    if (width_ == 0) {
+        // The offsets of the strings are moved by the size of the existing strings
+        uint32_t base = values_.size();
+        offsets_.reserve(offsets_.size() + rhs.offsets_.size());
+        for (size_t i = 0; i < rhs.size_; i++) {
+            uint32_t end = base + rhs.endOffset(i);
+            offsets_.append(reinterpret_cast<const char*>(&end), sizeof(end));
+        }
+    }
+    values_.append(rhs.values_);
+    size_ += rhs.size_;
+}
+
+
+void ColumnWriter::truncate(size_t size) {
+    if (size >= size_) {
+        return;
+    }
+    if (width_ == 0) {
+        values_.resize(size == 0 ? 0 : endOffset(size - 1));
+        offsets_.resize(size * sizeof(uint32_t));
+    } else {
+        values_.resize(size * width_);
+    }
+    size_ = size;
+}
+
+
+uint32_t ColumnWriter::endOffset(size_t i) const {
+    uint32_t end;
+    memcpy(&end, offsets_.data() + i * sizeof(uint32_t), sizeof(end));
+    return end;
+}
+
+}  // namespace nebula
@@ -0,0 +1,83 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef DATAMAN_COLUMNWRITER_H_
+#define DATAMAN_COLUMNWRITER_H_
+
+#include "base/Base.h"
+#include "interface/gen-cpp2/common_types.h"
+
+namespace nebula {
+
+/**
+ * It encodes the values of one column, i.e. the same prop of many rows.
+ *
+ * The values of a fixed-width type are kept one after another in little endian:
+ * BOOL in 1 byte, FLOAT in 4 bytes, INT, VID, TIMESTAMP and DOUBLE in 8 bytes.
+ * The strings are kept one after another too, with the end offset of each string
+ * in a separate buffer (4 bytes each).
+ * So the column could be decoded by ColumnReader into a typed array at once.
+ */
+class ColumnWriter final {
+public:
+    explicit ColumnWriter(cpp2::SupportedType type);
+
+    cpp2::SupportedType type() const {
+        return type_;
+    }
+
+    // The number of values
+    size_t size() const {
+        return size_;
+    }
+
+    // When the value does not match the type, the default value is appended instead
+    void appendBool(bool v);
+    void appendInt(int64_t v);
+    void appendDouble(double v);
+    void appendString(folly::StringPiece v);
+
+    // Append the default value of the type, i.e. false, 0, 0.0 or an empty string
+    void appendDefault();
+
+    // Append all the values of a column of the same type
+    void append(const ColumnWriter& rhs);
+
+    // Keep only the first `size' values
+    void truncate(size_t size);
+
+    // Return the references of the buffers, so that the caller can move them
+    std::string& values() {
+        return values_;
+    }
+
+    std::string& offsets() {
+        return offsets_;
+    }
+
+    // The bytes of each value of the type, or 0 for a string
+    static int32_t valueWidth(cpp2::SupportedType type);
+
+private:
+    template<typename T>
+    void appendFixed(T v) {
+        DCHECK_EQ(sizeof(T), static_cast<size_t>(width_));
+        values_.append(reinterpret_cast<const char*>(&v), sizeof(T));
+        size_++;
+    }
+
+    uint32_t endOffset(size_t i) const;
+
+private:
+    cpp2::SupportedType type_;
+    int32_t width_;
+    size_t size_{0};
+    std::string values_;
+    std::string offsets_;
+};
+
+}  // namespace nebula
+#endif  // DATAMAN_COLUMNWRITER_H_
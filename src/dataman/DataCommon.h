@@ -21,6 +21,19 @@ enum class ResultType {
 };
 
 
+/**
+ * The header byte of a row holds the number of bytes of the schema version in the highest
+ * three bits, and the number of bytes of a block offset minus one in the lowest three bits.
+ *
+ * A row of the format v2 is marked by the following bit, so the rows of both formats
+ * could be read side by side. Every field of such a row takes one slot of the fixed size,
+ * in the order of the schema. A string slot holds the offset (lower four bytes) and
+ * the length (higher four bytes) of the string, which is kept after the slots.
+ * */
+constexpr uint8_t kRowFormatV2Flag = 0x08;
+constexpr int64_t kRowFormatV2SlotSize = 8;
+
+
 using FieldValue = boost::variant<bool, int64_t, float, double, std::string>;
 #define VALUE_TYPE_BOOL 0
 #define VALUE_TYPE_INT 1
@@ -47,6 +47,10 @@ bool ResultSchemaProvider::ResultSchemaField::isValid() const {
  **********************************/
 ResultSchemaProvider::ResultSchemaProvider(Schema schema)
         : columns_(std::move(schema.get_columns())) {
+    auto* format = schema.get_schema_prop().get_row_format();
+    if (format != nullptr) {
+        rowFormat_ = *format;
+    }
     for (int64_t i = 0; i < static_cast<int64_t>(columns_.size()); i++) {
         const std::string& name = columns_[i].get_name();
         nameIndex_.emplace(std::make_pair(SpookyHashV2::Hash64(name.data(), name.size(), 0), i));
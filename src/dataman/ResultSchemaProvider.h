@@ -40,6 +40,10 @@ public:
 
     size_t getNumFields() const noexcept override;
 
+    cpp2::RowFormat getRowFormat() const noexcept override {
+        return rowFormat_;
+    }
+
     int64_t getFieldIndex(const folly::StringPiece name) const override;
     const char* getFieldName(int64_t index) const override;
 
@@ -52,6 +56,7 @@ public:
 
 protected:
     SchemaVer schemaVer_{0};
+    cpp2::RowFormat rowFormat_{cpp2::RowFormat::V1};
 
     ColumnDefs columns_;
     // Map of Hash64(field_name) -> array index
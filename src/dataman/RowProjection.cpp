@@ -0,0 +1,26 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include "dataman/RowProjection.h"
+
+namespace nebula {
+
+RowProjection::RowProjection(const meta::SchemaProviderIf* schema,
+                             std::vector<std::string> names)
+        : names_(std::move(names)) {
+    indexes_.reserve(names_.size());
+    if (schema == nullptr) {
+        indexes_.resize(names_.size(), -1);
+        return;
+    }
+    ver_ = schema->getVersion();
+    for (auto& name : names_) {
+        indexes_.emplace_back(schema->getFieldIndex(name));
+    }
+}
+
+}  // namespace nebula
@@ -0,0 +1,62 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef DATAMAN_ROWPROJECTION_H_
+#define DATAMAN_ROWPROJECTION_H_
+
+#include "base/Base.h"
+#include "dataman/RowReader.h"
+
+namespace nebula {
+
+/**
+ * The field indexes of some props, resolved by their names once for many rows.
+ *
+ * The indexes are resolved against one schema, e.g. the latest version of a tag,
+ * so no name is looked up for the rows of that version. The rows of other versions
+ * fall back to the lookup by name.
+ *
+ * It is immutable once built, so it could be shared among threads.
+ */
+class RowProjection final {
+public:
+    RowProjection(const meta::SchemaProviderIf* schema, std::vector<std::string> names);
+
+    size_t size() const {
+        return names_.size();
+    }
+
+    const std::string& name(size_t i) const {
+        return names_[i];
+    }
+
+    /**
+     * The index of the i-th prop in the schema of the reader, negative if there is none.
+     */
+    int64_t index(const RowReader* reader, size_t i) const {
+        DCHECK_LT(i, names_.size());
+        if (reader->schemaVer() == ver_) {
+            return indexes_[i];
+        }
+        return reader->getSchema()->getFieldIndex(names_[i]);
+    }
+
+    ErrorOr<ResultType, VariantType> get(const RowReader* reader, size_t i) const {
+        auto index = this->index(reader, i);
+        if (index < 0) {
+            return ResultType::E_NAME_NOT_FOUND;
+        }
+        return RowReader::getPropByIndex(reader, index);
+    }
+
+private:
+    SchemaVer ver_{-1};
+    std::vector<std::string> names_;
+    std::vector<int64_t> indexes_;
+};
+
+}  // namespace nebula
+#endif  // DATAMAN_ROWPROJECTION_H_
@@ -82,7 +82,8 @@ const RowReader::Cell* RowReader::Iterator::operator->() const {
 
 RowReader::Iterator& RowReader::Iterator::operator++() {
     if (*this) {
-        if (bytes_ > 0) {
+        // The fields of the format v2 might not fill their slots
+        if (bytes_ > 0 && !reader_->fixedWidth_) {
             offset_ += bytes_;
         } else {
             offset_ = reader_->skipToNext(index_, offset_);
@@ -228,14 +229,26 @@ bool RowReader::processHeader(folly::StringPiece row) {
     // schena version. If the number is zero, no schema version
     // presents
     numBytesForOffset_ = (*it & 0x07) + 1;
+    fixedWidth_ = (*it & kRowFormatV2Flag) != 0;
     int32_t verBytes = *(it++) >> 5;
     it += verBytes;
 
+    uint32_t numFields = schema_->getNumFields();
+    if (fixedWidth_) {
+        // There is no block offset, since every field could be found by its index
+        headerLen_ = reinterpret_cast<const char*>(it) - row.begin();
+        if (headerLen_ + kRowFormatV2SlotSize * numFields
+                > static_cast<int64_t>(row.size())) {
+            LOG(ERROR) << "Row data is too short";
+            return false;
+        }
+        return true;
+    }
+
     // Process the block offsets
     // Block offsets point to the start of every 16 fields, except the
     // first 16 fields
     // Block offsets are stored in Little Endian
-    uint32_t numFields = schema_->getNumFields();
     uint32_t numOffsets = (numFields >> 4);
     if (numBytesForOffset_ * numOffsets + verBytes + 1 > row.size()) {
         // Data is too short
@@ -263,6 +276,34 @@ bool RowReader::processHeader(folly::StringPiece row) {
 }
 
 
+bool RowReader::encodePrefix(int32_t numFields, std::string* encoded) const noexcept {
+    auto total = static_cast<int32_t>(schema_->getNumFields());
+    if (fixedWidth_ || numFields <= 0 || numFields > total) {
+        return false;
+    }
+    int64_t end = data_.size();
+    if (numFields < total) {
+        end = skipToField(numFields);
+        if (end < 0) {
+            return false;
+        }
+    }
+
+    int32_t numOffsets = numFields >> 4;
+    encoded->clear();
+    encoded->reserve(1 + numBytesForOffset_ * numOffsets + end);
+    char header = numBytesForOffset_ - 1;
+    encoded->append(&header, 1);
+    // The block offsets are relative to the data, so they are kept as they are
+    for (int32_t i = 1; i <= numOffsets; i++) {
+        int64_t offset = blockOffsets_[i].first;
+        encoded->append(reinterpret_cast<char*>(&offset), numBytesForOffset_);
+    }
+    encoded->append(data_.begin(), end);
+    return true;
+}
+
+
 int32_t RowReader::numFields() const noexcept {
     return schema_->getNumFields();
 }
@@ -277,6 +318,9 @@ int64_t RowReader::skipToNext(int64_t index, int64_t offset) const noexcept {
     const cpp2::ValueType& vType = schema_->getFieldType(index);
     CHECK(vType != CommonConstants::kInvalidValueType())
         << "No schema for the index " << index;
+    if (fixedWidth_) {
+        return (index + 1) * kRowFormatV2SlotSize;
+    }
     if (offsets_[index + 1] >= 0) {
         return offsets_[index + 1];
     }
@@ -347,6 +391,9 @@ int64_t RowReader::skipToField(int64_t index) const noexcept {
         // Index is out of range
         return static_cast<int64_t>(ResultType::E_INDEX_OUT_OF_RANGE);
     }
+    if (fixedWidth_) {
+        return index * kRowFormatV2SlotSize;
+    }
 
     int64_t base = index >> 4;
     const auto& blockOffset = blockOffsets_[base];
@@ -392,6 +439,18 @@ int32_t RowReader::readDouble(int64_t offset, double& v) const noexcept {
 
 int32_t RowReader::readString(int64_t offset, folly::StringPiece& v)
         const noexcept {
+    if (fixedWidth_) {
+        uint64_t slot;
+        memcpy(reinterpret_cast<char*>(&slot), &(data_[offset]), sizeof(slot));
+        uint64_t strOffset = slot & 0xFFFFFFFF;
+        uint64_t strLen = slot >> 32;
+        if (strOffset + strLen > data_.size()) {
+            return static_cast<int32_t>(ResultType::E_DATA_INVALID);
+        }
+        v = data_.subpiece(strOffset, strLen);
+        return kRowFormatV2SlotSize;
+    }
+
     int64_t strLen;
     int32_t intLen = readInteger(offset, strLen);
     CHECK_GT(intLen, 0) << "Invalid string length";
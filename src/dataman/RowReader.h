@@ -91,60 +91,12 @@ public:
 
     static ErrorOr<ResultType, VariantType> getPropByName(const RowReader* reader,
                                                     const std::string& prop) {
-        auto& vType = reader->getSchema()->getFieldType(prop);
-        switch (vType.type) {
-            case nebula::cpp2::SupportedType::BOOL: {
-                bool v;
-                auto ret = reader->getBool(prop, v);
-                if (ret != ResultType::SUCCEEDED) {
-                    return ret;
-                }
-                return v;
-            }
-            case nebula::cpp2::SupportedType::INT: {
-                int64_t v;
-                auto ret = reader->getInt(prop, v);
-                if (ret != ResultType::SUCCEEDED) {
-                    return ret;
-                }
-                return v;
-            }
-            case nebula::cpp2::SupportedType::VID: {
-                VertexID v;
-                auto ret = reader->getVid(prop, v);
-                if (ret != ResultType::SUCCEEDED) {
-                    return ret;
-                }
-                return v;
-            }
-            case nebula::cpp2::SupportedType::FLOAT: {
-                float v;
-                auto ret = reader->getFloat(prop, v);
-                if (ret != ResultType::SUCCEEDED) {
-                    return ret;
-                }
-                return static_cast<double>(v);
-            }
-            case nebula::cpp2::SupportedType::DOUBLE: {
-                double v;
-                auto ret = reader->getDouble(prop, v);
-                if (ret != ResultType::SUCCEEDED) {
-                    return ret;
-                }
-                return v;
-            }
-            case nebula::cpp2::SupportedType::STRING: {
-                folly::StringPiece v;
-                auto ret = reader->getString(prop, v);
-                if (ret != ResultType::SUCCEEDED) {
-                    return ret;
-                }
-                return v.toString();
-            }
-            default:
-                LOG(FATAL) << "Unknown type: " << static_cast<int32_t>(vType.type);
-                return ResultType::E_DATA_INVALID;
+        // Look up the name once, rather than for both the type and the value
+        auto index = reader->getSchema()->getFieldIndex(prop);
+        if (index < 0) {
+            return ResultType::E_NAME_NOT_FOUND;
         }
+        return getPropByIndex(reader, index);
     }
 
 
@@ -246,6 +198,14 @@ public:
         return schema_.get();
     }
 
+    /**
+     * Encode the first `numFields' fields without the schema version, so that they
+     * could be read by a schema of no version which has the same first fields.
+     * The data of the fields is copied as it is, without decoding.
+     * It returns false when the data corrupts, or when the row is of the format v2.
+     */
+    bool encodePrefix(int32_t numFields, std::string* encoded) const noexcept;
+
     // TODO getPath(const std::string& name) const noexcept;
     // TODO getPath(int64_t index) const noexcept;
     // TODO getList(const std::string& name) const noexcept;
@@ -260,6 +220,8 @@ private:
 
     folly::StringPiece data_;
     int32_t headerLen_ = 0;
+    // The row is of the format v2, whose fields are found by their index
+    bool fixedWidth_ = false;
     int32_t numBytesForOffset_ = 0;
     // Block offet value is composed by two integers. The first one is
     // the block offset, the second one is the largest index being visited
@@ -37,6 +37,11 @@ public:
         return data_;
     }
 
+    // Drop all the rows, while the memory is kept for the next rows
+    void clear() {
+        data_.clear();
+    }
+
     // Both schemas have to be same
     void addRow(RowWriter& writer);
     // Append the encoded row data
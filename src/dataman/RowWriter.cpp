@@ -13,17 +13,29 @@ using cpp2::Schema;
 using cpp2::SupportedType;
 using meta::SchemaProviderIf;
 
-RowWriter::RowWriter(std::shared_ptr<const SchemaProviderIf> schema)
-        : schema_(std::move(schema)) {
+RowWriter::RowWriter(std::shared_ptr<const SchemaProviderIf> schema, Arena* arena)
+        : schema_(std::move(schema))
+        , cord_(arena) {
     if (!schema_) {
         // Need to create a new schema
         schemaWriter_.reset(new SchemaWriter());
         schema_ = schemaWriter_;
+    } else if (schema_->getRowFormat() == cpp2::RowFormat::V2) {
+        fixedWidth_ = true;
+        slots_.resize(kRowFormatV2SlotSize * schema_->getNumFields(), '\0');
     }
 }
 
 
 int64_t RowWriter::size() const noexcept {
+    if (fixedWidth_) {
+        SchemaVer verBytes = 0;
+        if (schema_->getVersion() > 0) {
+            verBytes = calcOccupiedBytes(schema_->getVersion());
+        }
+        return slots_.size() + cord_.size() + verBytes + 1;
+    }
+
     auto offsetBytes = calcOccupiedBytes(cord_.size());
     SchemaVer verBytes = 0;
     if (schema_->getVersion() > 0) {
@@ -52,8 +64,12 @@ void RowWriter::encodeTo(std::string& encoded) noexcept {
     }
 
     // Header information
-    auto offsetBytes = calcOccupiedBytes(cord_.size());
-    char header = offsetBytes - 1;
+    char header;
+    if (fixedWidth_) {
+        header = kRowFormatV2Flag;
+    } else {
+        header = calcOccupiedBytes(cord_.size()) - 1;
+    }
 
     SchemaVer ver = schema_->getVersion();
     if (ver > 0) {
@@ -66,7 +82,14 @@ void RowWriter::encodeTo(std::string& encoded) noexcept {
         encoded.append(&header, 1);
     }
 
+    if (fixedWidth_) {
+        encoded.append(slots_);
+        cord_.appendTo(encoded);
+        return;
+    }
+
     // Offsets are stored in Little Endian
+    auto offsetBytes = (header & 0x07) + 1;
     for (auto offset : blockOffsets_) {
         encoded.append(reinterpret_cast<char*>(&offset), offsetBytes);
     }
@@ -101,6 +124,9 @@ int64_t RowWriter::calcOccupiedBytes(uint64_t v) const noexcept {
  *
  ***************************/
 RowWriter& RowWriter::operator<<(bool v) noexcept {
+    if (fixedWidth_) {
+        return writeFixedBool(v);
+    }
     RW_GET_COLUMN_TYPE(BOOL)
 
     switch (type->get_type()) {
@@ -120,6 +146,9 @@ RowWriter& RowWriter::operator<<(bool v) noexcept {
 
 
 RowWriter& RowWriter::operator<<(float v) noexcept {
+    if (fixedWidth_) {
+        return writeFixedDouble(v);
+    }
     RW_GET_COLUMN_TYPE(FLOAT)
 
     switch (type->get_type()) {
@@ -141,6 +170,9 @@ RowWriter& RowWriter::operator<<(float v) noexcept {
 
 
 RowWriter& RowWriter::operator<<(double v) noexcept {
+    if (fixedWidth_) {
+        return writeFixedDouble(v);
+    }
     RW_GET_COLUMN_TYPE(DOUBLE)
 
     switch (type->get_type()) {
@@ -166,6 +198,9 @@ RowWriter& RowWriter::operator<<(const std::string& v) noexcept {
 }
 
 RowWriter& RowWriter::operator<<(folly::StringPiece v) noexcept {
+    if (fixedWidth_) {
+        return writeFixedString(v);
+    }
     RW_GET_COLUMN_TYPE(STRING)
 
     switch (type->get_type()) {
@@ -219,6 +254,11 @@ RowWriter& RowWriter::operator<<(Skip&& skip) noexcept {
 
     int32_t skipTo = std::min(colNum_ + skip.toSkip_,
                               static_cast<int64_t>(schema_->getNumFields()));
+    if (fixedWidth_) {
+        // The slots are zero already
+        colNum_ = skipTo;
+        return *this;
+    }
     for (int i = colNum_; i < skipTo; i++) {
         switch (schema_->getFieldType(i).get_type()) {
             case SupportedType::BOOL: {
@@ -262,4 +302,82 @@ RowWriter& RowWriter::operator<<(Skip&& skip) noexcept {
     return *this;
 }
 
+
+/****************************
+ *
+ * Row Format V2
+ *
+ ***************************/
+RowWriter& RowWriter::writeFixedBool(bool v) noexcept {
+    CHECK_LT(colNum_, static_cast<int64_t>(schema_->getNumFields())) << "Too many fields";
+    switch (schema_->getFieldType(colNum_).get_type()) {
+        case SupportedType::BOOL:
+            writeSlot(v);
+            break;
+        default:
+            LOG(ERROR) << "Incompatible value type \"bool\"";
+            break;
+    }
+    colNum_++;
+    return *this;
+}
+
+
+RowWriter& RowWriter::writeFixedInt(int64_t v) noexcept {
+    CHECK_LT(colNum_, static_cast<int64_t>(schema_->getNumFields())) << "Too many fields";
+    switch (schema_->getFieldType(colNum_).get_type()) {
+        case SupportedType::INT:
+        case SupportedType::VID:
+        case SupportedType::TIMESTAMP:
+            writeSlot(v);
+            break;
+        default:
+            LOG(ERROR) << "Incompatible value type \"int\"";
+            break;
+    }
+    colNum_++;
+    return *this;
+}
+
+
+RowWriter& RowWriter::writeFixedDouble(double v) noexcept {
+    CHECK_LT(colNum_, static_cast<int64_t>(schema_->getNumFields())) << "Too many fields";
+    switch (schema_->getFieldType(colNum_).get_type()) {
+        case SupportedType::FLOAT:
+            writeSlot(static_cast<float>(v));
+            break;
+        case SupportedType::DOUBLE:
+            writeSlot(v);
+            break;
+        default:
+            LOG(ERROR) << "Incompatible value type \"double\"";
+            break;
+    }
+    colNum_++;
+    return *this;
+}
+
+
+RowWriter& RowWriter::writeFixedString(folly::StringPiece v) noexcept {
+    CHECK_LT(colNum_, static_cast<int64_t>(schema_->getNumFields())) << "Too many fields";
+    switch (schema_->getFieldType(colNum_).get_type()) {
+        case SupportedType::STRING: {
+            // The offset is relative to the first slot
+            uint64_t offset = slots_.size() + cord_.size();
+            if (offset + v.size() > std::numeric_limits<uint32_t>::max()) {
+                LOG(ERROR) << "The row is too large for the format v2";
+                break;
+            }
+            writeSlot(offset | (static_cast<uint64_t>(v.size()) << 32));
+            cord_ << v;
+            break;
+        }
+        default:
+            LOG(ERROR) << "Incompatible value type \"string\"";
+            break;
+    }
+    colNum_++;
+    return *this;
+}
+
 }  // namespace nebula
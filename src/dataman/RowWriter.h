@@ -8,7 +8,9 @@
 #define DATAMAN_ROWWRITER_H_
 
 #include "base/Base.h"
+#include "base/Arena.h"
 #include "base/Cord.h"
+#include "dataman/DataCommon.h"
 #include "dataman/SchemaWriter.h"
 
 namespace nebula {
@@ -18,6 +20,12 @@ namespace nebula {
  *
  * It can be used with or without schema. When no schema is assigned,
  * a new schema will be created according to the input data stream
+ *
+ * The row is encoded in the row format of the schema. A new schema
+ * always uses the format v1
+ *
+ * When an arena is given, the buffer of the row is allocated from it,
+ * so the arena should outlive the writer
  */
 class RowWriter {
 public:
@@ -66,7 +74,8 @@ public:
 public:
     explicit RowWriter(
         std::shared_ptr<const meta::SchemaProviderIf> schema
-            = std::shared_ptr<const meta::SchemaProviderIf>());
+            = std::shared_ptr<const meta::SchemaProviderIf>(),
+        Arena* arena = nullptr);
 
     // Encode into a binary array
     std::string encode() noexcept;
@@ -116,12 +125,31 @@ private:
     // Block offsets for every 16 fields
     std::vector<int64_t> blockOffsets_;
 
+    // When the row is of the format v2, the slots of all fields are kept here,
+    // while cord_ holds the strings
+    bool fixedWidth_ = false;
+    std::string slots_;
+
     template<typename T>
     typename std::enable_if<std::is_integral<T>::value>::type
     writeInt(T v);
 
     // Calculate the number of bytes occupied (ignore the leading 0s)
     int64_t calcOccupiedBytes(uint64_t v) const noexcept;
+
+    // Following methods write the value into the slot of the current field,
+    // for the format v2. The slots of the fields not written are left zero,
+    // which is the default value of any type
+    RowWriter& writeFixedBool(bool v) noexcept;
+    RowWriter& writeFixedInt(int64_t v) noexcept;
+    RowWriter& writeFixedDouble(double v) noexcept;
+    RowWriter& writeFixedString(folly::StringPiece v) noexcept;
+
+    template<typename T>
+    void writeSlot(T v) {
+        static_assert(sizeof(T) <= kRowFormatV2SlotSize, "The value is too large for a slot");
+        memcpy(&slots_[colNum_ * kRowFormatV2SlotSize], &v, sizeof(T));
+    }
 };
 
 }  // namespace nebula
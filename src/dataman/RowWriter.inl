@@ -9,6 +9,9 @@ namespace nebula {
 template<typename T>
 typename std::enable_if<std::is_integral<T>::value, RowWriter&>::type
 RowWriter::operator<<(T v) noexcept {
+    if (fixedWidth_) {
+        return writeFixedInt(static_cast<int64_t>(v));
+    }
     RW_GET_COLUMN_TYPE(INT)
 
     switch (type->get_type()) {
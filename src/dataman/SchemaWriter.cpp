@@ -17,6 +17,9 @@ using cpp2::ColumnDef;
 Schema SchemaWriter::moveSchema() noexcept {
     Schema schema;
     schema.set_columns(std::move(columns_));
+    if (rowFormat_ != cpp2::RowFormat::V1) {
+        schema.schema_prop.set_row_format(rowFormat_);
+    }
 
     nameIndex_.clear();
     return schema;
@@ -25,6 +25,11 @@ public:
     SchemaWriter& appendCol(folly::StringPiece name,
                             cpp2::ValueType&& type)noexcept;
 
+    SchemaWriter& setRowFormat(cpp2::RowFormat format) noexcept {
+        rowFormat_ = format;
+        return *this;
+    }
+
 private:
 };
 
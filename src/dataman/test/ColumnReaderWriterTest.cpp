@@ -0,0 +1,153 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include <gtest/gtest.h>
+#include "dataman/ColumnWriter.h"
+#include "dataman/ColumnReader.h"
+
+namespace nebula {
+
+TEST(ColumnReaderWriter, fixedWidth) {
+    ColumnWriter ints(cpp2::SupportedType::INT);
+    ColumnWriter floats(cpp2::SupportedType::FLOAT);
+    ColumnWriter bools(cpp2::SupportedType::BOOL);
+    for (int64_t i = 0; i < 100; i++) {
+        ints.appendInt(i * 1000000007L);
+        floats.appendDouble(i * 0.5);
+        bools.appendBool(i % 3 == 0);
+    }
+    // Mismatched values turn into the default value
+    ints.appendString("Hello");
+    floats.appendDefault();
+    bools.appendInt(1);
+    EXPECT_EQ(101, ints.size());
+    EXPECT_EQ(101 * sizeof(int64_t), ints.values().size());
+    EXPECT_EQ(101 * sizeof(float), floats.values().size());
+    EXPECT_TRUE(ints.offsets().empty());
+
+    auto intReader = ColumnReader::getColumnReader(cpp2::SupportedType::INT,
+                                                   ints.values(),
+                                                   ints.offsets());
+    ASSERT_NE(nullptr, intReader);
+    ASSERT_EQ(101, intReader->size());
+    EXPECT_EQ(5 * 1000000007L, intReader->getInt(5));
+    EXPECT_EQ(0, intReader->getInt(100));
+    std::vector<int64_t> intValues;
+    ASSERT_TRUE(intReader->decodeInts(&intValues));
+    ASSERT_EQ(101, intValues.size());
+    EXPECT_EQ(99 * 1000000007L, intValues[99]);
+    std::vector<double> doubleValues;
+    EXPECT_FALSE(intReader->decodeDoubles(&doubleValues));
+
+    auto floatReader = ColumnReader::getColumnReader(cpp2::SupportedType::FLOAT,
+                                                     floats.values(),
+                                                     floats.offsets());
+    ASSERT_NE(nullptr, floatReader);
+    ASSERT_TRUE(floatReader->decodeDoubles(&doubleValues));
+    ASSERT_EQ(101, doubleValues.size());
+    EXPECT_DOUBLE_EQ(49.5, doubleValues[99]);
+    EXPECT_DOUBLE_EQ(0.0, doubleValues[100]);
+
+    auto boolReader = ColumnReader::getColumnReader(cpp2::SupportedType::BOOL,
+                                                    bools.values(),
+                                                    bools.offsets());
+    ASSERT_NE(nullptr, boolReader);
+    std::vector<bool> boolValues;
+    ASSERT_TRUE(boolReader->decodeBools(&boolValues));
+    EXPECT_TRUE(boolValues[99]);
+    EXPECT_FALSE(boolValues[98]);
+    EXPECT_FALSE(boolValues[100]);
+    EXPECT_EQ(VariantType(true), boolReader->getValue(0));
+
+    // The size does not fit the type
+    EXPECT_EQ(nullptr, ColumnReader::getColumnReader(cpp2::SupportedType::DOUBLE,
+                                                     folly::StringPiece("abc"),
+                                                     folly::StringPiece()));
+}
+
+
+TEST(ColumnReaderWriter, strings) {
+    ColumnWriter strs(cpp2::SupportedType::STRING);
+    for (int32_t i = 0; i < 10; i++) {
+        strs.appendString(folly::stringPrintf("string_%d", i));
+    }
+    strs.appendDefault();
+    strs.appendString("");
+    strs.appendString("Last");
+
+    auto reader = ColumnReader::getColumnReader(cpp2::SupportedType::STRING,
+                                                strs.values(),
+                                                strs.offsets());
+    ASSERT_NE(nullptr, reader);
+    ASSERT_EQ(13, reader->size());
+    EXPECT_EQ("string_0", reader->getString(0));
+    EXPECT_EQ("string_9", reader->getString(9));
+    EXPECT_EQ("", reader->getString(10));
+    EXPECT_EQ("", reader->getString(11));
+    EXPECT_EQ("Last", reader->getString(12));
+    EXPECT_EQ(VariantType(std::string("string_3")), reader->getValue(3));
+
+    // Offsets out of the values
+    std::string badOffsets = strs.offsets();
+    badOffsets[0] = 100;
+    EXPECT_EQ(nullptr, ColumnReader::getColumnReader(cpp2::SupportedType::STRING,
+                                                     strs.values(),
+                                                     badOffsets));
+}
+
+
+TEST(ColumnReaderWriter, appendAndTruncate) {
+    ColumnWriter strs1(cpp2::SupportedType::STRING);
+    ColumnWriter strs2(cpp2::SupportedType::STRING);
+    ColumnWriter ints1(cpp2::SupportedType::INT);
+    ColumnWriter ints2(cpp2::SupportedType::INT);
+    for (int32_t i = 0; i < 5; i++) {
+        strs1.appendString(folly::stringPrintf("first_%d", i));
+        strs2.appendString(folly::stringPrintf("second_%d", i));
+        ints1.appendInt(i);
+        ints2.appendInt(i + 5);
+    }
+    strs1.truncate(3);
+    ints1.truncate(3);
+    EXPECT_EQ(3, strs1.size());
+    strs1.append(strs2);
+    ints1.append(ints2);
+    EXPECT_EQ(8, strs1.size());
+    EXPECT_EQ(8, ints1.size());
+
+    auto strReader = ColumnReader::getColumnReader(cpp2::SupportedType::STRING,
+                                                   strs1.values(),
+                                                   strs1.offsets());
+    ASSERT_NE(nullptr, strReader);
+    ASSERT_EQ(8, strReader->size());
+    EXPECT_EQ("first_2", strReader->getString(2));
+    EXPECT_EQ("second_0", strReader->getString(3));
+    EXPECT_EQ("second_4", strReader->getString(7));
+
+    auto intReader = ColumnReader::getColumnReader(cpp2::SupportedType::INT,
+                                                   ints1.values(),
+                                                   ints1.offsets());
+    ASSERT_NE(nullptr, intReader);
+    EXPECT_EQ(2, intReader->getInt(2));
+    EXPECT_EQ(5, intReader->getInt(3));
+    EXPECT_EQ(9, intReader->getInt(7));
+
+    strs1.truncate(0);
+    EXPECT_EQ(0, strs1.size());
+    EXPECT_TRUE(strs1.values().empty());
+}
+
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+
+    return RUN_ALL_TESTS();
+}
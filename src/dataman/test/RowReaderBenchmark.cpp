@@ -9,10 +9,12 @@
 #include "dataman/SchemaWriter.h"
 #include "dataman/RowWriter.h"
 #include "dataman/RowReader.h"
+#include "dataman/RowProjection.h"
 
 using nebula::SchemaWriter;
 using nebula::RowWriter;
 using nebula::RowReader;
+using nebula::RowProjection;
 
 auto schemaAllInts = std::make_shared<SchemaWriter>();
 auto schemaAllBools = std::make_shared<SchemaWriter>();
@@ -21,6 +23,9 @@ auto schemaAllDoubles = std::make_shared<SchemaWriter>();
 auto schemaAllVids = std::make_shared<SchemaWriter>();
 auto schemaAllTimestamps = std::make_shared<SchemaWriter>();
 auto schemaMix = std::make_shared<SchemaWriter>();
+// Wide schemas of both row formats
+auto schemaWide = std::make_shared<SchemaWriter>();
+auto schemaWideV2 = std::make_shared<SchemaWriter>();
 
 static std::string dataAllBools;        // NOLINT
 static std::string dataAllInts;         // NOLINT
@@ -29,6 +34,10 @@ static std::string dataAllStrings;      // NOLINT
 static std::string dataAllVids;         // NOLINT
 static std::string dataAllTimestamps;	// NOLINT
 static std::string dataMix;             // NOLINT
+static std::string dataWide;            // NOLINT
+static std::string dataWideV2;          // NOLINT
+
+const int32_t kWideFields = 128;
 
 
 void prepareSchema() {
@@ -85,6 +94,15 @@ void prepareSchema() {
              .appendCol("col30", nebula::cpp2::SupportedType::INT)
              .appendCol("col31", nebula::cpp2::SupportedType::INT)
              .appendCol("col32", nebula::cpp2::SupportedType::INT);
+
+    schemaWideV2->setRowFormat(nebula::cpp2::RowFormat::V2);
+    for (int32_t i = 0; i < kWideFields; i++) {
+        // Integers and strings in turn
+        auto type = i % 2 == 0 ? nebula::cpp2::SupportedType::INT
+                               : nebula::cpp2::SupportedType::STRING;
+        schemaWide->appendCol(folly::stringPrintf("col%03d", i), type);
+        schemaWideV2->appendCol(folly::stringPrintf("col%03d", i), type);
+    }
 }
 
 
@@ -122,6 +140,15 @@ void prepareData() {
     dataAllVids = wVids.encode();
     dataAllTimestamps = wTimestamps.encode();
     dataMix = wMix.encode();
+
+    RowWriter wWide(schemaWide);
+    RowWriter wWideV2(schemaWideV2);
+    for (int32_t i = 0; i < kWideFields; i += 2) {
+        wWide << i * 1000 << "Hello World";
+        wWideV2 << i * 1000 << "Hello World";
+    }
+    dataWide = wWide.encode();
+    dataWideV2 = wWideV2.encode();
 }
 
 
@@ -202,6 +229,28 @@ void readMix(int32_t iters) {
 }
 
 
+// Read a few random fields of a wide row, as a query of a few props does
+void readWideRandomly(uint32_t iters,
+                      const std::string& data,
+                      std::shared_ptr<SchemaWriter> schema) {
+    for (uint32_t i = 0; i < iters; i++) {
+        auto reader = RowReader::getRowReader(data, schema);
+        int64_t iVal;
+        folly::StringPiece sVal;
+        for (int j = 0; j < 8; j++) {
+            uint32_t idx = folly::Random::rand32(0, kWideFields);
+            if (idx % 2 == 0) {
+                reader->getInt(idx, iVal);
+                folly::doNotOptimizeAway(iVal);
+            } else {
+                reader->getString(idx, sVal);
+                folly::doNotOptimizeAway(sVal);
+            }
+        }
+    }
+}
+
+
 #define READ_VALUE(T, SCHEMA, DATA, FN) \
     for (uint64_t i = 0; i < iters; i++) { \
         auto reader = RowReader::getRowReader(DATA, SCHEMA); \
@@ -285,6 +334,62 @@ BENCHMARK_DRAW_LINE();
 BENCHMARK(read_mix, iters) {
     readMix(iters);
 }
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(read_wide_rand, iters) {
+    readWideRandomly(iters, dataWide, schemaWide);
+}
+BENCHMARK_RELATIVE(read_wide_rand_v2, iters) {
+    readWideRandomly(iters, dataWideV2, schemaWideV2);
+}
+BENCHMARK_DRAW_LINE();
+
+// Read a few props of a request from each row, as the storage service does
+const std::vector<std::string> kProjectedNames = {"col06", "col10", "col18", "col30"};
+
+BENCHMARK(read_props_by_name, iters) {
+    for (uint32_t i = 0; i < iters; i++) {
+        auto reader = RowReader::getRowReader(dataMix, schemaMix);
+        for (auto& name : kProjectedNames) {
+            auto res = RowReader::getPropByName(reader.get(), name);
+            folly::doNotOptimizeAway(res);
+        }
+    }
+}
+BENCHMARK_RELATIVE(read_props_by_projection, iters) {
+    std::unique_ptr<RowProjection> projection;
+    BENCHMARK_SUSPEND {
+        projection = std::make_unique<RowProjection>(schemaMix.get(), kProjectedNames);
+    }
+    for (uint32_t i = 0; i < iters; i++) {
+        auto reader = RowReader::getRowReader(dataMix, schemaMix);
+        for (size_t j = 0; j < projection->size(); j++) {
+            auto res = projection->get(reader.get(), j);
+            folly::doNotOptimizeAway(res);
+        }
+    }
+}
+BENCHMARK_RELATIVE(read_props_by_projection_typed, iters) {
+    std::unique_ptr<RowProjection> projection;
+    BENCHMARK_SUSPEND {
+        projection = std::make_unique<RowProjection>(schemaMix.get(), kProjectedNames);
+    }
+    for (uint32_t i = 0; i < iters; i++) {
+        auto reader = RowReader::getRowReader(dataMix, schemaMix);
+        int64_t iVal;
+        folly::StringPiece sVal;
+        double dVal;
+        reader->getInt(projection->index(reader.get(), 0), iVal);
+        folly::doNotOptimizeAway(iVal);
+        reader->getString(projection->index(reader.get(), 1), sVal);
+        folly::doNotOptimizeAway(sVal);
+        reader->getDouble(projection->index(reader.get(), 2), dVal);
+        folly::doNotOptimizeAway(dVal);
+        reader->getInt(projection->index(reader.get(), 3), iVal);
+        folly::doNotOptimizeAway(iVal);
+    }
+}
 /*************************
  * End of benchmarks
  ************************/
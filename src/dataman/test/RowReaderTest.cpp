@@ -7,6 +7,8 @@
 #include "base/Base.h"
 #include <gtest/gtest.h>
 #include "dataman/RowReader.h"
+#include "dataman/RowWriter.h"
+#include "dataman/RowProjection.h"
 #include "dataman/SchemaWriter.h"
 
 namespace nebula {
@@ -302,6 +304,151 @@ TEST(RowReader, iterator) {
     EXPECT_EQ(it, reader->end());
 }
 
+
+TEST(RowReader, formatV2) {
+    // A wide schema of both formats, whose fields cycle through the types
+    auto schema1 = std::make_shared<SchemaWriter>(1);
+    auto schema2 = std::make_shared<SchemaWriter>(2);
+    schema2->setRowFormat(cpp2::RowFormat::V2);
+    static const cpp2::SupportedType types[] = {
+        cpp2::SupportedType::BOOL,
+        cpp2::SupportedType::INT,
+        cpp2::SupportedType::STRING,
+        cpp2::SupportedType::FLOAT,
+        cpp2::SupportedType::DOUBLE,
+        cpp2::SupportedType::VID,
+        cpp2::SupportedType::TIMESTAMP,
+    };
+    const int32_t numFields = 140;
+    for (int32_t i = 0; i < numFields; i++) {
+        auto name = folly::stringPrintf("col%03d", i);
+        schema1->appendCol(name, types[i % 7]);
+        schema2->appendCol(name, types[i % 7]);
+    }
+
+    RowWriter writer1(schema1);
+    RowWriter writer2(schema2);
+    // Leave the last 7 fields to the default values
+    for (int32_t i = 0; i < numFields - 7; i++) {
+        switch (i % 7) {
+            case 0:
+                writer1 << (i % 2 == 0);
+                writer2 << (i % 2 == 0);
+                break;
+            case 1:
+                writer1 << i * 1000;
+                writer2 << i * 1000;
+                break;
+            case 2:
+                writer1 << folly::stringPrintf("string_%d", i);
+                writer2 << folly::stringPrintf("string_%d", i);
+                break;
+            case 3:
+            case 4:
+                writer1 << i * 1.5;
+                writer2 << i * 1.5;
+                break;
+            default:
+                writer1 << (static_cast<int64_t>(i) << 32);
+                writer2 << (static_cast<int64_t>(i) << 32);
+                break;
+        }
+    }
+    auto row1 = writer1.encode();
+    auto row2 = writer2.encode();
+    EXPECT_EQ(0, row1[0] & kRowFormatV2Flag);
+    EXPECT_NE(0, row2[0] & kRowFormatV2Flag);
+    EXPECT_EQ(writer2.size(), row2.size());
+
+    auto reader1 = RowReader::getRowReader(row1, schema1);
+    auto reader2 = RowReader::getRowReader(row2, schema2);
+    EXPECT_EQ(2, reader2->schemaVer());
+
+    // Read the fields backwards, so that no field of v1 has been visited before
+    for (int32_t i = numFields - 1; i >= 0; i--) {
+        auto v1 = RowReader::getPropByIndex(reader1.get(), i);
+        auto v2 = RowReader::getPropByIndex(reader2.get(), i);
+        ASSERT_TRUE(ok(v1));
+        ASSERT_TRUE(ok(v2));
+        EXPECT_EQ(value(v1), value(v2)) << "Field " << i;
+    }
+
+    int64_t iVal;
+    EXPECT_EQ(ResultType::SUCCEEDED, reader2->getInt(numFields - 6, iVal));
+    EXPECT_EQ(0, iVal);
+    folly::StringPiece sVal;
+    EXPECT_EQ(ResultType::SUCCEEDED, reader2->getString("col002", sVal));
+    EXPECT_EQ("string_2", sVal);
+    EXPECT_EQ(ResultType::SUCCEEDED, reader2->getString(numFields - 5, sVal));
+    EXPECT_EQ("", sVal);
+    EXPECT_EQ(ResultType::E_INCOMPATIBLE_TYPE, reader2->getString(1, sVal));
+    EXPECT_EQ(ResultType::E_INDEX_OUT_OF_RANGE, reader2->getInt(numFields, iVal));
+
+    // Iterate over the fields
+    int32_t index = 0;
+    for (auto it = reader2->begin(); it; ++it, ++index) {
+        if (index % 7 == 2) {
+            EXPECT_EQ(ResultType::SUCCEEDED, it->getString(sVal));
+            auto v1 = RowReader::getPropByIndex(reader1.get(), index);
+            EXPECT_EQ(boost::get<std::string>(value(v1)), sVal.str());
+        }
+    }
+    EXPECT_EQ(numFields, index);
+
+    std::string prefix;
+    EXPECT_FALSE(reader2->encodePrefix(10, &prefix));
+}
+
+
+TEST(RowReader, projection) {
+    auto schema1 = std::make_shared<SchemaWriter>(1);
+    schema1->appendCol("a", cpp2::SupportedType::INT)
+            .appendCol("b", cpp2::SupportedType::STRING)
+            .appendCol("c", cpp2::SupportedType::DOUBLE);
+    // The fields are reordered in version 2
+    auto schema2 = std::make_shared<SchemaWriter>(2);
+    schema2->appendCol("b", cpp2::SupportedType::STRING)
+            .appendCol("a", cpp2::SupportedType::INT);
+
+    RowWriter writer1(schema1);
+    writer1 << 1 << "Hello" << 3.14;
+    auto row1 = writer1.encode();
+    RowWriter writer2(schema2);
+    writer2 << "World" << 2;
+    auto row2 = writer2.encode();
+
+    RowProjection projection(schema1.get(), {"c", "a", "d"});
+    ASSERT_EQ(3, projection.size());
+
+    auto reader1 = RowReader::getRowReader(row1, schema1);
+    EXPECT_EQ(2, projection.index(reader1.get(), 0));
+    EXPECT_EQ(0, projection.index(reader1.get(), 1));
+    EXPECT_GT(0, projection.index(reader1.get(), 2));
+    auto res = projection.get(reader1.get(), 0);
+    ASSERT_TRUE(ok(res));
+    EXPECT_DOUBLE_EQ(3.14, boost::get<double>(value(res)));
+    res = projection.get(reader1.get(), 1);
+    ASSERT_TRUE(ok(res));
+    EXPECT_EQ(1, boost::get<int64_t>(value(res)));
+    res = projection.get(reader1.get(), 2);
+    ASSERT_FALSE(ok(res));
+    EXPECT_EQ(ResultType::E_NAME_NOT_FOUND, error(res));
+
+    // Resolved by name for the other version
+    auto reader2 = RowReader::getRowReader(row2, schema2);
+    EXPECT_GT(0, projection.index(reader2.get(), 0));
+    EXPECT_EQ(1, projection.index(reader2.get(), 1));
+    res = projection.get(reader2.get(), 1);
+    ASSERT_TRUE(ok(res));
+    EXPECT_EQ(2, boost::get<int64_t>(value(res)));
+
+    res = RowReader::getPropByName(reader2.get(), "b");
+    ASSERT_TRUE(ok(res));
+    EXPECT_EQ("World", boost::get<std::string>(value(res)));
+    res = RowReader::getPropByName(reader2.get(), "c");
+    EXPECT_FALSE(ok(res));
+}
+
 }  // namespace nebula
 
 
@@ -295,6 +295,66 @@ TEST(RowUpdater, encodeWithMissingFields) {
 }
 
 
+TEST(RowUpdater, toFormatV2) {
+    // Rewrite a row of the format v1 into the format v2 of a newer schema
+    auto schemaV2 = std::make_shared<SchemaWriter>(1);
+    schemaV2->setRowFormat(nebula::cpp2::RowFormat::V2);
+    for (auto it = schema->begin(); it; ++it) {
+        schemaV2->appendCol(it->getName(), it->getType().get_type());
+    }
+
+    RowWriter writer(schema);
+    writer << 123 << 456 << "Hello" << "World"
+           << true << 3.1415926 << 0xABCDABCDABCDABCD
+           << 2.17 << 1551331828;
+    std::string encoded(writer.encode());
+
+    auto reader = RowReader::getRowReader(encoded, schema);
+    RowUpdater updater(std::move(reader), schemaV2);
+    EXPECT_EQ(ResultType::SUCCEEDED,
+              updater.setInt("col2", 789));
+    EXPECT_EQ(ResultType::SUCCEEDED,
+              updater.setString("col3", "Back"));
+    std::string updated(updater.encode());
+    EXPECT_NE(0, updated[0] & nebula::kRowFormatV2Flag);
+
+    bool bVal;
+    int64_t iVal;
+    folly::StringPiece sVal;
+    float fVal;
+    double dVal;
+
+    auto reader2 = RowReader::getRowReader(updated, schemaV2);
+    EXPECT_EQ(ResultType::SUCCEEDED,
+              reader2->getInt("col1", iVal));
+    EXPECT_EQ(123, iVal);
+    EXPECT_EQ(ResultType::SUCCEEDED,
+              reader2->getInt("col2", iVal));
+    EXPECT_EQ(789, iVal);
+    EXPECT_EQ(ResultType::SUCCEEDED,
+              reader2->getString("col3", sVal));
+    EXPECT_EQ("Back", sVal);
+    EXPECT_EQ(ResultType::SUCCEEDED,
+              reader2->getString("col4", sVal));
+    EXPECT_EQ("World", sVal);
+    EXPECT_EQ(ResultType::SUCCEEDED,
+              reader2->getBool("col5", bVal));
+    EXPECT_TRUE(bVal);
+    EXPECT_EQ(ResultType::SUCCEEDED,
+              reader2->getFloat("col6", fVal));
+    EXPECT_FLOAT_EQ(3.1415926, fVal);
+    EXPECT_EQ(ResultType::SUCCEEDED,
+              reader2->getVid("col7", iVal));
+    EXPECT_EQ(0xABCDABCDABCDABCD, iVal);
+    EXPECT_EQ(ResultType::SUCCEEDED,
+              reader2->getDouble("col8", dVal));
+    EXPECT_DOUBLE_EQ(2.17, dVal);
+    EXPECT_EQ(ResultType::SUCCEEDED,
+              reader2->getTimestamp("col9", iVal));
+    EXPECT_EQ(1551331828, iVal);
+}
+
+
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
     folly::init(&argc, &argv, true);
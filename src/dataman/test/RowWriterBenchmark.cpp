@@ -8,9 +8,12 @@
 #include <folly/Benchmark.h>
 #include "dataman/SchemaWriter.h"
 #include "dataman/RowWriter.h"
+#include "dataman/RowSetWriter.h"
 
+using nebula::Arena;
 using nebula::SchemaWriter;
 using nebula::RowWriter;
+using nebula::RowSetWriter;
 using nebula::meta::SchemaProviderIf;
 
 auto schemaAllInts = std::make_shared<SchemaWriter>();
@@ -88,6 +91,24 @@ void writeMix(std::shared_ptr<SchemaProviderIf> schema, int32_t iters) {
 }
 
 
+// Encode the rows into a row set, as the storage service does for the edges
+void writeMixToRowSet(std::shared_ptr<SchemaProviderIf> schema, Arena* arena, int32_t iters) {
+    RowSetWriter rsWriter;
+    for (int32_t i = 0; i < iters; i++) {
+        RowWriter writer(schema, arena);
+        writer << true << 123 << "Hello" << 3.1415926 << 0xABCDABCDABCDABCD;
+        rsWriter.addRow(writer);
+        if (arena != nullptr) {
+            arena->reset();
+        }
+        if (rsWriter.data().size() > 1024 * 1024) {
+            rsWriter.clear();
+        }
+    }
+    folly::doNotOptimizeAway(rsWriter);
+}
+
+
 template<typename T>
 void writeValues(std::shared_ptr<SchemaProviderIf> schema, T val, int32_t iters) {
     for (int32_t i = 0; i < iters; i++) {
@@ -162,6 +183,16 @@ BENCHMARK(mix_no_schema, iters) {
 BENCHMARK(mix_with_schema, iters) {
     writeMix(schemaMix, iters);
 }
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(row_set_malloc, iters) {
+    writeMixToRowSet(schemaMix, nullptr, iters);
+}
+BENCHMARK_RELATIVE(row_set_arena, iters) {
+    Arena arena;
+    writeMixToRowSet(schemaMix, &arena, iters);
+}
 /*************************
  * End of benchmarks
  ************************/
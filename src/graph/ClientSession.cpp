@@ -6,6 +6,8 @@
 
 #include "base/Base.h"
 #include "graph/ClientSession.h"
+#include "graph/ExecutionPlan.h"
+#include "graph/GraphFlags.h"
 
 
 namespace nebula {
@@ -15,6 +17,8 @@ ClientSession::ClientSession(int64_t id) {
     id_ = id;
 }
 
+ClientSession::~ClientSession() = default;
+
 std::shared_ptr<ClientSession> ClientSession::create(int64_t id) {
     // return std::make_shared<ClientSession>(id);
     // `std::make_shared' cannot access ClientSession's construtor
@@ -29,5 +33,30 @@ uint64_t ClientSession::idleSeconds() const {
     return idleDuration_.elapsedInSec();
 }
 
+void ClientSession::addCursor(int64_t cursorId, std::unique_ptr<ExecutionPlan> plan) {
+    std::vector<std::unique_ptr<ExecutionPlan>> dropped;
+    {
+        std::lock_guard<std::mutex> guard(cursorsLock_);
+        cursors_.emplace(cursorId, std::move(plan));
+        while (cursors_.size() > static_cast<size_t>(std::max(1, FLAGS_max_cursors_per_session))) {
+            VLOG(1) << "Drop the cursor " << cursors_.begin()->first << " of session " << id_;
+            dropped.emplace_back(std::move(cursors_.begin()->second));
+            cursors_.erase(cursors_.begin());
+        }
+    }
+    // The plans are released out of the lock
+}
+
+std::unique_ptr<ExecutionPlan> ClientSession::takeCursor(int64_t cursorId) {
+    std::lock_guard<std::mutex> guard(cursorsLock_);
+    auto it = cursors_.find(cursorId);
+    if (it == cursors_.end()) {
+        return nullptr;
+    }
+    auto plan = std::move(it->second);
+    cursors_.erase(it);
+    return plan;
+}
+
 }   // namespace graph
 }   // namespace nebula
@@ -9,6 +9,7 @@
 
 #include "base/Base.h"
 #include "time/Duration.h"
+#include "gen-cpp2/graph_types.h"
 
 /**
  * A ClientSession holds the context informations of a session opened by a client.
@@ -17,8 +18,12 @@
 namespace nebula {
 namespace graph {
 
+class ExecutionPlan;
+
 class ClientSession final {
 public:
+    ~ClientSession();
+
     int64_t id() const {
         return id_;
     }
@@ -52,6 +57,23 @@ public:
 
     void charge();
 
+    int64_t newCursorId() {
+        return ++lastCursorId_;
+    }
+
+    /**
+     * Keep the plan of a paged query as a cursor, which produces the next page on demand.
+     * At most `max_cursors_per_session' cursors are kept, the oldest ones are dropped.
+     */
+    void addCursor(int64_t cursorId, std::unique_ptr<ExecutionPlan> plan);
+
+    /**
+     * Take the cursor out to produce its next page, the plan adds itself back if there
+     * are still more pages. It returns nullptr if there is no such cursor,
+     * e.g. it was exhausted, dropped, or is producing a page.
+     */
+    std::unique_ptr<ExecutionPlan> takeCursor(int64_t cursorId);
+
 private:
     // ClientSession could only be created via SessionManager
     friend class SessionManager;
@@ -67,6 +89,10 @@ private:
     time::Duration      idleDuration_;
     std::string         spaceName_;
     std::string         user_;
+
+    std::atomic<int64_t>            lastCursorId_{0};
+    std::mutex                      cursorsLock_;
+    std::map<int64_t, std::unique_ptr<ExecutionPlan>> cursors_;
 };
 
 }   // namespace graph
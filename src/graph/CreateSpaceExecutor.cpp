@@ -31,6 +31,9 @@ Status CreateSpaceExecutor::prepare() {
                     return Status::Error("Replica_factor value should be greater than zero");
                 }
                 break;
+            case SpaceOptItem::MAINTAIN_DEGREES:
+                maintainDegrees_ = item->get_maintain_degrees();
+                break;
         }
     }
     return Status::OK();
@@ -38,7 +41,10 @@ Status CreateSpaceExecutor::prepare() {
 
 
 void CreateSpaceExecutor::execute() {
-    auto future = ectx()->getMetaClient()->createSpace(*spaceName_, partNum_, replicaFactor_);
+    auto future = ectx()->getMetaClient()->createSpace(*spaceName_,
+                                                       partNum_,
+                                                       replicaFactor_,
+                                                       maintainDegrees_);
     auto *runner = ectx()->rctx()->runner();
 
     auto cb = [this] (auto &&resp) {
@@ -48,6 +48,15 @@ public:
         return rctx_.get();
     }
 
+    /**
+     * Replace the request context, when the next page of a paged query is requested.
+     * The previous one is returned, to be finished by the caller.
+     */
+    RequestContextPtr resetRctx(RequestContextPtr rctx) {
+        std::swap(rctx_, rctx);
+        return rctx;
+    }
+
     meta::SchemaManager* schemaManager() const {
         return sm_;
     }
@@ -45,6 +45,10 @@ void ExecutionPlan::execute() {
     };
     executor_->setOnFinish(std::move(onFinish));
     executor_->setOnError(std::move(onError));
+    pageSize_ = rctx->pageSize();
+    if (pageSize_ > 0) {
+        executor_->setPageSize(pageSize_);
+    }
 
     executor_->execute();
 }
@@ -52,18 +56,67 @@ void ExecutionPlan::execute() {
 
 void ExecutionPlan::onFinish() {
     auto *rctx = ectx()->rctx();
-    executor_->setupResponse(rctx->resp());
+    auto &resp = rctx->resp();
+    executor_->setupResponse(resp);
+    if (pageSize_ > 0 && resp.__isset.rows && resp.rows.size() > static_cast<size_t>(pageSize_)) {
+        // More rows than a page are produced at once, keep the rest for the next pages
+        std::move(resp.rows.begin() + pageSize_, resp.rows.end(), std::back_inserter(rowsLeft_));
+        resp.rows.resize(pageSize_);
+        if (resp.__isset.column_names) {
+            columnNames_ = resp.column_names;
+        }
+    }
+    finishPage();
+}
+
+
+void ExecutionPlan::nextPage(ExecutionContext::RequestContextPtr rctx) {
+    auto prev = ectx_->resetRctx(std::move(rctx));
+    DCHECK(prev == nullptr);
+    if (rowsLeft_.empty()) {
+        executor_->nextPage();
+        return;
+    }
+    auto end = rowsLeft_.begin() + std::min(rowsLeft_.size(), static_cast<size_t>(pageSize_));
+    std::vector<cpp2::RowValue> rows(std::make_move_iterator(rowsLeft_.begin()),
+                                     std::make_move_iterator(end));
+    rowsLeft_.erase(rowsLeft_.begin(), end);
+    auto &resp = ectx()->rctx()->resp();
+    resp.set_error_code(cpp2::ErrorCode::SUCCEEDED);
+    resp.set_column_names(columnNames_);
+    resp.set_rows(std::move(rows));
+    finishPage();
+}
+
+
+void ExecutionPlan::finishPage() {
+    auto *rctx = ectx()->rctx();
     auto latency = rctx->duration().elapsedInUSec();
     rctx->resp().set_latency_in_us(latency);
     auto &spaceName = rctx->session()->spaceName();
     rctx->resp().set_space_name(spaceName);
-    rctx->finish();
+    if (rowsLeft_.empty() && !executor_->hasMorePages()) {
+        rctx->finish();
+        // The `ExecutionPlan' is the root node holding all resources during the execution.
+        // When the whole query process is done, it's safe to release this object, as long as
+        // no other contexts have chances to access these resources later on,
+        // e.g. previously launched uncompleted async sub-tasks, EVEN on failures.
+        delete this;
+        return;
+    }
 
-    // The `ExecutionPlan' is the root node holding all resources during the execution.
-    // When the whole query process is done, it's safe to release this object, as long as
-    // no other contexts have chances to access these resources later on,
-    // e.g. previously launched uncompleted async sub-tasks, EVEN on failures.
-    delete this;
+    // Keep the plan in the session for the next pages. The request context is taken out,
+    // so that the plan kept in the session does not hold the session in turn.
+    auto finished = ectx_->resetRctx(nullptr);
+    auto *session = finished->session();
+    if (cursorId_ == 0) {
+        cursorId_ = session->newCursorId();
+    }
+    finished->resp().set_cursor_id(cursorId_);
+    // The plan could only be resumed after the client receives the cursor id,
+    // and nothing should touch it here after that.
+    session->addCursor(cursorId_, std::unique_ptr<ExecutionPlan>(this));
+    finished->finish();
 }
 
 
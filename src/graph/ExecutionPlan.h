@@ -46,14 +46,34 @@ public:
      */
     void onError(Status);
 
+    /**
+     * Produce the next page of a paged query into `rctx'.
+     * The plan of a paged query is kept in the session as a cursor between the pages,
+     * and it finishes the same way as `execute'.
+     */
+    void nextPage(ExecutionContext::RequestContextPtr rctx);
+
     ExecutionContext* ectx() const {
         return ectx_.get();
     }
 
+private:
+    /**
+     * Respond the current page. The plan is kept as a cursor if there are more rows,
+     * otherwise it is released.
+     */
+    void finishPage();
+
 private:
     std::unique_ptr<SequentialSentences>        sentences_;
     std::unique_ptr<ExecutionContext>           ectx_;
     std::unique_ptr<SequentialExecutor>         executor_;
+    // The max number of rows in each page, 0 if the query is not paged
+    int32_t                                     pageSize_{0};
+    int64_t                                     cursorId_{0};
+    // The rows produced beyond the current page, by the executors producing all at once
+    std::deque<cpp2::RowValue>                  rowsLeft_;
+    std::vector<std::string>                    columnNames_;
 };
 
 }   // namespace graph
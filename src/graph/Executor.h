@@ -70,6 +70,30 @@ public:
         resp.set_error_code(cpp2::ErrorCode::SUCCEEDED);
     }
 
+    /**
+     * Ask the last executor to produce its result in pages of about `pageSize' rows.
+     * An executor which supports it stops after a page is ready, and sets up the response
+     * with the rows of that page only. It is ignored by the others.
+     */
+    virtual void setPageSize(int32_t pageSize) {
+        UNUSED(pageSize);
+    }
+
+    /**
+     * Whether the executor stopped after a page with more rows to produce.
+     */
+    virtual bool hasMorePages() const {
+        return false;
+    }
+
+    /**
+     * Produce the next page, when `hasMorePages'.
+     * It ends by invoking either `onFinish_' or `onError_', just like `execute'.
+     */
+    virtual void nextPage() {
+        LOG(FATAL) << name() << " has no more pages";
+    }
+
     ExecutionContext* ectx() const {
         return ectx_;
     }
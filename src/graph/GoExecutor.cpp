@@ -6,6 +6,8 @@
 
 #include "base/Base.h"
 #include "graph/GoExecutor.h"
+#include "graph/GraphFlags.h"
+#include "dataman/ColumnReader.h"
 #include "dataman/RowReader.h"
 #include "dataman/RowSetReader.h"
 #include "dataman/ResultSchemaProvider.h"
@@ -66,6 +68,12 @@ Status GoExecutor::prepareClauses() {
         if (!status.ok()) {
             break;
         }
+        status = prepareLimit();
+        if (!status.ok()) {
+            break;
+        }
+        prepareTraverse();
+        prepareColumnar();
     } while (false);
 
     if (!status.ok()) {
@@ -91,6 +99,8 @@ void GoExecutor::execute() {
         onError_(std::move(status));
         return;
     }
+    // The space is kept for the next pages, even if the session switches to another one
+    spaceId_ = ectx()->rctx()->session()->space();
     if (starts_.empty()) {
         onEmptyInputs();
         return;
@@ -191,12 +201,23 @@ Status GoExecutor::prepareOver() {
             LOG(FATAL) << "Over clause shall never be null";
         }
         auto spaceId = ectx()->rctx()->session()->space();
-        auto edgeStatus = ectx()->schemaManager()->toEdgeType(spaceId, *clause->edge());
-        if (!edgeStatus.ok()) {
-            status = edgeStatus.status();
+        for (auto *edge : clause->edges()) {
+            auto edgeStatus = ectx()->schemaManager()->toEdgeType(spaceId, *edge->edge());
+            if (!edgeStatus.ok()) {
+                status = edgeStatus.status();
+                break;
+            }
+            auto edgeType = edgeStatus.value();
+            auto *alias = edge->alias() != nullptr ? edge->alias() : edge->edge();
+            if (!edgeAliases_.emplace(*alias, edgeType).second) {
+                status = Status::Error("Duplicate edge alias `%s'", alias->c_str());
+                break;
+            }
+            edgeTypes_.emplace_back(edgeType);
+        }
+        if (!status.ok()) {
             break;
         }
-        edgeType_ = edgeStatus.value();
         reversely_ = clause->isReversely();
     } while (false);
 
@@ -212,11 +233,99 @@ Status GoExecutor::prepareWhere() {
     auto *clause = sentence_->whereClause();
     if (clause != nullptr) {
         filter_ = clause->filter();
+        if (FLAGS_filter_pushdown) {
+            prepareFilterPushdown();
+        }
     }
     return Status::OK();
 }
 
 
+void GoExecutor::prepareFilterPushdown() {
+    // Split the filter into conjuncts, i.e. `A && B && C' into {A, B, C}
+    std::vector<const Expression*> conjuncts;
+    std::vector<const Expression*> stack = {filter_};
+    while (!stack.empty()) {
+        auto *expr = stack.back();
+        stack.pop_back();
+        if (expr->kind() == Expression::kLogical) {
+            auto *logExpr = static_cast<const LogicalExpression*>(expr);
+            if (logExpr->op() == LogicalExpression::AND) {
+                stack.emplace_back(logExpr->right());
+                stack.emplace_back(logExpr->left());
+                continue;
+            }
+        }
+        conjuncts.emplace_back(expr);
+    }
+
+    std::unique_ptr<Expression> pushdown;
+    filterFullyPushed_ = true;
+    for (auto *expr : conjuncts) {
+        if (!canPushdown(expr)) {
+            filterFullyPushed_ = false;
+            continue;
+        }
+        // `filter_' is still evaluated upon the final result, so we push down a copy.
+        auto copy = Expression::decode(Expression::encode(expr));
+        if (!copy.ok()) {
+            LOG(WARNING) << "Failed to copy `" << expr->toString() << "' for pushdown: "
+                         << copy.status();
+            filterFullyPushed_ = false;
+            continue;
+        }
+        if (pushdown == nullptr) {
+            pushdown = std::move(copy).value();
+        } else {
+            pushdown = std::make_unique<LogicalExpression>(pushdown.release(),
+                                                           LogicalExpression::AND,
+                                                           std::move(copy).value().release());
+        }
+    }
+
+    if (pushdown != nullptr) {
+        VLOG(1) << "Push down filter: " << pushdown->toString();
+        filterPushdown_ = Expression::encode(pushdown.get());
+    }
+}
+
+
+bool GoExecutor::canPushdown(const Expression *expr) const {
+    switch (expr->kind()) {
+        case Expression::kPrimary:
+        case Expression::kSourceProp:
+            return true;
+        case Expression::kEdgeRank:
+        case Expression::kEdgeDstId:
+        case Expression::kEdgeSrcId:
+        case Expression::kEdgeType:
+        case Expression::kAliasProp:
+            // Storage could not tell the props of one edge type from another's
+            return !isMultiEdges();
+        case Expression::kUnary: {
+            auto *unaExpr = static_cast<const UnaryExpression*>(expr);
+            return canPushdown(unaExpr->operand());
+        }
+        case Expression::kArithmetic: {
+            auto *ariExpr = static_cast<const ArithmeticExpression*>(expr);
+            return canPushdown(ariExpr->left()) && canPushdown(ariExpr->right());
+        }
+        case Expression::kRelational: {
+            auto *relExpr = static_cast<const RelationalExpression*>(expr);
+            return canPushdown(relExpr->left()) && canPushdown(relExpr->right());
+        }
+        case Expression::kLogical: {
+            auto *logExpr = static_cast<const LogicalExpression*>(expr);
+            return canPushdown(logExpr->left()) && canPushdown(logExpr->right());
+        }
+        default:
+            // Function calls, type castings and the props of the dst vertex,
+            // the input or the variables are not supported by storage yet.
+            return false;
+    }
+}
+
+
 Status GoExecutor::prepareYield() {
     auto *clause = sentence_->yieldClause();
     if (clause != nullptr) {
@@ -235,6 +344,16 @@ Status GoExecutor::prepareNeededProps() {
             if (!status.ok()) {
                 break;
             }
+            // Upon several edge types, the filter is evaluated by tree,
+            // whose getters know the props of one edge type from another's.
+            if (!isMultiEdges()) {
+                auto programRet = ExpressionProgram::compile(filter_);
+                if (programRet.ok()) {
+                    filterProgram_ = std::move(programRet).value();
+                } else {
+                    VLOG(1) << "Evaluate the filter by tree, " << programRet.status();
+                }
+            }
         }
 
         for (auto *col : yields_) {
@@ -248,6 +367,21 @@ Status GoExecutor::prepareNeededProps() {
             break;
         }
 
+        if (isMultiEdges()) {
+            for (auto &prop : expCtx_->aliasProps()) {
+                if (edgeAliases_.find(prop.first) == edgeAliases_.end()) {
+                    status = Status::Error("Edge `%s' not specified in the `OVER' clause",
+                                           prop.first.c_str());
+                    break;
+                }
+            }
+            if (!status.ok()) {
+                break;
+            }
+        } else if (FLAGS_batch_evaluation) {
+            prepareBatchEvaluation();
+        }
+
         if (expCtx_->hasVariableProp()) {
             if (fromType_ != kVariable) {
                 status = Status::Error("A variable must be referred in FROM "
@@ -280,6 +414,38 @@ Status GoExecutor::prepareNeededProps() {
 }
 
 
+void GoExecutor::prepareBatchEvaluation() {
+    if (filter_ != nullptr && filterProgram_ == nullptr) {
+        return;
+    }
+    std::vector<std::unique_ptr<ExpressionProgram>> programs;
+    for (auto *col : yields_) {
+        auto programRet = ExpressionProgram::compile(col->expr());
+        if (!programRet.ok()) {
+            VLOG(1) << "Evaluate the yield columns row by row, " << programRet.status();
+            return;
+        }
+        programs.emplace_back(std::move(programRet).value());
+    }
+    // The props shared by several yield columns are decoded only once.
+    for (auto &program : programs) {
+        std::vector<size_t> slotMap;
+        for (auto &slot : program->slots()) {
+            auto it = std::find_if(yieldSlots_.begin(), yieldSlots_.end(), [&] (auto &s) {
+                return s.kind == slot.kind && s.alias == slot.alias && s.prop == slot.prop;
+            });
+            slotMap.emplace_back(it - yieldSlots_.begin());
+            if (it == yieldSlots_.end()) {
+                yieldSlots_.emplace_back(slot);
+            }
+        }
+        yieldSlotMaps_.emplace_back(std::move(slotMap));
+    }
+    yieldPrograms_ = std::move(programs);
+    batchEval_ = true;
+}
+
+
 Status GoExecutor::prepareDistinct() {
     auto *clause = sentence_->yieldClause();
     if (clause != nullptr) {
@@ -292,6 +458,67 @@ Status GoExecutor::prepareDistinct() {
 }
 
 
+Status GoExecutor::prepareLimit() {
+    auto *sample = sentence_->sampleClause();
+    if (sample != nullptr) {
+        if (sample->count() <= 0) {
+            return Status::Error("`SAMPLE' count should be positive");
+        }
+        sampleSize_ = sample->count();
+    }
+    auto *limit = sentence_->limitClause();
+    if (limit != nullptr) {
+        if (limit->count() <= 0) {
+            return Status::Error("`LIMIT' count should be positive");
+        }
+        limit_ = limit->count();
+    }
+    return Status::OK();
+}
+
+
+storage::cpp2::EdgeLimit GoExecutor::buildEdgeLimit() const {
+    storage::cpp2::EdgeLimit limit;
+    if (sampleSize_ > 0) {
+        limit.set_per_vertex(sampleSize_);
+        limit.set_random_sample(true);
+    }
+    // Rows are dropped after storage by distinct and by the conjuncts not pushed down,
+    // and the vertices of the final step are spread over the rounds of `traverse'.
+    if (limit_ > 0 && isFinalStep() && !distinct_ && !traverse_
+            && (filter_ == nullptr || filterFullyPushed_)) {
+        limit.set_total(limit_);
+    }
+    return limit;
+}
+
+
+void GoExecutor::prepareTraverse() {
+    if (!FLAGS_storage_traverse || steps_ == 1 || isMultiEdges()) {
+        return;
+    }
+    // The source of each dst is not tracked by storage
+    if (expCtx_->hasInputProp() || expCtx_->hasVariableProp()) {
+        return;
+    }
+    traverse_ = true;
+}
+
+
+void GoExecutor::prepareColumnar() {
+    // Storage encodes the edges of only one type by columns
+    if (!FLAGS_columnar_neighbors || !batchEval_ || isMultiEdges() || traverse_) {
+        return;
+    }
+    // The props of dst vertices are fetched row by row. And a missing tag of a src vertex
+    // fails the evaluation row by row, but is filled with the defaults in the columns.
+    if (expCtx_->hasSrcTagProp() || expCtx_->hasDstTagProp()) {
+        return;
+    }
+    columnar_ = true;
+}
+
+
 Status GoExecutor::setupStarts() {
     // Literal vertex ids
     if (!starts_.empty()) {
@@ -332,7 +559,22 @@ void GoExecutor::setupResponse(cpp2::ExecutionResponse &resp) {
 
 
 void GoExecutor::stepOut() {
-    auto spaceId = ectx()->rctx()->session()->space();
+    if (traverse_) {
+        // The filter and the returned props are of the final step
+        curStep_ = steps_;
+        Frontier frontier;
+        frontier.emplace(steps_, std::move(starts_));
+        traverse(std::move(frontier));
+        return;
+    }
+    // Step out from a page of vertices at a time in the final step, so that only
+    // the response of one page is held in memory.
+    auto pageSize = static_cast<size_t>(FLAGS_step_out_page_size);
+    if (isFinalStep() && pageSize > 0 && starts_.size() > pageSize) {
+        pendingStarts_.assign(starts_.begin() + pageSize, starts_.end());
+        starts_.resize(pageSize);
+    }
+    auto spaceId = spaceId_;
     auto status = getStepOutProps();
     if (!status.ok()) {
         DCHECK(onError_);
@@ -340,12 +582,16 @@ void GoExecutor::stepOut() {
         return;
     }
     auto returns = status.value();
+    // The WHERE clause only applies to the final step
+    std::string filterPushdown = isFinalStep() ? filterPushdown_ : "";
     auto future = ectx()->storage()->getNeighbors(spaceId,
                                                   starts_,
-                                                  edgeType_,
+                                                  edgeTypes_,
                                                   !reversely_,
-                                                  "",
-                                                  std::move(returns));
+                                                  std::move(filterPushdown),
+                                                  std::move(returns),
+                                                  buildEdgeLimit(),
+                                                  columnar_ && isFinalStep());
     auto *runner = ectx()->rctx()->runner();
     auto cb = [this] (auto &&result) {
         auto completeness = result.completeness();
@@ -374,12 +620,122 @@ void GoExecutor::stepOut() {
 }
 
 
+void GoExecutor::traverse(Frontier frontier) {
+    auto spaceId = spaceId_;
+    auto status = getStepOutProps();
+    if (!status.ok()) {
+        DCHECK(onError_);
+        onError_(Status::Error("Get step out props failed"));
+        return;
+    }
+    auto returns = status.value();
+    std::vector<folly::SemiFuture<RpcResponse>> futures;
+    for (auto &pair : frontier) {
+        auto &traversed = traversed_[pair.first];
+        std::vector<VertexID> starts;
+        for (auto id : pair.second) {
+            if (traversed.emplace(id).second) {
+                starts.emplace_back(id);
+            }
+        }
+        if (starts.empty()) {
+            continue;
+        }
+        futures.emplace_back(ectx()->storage()->traverse(spaceId,
+                                                         std::move(starts),
+                                                         edgeTypes_.front(),
+                                                         !reversely_,
+                                                         pair.first,
+                                                         filterPushdown_,
+                                                         returns,
+                                                         buildEdgeLimit()));
+    }
+    if (futures.empty()) {
+        onTraverseFinished();
+        return;
+    }
+
+    auto *runner = ectx()->rctx()->runner();
+    auto cb = [this] (auto &&results) {
+        Frontier next;
+        for (auto &t : results) {
+            if (t.hasException()) {
+                LOG(ERROR) << "Exception caught: " << t.exception().what();
+                onError_(Status::Error("Internal error"));
+                return;
+            }
+            auto &result = t.value();
+            auto completeness = result.completeness();
+            if (completeness == 0) {
+                DCHECK(onError_);
+                onError_(Status::Error("Traverse failed"));
+                return;
+            } else if (completeness != 100) {
+                LOG(INFO) << "Traverse partially failed: "  << completeness << "%";
+                for (auto &error : result.failedParts()) {
+                    LOG(ERROR) << "part: " << error.first
+                               << "error code: " << static_cast<int>(error.second);
+                }
+            }
+            for (auto &resp : result.responses()) {
+                auto *remote = resp.get_frontier();
+                if (remote != nullptr) {
+                    for (auto &pair : *remote) {
+                        auto &ids = next[pair.first];
+                        ids.insert(ids.end(), pair.second.begin(), pair.second.end());
+                    }
+                }
+                traverseResps_.emplace_back(std::move(resp));
+            }
+        }
+        if (next.empty()) {
+            onTraverseFinished();
+            return;
+        }
+        traverse(std::move(next));
+    };
+    auto error = [this] (auto &&e) {
+        LOG(ERROR) << "Exception caught: " << e.what();
+        onError_(Status::Error("Internal error"));
+    };
+    folly::collectAll(std::move(futures)).via(runner).thenValue(cb).thenError(error);
+}
+
+
+void GoExecutor::onTraverseFinished() {
+    RpcResponse rpcResp(std::max<size_t>(traverseResps_.size(), 1));
+    // A vertex could be reached by several hosts, which step out from it in their own
+    // rounds, but it is the same host who leads its partition and returns its edges.
+    std::unordered_set<VertexID> uniqID;
+    for (auto &resp : traverseResps_) {
+        auto *vertices = resp.get_vertices();
+        if (vertices != nullptr) {
+            std::vector<storage::cpp2::VertexData> uniq;
+            for (auto &vdata : *vertices) {
+                if (uniqID.emplace(vdata.get_vertex_id()).second) {
+                    uniq.emplace_back(std::move(vdata));
+                }
+            }
+            resp.set_vertices(std::move(uniq));
+        }
+        rpcResp.responses().emplace_back(std::move(resp));
+    }
+    traverseResps_.clear();
+    traversed_.clear();
+    onStepOutResponse(std::move(rpcResp));
+}
+
+
 void GoExecutor::onStepOutResponse(RpcResponse &&rpcResp) {
     if (isFinalStep()) {
         if (expCtx_->hasDstTagProp()) {
             auto dstids = getDstIdsFromResp(rpcResp);
             if (dstids.empty()) {
-                onEmptyInputs();
+                if (pendingStarts_.empty() && rsWriter_ == nullptr && rowsResponded_ == 0) {
+                    onEmptyInputs();
+                } else {
+                    finishExecution(std::move(rpcResp));
+                }
                 return;
             }
             fetchVertexProps(std::move(dstids), std::move(rpcResp));
@@ -411,31 +767,66 @@ std::vector<VertexID> GoExecutor::getDstIdsFromResp(RpcResponse &rpcResp) const
         if (vertices == nullptr) {
             continue;
         }
-        auto schema = std::make_shared<ResultSchemaProvider>(resp.edge_schema);
-        for (auto &vdata : *vertices) {
-            RowSetReader rsReader(schema, vdata.edge_data);
+        auto collect = [&] (const RowSetReader &rsReader, VertexID srcId) {
             auto iter = rsReader.begin();
             while (iter) {
                 VertexID dst;
                 auto rc = iter->getVid("_dst", dst);
                 CHECK(rc == ResultType::SUCCEEDED);
                 if (!isFinalStep() && backTracker_ != nullptr) {
-                    backTracker_->add(vdata.get_vertex_id(), dst);
+                    backTracker_->add(srcId, dst);
                 }
                 set.emplace(dst);
                 ++iter;
             }
+        };
+        if (isMultiEdges()) {
+            auto *edgeSchemas = resp.get_edge_schemas();
+            if (edgeSchemas == nullptr) {
+                continue;
+            }
+            std::unordered_map<EdgeType, std::shared_ptr<ResultSchemaProvider>> schemas;
+            for (auto &schema : *edgeSchemas) {
+                schemas.emplace(schema.first,
+                                std::make_shared<ResultSchemaProvider>(schema.second));
+            }
+            for (auto &vdata : *vertices) {
+                for (auto &edata : vdata.edges) {
+                    auto it = schemas.find(edata.type);
+                    DCHECK(it != schemas.end());
+                    collect(RowSetReader(it->second, edata.data), vdata.get_vertex_id());
+                }
+            }
+            continue;
+        }
+        auto schema = std::make_shared<ResultSchemaProvider>(resp.edge_schema);
+        for (auto &vdata : *vertices) {
+            collect(RowSetReader(schema, vdata.edge_data), vdata.get_vertex_id());
         }
     }
     return std::vector<VertexID>(set.begin(), set.end());
 }
 
 void GoExecutor::finishExecution(RpcResponse &&rpcResp) {
-    std::unique_ptr<InterimResult> outputs;
-
-    if (!setupInterimResult(std::move(rpcResp), outputs)) {
+    if (!setupInterimResult(std::move(rpcResp))) {
         return;
     }
+    if (!pendingStarts_.empty() && (limit_ == 0 || resultRows_ < limit_)) {
+        // Respond the rows so far as a page if they are enough, and go on stepping out
+        // from the rest vertices only when the next page is requested.
+        if (onResult_ || pageSize_ <= 0 || resultRows_ - rowsResponded_ < pageSize_) {
+            nextPage();
+            return;
+        }
+        suspended_ = true;
+    }
+    rowsResponded_ = resultRows_;
+
+    std::unique_ptr<InterimResult> outputs;
+    // No results populated
+    if (rsWriter_ != nullptr) {
+        outputs = std::make_unique<InterimResult>(std::move(rsWriter_));
+    }
     if (onResult_) {
         onResult_(std::move(outputs));
     } else {
@@ -451,6 +842,14 @@ void GoExecutor::finishExecution(RpcResponse &&rpcResp) {
     onFinish_();
 }
 
+void GoExecutor::nextPage() {
+    suspended_ = false;
+    starts_ = std::move(pendingStarts_);
+    pendingStarts_.clear();
+    vertexHolder_.reset();
+    stepOut();
+}
+
 StatusOr<std::vector<storage::cpp2::PropDef>> GoExecutor::getStepOutProps() {
     std::vector<storage::cpp2::PropDef> props;
     {
@@ -464,7 +863,7 @@ StatusOr<std::vector<storage::cpp2::PropDef>> GoExecutor::getStepOutProps() {
         return props;
     }
 
-    auto spaceId = ectx()->rctx()->session()->space();
+    auto spaceId = spaceId_;
     SchemaProps tagProps;
     for (auto &tagProp : expCtx_->srcTagProps()) {
         tagProps[tagProp.first].emplace_back(tagProp.second);
@@ -492,6 +891,15 @@ StatusOr<std::vector<storage::cpp2::PropDef>> GoExecutor::getStepOutProps() {
         storage::cpp2::PropDef pd;
         pd.owner = storage::cpp2::PropOwner::EDGE;
         pd.name = prop.second;
+        if (isMultiEdges()) {
+            auto edgeType = edgeAliases_[prop.first];
+            pd.set_edge_type(edgeType);
+            auto value = defaultEdgeProp(spaceId, edgeType, prop.second);
+            if (!value.ok()) {
+                return value.status();
+            }
+            edgeDefaults_[prop] = std::move(value).value();
+        }
         props.emplace_back(std::move(pd));
     }
 
@@ -499,8 +907,37 @@ StatusOr<std::vector<storage::cpp2::PropDef>> GoExecutor::getStepOutProps() {
 }
 
 
+StatusOr<VariantType> GoExecutor::defaultEdgeProp(GraphSpaceID spaceId,
+                                                  EdgeType edgeType,
+                                                  const std::string &prop) const {
+    if (prop == "_src" || prop == "_dst" || prop == "_rank" || prop == "_type") {
+        return static_cast<int64_t>(0);
+    }
+    auto schema = ectx()->schemaManager()->getEdgeSchema(spaceId, edgeType);
+    if (schema == nullptr) {
+        return Status::Error("No schema found for edge type %d", edgeType);
+    }
+    const auto &type = schema->getFieldType(prop);
+    switch (type.type) {
+        case nebula::cpp2::SupportedType::BOOL:
+            return false;
+        case nebula::cpp2::SupportedType::INT:
+        case nebula::cpp2::SupportedType::VID:
+        case nebula::cpp2::SupportedType::TIMESTAMP:
+            return static_cast<int64_t>(0);
+        case nebula::cpp2::SupportedType::FLOAT:
+        case nebula::cpp2::SupportedType::DOUBLE:
+            return 0.0;
+        case nebula::cpp2::SupportedType::STRING:
+            return std::string();
+        default:
+            return Status::Error("Edge prop `%s' not found", prop.c_str());
+    }
+}
+
+
 StatusOr<std::vector<storage::cpp2::PropDef>> GoExecutor::getDstProps() {
-    auto spaceId = ectx()->rctx()->session()->space();
+    auto spaceId = spaceId_;
     SchemaProps tagProps;
     for (auto &tagProp : expCtx_->dstTagProps()) {
         tagProps[tagProp.first].emplace_back(tagProp.second);
@@ -529,7 +966,7 @@ StatusOr<std::vector<storage::cpp2::PropDef>> GoExecutor::getDstProps() {
 
 
 void GoExecutor::fetchVertexProps(std::vector<VertexID> ids, RpcResponse &&rpcResp) {
-    auto spaceId = ectx()->rctx()->session()->space();
+    auto spaceId = spaceId_;
     auto status = getDstProps();
     if (!status.ok()) {
         DCHECK(onError_);
@@ -582,14 +1019,11 @@ std::vector<std::string> GoExecutor::getResultColumnNames() const {
     return result;
 }
 
-bool GoExecutor::setupInterimResult(RpcResponse &&rpcResp, std::unique_ptr<InterimResult> &result) {
+bool GoExecutor::setupInterimResult(RpcResponse &&rpcResp) {
     // Generic results
-    std::shared_ptr<SchemaWriter> schema;
-    std::unique_ptr<RowSetWriter> rsWriter;
-    auto uniqResult = std::make_unique<std::unordered_set<std::string>>();
     auto cb = [&] (std::vector<VariantType> record) {
-        if (schema == nullptr) {
-            schema = std::make_shared<SchemaWriter>();
+        if (resultSchema_ == nullptr) {
+            auto schema = std::make_shared<SchemaWriter>();
             auto colnames = getResultColumnNames();
             for (auto i = 0u; i < record.size(); i++) {
                 SupportedType type;
@@ -612,10 +1046,14 @@ bool GoExecutor::setupInterimResult(RpcResponse &&rpcResp, std::unique_ptr<Inter
                 }
                 schema->appendCol(colnames[i], type);
             }  // for
-            rsWriter = std::make_unique<RowSetWriter>(schema);
+            resultSchema_ = std::move(schema);
         }  // if
+        if (rsWriter_ == nullptr) {
+            // The rows of the previous pages have been responded
+            rsWriter_ = std::make_unique<RowSetWriter>(resultSchema_);
+        }
 
-        RowWriter writer(schema);
+        RowWriter writer(resultSchema_);
         for (auto &column : record) {
             switch (column.which()) {
                 case 0:
@@ -636,23 +1074,21 @@ bool GoExecutor::setupInterimResult(RpcResponse &&rpcResp, std::unique_ptr<Inter
         }
         // TODO Consider float/double, and need to reduce mem copy.
         std::string encode = writer.encode();
+        if (limit_ > 0 && resultRows_ >= limit_) {
+            return;
+        }
         if (distinct_) {
-            auto ret = uniqResult->emplace(encode);
+            auto ret = uniqResult_.emplace(encode);
             if (ret.second) {
-                rsWriter->addRow(std::move(encode));
+                rsWriter_->addRow(std::move(encode));
+                ++resultRows_;
             }
         } else {
-            rsWriter->addRow(std::move(encode));
+            rsWriter_->addRow(std::move(encode));
+            ++resultRows_;
         }
     };  // cb
-    if (!processFinalResult(rpcResp, cb)) {
-        return false;
-    }
-    // No results populated
-    if (rsWriter != nullptr) {
-        result = std::make_unique<InterimResult>(std::move(rsWriter));
-    }
-    return true;
+    return processFinalResult(rpcResp, cb);
 }
 
 
@@ -669,6 +1105,12 @@ void GoExecutor::onEmptyInputs() {
 bool GoExecutor::processFinalResult(RpcResponse &rpcResp, Callback cb) const {
     auto all = rpcResp.responses();
     for (auto &resp : all) {
+        if (resp.__isset.columnar) {
+            if (!processColumns(resp, cb)) {
+                return false;
+            }
+            continue;
+        }
         if (resp.get_vertices() == nullptr) {
             continue;
         }
@@ -680,6 +1122,24 @@ bool GoExecutor::processFinalResult(RpcResponse &rpcResp, Callback cb) const {
         if (resp.get_edge_schema() != nullptr) {
             eschema = std::make_shared<ResultSchemaProvider>(resp.edge_schema);
         }
+        std::unordered_map<EdgeType, std::shared_ptr<ResultSchemaProvider>> eschemas;
+        if (resp.get_edge_schemas() != nullptr) {
+            for (auto &schema : resp.edge_schemas) {
+                eschemas.emplace(schema.first,
+                                 std::make_shared<ResultSchemaProvider>(schema.second));
+            }
+        }
+
+        std::vector<int64_t> filterIndexes;
+        std::vector<int64_t> yieldIndexes;
+        ExpressionProgram::SlotValues filterValues;
+        if (filterProgram_ != nullptr) {
+            filterIndexes = resolveSlots(filterProgram_->slots(), eschema.get());
+            filterValues.resize(filterIndexes.size());
+        }
+        if (batchEval_) {
+            yieldIndexes = resolveSlots(yieldSlots_, eschema.get());
+        }
 
         for (auto &vdata : resp.vertices) {
             std::unique_ptr<RowReader> vreader;
@@ -692,96 +1152,505 @@ bool GoExecutor::processFinalResult(RpcResponse &rpcResp, Callback cb) const {
                 DCHECK(vdata.__isset.vertex_data);
                 vreader = RowReader::getRowReader(vdata.vertex_data, vschema);
             }
-            DCHECK(vdata.__isset.edge_data);
-            DCHECK(eschema != nullptr);
-            RowSetReader rsReader(eschema, vdata.edge_data);
-            auto iter = rsReader.begin();
-            while (iter) {
-                auto &getters = expCtx_->getters();
-                getters.getAliasProp = [&](const std::string &,
-                                           const std::string &prop) -> OptVariantType {
-                    auto res = RowReader::getPropByName(&*iter, prop);
-                    if (ok(res)) {
-                        return value(res);
-                    }
-                    return Status::Error("get edge prop failed");
-                };
-                getters.getSrcTagProp = [&](const std::string &tagName,
-                                            const std::string &prop) -> OptVariantType {
-                    auto tagIter = this->srcTagProps_.find(std::make_pair(tagName, prop));
-                    if (tagIter == this->srcTagProps_.end()) {
-                        auto msg = folly::sformat(
-                            "Src tagName : {} , propName : {} is not exist", tagName, prop);
-                        LOG(ERROR) << msg;
-                        return Status::Error(msg);
-                    }
-                    auto index = tagIter->second;
-                    const nebula::cpp2::ValueType &type = vschema->getFieldType(index);
-                    if (type == CommonConstants::kInvalidValueType()) {
-                        auto msg =
-                            folly::sformat("Tag: {} no schema for the index {}", tagName, index);
-                        LOG(ERROR) << msg;
-                        return Status::Error(msg);
-                    }
-                    auto res = RowReader::getPropByIndex(vreader.get(), index);
-                    if (ok(res)) {
-                        return value(std::move(res));
-                    }
-                    return Status::Error(folly::sformat("{}.{} was not exist", tagName, prop));
-                };
-                getters.getDstTagProp = [&](const std::string &tagName,
-                                            const std::string &prop) -> OptVariantType {
-                    auto res = RowReader::getPropByName(&*iter, "_dst");
-                    CHECK(ok(res));
-                    auto dst = value(std::move(res));
-                    auto tagIter = this->dstTagProps_.find(std::make_pair(tagName, prop));
-                    if (tagIter == this->dstTagProps_.end()) {
-                        auto msg = folly::sformat(
-                            "Src tagName : {} , propName : {} is not exist", tagName, prop);
-                        LOG(ERROR) << msg;
-                        return Status::Error(msg);
-                    }
-                    auto index = tagIter->second;
-                    return vertexHolder_->get(boost::get<int64_t>(dst), index);
-                };
-                getters.getVariableProp = [&] (const std::string &prop) {
-                    return getPropFromInterim(vdata.get_vertex_id(), prop);
-                };
-                getters.getInputProp = [&] (const std::string &prop) {
-                    return getPropFromInterim(vdata.get_vertex_id(), prop);
-                };
-                // Evaluate filter
-                if (filter_ != nullptr) {
-                    auto value = filter_->eval();
-                    if (!value.ok()) {
-                        onError_(value.status());
+            if (isMultiEdges()) {
+                for (auto &edata : vdata.edges) {
+                    auto it = eschemas.find(edata.type);
+                    DCHECK(it != eschemas.end());
+                    RowSetReader rsReader(it->second, edata.data);
+                    if (!processEdges(rsReader,
+                                      edata.type,
+                                      vdata.get_vertex_id(),
+                                      vschema.get(),
+                                      vreader.get(),
+                                      filterIndexes,
+                                      filterValues,
+                                      cb)) {
                         return false;
                     }
-                    if (!Expression::asBool(value.value())) {
-                        ++iter;
-                        continue;
-                    }
                 }
-                std::vector<VariantType> record;
-                record.reserve(yields_.size());
-                for (auto *column : yields_) {
-                    auto *expr = column->expr();
-                    auto value = expr->eval();
-                    if (!value.ok()) {
-                        onError_(value.status());
-                        return false;
-                    }
-                    record.emplace_back(std::move(value.value()));
+                continue;
+            }
+            DCHECK(vdata.__isset.edge_data);
+            DCHECK(eschema != nullptr);
+            RowSetReader rsReader(eschema, vdata.edge_data);
+            if (batchEval_) {
+                if (!processBlock(rsReader,
+                                  vdata.get_vertex_id(),
+                                  vreader.get(),
+                                  filterIndexes,
+                                  yieldIndexes,
+                                  cb)) {
+                    return false;
                 }
-                cb(std::move(record));
-                ++iter;
-            }   // while `iter'
+                continue;
+            }
+            if (!processEdges(rsReader,
+                              edgeTypes_.front(),
+                              vdata.get_vertex_id(),
+                              vschema.get(),
+                              vreader.get(),
+                              filterIndexes,
+                              filterValues,
+                              cb)) {
+                return false;
+            }
         }   // for `vdata'
     }   // for `resp'
     return true;
 }
 
 
+bool GoExecutor::processEdges(const RowSetReader &rsReader,
+                              EdgeType edgeType,
+                              VertexID srcId,
+                              const meta::SchemaProviderIf *vschema,
+                              const RowReader *vreader,
+                              const std::vector<int64_t> &filterIndexes,
+                              ExpressionProgram::SlotValues &filterValues,
+                              Callback &cb) const {
+    auto iter = rsReader.begin();
+    // The getters refer to `iter', so they are bound once for all edges.
+    auto &getters = expCtx_->getters();
+    getters.getAliasProp = [&](const std::string &alias,
+                               const std::string &prop) -> OptVariantType {
+        if (isMultiEdges() && edgeAliases_.find(alias)->second != edgeType) {
+            auto it = edgeDefaults_.find(std::make_pair(alias, prop));
+            DCHECK(it != edgeDefaults_.end());
+            return it->second;
+        }
+        auto res = RowReader::getPropByName(&*iter, prop);
+        if (ok(res)) {
+            return value(res);
+        }
+        return Status::Error("get edge prop failed");
+    };
+    getters.getSrcTagProp = [&](const std::string &tagName,
+                                const std::string &prop) -> OptVariantType {
+        auto tagIter = this->srcTagProps_.find(std::make_pair(tagName, prop));
+        if (tagIter == this->srcTagProps_.end()) {
+            auto msg = folly::sformat(
+                "Src tagName : {} , propName : {} is not exist", tagName, prop);
+            LOG(ERROR) << msg;
+            return Status::Error(msg);
+        }
+        auto index = tagIter->second;
+        const nebula::cpp2::ValueType &type = vschema->getFieldType(index);
+        if (type == CommonConstants::kInvalidValueType()) {
+            auto msg =
+                folly::sformat("Tag: {} no schema for the index {}", tagName, index);
+            LOG(ERROR) << msg;
+            return Status::Error(msg);
+        }
+        auto res = RowReader::getPropByIndex(vreader, index);
+        if (ok(res)) {
+            return value(std::move(res));
+        }
+        return Status::Error(folly::sformat("{}.{} was not exist", tagName, prop));
+    };
+    getters.getDstTagProp = [&](const std::string &tagName,
+                                const std::string &prop) -> OptVariantType {
+        auto res = RowReader::getPropByName(&*iter, "_dst");
+        CHECK(ok(res));
+        auto dst = value(std::move(res));
+        auto tagIter = this->dstTagProps_.find(std::make_pair(tagName, prop));
+        if (tagIter == this->dstTagProps_.end()) {
+            auto msg = folly::sformat(
+                "Src tagName : {} , propName : {} is not exist", tagName, prop);
+            LOG(ERROR) << msg;
+            return Status::Error(msg);
+        }
+        auto index = tagIter->second;
+        return vertexHolder_->get(boost::get<int64_t>(dst), index);
+    };
+    getters.getVariableProp = [&] (const std::string &prop) {
+        return getPropFromInterim(srcId, prop);
+    };
+    getters.getInputProp = [&] (const std::string &prop) {
+        return getPropFromInterim(srcId, prop);
+    };
+    while (iter) {
+        // Evaluate filter
+        if (filterProgram_ != nullptr) {
+            auto status = loadSlots(filterProgram_->slots(),
+                                    filterIndexes,
+                                    srcId,
+                                    vreader,
+                                    &*iter,
+                                    filterValues);
+            if (!status.ok()) {
+                onError_(std::move(status));
+                return false;
+            }
+            auto value = filterProgram_->eval(filterValues);
+            if (!value.ok()) {
+                onError_(value.status());
+                return false;
+            }
+            if (!Expression::asBool(value.value())) {
+                ++iter;
+                continue;
+            }
+        } else if (filter_ != nullptr) {
+            auto value = filter_->eval();
+            if (!value.ok()) {
+                onError_(value.status());
+                return false;
+            }
+            if (!Expression::asBool(value.value())) {
+                ++iter;
+                continue;
+            }
+        }
+        std::vector<VariantType> record;
+        record.reserve(yields_.size());
+        for (auto *column : yields_) {
+            auto *expr = column->expr();
+            auto value = expr->eval();
+            if (!value.ok()) {
+                onError_(value.status());
+                return false;
+            }
+            record.emplace_back(std::move(value.value()));
+        }
+        cb(std::move(record));
+        ++iter;
+    }   // while `iter'
+    return true;
+}
+
+
+bool GoExecutor::processBlock(const RowSetReader &rsReader,
+                              VertexID srcId,
+                              const RowReader *vreader,
+                              const std::vector<int64_t> &filterIndexes,
+                              const std::vector<int64_t> &yieldIndexes,
+                              Callback &cb) const {
+    auto load = [&] (const std::vector<ExpressionProgram::Slot> &slots,
+                     const std::vector<int64_t> &indexes,
+                     const std::vector<uint32_t> *selected,
+                     std::vector<ValueColumn> *columns,
+                     size_t *rows) {
+        columns->resize(slots.size());
+        ExpressionProgram::SlotValues values(slots.size());
+        uint32_t row = 0;
+        std::vector<uint32_t>::const_iterator next;
+        if (selected != nullptr) {
+            next = selected->begin();
+        }
+        for (auto iter = rsReader.begin(); iter; ++iter, ++row) {
+            if (selected != nullptr) {
+                if (next == selected->end()) {
+                    break;
+                }
+                if (*next != row) {
+                    continue;
+                }
+                ++next;
+            }
+            auto status = loadSlots(slots, indexes, srcId, vreader, &*iter, values);
+            if (!status.ok()) {
+                return status;
+            }
+            for (auto i = 0u; i < slots.size(); i++) {
+                (*columns)[i].append(values[i]);
+            }
+            ++*rows;
+        }
+        return Status::OK();
+    };
+    return evalBlock(filterIndexes, yieldIndexes, load, cb);
+}
+
+
+bool GoExecutor::processColumns(const storage::cpp2::QueryResponse &resp, Callback &cb) const {
+    auto &data = resp.columnar;
+    if (data.vertex_ids.empty()) {
+        return true;
+    }
+    if (resp.get_edge_schema() == nullptr
+            || data.edge_offsets.size() != data.vertex_ids.size() + 1
+            || data.edge_columns.size() != resp.edge_schema.columns.size()) {
+        onError_(Status::Error("Corrupted columns of edges"));
+        return false;
+    }
+    auto eschema = std::make_shared<ResultSchemaProvider>(resp.edge_schema);
+    auto edges = static_cast<size_t>(data.edge_offsets.back());
+
+    // Decode each column of all edges into a typed array at once
+    std::vector<ValueColumn> edgeColumns;
+    edgeColumns.reserve(data.edge_columns.size());
+    for (auto i = 0u; i < data.edge_columns.size(); i++) {
+        auto &column = data.edge_columns[i];
+        auto reader = ColumnReader::getColumnReader(eschema->getFieldType(i).get_type(),
+                                                    column.values,
+                                                    column.offsets);
+        if (reader == nullptr || reader->size() != edges) {
+            onError_(Status::Error("Corrupted columns of edges"));
+            return false;
+        }
+        switch (reader->type()) {
+            case nebula::cpp2::SupportedType::BOOL: {
+                std::vector<bool> values;
+                reader->decodeBools(&values);
+                edgeColumns.emplace_back(ValueColumn::ofBools(values));
+                break;
+            }
+            case nebula::cpp2::SupportedType::INT:
+            case nebula::cpp2::SupportedType::VID:
+            case nebula::cpp2::SupportedType::TIMESTAMP: {
+                std::vector<int64_t> values;
+                reader->decodeInts(&values);
+                edgeColumns.emplace_back(ValueColumn::ofInts(std::move(values)));
+                break;
+            }
+            case nebula::cpp2::SupportedType::FLOAT:
+            case nebula::cpp2::SupportedType::DOUBLE: {
+                std::vector<double> values;
+                reader->decodeDoubles(&values);
+                edgeColumns.emplace_back(ValueColumn::ofDoubles(std::move(values)));
+                break;
+            }
+            default: {
+                ValueColumn values;
+                values.reserve(edges);
+                for (auto j = 0u; j < edges; j++) {
+                    values.append(reader->getValue(j));
+                }
+                edgeColumns.emplace_back(std::move(values));
+            }
+        }
+    }
+
+    std::vector<int64_t> filterIndexes;
+    if (filterProgram_ != nullptr) {
+        filterIndexes = resolveSlots(filterProgram_->slots(), eschema.get());
+    }
+    auto yieldIndexes = resolveSlots(yieldSlots_, eschema.get());
+
+    for (auto i = 0u; i < data.vertex_ids.size(); i++) {
+        auto srcId = data.vertex_ids[i];
+        auto begin = static_cast<size_t>(data.edge_offsets[i]);
+        auto end = static_cast<size_t>(data.edge_offsets[i + 1]);
+        if (begin > end || end > edges) {
+            onError_(Status::Error("Corrupted columns of edges"));
+            return false;
+        }
+        if (begin == end) {
+            continue;
+        }
+        auto load = [&] (const std::vector<ExpressionProgram::Slot> &slots,
+                         const std::vector<int64_t> &indexes,
+                         const std::vector<uint32_t> *selected,
+                         std::vector<ValueColumn> *columns,
+                         size_t *rows) {
+            *rows = selected == nullptr ? end - begin : selected->size();
+            columns->reserve(slots.size());
+            for (auto j = 0u; j < slots.size(); j++) {
+                auto &slot = slots[j];
+                switch (slot.kind) {
+                    case Expression::kAliasProp:
+                    case Expression::kEdgeSrcId:
+                    case Expression::kEdgeDstId:
+                    case Expression::kEdgeRank:
+                        if (indexes[j] < 0) {
+                            return Status::Error("get edge prop failed");
+                        }
+                        columns->emplace_back(edgeColumns[indexes[j]].slice(begin, end, selected));
+                        break;
+                    case Expression::kVariableProp:
+                    case Expression::kInputProp:
+                        columns->emplace_back(
+                            ValueColumn::repeat(getPropFromInterim(srcId, slot.prop), *rows));
+                        break;
+                    default:
+                        // The vertex props are never fetched by columns, see `prepareColumnar'
+                        return Status::Error("Unknown slot kind %u",
+                                             static_cast<uint32_t>(slot.kind));
+                }
+            }
+            return Status::OK();
+        };
+        if (!evalBlock(filterIndexes, yieldIndexes, load, cb)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool GoExecutor::evalBlock(const std::vector<int64_t> &filterIndexes,
+                           const std::vector<int64_t> &yieldIndexes,
+                           const ColumnsLoader &load,
+                           Callback &cb) const {
+    // Evaluate the filter upon all edges, to get the selected ones
+    std::vector<uint32_t> selected;
+    if (filterProgram_ != nullptr) {
+        std::vector<ValueColumn> columns;
+        size_t rows = 0;
+        auto status = load(filterProgram_->slots(), filterIndexes, nullptr, &columns, &rows);
+        if (!status.ok()) {
+            onError_(std::move(status));
+            return false;
+        }
+        std::vector<const ValueColumn*> inputs;
+        for (auto &column : columns) {
+            inputs.emplace_back(&column);
+        }
+        auto result = filterProgram_->evalBatch(inputs, rows);
+        if (!result.ok()) {
+            onError_(result.status());
+            return false;
+        }
+        result.value().select(&selected);
+        if (selected.empty()) {
+            return true;
+        }
+    }
+
+    // Only the selected edges are loaded for the yield columns,
+    // so that the others never raise an error, just like the row by row evaluation.
+    std::vector<ValueColumn> columns;
+    size_t rows = 0;
+    auto status = load(yieldSlots_,
+                       yieldIndexes,
+                       filterProgram_ != nullptr ? &selected : nullptr,
+                       &columns,
+                       &rows);
+    if (!status.ok()) {
+        onError_(std::move(status));
+        return false;
+    }
+
+    std::vector<ValueColumn> results;
+    results.reserve(yieldPrograms_.size());
+    for (auto i = 0u; i < yieldPrograms_.size(); i++) {
+        std::vector<const ValueColumn*> inputs;
+        for (auto index : yieldSlotMaps_[i]) {
+            inputs.emplace_back(&columns[index]);
+        }
+        auto result = yieldPrograms_[i]->evalBatch(inputs, rows);
+        if (!result.ok()) {
+            onError_(result.status());
+            return false;
+        }
+        results.emplace_back(std::move(result).value());
+    }
+    for (auto i = 0u; i < rows; i++) {
+        std::vector<VariantType> record;
+        record.reserve(results.size());
+        for (auto &result : results) {
+            record.emplace_back(result.at(i));
+        }
+        cb(std::move(record));
+    }
+    return true;
+}
+
+
+std::vector<int64_t>
+GoExecutor::resolveSlots(const std::vector<ExpressionProgram::Slot> &slots,
+                         const meta::SchemaProviderIf *eschema) const {
+    std::vector<int64_t> indexes;
+    indexes.reserve(slots.size());
+    for (auto &slot : slots) {
+        int64_t index = -1;
+        switch (slot.kind) {
+            case Expression::kAliasProp:
+            case Expression::kEdgeSrcId:
+            case Expression::kEdgeDstId:
+            case Expression::kEdgeRank:
+                if (eschema != nullptr) {
+                    index = eschema->getFieldIndex(slot.prop);
+                }
+                break;
+            case Expression::kSourceProp: {
+                auto it = srcTagProps_.find(std::make_pair(slot.alias, slot.prop));
+                if (it != srcTagProps_.end()) {
+                    index = it->second;
+                }
+                break;
+            }
+            case Expression::kDestProp: {
+                auto it = dstTagProps_.find(std::make_pair(slot.alias, slot.prop));
+                if (it != dstTagProps_.end()) {
+                    index = it->second;
+                }
+                break;
+            }
+            default:
+                // Input and variable props are looked up by name
+                break;
+        }
+        indexes.emplace_back(index);
+    }
+    return indexes;
+}
+
+
+Status GoExecutor::loadSlots(const std::vector<ExpressionProgram::Slot> &slots,
+                             const std::vector<int64_t> &indexes,
+                             VertexID srcId,
+                             const RowReader *vreader,
+                             const RowReader *ereader,
+                             ExpressionProgram::SlotValues &values) const {
+    for (auto i = 0u; i < slots.size(); i++) {
+        auto &slot = slots[i];
+        auto index = indexes[i];
+        switch (slot.kind) {
+            case Expression::kAliasProp:
+            case Expression::kEdgeSrcId:
+            case Expression::kEdgeDstId:
+            case Expression::kEdgeRank: {
+                if (index < 0) {
+                    return Status::Error("get edge prop failed");
+                }
+                auto res = RowReader::getPropByIndex(ereader, index);
+                if (!ok(res)) {
+                    return Status::Error("get edge prop failed");
+                }
+                values[i] = value(std::move(res));
+                break;
+            }
+            case Expression::kSourceProp: {
+                if (index < 0 || vreader == nullptr) {
+                    return Status::Error("%s.%s was not exist",
+                                         slot.alias.c_str(), slot.prop.c_str());
+                }
+                auto res = RowReader::getPropByIndex(vreader, index);
+                if (!ok(res)) {
+                    return Status::Error("%s.%s was not exist",
+                                         slot.alias.c_str(), slot.prop.c_str());
+                }
+                values[i] = value(std::move(res));
+                break;
+            }
+            case Expression::kDestProp: {
+                if (index < 0) {
+                    return Status::Error("Dst tagName : %s , propName : %s is not exist",
+                                         slot.alias.c_str(), slot.prop.c_str());
+                }
+                auto res = RowReader::getPropByName(ereader, "_dst");
+                CHECK(ok(res));
+                auto dst = value(std::move(res));
+                auto prop = vertexHolder_->get(boost::get<int64_t>(dst), index);
+                if (!prop.ok()) {
+                    return prop.status();
+                }
+                values[i] = std::move(prop).value();
+                break;
+            }
+            case Expression::kVariableProp:
+            case Expression::kInputProp:
+                values[i] = getPropFromInterim(srcId, slot.prop);
+                break;
+            default:
+                return Status::Error("Unknown slot kind %u", static_cast<uint32_t>(slot.kind));
+        }
+    }
+    return Status::OK();
+}
+
+
 OptVariantType GoExecutor::VertexHolder::get(VertexID id, int64_t index) const {
     DCHECK(schema_ != nullptr);
     auto iter = data_.find(id);
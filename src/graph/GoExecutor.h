@@ -10,9 +10,13 @@
 #include "base/Base.h"
 #include "graph/TraverseExecutor.h"
 #include "storage/client/StorageClient.h"
+#include "filter/ExpressionProgram.h"
 
 namespace nebula {
 
+class RowReader;
+class RowSetReader;
+
 namespace storage {
 namespace cpp2 {
 class QueryResponse;
@@ -37,6 +41,19 @@ public:
 
     void setupResponse(cpp2::ExecutionResponse &resp) override;
 
+    void setPageSize(int32_t pageSize) override {
+        pageSize_ = pageSize;
+    }
+
+    bool hasMorePages() const override {
+        return suspended_;
+    }
+
+    /**
+     * Go on stepping out from the vertices of the final step left, see `finishExecution'.
+     */
+    void nextPage() override;
+
 private:
     /**
      * To do some preparing works on the clauses
@@ -51,12 +68,53 @@ private:
 
     Status prepareWhere();
 
+    /**
+     * To pick out the conjuncts of the filter which could be evaluated by storage,
+     * and encode them to be sent along with the final step.
+     */
+    void prepareFilterPushdown();
+
+    /**
+     * To check if an expression could be evaluated by storage, i.e. it only refers to
+     * literals, properties of the source vertex and properties of the edge.
+     */
+    bool canPushdown(const Expression *expr) const;
+
     Status prepareYield();
 
     Status prepareNeededProps();
 
+    /**
+     * To compile the yield columns, and enable the block evaluation
+     * if they and the filter are all compiled.
+     */
+    void prepareBatchEvaluation();
+
     Status prepareDistinct();
 
+    /**
+     * To check the `SAMPLE' and `LIMIT' clauses.
+     */
+    Status prepareLimit();
+
+    /**
+     * To build the bound on the edges returned by storage for the current step.
+     * `SAMPLE' applies to every step, while `LIMIT' could only be pushed down along
+     * with the final step, when each edge passed storage makes exactly one row.
+     */
+    storage::cpp2::EdgeLimit buildEdgeLimit() const;
+
+    /**
+     * To check if the steps could be expanded by the storage service, see `traverse'.
+     */
+    void prepareTraverse();
+
+    /**
+     * To check if the edges of the final step could be fetched by columns,
+     * see `processColumns'.
+     */
+    void prepareColumnar();
+
     /**
      * To check if this is the final step.
      */
@@ -64,6 +122,14 @@ private:
         return curStep_ == steps_;
     }
 
+    /**
+     * To check if several edge types are specified in the `OVER' clause.
+     * If so, the edges of each type come in their own block, with their own schema.
+     */
+    bool isMultiEdges() const {
+        return edgeTypes_.size() > 1;
+    }
+
     /**
      * To check if `UPTO' is specified.
      * If so, we are supposed to apply the filter in each step.
@@ -97,6 +163,21 @@ private:
      */
     void onStepOutResponse(RpcResponse &&rpcResp);
 
+    using Frontier = std::unordered_map<int32_t, std::vector<VertexID>>;
+    /**
+     * To step out all the steps at once, by letting each storage host expand the
+     * intermediate steps within the partitions it leads. The vertices reached in
+     * the other hosts come back as the frontier, which is traversed from in the next round.
+     * `frontier' is keyed by the steps left.
+     */
+    void traverse(Frontier frontier);
+
+    /**
+     * Callback invoked when no frontier is left. The responses of all rounds are merged,
+     * as if they were of the final step.
+     */
+    void onTraverseFinished();
+
     /**
      * Callback invoked when the stepping out action reaches the dead end.
      */
@@ -110,6 +191,14 @@ private:
     StatusOr<std::vector<storage::cpp2::PropDef>> getStepOutProps();
     StatusOr<std::vector<storage::cpp2::PropDef>> getDstProps();
 
+    /**
+     * To get the value of a prop of `edgeType' upon the edges of the other types,
+     * i.e. the default value of the prop's type.
+     */
+    StatusOr<VariantType> defaultEdgeProp(GraphSpaceID spaceId,
+                                          EdgeType edgeType,
+                                          const std::string &prop) const;
+
     void fetchVertexProps(std::vector<VertexID> ids, RpcResponse &&rpcResp);
 
     /**
@@ -128,10 +217,10 @@ private:
     void finishExecution(RpcResponse &&rpcResp);
 
     /**
-     * To setup an intermediate representation of the execution result,
-     * which is about to be piped to the next executor.
+     * To add the rows of a response to an intermediate representation of the execution
+     * result, which is about to be piped to the next executor.
      */
-    bool setupInterimResult(RpcResponse &&rpcResp, std::unique_ptr<InterimResult> &result);
+    bool setupInterimResult(RpcResponse &&rpcResp);
 
     /**
      * To setup the header of the execution result, i.e. the column names.
@@ -150,6 +239,72 @@ private:
     using Callback = std::function<void(std::vector<VariantType>)>;
     bool processFinalResult(RpcResponse &rpcResp, Callback cb) const;
 
+    /**
+     * To evaluate the filter and yield columns over the edges of one type
+     * of one source vertex, row by row.
+     */
+    bool processEdges(const RowSetReader &rsReader,
+                      EdgeType edgeType,
+                      VertexID srcId,
+                      const meta::SchemaProviderIf *vschema,
+                      const RowReader *vreader,
+                      const std::vector<int64_t> &filterIndexes,
+                      ExpressionProgram::SlotValues &filterValues,
+                      Callback &cb) const;
+
+    /**
+     * To evaluate the filter and yield columns over all edges of one source vertex,
+     * one column at a time. Only used when all of them are compiled.
+     */
+    bool processBlock(const RowSetReader &rsReader,
+                      VertexID srcId,
+                      const RowReader *vreader,
+                      const std::vector<int64_t> &filterIndexes,
+                      const std::vector<int64_t> &yieldIndexes,
+                      Callback &cb) const;
+
+    /**
+     * The same as `processBlock', but over the edges returned by columns,
+     * i.e. QueryResponse.columnar, which are decoded once for the whole response.
+     */
+    bool processColumns(const storage::cpp2::QueryResponse &resp, Callback &cb) const;
+
+    /**
+     * To fill the columns of the given slots for a block of edges, of only the `selected'
+     * rows if it is not null, and to tell the number of rows filled.
+     */
+    using ColumnsLoader = std::function<Status(const std::vector<ExpressionProgram::Slot> &slots,
+                                               const std::vector<int64_t> &indexes,
+                                               const std::vector<uint32_t> *selected,
+                                               std::vector<ValueColumn> *columns,
+                                               size_t *rows)>;
+
+    /**
+     * To evaluate the filter and then the yield columns of the selected rows over a block
+     * of edges, whose columns are filled by `load'.
+     */
+    bool evalBlock(const std::vector<int64_t> &filterIndexes,
+                   const std::vector<int64_t> &yieldIndexes,
+                   const ColumnsLoader &load,
+                   Callback &cb) const;
+
+    /**
+     * To resolve the index of each slot of a compiled program, e.g. the field index
+     * within the edge or the vertex schema, which is the same for a whole response.
+     */
+    std::vector<int64_t> resolveSlots(const std::vector<ExpressionProgram::Slot> &slots,
+                                      const meta::SchemaProviderIf *eschema) const;
+
+    /**
+     * To fill the slots of a compiled program for the current edge.
+     */
+    Status loadSlots(const std::vector<ExpressionProgram::Slot> &slots,
+                     const std::vector<int64_t> &indexes,
+                     VertexID srcId,
+                     const RowReader *vreader,
+                     const RowReader *ereader,
+                     ExpressionProgram::SlotValues &values) const;
+
     /**
      * A container to hold the mapping from vertex id to its properties, used for lookups
      * during the final evaluation process.
@@ -207,10 +362,36 @@ private:
     uint32_t                                    curStep_{1};
     bool                                        upto_{false};
     bool                                        reversely_{false};
-    EdgeType                                    edgeType_;
+    std::vector<EdgeType>                       edgeTypes_;
+    // The alias, or the name if no alias, of each edge in the `OVER' clause => its type
+    std::unordered_map<std::string, EdgeType>   edgeAliases_;
+    // The value of a prop on the edges of the other types, when isMultiEdges()
+    std::unordered_map<std::pair<std::string, std::string>, VariantType> edgeDefaults_;
     std::string                                *varname_{nullptr};
     std::string                                *colname_{nullptr};
     Expression                                 *filter_{nullptr};
+    // The compiled `filter_', null if it could not be compiled.
+    std::unique_ptr<ExpressionProgram>          filterProgram_;
+    // The compiled yield columns, empty if any of them could not be compiled.
+    std::vector<std::unique_ptr<ExpressionProgram>> yieldPrograms_;
+    // The distinct slots of all yieldPrograms_, and where each program's slots are in it.
+    std::vector<ExpressionProgram::Slot>        yieldSlots_;
+    std::vector<std::vector<size_t>>            yieldSlotMaps_;
+    // Whether to evaluate over a block of edges at a time, see `processBlock'.
+    bool                                        batchEval_{false};
+    // Whether the edges of the final step are fetched by columns.
+    bool                                        columnar_{false};
+    std::string                                 filterPushdown_;
+    // Whether all the conjuncts of `filter_' are pushed down.
+    bool                                        filterFullyPushed_{false};
+    // The `SAMPLE' size of each vertex and the `LIMIT' of rows, zero if not specified.
+    int64_t                                     sampleSize_{0};
+    int64_t                                     limit_{0};
+    // Whether to step out by `traverse'.
+    bool                                        traverse_{false};
+    // Steps left => vertices ever traversed from
+    std::unordered_map<int32_t, std::unordered_set<VertexID>> traversed_;
+    std::vector<storage::cpp2::QueryResponse>   traverseResps_;
     std::vector<YieldColumn*>                   yields_;
     bool                                        distinct_{false};
     bool                                        distinctPushDown_{false};
@@ -219,6 +400,20 @@ private:
     std::unique_ptr<InterimIndex>               index_;
     std::unique_ptr<ExpressionContext>          expCtx_;
     std::vector<VertexID>                       starts_;
+    GraphSpaceID                                spaceId_{-1};
+    // The vertices of the final step left to the next pages
+    std::vector<VertexID>                       pendingStarts_;
+    // The rows of each page responded to the client, 0 to respond all at once
+    int32_t                                     pageSize_{0};
+    // Whether it stopped after a page, with pendingStarts_ to go on with
+    bool                                        suspended_{false};
+    // The rows responded in the previous pages
+    int64_t                                     rowsResponded_{0};
+    // The rows evaluated from the pages of the final step so far
+    int64_t                                     resultRows_{0};
+    std::shared_ptr<SchemaWriter>               resultSchema_;
+    std::unique_ptr<RowSetWriter>               rsWriter_;
+    std::unordered_set<std::string>             uniqResult_;
     std::unique_ptr<VertexHolder>               vertexHolder_;
     std::unique_ptr<VertexBackTracker>          backTracker_;
     std::unique_ptr<cpp2::ExecutionResponse>    resp_;
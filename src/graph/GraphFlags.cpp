@@ -28,3 +28,16 @@ DEFINE_string(stderr_log_file, "graphd-stderr.log", "Destination filename of std
 DEFINE_bool(daemonize, true, "Whether run as a daemon process");
 DEFINE_string(meta_server_addrs, "", "list of meta server addresses,"
                                      "the format looks like ip1:port1, ip2:port2, ip3:port3");
+
+DEFINE_bool(filter_pushdown, true, "Whether to push the storage evaluable part "
+                                   "of the WHERE clause down to the storage service");
+DEFINE_bool(batch_evaluation, true, "Whether to evaluate the WHERE clause and the YIELD "
+                                    "columns of GO over all edges of a vertex at a time");
+DEFINE_bool(columnar_neighbors, true, "Whether to fetch the edges of the final step of GO "
+                                      "by columns, when they are evaluated in batch");
+DEFINE_bool(storage_traverse, true, "Whether to let the storage service expand the "
+                                    "intermediate steps of GO within each host");
+DEFINE_int32(max_cursors_per_session, 16, "The max number of paged queries kept in a session "
+                                          "for their next pages, the oldest ones are dropped");
+DEFINE_int32(step_out_page_size, 100000, "The max number of vertices to step out from at a "
+                                         "time in the final step of GO, 0 for unlimited");
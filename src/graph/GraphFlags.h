@@ -27,5 +27,12 @@ DECLARE_string(stderr_log_file);
 DECLARE_bool(daemonize);
 DECLARE_string(meta_server_addrs);
 
+DECLARE_bool(filter_pushdown);
+DECLARE_bool(batch_evaluation);
+DECLARE_bool(columnar_neighbors);
+DECLARE_bool(storage_traverse);
+DECLARE_int32(step_out_page_size);
+DECLARE_int32(max_cursors_per_session);
+
 
 #endif  // GRAPH_GRAPHFLAGS_H_
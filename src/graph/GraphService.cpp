@@ -8,6 +8,7 @@
 #include "graph/GraphService.h"
 #include "time/Duration.h"
 #include "graph/RequestContext.h"
+#include "graph/ExecutionPlan.h"
 #include "graph/SimpleAuthenticator.h"
 #include "storage/client/StorageClient.h"
 
@@ -63,9 +64,18 @@ void GraphService::signout(int64_t sessionId) {
 
 folly::Future<cpp2::ExecutionResponse>
 GraphService::future_execute(int64_t sessionId, const std::string& query) {
+    return future_executePaged(sessionId, query, 0);
+}
+
+
+folly::Future<cpp2::ExecutionResponse>
+GraphService::future_executePaged(int64_t sessionId,
+                                  const std::string& query,
+                                  int32_t pageSize) {
     auto ctx = std::make_unique<RequestContext<cpp2::ExecutionResponse>>();
     ctx->setQuery(query);
     ctx->setRunner(getThreadManager());
+    ctx->setPageSize(std::max(0, pageSize));
     auto future = ctx->future();
     {
         auto result = sessionManager_->findSession(sessionId);
@@ -84,6 +94,33 @@ GraphService::future_execute(int64_t sessionId, const std::string& query) {
 }
 
 
+folly::Future<cpp2::ExecutionResponse>
+GraphService::future_fetchPage(int64_t sessionId, int64_t cursorId) {
+    auto ctx = std::make_unique<RequestContext<cpp2::ExecutionResponse>>();
+    ctx->setRunner(getThreadManager());
+    auto future = ctx->future();
+    auto result = sessionManager_->findSession(sessionId);
+    if (!result.ok()) {
+        FLOG_ERROR("Session not found, id[%ld]", sessionId);
+        ctx->resp().set_error_code(cpp2::ErrorCode::E_SESSION_INVALID);
+        ctx->resp().set_error_msg(result.status().toString());
+        ctx->finish();
+        return future;
+    }
+    auto plan = result.value()->takeCursor(cursorId);
+    if (plan == nullptr) {
+        ctx->resp().set_error_code(cpp2::ErrorCode::E_CURSOR_NOT_FOUND);
+        ctx->resp().set_error_msg(folly::stringPrintf("Cursor not found, id[%ld]", cursorId));
+        ctx->finish();
+        return future;
+    }
+    ctx->setSession(std::move(result).value());
+    // The plan releases itself once all the pages are produced
+    plan.release()->nextPage(std::move(ctx));
+    return future;
+}
+
+
 const char* GraphService::getErrorStr(cpp2::ErrorCode result) {
     switch (result) {
     case cpp2::ErrorCode::SUCCEEDED:
@@ -99,6 +136,8 @@ const char* GraphService::getErrorStr(cpp2::ErrorCode result) {
         return "The session timed out";
     case cpp2::ErrorCode::E_SYNTAX_ERROR:
         return "Syntax error";
+    case cpp2::ErrorCode::E_CURSOR_NOT_FOUND:
+        return "The cursor is not found";
     /**********************
      * Unknown error
      **********************/
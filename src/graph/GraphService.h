@@ -36,6 +36,12 @@ public:
     folly::Future<cpp2::ExecutionResponse>
     future_execute(int64_t sessionId, const std::string& stmt) override;
 
+    folly::Future<cpp2::ExecutionResponse>
+    future_executePaged(int64_t sessionId, const std::string& stmt, int32_t pageSize) override;
+
+    folly::Future<cpp2::ExecutionResponse>
+    future_fetchPage(int64_t sessionId, int64_t cursorId) override;
+
     const char* getErrorStr(cpp2::ErrorCode result);
 
 private:
@@ -122,5 +122,20 @@ void PipeExecutor::setupResponse(cpp2::ExecutionResponse &resp) {
     right_->setupResponse(resp);
 }
 
+
+void PipeExecutor::setPageSize(int32_t pageSize) {
+    right_->setPageSize(pageSize);
+}
+
+
+bool PipeExecutor::hasMorePages() const {
+    return right_->hasMorePages();
+}
+
+
+void PipeExecutor::nextPage() {
+    right_->nextPage();
+}
+
 }   // namespace graph
 }   // namespace nebula
@@ -29,6 +29,12 @@ public:
 
     void setupResponse(cpp2::ExecutionResponse &resp) override;
 
+    void setPageSize(int32_t pageSize) override;
+
+    bool hasMorePages() const override;
+
+    void nextPage() override;
+
 private:
     Status syntaxPreCheck();
 
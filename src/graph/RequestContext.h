@@ -76,6 +76,18 @@ public:
         return duration_;
     }
 
+    int32_t pageSize() const {
+        return pageSize_;
+    }
+
+    /**
+     * Respond at most `pageSize' rows, and keep the query as a cursor of the session for
+     * the rest rows. 0 to respond all the rows at once.
+     */
+    void setPageSize(int32_t pageSize) {
+        pageSize_ = pageSize;
+    }
+
     void finish() {
         promise_.setValue(std::move(resp_));
     }
@@ -87,6 +99,7 @@ private:
     folly::Promise<Response>                    promise_;
     std::shared_ptr<ClientSession>              session_;
     folly::Executor                            *runner_{nullptr};
+    int32_t                                     pageSize_{0};
 };
 
 }   // namespace graph
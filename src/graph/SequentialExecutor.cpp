@@ -70,5 +70,20 @@ void SequentialExecutor::setupResponse(cpp2::ExecutionResponse &resp) {
     executors_.back()->setupResponse(resp);
 }
 
+
+void SequentialExecutor::setPageSize(int32_t pageSize) {
+    executors_.back()->setPageSize(pageSize);
+}
+
+
+bool SequentialExecutor::hasMorePages() const {
+    return executors_.back()->hasMorePages();
+}
+
+
+void SequentialExecutor::nextPage() {
+    executors_.back()->nextPage();
+}
+
 }   // namespace graph
 }   // namespace nebula
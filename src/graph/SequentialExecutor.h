@@ -28,6 +28,12 @@ public:
 
     void setupResponse(cpp2::ExecutionResponse &resp) override;
 
+    void setPageSize(int32_t pageSize) override;
+
+    bool hasMorePages() const override;
+
+    void nextPage() override;
+
 private:
     SequentialSentences                        *sentences_{nullptr};
     std::vector<std::unique_ptr<Executor>>      executors_;
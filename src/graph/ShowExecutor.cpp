@@ -314,6 +314,9 @@ void ShowExecutor::showCreateSpace() {
         buf += ", ";
         buf += "replica_factor = ";
         buf += folly::to<std::string>(properties.get_replica_factor());
+        if (properties.get_maintain_degrees()) {
+            buf += ", maintain_degrees = true";
+        }
         buf += ")";
 
         row[1].set_str(buf);;
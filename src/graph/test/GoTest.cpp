@@ -10,6 +10,7 @@
 #include "graph/test/TraverseTestBase.h"
 #include "meta/test/TestUtils.h"
 
+DECLARE_int32(step_out_page_size);
 
 namespace nebula {
 namespace graph {
@@ -407,5 +408,288 @@ TEST_F(GoTest, ReferenceVariableInYieldAndWhere) {
     }
 }
 
+
+TEST_F(GoTest, FilterPushdown) {
+    {
+        cpp2::ExecutionResponse resp;
+        auto &player = players_["Tony Parker"];
+        auto *fmt = "GO FROM %ld OVER like "
+                    "WHERE like.likeness >= 95 && $$.player.age > 41 "
+                    "YIELD $$.player.name, like.likeness";
+        auto query = folly::stringPrintf(fmt, player.vid());
+        auto code = client_->execute(query, resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        std::vector<std::tuple<std::string, int64_t>> expected = {
+            {"Tim Duncan", 95},
+        };
+        ASSERT_TRUE(verifyResult(resp, expected));
+    }
+    {
+        cpp2::ExecutionResponse resp;
+        auto &player = players_["Tony Parker"];
+        auto *fmt = "GO FROM %ld OVER like "
+                    "WHERE $^.player.age > 30 && like._dst != %ld "
+                    "YIELD $$.player.name, like.likeness";
+        auto query = folly::stringPrintf(fmt, player.vid(), players_["Tim Duncan"].vid());
+        auto code = client_->execute(query, resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        std::vector<std::tuple<std::string, int64_t>> expected = {
+            {"Manu Ginobili", 95},
+            {"LaMarcus Aldridge", 90},
+        };
+        ASSERT_TRUE(verifyResult(resp, expected));
+    }
+    {
+        cpp2::ExecutionResponse resp;
+        auto &player = players_["Tony Parker"];
+        auto *fmt = "GO 2 STEPS FROM %ld OVER like "
+                    "WHERE like.likeness > 90 "
+                    "YIELD like._dst";
+        auto query = folly::stringPrintf(fmt, player.vid());
+        auto code = client_->execute(query, resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        std::vector<std::tuple<int64_t>> expected = {
+            {players_["Tony Parker"].vid()},
+            {players_["Manu Ginobili"].vid()},
+        };
+        ASSERT_TRUE(verifyResult(resp, expected));
+    }
+}
+
+
+TEST_F(GoTest, MultiEdges) {
+    {
+        cpp2::ExecutionResponse resp;
+        auto &player = players_["Tim Duncan"];
+        auto *fmt = "GO FROM %ld OVER serve, like";
+        auto query = folly::stringPrintf(fmt, player.vid());
+        auto code = client_->execute(query, resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        std::vector<std::tuple<int64_t, int64_t>> expected = {
+            {teams_["Spurs"].vid(), 0},
+            {0, players_["Tony Parker"].vid()},
+            {0, players_["Manu Ginobili"].vid()},
+        };
+        ASSERT_TRUE(verifyResult(resp, expected));
+    }
+    {
+        cpp2::ExecutionResponse resp;
+        auto &player = players_["Tony Parker"];
+        auto *fmt = "GO FROM %ld OVER serve AS s, like AS l "
+                    "WHERE s.start_year > 2000 || l.likeness > 90 "
+                    "YIELD s.start_year, l.likeness, l._dst";
+        auto query = folly::stringPrintf(fmt, player.vid());
+        auto code = client_->execute(query, resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        std::vector<std::tuple<int64_t, int64_t, int64_t>> expected = {
+            {2018, 0, 0},
+            {0, 95, players_["Tim Duncan"].vid()},
+            {0, 95, players_["Manu Ginobili"].vid()},
+        };
+        ASSERT_TRUE(verifyResult(resp, expected));
+    }
+    {
+        cpp2::ExecutionResponse resp;
+        auto &player = players_["Tony Parker"];
+        auto *fmt = "GO FROM %ld OVER serve, like YIELD teammate._dst";
+        auto query = folly::stringPrintf(fmt, player.vid());
+        auto code = client_->execute(query, resp);
+        ASSERT_NE(cpp2::ErrorCode::SUCCEEDED, code);
+    }
+}
+
+
+TEST_F(GoTest, SampleAndLimit) {
+    std::unordered_set<int64_t> likes = {
+        players_["Tim Duncan"].vid(),
+        players_["Manu Ginobili"].vid(),
+        players_["LaMarcus Aldridge"].vid(),
+    };
+    {
+        cpp2::ExecutionResponse resp;
+        auto &player = players_["Tony Parker"];
+        auto *fmt = "GO FROM %ld OVER like SAMPLE 2 YIELD like._dst";
+        auto query = folly::stringPrintf(fmt, player.vid());
+        auto code = client_->execute(query, resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        ASSERT_NE(nullptr, resp.get_rows());
+        ASSERT_EQ(2, resp.get_rows()->size());
+        for (auto &row : *resp.get_rows()) {
+            auto dst = row.get_columns()[0].get_integer();
+            ASSERT_EQ(1, likes.count(dst));
+        }
+    }
+    {
+        cpp2::ExecutionResponse resp;
+        auto &player = players_["Tony Parker"];
+        auto *fmt = "GO FROM %ld OVER like WHERE like.likeness >= 90 "
+                    "YIELD like._dst LIMIT 1";
+        auto query = folly::stringPrintf(fmt, player.vid());
+        auto code = client_->execute(query, resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        ASSERT_NE(nullptr, resp.get_rows());
+        ASSERT_EQ(1, resp.get_rows()->size());
+        auto dst = (*resp.get_rows())[0].get_columns()[0].get_integer();
+        ASSERT_EQ(1, likes.count(dst));
+    }
+    {
+        // The filter on the dst vertex is not pushed down, so nor is the limit.
+        cpp2::ExecutionResponse resp;
+        auto &player = players_["Tony Parker"];
+        auto *fmt = "GO FROM %ld OVER like WHERE $$.player.age > 41 "
+                    "YIELD $$.player.name LIMIT 1";
+        auto query = folly::stringPrintf(fmt, player.vid());
+        auto code = client_->execute(query, resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        std::vector<std::tuple<std::string>> expected = {
+            {"Tim Duncan"},
+        };
+        ASSERT_TRUE(verifyResult(resp, expected));
+    }
+    {
+        cpp2::ExecutionResponse resp;
+        auto &player = players_["Tony Parker"];
+        auto *fmt = "GO FROM %ld OVER like SAMPLE 0";
+        auto query = folly::stringPrintf(fmt, player.vid());
+        auto code = client_->execute(query, resp);
+        ASSERT_NE(cpp2::ErrorCode::SUCCEEDED, code);
+    }
+}
+
+TEST_F(GoTest, Paged) {
+    auto &player = players_["Tony Parker"];
+    auto query = folly::stringPrintf("GO FROM %ld OVER like YIELD like._dst", player.vid());
+    int64_t cursorId;
+    {
+        cpp2::ExecutionResponse resp;
+        auto code = client_->executePaged(query, 2, resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        ASSERT_NE(nullptr, resp.get_rows());
+        ASSERT_EQ(2, resp.get_rows()->size());
+        ASSERT_NE(nullptr, resp.get_cursor_id());
+        cursorId = *resp.get_cursor_id();
+    }
+    {
+        cpp2::ExecutionResponse resp;
+        auto code = client_->fetchPage(cursorId, resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        ASSERT_NE(nullptr, resp.get_rows());
+        ASSERT_EQ(1, resp.get_rows()->size());
+        ASSERT_EQ(nullptr, resp.get_cursor_id());
+    }
+    {
+        // Exhausted
+        cpp2::ExecutionResponse resp;
+        auto code = client_->fetchPage(cursorId, resp);
+        ASSERT_EQ(cpp2::ErrorCode::E_CURSOR_NOT_FOUND, code);
+    }
+    {
+        // All in the first page
+        cpp2::ExecutionResponse resp;
+        auto code = client_->executePaged(query, 3, resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        ASSERT_EQ(3, resp.get_rows()->size());
+        ASSERT_EQ(nullptr, resp.get_cursor_id());
+    }
+}
+
+
+TEST_F(GoTest, StepOutInPages) {
+    auto *fmt = "GO FROM %ld,%ld,%ld OVER like YIELD like._dst, like.likeness";
+    auto query = folly::stringPrintf(fmt,
+                                     players_["Tony Parker"].vid(),
+                                     players_["Tim Duncan"].vid(),
+                                     players_["Manu Ginobili"].vid());
+    auto collect = [] (const cpp2::ExecutionResponse &resp) {
+        std::vector<std::pair<int64_t, int64_t>> rows;
+        for (auto &row : *resp.get_rows()) {
+            auto &columns = row.get_columns();
+            rows.emplace_back(columns[0].get_integer(), columns[1].get_integer());
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    };
+    cpp2::ExecutionResponse expected;
+    ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, client_->execute(query, expected));
+    ASSERT_NE(nullptr, expected.get_rows());
+
+    auto pageSize = FLAGS_step_out_page_size;
+    FLAGS_step_out_page_size = 1;
+    cpp2::ExecutionResponse resp;
+    auto code = client_->execute(query, resp);
+    ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+    ASSERT_NE(nullptr, resp.get_rows());
+    ASSERT_EQ(collect(expected), collect(resp));
+
+    // The pages are stepped out from on demand, two cursors are kept at the same time
+    std::vector<cpp2::ExecutionResponse> firstPages(2);
+    for (auto &page : firstPages) {
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, client_->executePaged(query, 2, page));
+        ASSERT_NE(nullptr, page.get_rows());
+        ASSERT_LE(page.get_rows()->size(), 2);
+        ASSERT_NE(nullptr, page.get_cursor_id());
+    }
+    ASSERT_NE(*firstPages[0].get_cursor_id(), *firstPages[1].get_cursor_id());
+    for (auto &page : firstPages) {
+        cpp2::ExecutionResponse all = page;
+        auto cursorId = *page.get_cursor_id();
+        while (true) {
+            cpp2::ExecutionResponse next;
+            ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, client_->fetchPage(cursorId, next));
+            ASSERT_NE(nullptr, next.get_rows());
+            ASSERT_LE(next.get_rows()->size(), 2);
+            all.rows.insert(all.rows.end(), next.rows.begin(), next.rows.end());
+            if (next.get_cursor_id() == nullptr) {
+                break;
+            }
+            ASSERT_EQ(cursorId, *next.get_cursor_id());
+        }
+        ASSERT_EQ(collect(expected), collect(all));
+    }
+    FLAGS_step_out_page_size = pageSize;
+}
+
+
+TEST_F(GoTest, Columnar) {
+    auto collect = [] (const cpp2::ExecutionResponse &resp) {
+        std::vector<std::vector<int64_t>> rows;
+        for (auto &row : *resp.get_rows()) {
+            std::vector<int64_t> values;
+            for (auto &column : row.get_columns()) {
+                values.emplace_back(column.get_integer());
+            }
+            rows.emplace_back(std::move(values));
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    };
+    std::vector<std::string> queries = {
+        folly::stringPrintf("GO FROM %ld,%ld OVER like WHERE like.likeness > 80 "
+                            "YIELD like._dst, like.likeness + 1",
+                            players_["Tony Parker"].vid(),
+                            players_["Tim Duncan"].vid()),
+        folly::stringPrintf("GO FROM %ld OVER like YIELD like._dst AS id, like.likeness AS l "
+                            "| GO FROM $-.id OVER like WHERE like.likeness >= $-.l "
+                            "YIELD $-.id, like._dst, like.likeness - $-.l",
+                            players_["Tim Duncan"].vid()),
+    };
+    auto columnar = FLAGS_columnar_neighbors;
+    for (auto &query : queries) {
+        FLAGS_columnar_neighbors = false;
+        cpp2::ExecutionResponse expected;
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, client_->execute(query, expected));
+        ASSERT_NE(nullptr, expected.get_rows());
+        ASSERT_FALSE(expected.get_rows()->empty());
+
+        FLAGS_columnar_neighbors = true;
+        cpp2::ExecutionResponse resp;
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, client_->execute(query, resp));
+        ASSERT_NE(nullptr, resp.get_rows());
+        ASSERT_EQ(collect(expected), collect(resp)) << query;
+    }
+    FLAGS_columnar_neighbors = columnar;
+}
+
+
 }   // namespace graph
 }   // namespace nebula
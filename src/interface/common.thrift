@@ -69,9 +69,18 @@ struct ColumnDef {
     2: required ValueType type,
 }
 
+// The encodings of the rows of a tag or an edge
+enum RowFormat {
+    // The fields are encoded one after another in variable lengths
+    V1 = 1,
+    // Every field takes a slot of a fixed width, and strings are kept after the slots
+    V2 = 2,
+} (cpp.enum_strict)
+
 struct SchemaProp {
-    1: optional i64      ttl_duration,
-    2: optional string   ttl_col,
+    1: optional i64         ttl_duration,
+    2: optional string      ttl_col,
+    3: optional RowFormat   row_format,
 }
 
 struct Schema {
@@ -27,6 +27,8 @@ enum ErrorCode {
     E_EXECUTION_ERROR = -8,
     // Nothing is executed When command is comment
     E_STATEMENT_EMTPY = -9,
+    // The cursor of fetchPage is exhausted, dropped or unknown
+    E_CURSOR_NOT_FOUND = -10,
 } (cpp.enum_strict)
 
 
@@ -93,6 +95,7 @@ struct ExecutionResponse {
     4: optional list<binary> column_names;  // Column names
     5: optional list<RowValue> rows;
     6: optional string space_name;
+    7: optional i64 cursor_id;              // Set if there are rows left to fetchPage
 }
 
 
@@ -109,4 +112,10 @@ service GraphService {
     oneway void signout(1: i64 sessionId)
 
     ExecutionResponse execute(1: i64 sessionId, 2: string stmt)
+
+    // Return at most `pageSize' rows. If there are more, the query is kept in the session
+    // as a cursor, which produces the next page when pulled by `fetchPage'.
+    ExecutionResponse executePaged(1: i64 sessionId, 2: string stmt, 3: i32 pageSize)
+
+    ExecutionResponse fetchPage(1: i64 sessionId, 2: i64 cursorId)
 }
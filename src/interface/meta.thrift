@@ -86,6 +86,9 @@ struct SpaceProperties {
     1: string               space_name,
     2: i32                  partition_num,
     3: i32                  replica_factor,
+    // Maintain the degree counters of the vertices when the edges are added,
+    // it could not be changed once the space is created.
+    4: bool                 maintain_degrees = false,
 }
 
 struct SpaceItem {
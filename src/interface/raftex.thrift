@@ -31,6 +31,9 @@ enum ErrorCode {
     E_NOT_A_LEADER = -13;
     E_HOST_DISCONNECTED = -14;
     E_TOO_MANY_REQUESTS = -15;
+    E_WAITING_SNAPSHOT = -16;   // The host is receiving a snapshot
+
+    E_PERSIST_SNAPSHOT_FAILED = -17;
 
     E_EXCEPTION = -20;          // An thrift internal exception was thrown
 }
@@ -122,9 +125,40 @@ struct AppendLogResponse {
 }
 
 
+/*
+  SendSnapshotRequest carries a chunk of the rows in the leader's state machine.
+
+  The chunks of a snapshot are sent concurrently and could be applied in any order.
+  The last request has no rows but `done' set, which is sent after all the chunks
+  have been accepted. It carries the log the snapshot has been committed to,
+  and the total number of rows to verify.
+*/
+struct SendSnapshotRequest {
+    1: GraphSpaceID     space;
+    2: PartitionID      part;
+    3: TermID           term;               // The leader's term
+    4: IPv4             leader_ip;
+    5: Port             leader_port;
+    // It identifies the snapshot, the larger one is the later
+    6: i64              snapshot_id;
+    7: list<binary>     rows;
+    8: bool             done;
+    9: LogID            committed_log_id;
+    10: TermID          committed_log_term;
+    11: i64             total_count;
+    12: i64             total_size;
+}
+
+
+struct SendSnapshotResponse {
+    1: ErrorCode    error_code;
+}
+
+
 service RaftexService {
     AskForVoteResponse askForVote(1: AskForVoteRequest req);
     AppendLogResponse appendLog(1: AppendLogRequest req);
+    SendSnapshotResponse sendSnapshot(1: SendSnapshotRequest req);
 }
 
 
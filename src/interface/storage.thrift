@@ -23,6 +23,7 @@ enum ErrorCode {
     E_KEY_HAS_EXISTS = -12,
     E_SPACE_NOT_FOUND = -13,
     E_PART_NOT_FOUND = -14,
+    E_BUFFER_OVERFLOW = -15,
 
     // meta failures
     E_EDGE_PROP_NOT_FOUND = -21,
@@ -46,12 +47,23 @@ struct PropDef {
     2: common.TagID tag_id,       // Only valid when owner is SOURCE or DEST
     3: string name,      // Property name
     4: StatType stat,    // calc stats when setted.
+    // Only valid when owner is EDGE and edge_types requested,
+    // the prop is returned for edges of this type only, or of all types if 0.
+    5: common.EdgeType edge_type,
+    // Only valid when stat is PERCENTILE, in [0, 100].
+    6: double percentile = 50.0,
 }
 
 enum StatType {
     SUM = 1,
     COUNT = 2,
     AVG = 3,
+    MIN = 4,
+    MAX = 5,
+    // Estimated by HyperLogLog
+    COUNT_DISTINCT = 6,
+    // Estimated by t-digest
+    PERCENTILE = 7,
 } (cpp.enum_strict)
 
 struct ResultCode {
@@ -59,12 +71,54 @@ struct ResultCode {
     2: required common.PartitionID part_id,
     // Only valid when code is E_LEADER_CHANAGED.
     3: optional common.HostAddr  leader,
+    // Only valid when code is E_BUFFER_OVERFLOW, the time to wait before retrying
+    4: optional i32 retry_after_ms,
+}
+
+struct EdgeData {
+    1: common.EdgeType type,
+    2: binary data,        // decode according to edge_schemas[type].
 }
 
 struct VertexData {
     1: common.VertexID vertex_id,
     2: binary vertex_data, // decode according to vertex_schema.
     3: binary edge_data,   // decode according to edge_schema.
+    4: list<EdgeData> edges,   // one block for each type, when edge_types requested.
+}
+
+// The values of one column, see ColumnarData
+struct ColumnData {
+    // BOOL takes 1 byte per value, FLOAT 4 bytes, and INT, VID, TIMESTAMP and DOUBLE 8 bytes,
+    // all in little endian. The strings of STRING are kept one after another.
+    1: binary values,
+    // Only for STRING, the end offset of each string in values, 4 bytes in little endian each
+    2: binary offsets,
+}
+
+// The vertices and their edges of a QueryResponse, encoded by columns rather than by rows
+struct ColumnarData {
+    1: list<common.VertexID> vertex_ids,
+    // The vertex props in the order of vertex_schema, one value for each vertex
+    2: list<ColumnData> vertex_columns,
+    // The edges of the i-th vertex are [edge_offsets[i], edge_offsets[i + 1]) of the edge columns
+    3: list<i32> edge_offsets,
+    // The edge props in the order of edge_schema, one value for each edge
+    4: list<ColumnData> edge_columns,
+}
+
+enum CompressionType {
+    NONE = 0,
+    LZ4 = 1,
+    ZSTD = 2,
+} (cpp.enum_strict)
+
+// A response serialized by the compact protocol (without its result) and then compressed
+struct CompressedPayload {
+    1: CompressionType type,
+    // The size before compression
+    2: i32 raw_size,
+    3: binary data,
 }
 
 struct ResponseCommon {
@@ -79,6 +133,14 @@ struct QueryResponse {
     2: optional common.Schema vertex_schema,   // vertex related props
     3: optional common.Schema edge_schema,     // edge related props
     4: optional list<VertexData> vertices,
+    // edge related props of each type, when edge_types requested
+    5: optional map<common.EdgeType, common.Schema>(cpp.template = "std::unordered_map") edge_schemas,
+    // Only for traverse, steps left => the vertices reached in the partitions of other hosts
+    6: optional map<i32, list<common.VertexID>>(cpp.template = "std::unordered_map") frontier,
+    // Instead of vertices, when the columnar encoding is requested
+    7: optional ColumnarData columnar,
+    // Instead of all the fields above but result, when it is large enough to be compressed
+    8: optional CompressedPayload compressed,
 }
 
 struct ExecResponse {
@@ -89,6 +151,8 @@ struct EdgePropResponse {
     1: required ResponseCommon result,
     2: optional common.Schema schema,          // edge related props
     3: optional binary data,
+    // Instead of schema and data, when they are large enough to be compressed
+    4: optional CompressedPayload compressed,
 }
 
 
@@ -98,6 +162,17 @@ struct QueryStatsResponse {
     3: optional binary data,
 }
 
+// The degrees of one vertex, one for each type of DegreeRequest.edge_types, in the same order
+struct VertexDegrees {
+    1: common.VertexID vertex_id,
+    2: list<i64> degrees,
+}
+
+struct DegreeResponse {
+    1: required ResponseCommon result,
+    2: optional list<VertexDegrees> vertices,
+}
+
 struct Tag {
     1: common.TagID tag_id,
     2: binary props,
@@ -122,6 +197,17 @@ struct Edge {
     2: binary props,
 }
 
+// To bound the number of edges returned by getNeighbors, no limit if non-positive.
+// The limits apply to the edges which pass the filter.
+struct EdgeLimit {
+    // At most `per_vertex' edges for each vertex, and for each type if edge_types requested
+    1: i64 per_vertex,
+    // Choose the `per_vertex' edges by reservoir sampling, instead of the first ones
+    2: bool random_sample,
+    // At most `total' edges for the whole request
+    3: i64 total,
+}
+
 struct GetNeighborsRequest {
     1: common.GraphSpaceID space_id,
     // partId => ids
@@ -130,12 +216,42 @@ struct GetNeighborsRequest {
     3: common.EdgeType edge_type,
     4: binary filter,
     5: list<PropDef> return_columns,
+    6: optional EdgeLimit edge_limit,
+    // Going along all these types at once instead of edge_type if not empty,
+    // the edges of each type are returned in their own block, i.e. VertexData.edges
+    7: list<common.EdgeType> edge_types,
+    // Return the vertices and edges in QueryResponse.columnar rather than by rows.
+    // It is ignored when edge_types is not empty.
+    8: bool columnar = false,
+    // The compressions the client could decode, in the order of preference.
+    // The response is not compressed if it is empty.
+    9: list<CompressionType> accept_compression,
+}
+
+// To step out several times within one storage host, the hops stay in its own partitions
+// are expanded locally, and only the final step is returned, just like getNeighbors.
+struct TraverseRequest {
+    1: common.GraphSpaceID space_id,
+    // partId => ids
+    2: map<common.PartitionID, list<common.VertexID>>(cpp.template = "std::unordered_map") parts,
+    3: common.EdgeType edge_type,
+    // The number of steps left, including the one from `parts'
+    4: i32 steps,
+    // The number of partitions of the space, to locate the partition of a vertex
+    5: i32 parts_num,
+    // The filter, return_columns and the total of edge_limit only apply to the final step,
+    // while per_vertex of edge_limit applies to every step.
+    6: binary filter,
+    7: list<PropDef> return_columns,
+    8: optional EdgeLimit edge_limit,
 }
 
 struct VertexPropRequest {
     1: common.GraphSpaceID space_id,
     2: map<common.PartitionID, list<common.VertexID>>(cpp.template = "std::unordered_map") parts,
     3: list<PropDef> return_columns,
+    // See GetNeighborsRequest.accept_compression
+    4: list<CompressionType> accept_compression,
 }
 
 struct EdgePropRequest {
@@ -145,6 +261,17 @@ struct EdgePropRequest {
     3: common.EdgeType edge_type,
     4: binary filter,
     5: list<PropDef> return_columns,
+    // See GetNeighborsRequest.accept_compression
+    6: list<CompressionType> accept_compression,
+}
+
+// The degrees are counted when the edges are added, so they are got without any scan.
+struct DegreeRequest {
+    1: common.GraphSpaceID space_id,
+    // partId => ids
+    2: map<common.PartitionID, list<common.VertexID>>(cpp.template = "std::unordered_map") parts,
+    // The number of out-edges of the type if it is positive, otherwise the in-edges of -type
+    3: list<common.EdgeType> edge_types,
 }
 
 struct AddVerticesRequest {
@@ -216,6 +343,8 @@ service StorageService {
     QueryResponse getOutBound(1: GetNeighborsRequest req)
     QueryResponse getInBound(1: GetNeighborsRequest req)
 
+    QueryResponse traverse(1: TraverseRequest req)
+
     QueryStatsResponse outBoundStats(1: GetNeighborsRequest req)
     QueryStatsResponse inBoundStats(1: GetNeighborsRequest req)
 
@@ -223,6 +352,8 @@ service StorageService {
     QueryResponse getProps(1: VertexPropRequest req);
     EdgePropResponse getEdgeProps(1: EdgePropRequest req)
 
+    DegreeResponse getDegrees(1: DegreeRequest req)
+
     ExecResponse addVertices(1: AddVerticesRequest req);
     ExecResponse addEdges(1: AddEdgesRequest req);
 
@@ -24,6 +24,7 @@ enum ResultCode {
     ERR_INVALID_ARGUMENT    = -6,
     ERR_IO_ERROR            = -7,
     ERR_UNSUPPORTED         = -8,
+    ERR_BUFFER_OVERFLOW     = -9,
     ERR_UNKNOWN             = -100,
 };
 
@@ -61,6 +61,15 @@ public:
     virtual ResultCode prefix(const std::string& prefix,
                               std::unique_ptr<KVIterator>* iter) = 0;
 
+    // Return false if there is no key with 'prefix' for sure, without any disk I/O.
+    // It is meant to skip the lookups of the missing ones cheaply.
+    virtual bool mayExist(const std::string& prefix) = 0;
+
+    // Create a scanner for a series of prefix scans, which reuses its iterators.
+    // If 'pinData' is true, the keys and values returned stay valid along with the scanner,
+    // rather than until the iterator moves.
+    virtual std::unique_ptr<KVScanner> scanner(bool pinData) = 0;
+
     // Get all results in range [start, end)
     virtual ResultCode put(std::string key, std::string value) = 0;
 
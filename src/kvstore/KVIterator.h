@@ -8,6 +8,7 @@
 #define KVSTORE_KVITERATOR_H_
 
 #include "base/Base.h"
+#include "kvstore/Common.h"
 
 namespace nebula {
 namespace kvstore {
@@ -27,6 +28,24 @@ public:
     virtual folly::StringPiece val() const = 0;
 };
 
+
+/**
+ * A scanner serves a series of prefix scans, e.g. for all the vertices of a bucket,
+ * reusing the underlying iterators instead of creating one for each prefix.
+ * So the scans see the data as of when the iterators are created, not as of each scan.
+ *
+ * The iterator returned is only valid until the next call of `prefix', so the scans
+ * could not be nested. Not thread safe.
+ */
+class KVScanner {
+public:
+    virtual ~KVScanner() = default;
+
+    virtual ResultCode prefix(PartitionID partId,
+                              const std::string& prefix,
+                              std::unique_ptr<KVIterator>* iter) = 0;
+};
+
 }  // namespace kvstore
 }  // namespace nebula
 #endif  // KVSTORE_KVITERATOR_H_
@@ -42,6 +42,9 @@ struct KVOptions {
      * Custom CompactionFilter used in compaction.
      * */
     std::shared_ptr<KVCompactionFilterFactory> cfFactory_{nullptr};
+
+    // Stats of the raft write pipeline, they are not reported if it is null
+    std::shared_ptr<raftex::PipelineStats> raftStats_{nullptr};
 };
 
 
@@ -67,6 +70,13 @@ public:
     // returned
     virtual ErrorOr<ResultCode, HostAddr> partLeader(GraphSpaceID spaceId, PartitionID partID) = 0;
 
+    // Retrieve the suggested time (in milliseconds) to wait before writing
+    // to the given partition again. This is usually called when
+    // ERR_BUFFER_OVERFLOW result code is returned
+    virtual ResultCode partRetryAfterMs(GraphSpaceID spaceId,
+                                        PartitionID partId,
+                                        int32_t* retryAfterMs) = 0;
+
     virtual PartManager* partManager() const {
         return nullptr;
     }
@@ -110,6 +120,15 @@ public:
                               std::string&& prefix,
                               std::unique_ptr<KVIterator>* iter) = delete;
 
+    // Return false if there is no key with the prefix for sure, true if there might be
+    // or on errors, which are left to `prefix' to report.
+    virtual bool mayExist(GraphSpaceID spaceId,
+                          PartitionID  partId,
+                          const std::string& prefix) = 0;
+
+    // Create a scanner for a series of prefix scans in the space, see KVEngine::scanner.
+    virtual std::unique_ptr<KVScanner> scanner(GraphSpaceID spaceId, bool pinData) = 0;
+
     virtual void asyncMultiPut(GraphSpaceID spaceId,
                                PartitionID  partId,
                                std::vector<KV> keyValues,
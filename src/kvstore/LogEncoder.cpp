@@ -197,6 +197,25 @@ HostAddr decodeTransLeader(folly::StringPiece encoded) {
            sizeof(addr.second));
     return addr;
 }
+
+std::string encodeKV(folly::StringPiece key, folly::StringPiece val) {
+    std::string encoded;
+    encoded.reserve(sizeof(uint32_t) + key.size() + val.size());
+    uint32_t len = static_cast<uint32_t>(key.size());
+    encoded.append(reinterpret_cast<char*>(&len), sizeof(len));
+    encoded.append(key.data(), key.size());
+    encoded.append(val.data(), val.size());
+    return encoded;
+}
+
+std::pair<folly::StringPiece, folly::StringPiece> decodeKV(folly::StringPiece encoded) {
+    uint32_t len;
+    CHECK_GE(encoded.size(), sizeof(len));
+    memcpy(&len, encoded.begin(), sizeof(len));
+    CHECK_GE(encoded.size(), sizeof(len) + len);
+    return std::make_pair(encoded.subpiece(sizeof(len), len),
+                          encoded.subpiece(sizeof(len) + len));
+}
 }  // namespace kvstore
 }  // namespace nebula
 
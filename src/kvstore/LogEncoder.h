@@ -39,6 +39,10 @@ HostAddr decodeLearner(const std::string& encoded);
 
 std::string encodeTransLeader(const HostAddr& targetAddr);
 HostAddr decodeTransLeader(folly::StringPiece encoded);
+
+// A row of the snapshot, [key length][key][value]
+std::string encodeKV(folly::StringPiece key, folly::StringPiece val);
+std::pair<folly::StringPiece, folly::StringPiece> decodeKV(folly::StringPiece encoded);
 }  // namespace kvstore
 }  // namespace nebula
 #endif  // KVSTORE_LOGENCODER_H_
@@ -16,6 +16,15 @@
 DEFINE_string(engine_type, "rocksdb", "rocksdb, memory...");
 DEFINE_int32(custom_filter_interval_secs, 24 * 3600, "interval to trigger custom compaction");
 DEFINE_int32(num_workers, 4, "Number of worker threads");
+DEFINE_bool(enable_shared_wal, false,
+            "Whether all the parts on a data path write their logs to one shared wal");
+DEFINE_int32(wal_group_commit_window_us, 0,
+             "Microseconds to wait for the other parts' logs before syncing the shared wal");
+
+DECLARE_int32(wal_ttl);
+DECLARE_int64(wal_file_size);
+DECLARE_int32(wal_buffer_size);
+DECLARE_int32(wal_buffer_num);
 
 namespace nebula {
 namespace kvstore {
@@ -37,6 +46,20 @@ bool NebulaStore::init() {
     LOG(INFO) << "Start the raft service...";
     bgWorkers_ = std::make_shared<thread::GenericThreadPool>();
     bgWorkers_->start(FLAGS_num_workers);
+    snapshot_ = std::make_shared<raftex::SnapshotManager>();
+    if (FLAGS_enable_shared_wal) {
+        wal::SharedWalPolicy policy;
+        policy.ttl = FLAGS_wal_ttl;
+        policy.fileSize = FLAGS_wal_file_size;
+        policy.bufferSize = FLAGS_wal_buffer_size;
+        policy.numBuffers = FLAGS_wal_buffer_num;
+        policy.groupCommitWindowUs = FLAGS_wal_group_commit_window_us;
+        for (auto& path : options_.dataPaths_) {
+            sharedWals_.emplace(path,
+                                wal::SharedWal::getWal(folly::stringPrintf("%s/wal", path.c_str()),
+                                                       policy));
+        }
+    }
     raftService_ = raftex::RaftexService::createService(ioPool_,
                                                         workers_,
                                                         raftAddr_.second);
@@ -149,6 +172,23 @@ ErrorOr<ResultCode, HostAddr> NebulaStore::partLeader(GraphSpaceID spaceId, Part
     return getStoreAddr(partIt->second->leader());
 }
 
+ResultCode NebulaStore::partRetryAfterMs(GraphSpaceID spaceId,
+                                         PartitionID partId,
+                                         int32_t* retryAfterMs) {
+    folly::RWSpinLock::ReadHolder rh(&lock_);
+    auto it = spaces_.find(spaceId);
+    if (UNLIKELY(it == spaces_.end())) {
+        return ResultCode::ERR_SPACE_NOT_FOUND;
+    }
+    auto& parts = it->second->parts_;
+    auto partIt = parts.find(partId);
+    if (UNLIKELY(partIt == parts.end())) {
+        return ResultCode::ERR_PART_NOT_FOUND;
+    }
+    *retryAfterMs = partIt->second->retryAfterMs();
+    return ResultCode::SUCCEEDED;
+}
+
 void NebulaStore::addSpace(GraphSpaceID spaceId) {
     folly::RWSpinLock::WriteHolder wh(&lock_);
     if (this->spaces_.find(spaceId) != this->spaces_.end()) {
@@ -206,7 +246,11 @@ std::shared_ptr<Part> NebulaStore::newPart(GraphSpaceID spaceId,
                                        engine,
                                        ioPool_,
                                        bgWorkers_,
-                                       workers_);
+                                       workers_,
+                                       snapshot_,
+                                       sharedWal(engine),
+                                       options_.partMan_->maintainDegrees(spaceId),
+                                       options_.raftStats_);
     auto partMeta = options_.partMan_->partMeta(spaceId, partId);
     std::vector<HostAddr> peers;
     for (auto& h : partMeta.peers_) {
@@ -220,6 +264,17 @@ std::shared_ptr<Part> NebulaStore::newPart(GraphSpaceID spaceId,
     return part;
 }
 
+std::shared_ptr<wal::SharedWal> NebulaStore::sharedWal(KVEngine* engine) {
+    // The data root of the engine is "<data path>/nebula/<space id>"
+    folly::StringPiece dataRoot(engine->getDataRoot());
+    for (auto& entry : sharedWals_) {
+        if (dataRoot.startsWith(folly::stringPrintf("%s/nebula/", entry.first.c_str()))) {
+            return entry.second;
+        }
+    }
+    return nullptr;
+}
+
 void NebulaStore::removeSpace(GraphSpaceID spaceId) {
     folly::RWSpinLock::WriteHolder wh(&lock_);
     auto spaceIt = this->spaces_.find(spaceId);
@@ -306,6 +361,62 @@ ResultCode NebulaStore::prefix(GraphSpaceID spaceId,
     return e->prefix(prefix, iter);
 }
 
+
+namespace {
+
+/**
+ * Dispatch the scans to the scanners of the engines, which hold the partitions.
+ * */
+class NebulaScanner : public KVScanner {
+public:
+    using EngineGetter = std::function<ErrorOr<ResultCode, KVEngine*>(PartitionID)>;
+
+    NebulaScanner(EngineGetter getter, bool pinData)
+        : getter_(std::move(getter))
+        , pinData_(pinData) {}
+
+    ResultCode prefix(PartitionID partId,
+                      const std::string& prefix,
+                      std::unique_ptr<KVIterator>* iter) override {
+        auto ret = getter_(partId);
+        if (!ok(ret)) {
+            return error(ret);
+        }
+        auto* e = nebula::value(ret);
+        auto& scanner = scanners_[e];
+        if (scanner == nullptr) {
+            scanner = e->scanner(pinData_);
+        }
+        return scanner->prefix(partId, prefix, iter);
+    }
+
+private:
+    EngineGetter                                                getter_;
+    bool                                                        pinData_;
+    std::unordered_map<KVEngine*, std::unique_ptr<KVScanner>>   scanners_;
+};
+
+}  // Anonymous namespace
+
+
+std::unique_ptr<KVScanner> NebulaStore::scanner(GraphSpaceID spaceId, bool pinData) {
+    auto getter = [this, spaceId] (PartitionID partId) {
+        return engine(spaceId, partId);
+    };
+    return std::make_unique<NebulaScanner>(std::move(getter), pinData);
+}
+
+
+bool NebulaStore::mayExist(GraphSpaceID spaceId,
+                           PartitionID partId,
+                           const std::string& prefix) {
+    auto ret = engine(spaceId, partId);
+    if (!ok(ret)) {
+        return true;
+    }
+    return nebula::value(ret)->mayExist(prefix);
+}
+
 void NebulaStore::asyncMultiPut(GraphSpaceID spaceId,
                                 PartitionID partId,
                                 std::vector<KV> keyValues,
@@ -11,6 +11,8 @@
 #include <gtest/gtest_prod.h>
 #include <folly/RWSpinLock.h>
 #include "kvstore/raftex/RaftexService.h"
+#include "kvstore/raftex/SnapshotManager.h"
+#include "kvstore/wal/SharedWal.h"
 #include "kvstore/KVStore.h"
 #include "kvstore/PartManager.h"
 #include "kvstore/Part.h"
@@ -35,6 +37,7 @@ class NebulaStore : public KVStore, public Handler {
     FRIEND_TEST(NebulaStoreTest, PartsTest);
     FRIEND_TEST(NebulaStoreTest, ThreeCopiesTest);
     FRIEND_TEST(NebulaStoreTest, TransLeaderTest);
+    FRIEND_TEST(NebulaStoreTest, DegreesTest);
 
 public:
     NebulaStore(KVOptions options,
@@ -84,6 +87,11 @@ public:
     // Return the current leader
     ErrorOr<ResultCode, HostAddr> partLeader(GraphSpaceID spaceId, PartitionID partId) override;
 
+    // Return the time to wait before writing to the part again
+    ResultCode partRetryAfterMs(GraphSpaceID spaceId,
+                                PartitionID partId,
+                                int32_t* retryAfterMs) override;
+
     PartManager* partManager() const override {
         return options_.partMan_.get();
     }
@@ -111,6 +119,12 @@ public:
                       const std::string& prefix,
                       std::unique_ptr<KVIterator>* iter) override;
 
+    bool mayExist(GraphSpaceID spaceId,
+                  PartitionID  partId,
+                  const std::string& prefix) override;
+
+    std::unique_ptr<KVScanner> scanner(GraphSpaceID spaceId, bool pinData) override;
+
     // async batch put.
     void asyncMultiPut(GraphSpaceID spaceId,
                        PartitionID  partId,
@@ -183,6 +197,9 @@ private:
                                   PartitionID partId,
                                   KVEngine* engine);
 
+    // The shared wal of the data path where the engine is, nullptr if it is disabled
+    std::shared_ptr<wal::SharedWal> sharedWal(KVEngine* engine);
+
     ErrorOr<ResultCode, KVEngine*> engine(GraphSpaceID spaceId, PartitionID partId);
 
     ErrorOr<ResultCode, std::shared_ptr<SpacePartInfo>> space(GraphSpaceID spaceId);
@@ -200,6 +217,9 @@ private:
     KVOptions options_;
 
     std::shared_ptr<raftex::RaftexService> raftService_;
+    std::shared_ptr<raftex::SnapshotManager> snapshot_;
+    // data path -> the wal shared by all the parts on it
+    std::unordered_map<std::string, std::shared_ptr<wal::SharedWal>> sharedWals_;
 };
 
 }  // namespace kvstore
@@ -6,6 +6,7 @@
 
 #include "kvstore/Part.h"
 #include "kvstore/LogEncoder.h"
+#include "base/NebulaKeyUtils.h"
 
 DEFINE_int32(cluster_id, 0, "A unique id for each cluster");
 
@@ -15,15 +16,48 @@ namespace kvstore {
 using raftex::AppendLogResult;
 
 const char* kCommitKeyPrefix = "__system_commit_msg_";
+// The keys local to the engine, which are not replicated
+const char* kSystemKeyPrefix = "__system_";
 
 namespace {
 
+// The smallest key beyond all the keys with the prefix. It is empty if there is no such key,
+// i.e. the prefix is empty or all 0xFF.
+std::string prefixEnd(const std::string& prefix) {
+    auto end = prefix;
+    while (!end.empty() && static_cast<uint8_t>(end.back()) == 0xFF) {
+        end.pop_back();
+    }
+    if (!end.empty()) {
+        end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+    }
+    return end;
+}
+
+// Remove the keys in [start, end), the empty end means no upper bound
+ResultCode removeRows(const std::string& start, const std::string& end, WriteBatch* batch) {
+    if (!end.empty()) {
+        return start < end ? batch->removeRange(start, end) : ResultCode::SUCCEEDED;
+    }
+    // The keys starting with 0xFF have no bounded range, they are removed one by one.
+    // No data key starts with it unless the part id is so, which is rare.
+    static const std::string kLast(1, static_cast<char>(0xFF));
+    DCHECK_LT(start, kLast);
+    auto code = batch->removeRange(start, kLast);
+    if (code != ResultCode::SUCCEEDED) {
+        return code;
+    }
+    return batch->removePrefix(kLast);
+}
+
 ResultCode toResultCode(AppendLogResult res) {
     switch (res) {
         case AppendLogResult::SUCCEEDED:
             return ResultCode::SUCCEEDED;
         case AppendLogResult::E_NOT_A_LEADER:
             return ResultCode::ERR_LEADER_CHANGED;
+        case AppendLogResult::E_BUFFER_OVERFLOW:
+            return ResultCode::ERR_BUFFER_OVERFLOW;
         default:
             return ResultCode::ERR_CONSENSUS_ERROR;
     }
@@ -39,7 +73,11 @@ Part::Part(GraphSpaceID spaceId,
            KVEngine* engine,
            std::shared_ptr<folly::IOThreadPoolExecutor> ioPool,
            std::shared_ptr<thread::GenericThreadPool> workers,
-           std::shared_ptr<folly::Executor> handlers)
+           std::shared_ptr<folly::Executor> handlers,
+           std::shared_ptr<raftex::SnapshotManager> snapshot,
+           std::shared_ptr<wal::SharedWal> sharedWal,
+           bool maintainDegrees,
+           std::shared_ptr<raftex::PipelineStats> stats)
         : RaftPart(FLAGS_cluster_id,
                    spaceId,
                    partId,
@@ -47,11 +85,15 @@ Part::Part(GraphSpaceID spaceId,
                    walPath,
                    ioPool,
                    workers,
-                   handlers)
+                   handlers,
+                   snapshot,
+                   sharedWal,
+                   std::move(stats))
         , spaceId_(spaceId)
         , partId_(partId)
         , walPath_(walPath)
-        , engine_(engine) {
+        , engine_(engine)
+        , maintainDegrees_(maintainDegrees) {
 }
 
 
@@ -176,6 +218,20 @@ bool Part::commitLogs(std::unique_ptr<LogIterator> iter) {
     auto batch = engine_->startBatchWrite();
     LogID lastId = -1;
     TermID lastTerm = -1;
+    // The counters are derived from the logs and the rows before them on every replica,
+    // so that they agree with each other without any extra round of raft.
+    std::unique_ptr<KVScanner> scanner;
+    std::unordered_set<std::string> edges;
+    std::unordered_map<std::string, int64_t> degrees;
+    auto count = [&] (folly::StringPiece key) {
+        if (!maintainDegrees_) {
+            return true;
+        }
+        if (scanner == nullptr) {
+            scanner = engine_->scanner(false);
+        }
+        return countDegree(key, scanner.get(), &edges, &degrees);
+    };
     while (iter->valid()) {
         lastId = iter->logId();
         lastTerm = iter->logTerm();
@@ -191,6 +247,9 @@ bool Part::commitLogs(std::unique_ptr<LogIterator> iter) {
         case OP_PUT: {
             auto pieces = decodeMultiValues(log);
             DCHECK_EQ(2, pieces.size());
+            if (!count(pieces[0])) {
+                return false;
+            }
             if (batch->put(pieces[0], pieces[1]) != ResultCode::SUCCEEDED) {
                 LOG(ERROR) << "Failed to call WriteBatch::put()";
                 return false;
@@ -202,6 +261,9 @@ bool Part::commitLogs(std::unique_ptr<LogIterator> iter) {
             // Make the number of values are an even number
             DCHECK_EQ((kvs.size() + 1) / 2, kvs.size() / 2);
             for (size_t i = 0; i < kvs.size(); i += 2) {
+                if (!count(kvs[i])) {
+                    return false;
+                }
                 if (batch->put(kvs[i], kvs[i + 1]) != ResultCode::SUCCEEDED) {
                     LOG(ERROR) << "Failed to call WriteBatch::put()";
                     return false;
@@ -261,17 +323,74 @@ bool Part::commitLogs(std::unique_ptr<LogIterator> iter) {
         ++(*iter);
     }
 
+    if (!putDegrees(degrees, batch.get())) {
+        return false;
+    }
+
     if (lastId >= 0) {
-        std::string commitMsg;
-        commitMsg.reserve(sizeof(LogID) + sizeof(TermID));
-        commitMsg.append(reinterpret_cast<char*>(&lastId), sizeof(LogID));
-        commitMsg.append(reinterpret_cast<char*>(&lastTerm), sizeof(TermID));
-        batch->put(folly::stringPrintf("%s%d", kCommitKeyPrefix, partId_), commitMsg);
+        batch->put(folly::stringPrintf("%s%d", kCommitKeyPrefix, partId_),
+                   commitMsg(lastId, lastTerm));
     }
 
     return engine_->commitBatchWrite(std::move(batch)) == ResultCode::SUCCEEDED;
 }
 
+bool Part::countDegree(folly::StringPiece key,
+                       KVScanner* scanner,
+                       std::unordered_set<std::string>* edges,
+                       std::unordered_map<std::string, int64_t>* degrees) {
+    // The data keys start with the part id, unlike the keys of other stores, e.g. the meta
+    if (!NebulaKeyUtils::isEdge(key)
+            || NebulaKeyUtils::readInt<PartitionID>(key.data(), key.size()) != partId_) {
+        return true;
+    }
+    auto edge = NebulaKeyUtils::keyWithNoVersion(key).str();
+    if (edges->find(edge) != edges->end()) {
+        return true;
+    }
+    // Most edges inserted are new ones, which are told by the bloom filters
+    bool existed = false;
+    if (engine_->mayExist(edge)) {
+        std::unique_ptr<KVIterator> iter;
+        auto ret = scanner->prefix(partId_, edge, &iter);
+        if (ret != ResultCode::SUCCEEDED) {
+            LOG(ERROR) << idStr_ << "Check the edge failed, code " << static_cast<int32_t>(ret);
+            return false;
+        }
+        existed = iter != nullptr && iter->valid();
+    }
+    edges->emplace(std::move(edge));
+    if (!existed) {
+        auto degreeKey = NebulaKeyUtils::degreeKey(partId_,
+                                                   NebulaKeyUtils::getSrcId(key),
+                                                   NebulaKeyUtils::getEdgeType(key));
+        (*degrees)[degreeKey]++;
+    }
+    return true;
+}
+
+bool Part::putDegrees(const std::unordered_map<std::string, int64_t>& degrees,
+                      WriteBatch* batch) {
+    for (auto& degree : degrees) {
+        auto count = degree.second;
+        std::string val;
+        auto ret = engine_->get(degree.first, &val);
+        if (ret == ResultCode::SUCCEEDED && val.size() == sizeof(int64_t)) {
+            count += NebulaKeyUtils::readInt<int64_t>(val.data(), val.size());
+        } else if (ret != ResultCode::ERR_KEY_NOT_FOUND) {
+            LOG(ERROR) << idStr_ << "Read the degree failed, code " << static_cast<int32_t>(ret);
+            return false;
+        }
+        if (batch->put(degree.first,
+                       folly::StringPiece(reinterpret_cast<const char*>(&count), sizeof(int64_t)))
+                != ResultCode::SUCCEEDED) {
+            LOG(ERROR) << "Failed to call WriteBatch::put()";
+            return false;
+        }
+    }
+    return true;
+}
+
 bool Part::preProcessLog(LogID logId,
                          TermID termId,
                          ClusterID clusterId,
@@ -301,6 +420,86 @@ bool Part::preProcessLog(LogID logId,
     return true;
 }
 
+std::string Part::commitMsg(LogID committedLogId, TermID committedLogTerm) {
+    std::string msg;
+    msg.reserve(sizeof(LogID) + sizeof(TermID));
+    msg.append(reinterpret_cast<char*>(&committedLogId), sizeof(LogID));
+    msg.append(reinterpret_cast<char*>(&committedLogTerm), sizeof(TermID));
+    return msg;
+}
+
+std::vector<std::string> Part::snapshotPrefixes() {
+    if (engine_->totalPartsNum() <= 1) {
+        // All the rows in the engine belong to the part, whatever the keys look like
+        return {""};
+    }
+    return {NebulaKeyUtils::prefix(partId_), NebulaKeyUtils::degreePrefix(partId_)};
+}
+
+StatusOr<std::pair<LogID, TermID>>
+Part::accessAllRowsInSnapshot(raftex::SnapshotCallback cb) {
+    // The rows are read after the committed log id, so they include all the logs up to it,
+    // and probably some later ones, which are just applied again by the receiver.
+    auto committed = lastCommittedLogId();
+    for (auto& prefix : snapshotPrefixes()) {
+        std::unique_ptr<KVIterator> iter;
+        if (engine_->prefix(prefix, &iter) != ResultCode::SUCCEEDED) {
+            LOG(ERROR) << idStr_ << "Failed to scan the part";
+            return Status::Error("Failed to scan the part %d", partId_);
+        }
+        for (; iter->valid(); iter->next()) {
+            if (iter->key().startsWith(kSystemKeyPrefix)) {
+                continue;
+            }
+            if (!cb(encodeKV(iter->key(), iter->val()))) {
+                return committed;
+            }
+        }
+    }
+    return committed;
+}
+
+bool Part::cleanup() {
+    LOG(INFO) << idStr_ << "Clean up all the rows of the part";
+    // The rows are removed by ranges rather than one by one, except the system keys
+    auto batch = engine_->startBatchWrite();
+    auto sysStart = std::string(kSystemKeyPrefix);
+    auto sysEnd = prefixEnd(sysStart);
+    for (auto& prefix : snapshotPrefixes()) {
+        auto end = prefixEnd(prefix);
+        auto stop = end.empty() ? sysStart : std::min(end, sysStart);
+        auto code = removeRows(prefix, stop, batch.get());
+        if (code == ResultCode::SUCCEEDED) {
+            code = removeRows(std::max(prefix, sysEnd), end, batch.get());
+        }
+        if (code != ResultCode::SUCCEEDED) {
+            LOG(ERROR) << idStr_ << "Failed to remove the rows, error " << code;
+            return false;
+        }
+    }
+    batch->remove(folly::stringPrintf("%s%d", kCommitKeyPrefix, partId_));
+    return engine_->commitBatchWrite(std::move(batch)) == ResultCode::SUCCEEDED;
+}
+
+bool Part::commitSnapshot(const std::vector<std::string>& rows,
+                          LogID committedLogId,
+                          TermID committedLogTerm,
+                          bool finished) {
+    auto batch = engine_->startBatchWrite();
+    for (auto& row : rows) {
+        auto kv = decodeKV(row);
+        if (batch->put(kv.first, kv.second) != ResultCode::SUCCEEDED) {
+            LOG(ERROR) << "Failed to call WriteBatch::put()";
+            return false;
+        }
+    }
+    if (finished) {
+        batch->put(folly::stringPrintf("%s%d", kCommitKeyPrefix, partId_),
+                   commitMsg(committedLogId, committedLogTerm));
+    }
+    return engine_->commitBatchWrite(std::move(batch)) == ResultCode::SUCCEEDED;
+}
+
 }  // namespace kvstore
 }  // namespace nebula
 
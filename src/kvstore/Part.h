@@ -25,7 +25,11 @@ public:
          KVEngine* engine,
          std::shared_ptr<folly::IOThreadPoolExecutor> pool,
          std::shared_ptr<thread::GenericThreadPool> workers,
-         std::shared_ptr<folly::Executor> handlers);
+         std::shared_ptr<folly::Executor> handlers,
+         std::shared_ptr<raftex::SnapshotManager> snapshot,
+         std::shared_ptr<wal::SharedWal> sharedWal,
+         bool maintainDegrees,
+         std::shared_ptr<raftex::PipelineStats> stats);
 
     virtual ~Part() {
         LOG(INFO) << idStr_ << "~Part()";
@@ -78,11 +82,41 @@ private:
                        ClusterID clusterId,
                        const std::string& log) override;
 
+    StatusOr<std::pair<LogID, TermID>>
+    accessAllRowsInSnapshot(raftex::SnapshotCallback cb) override;
+
+    bool cleanup() override;
+
+    bool commitSnapshot(const std::vector<std::string>& rows,
+                        LogID committedLogId,
+                        TermID committedLogTerm,
+                        bool finished) override;
+
+    // The prefixes of all the rows of the part
+    std::vector<std::string> snapshotPrefixes();
+
+    /**
+     * Count the edge into the degree counter of its vertex if it has not existed in any version,
+     * see maintainDegrees_. `edges' are the ones already counted in the same batch.
+     * */
+    bool countDegree(folly::StringPiece key,
+                     KVScanner* scanner,
+                     std::unordered_set<std::string>* edges,
+                     std::unordered_map<std::string, int64_t>* degrees);
+
+    // Put the counters added by the edges of one batch, along with the edges
+    bool putDegrees(const std::unordered_map<std::string, int64_t>& degrees, WriteBatch* batch);
+
+    std::string commitMsg(LogID committedLogId, TermID committedLogTerm);
+
 protected:
     GraphSpaceID spaceId_;
     PartitionID partId_;
     std::string walPath_;
     KVEngine* engine_ = nullptr;
+    // Maintain the degree counters of the vertices when the logs of new edges are applied,
+    // it is a property of the space, so that all the replicas agree on it.
+    bool maintainDegrees_ = false;
     NewLeaderCallback newLeaderCb_ = nullptr;
 };
 
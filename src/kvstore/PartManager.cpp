@@ -67,6 +67,10 @@ bool MetaServerBasedPartManager::spaceExist(const HostAddr& host,
     return client_->checkSpaceExistInCache(host, spaceId);
 }
 
+bool MetaServerBasedPartManager::maintainDegrees(GraphSpaceID spaceId) {
+    return client_->maintainDegreesFromCache(spaceId);
+}
+
 void MetaServerBasedPartManager::onSpaceAdded(GraphSpaceID spaceId) {
     if (handler_ != nullptr) {
         handler_->addSpace(spaceId);
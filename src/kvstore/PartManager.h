@@ -53,6 +53,12 @@ public:
      * */
     virtual bool spaceExist(const HostAddr& host, GraphSpaceID spaceId) = 0;
 
+    /**
+     * Check the degree counters are maintained in the space or not,
+     * it is decided when the space is created, so all the replicas agree on it.
+     * */
+    virtual bool maintainDegrees(GraphSpaceID spaceId) = 0;
+
     /**
      * Register Handler
      * */
@@ -121,12 +127,22 @@ public:
         return partsMap_.find(spaceId) != partsMap_.end();
     }
 
+    bool maintainDegrees(GraphSpaceID spaceId) override {
+        return degreesSpaces_.find(spaceId) != degreesSpaces_.end();
+    }
+
     PartsMap& partsMap() {
         return partsMap_;
     }
 
+    std::unordered_set<GraphSpaceID>& degreesSpaces() {
+        return degreesSpaces_;
+    }
+
 private:
     PartsMap partsMap_;
+    // The spaces maintaining the degree counters
+    std::unordered_set<GraphSpaceID> degreesSpaces_;
 };
 
 
@@ -144,6 +160,8 @@ public:
 
      bool spaceExist(const HostAddr& host, GraphSpaceID spaceId) override;
 
+     bool maintainDegrees(GraphSpaceID spaceId) override;
+
      /**
       * Implement the interfaces in MetaChangedListener
       * */
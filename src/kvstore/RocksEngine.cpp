@@ -7,6 +7,7 @@
 #include "base/Base.h"
 #include "kvstore/RocksEngine.h"
 #include <folly/String.h>
+#include <rocksdb/slice_transform.h>
 #include "fs/FileUtils.h"
 #include "kvstore/KVStore.h"
 #include "kvstore/RocksEngineConfig.h"
@@ -55,6 +56,7 @@ public:
     ResultCode removePrefix(folly::StringPiece prefix) override {
         rocksdb::Slice pre(prefix.begin(), prefix.size());
         rocksdb::ReadOptions options;
+        options.total_order_seek = true;
         std::unique_ptr<rocksdb::Iterator> iter(db_->NewIterator(options));
         iter->Seek(pre);
         while (iter->Valid()) {
@@ -85,9 +87,98 @@ public:
     }
 };
 
+/**
+ * A view of the iterator owned by RocksPrefixScanner.
+ * */
+class RocksScanIter : public KVIterator {
+public:
+    RocksScanIter(rocksdb::Iterator* iter, rocksdb::Slice prefix)
+        : iter_(iter)
+        , prefix_(prefix) {}
+
+    bool valid() const override {
+        return iter_->Valid() && iter_->key().starts_with(prefix_);
+    }
+
+    void next() override {
+        iter_->Next();
+    }
+
+    void prev() override {
+        iter_->Prev();
+    }
+
+    folly::StringPiece key() const override {
+        return folly::StringPiece(iter_->key().data(), iter_->key().size());
+    }
+
+    folly::StringPiece val() const override {
+        return folly::StringPiece(iter_->value().data(), iter_->value().size());
+    }
+
+private:
+    rocksdb::Iterator* iter_;
+    rocksdb::Slice prefix_;
+};
+
 }  // Anonymous namespace
 
 
+/***************************************
+ *
+ * Implementation of RocksPrefixScanner
+ *
+ **************************************/
+ResultCode RocksPrefixScanner::prefix(PartitionID,
+                                      const std::string& prefix,
+                                      std::unique_ptr<KVIterator>* iter) {
+    prefix_ = prefix;
+    rocksdb::Slice pre(prefix_.data(), prefix_.size());
+    // The smallest key beyond all the keys with the prefix
+    upperBound_ = prefix_;
+    while (!upperBound_.empty() && static_cast<uint8_t>(upperBound_.back()) == 0xFF) {
+        upperBound_.pop_back();
+    }
+    rocksdb::Iterator* it = nullptr;
+    if (upperBound_.empty()) {
+        rocksdb::ReadOptions options;
+        options.total_order_seek = true;
+        options.pin_data = pinData_;
+        unboundedIter_.reset(db_->NewIterator(options));
+        it = unboundedIter_.get();
+    } else {
+        upperBound_.back()++;
+        upperSlice_ = rocksdb::Slice(upperBound_.data(), upperBound_.size());
+        // All the keys with `pre' share its extracted prefix as long as it is in domain
+        it = getIter(extractor_ == nullptr || !extractor_->InDomain(pre));
+    }
+    if (it == nullptr) {
+        return ResultCode::ERR_UNKNOWN;
+    }
+    it->Seek(pre);
+    iter->reset(new RocksScanIter(it, pre));
+    return ResultCode::SUCCEEDED;
+}
+
+
+rocksdb::Iterator* RocksPrefixScanner::getIter(bool totalOrder) {
+    auto& iter = totalOrder ? totalOrderIter_ : prefixIter_;
+    if (iter == nullptr) {
+        rocksdb::ReadOptions options;
+        if (totalOrder) {
+            options.total_order_seek = true;
+        } else {
+            options.prefix_same_as_start = true;
+        }
+        // The bound is updated in place before each seek
+        options.iterate_upper_bound = &upperSlice_;
+        options.pin_data = pinData_;
+        iter.reset(db_->NewIterator(options));
+    }
+    return iter.get();
+}
+
+
 /***************************************
  *
  * Implementation of WriteBatch
@@ -118,6 +209,7 @@ RocksEngine::RocksEngine(GraphSpaceID spaceId,
     status = rocksdb::DB::Open(options, path, &db);
     CHECK(status.ok());
     db_.reset(db);
+    extractor_ = options.prefix_extractor;
     partsNum_ = allParts().size();
 }
 
@@ -179,6 +271,7 @@ ResultCode RocksEngine::range(const std::string& start,
                               const std::string& end,
                               std::unique_ptr<KVIterator>* storageIter) {
     rocksdb::ReadOptions options;
+    options.total_order_seek = true;
     rocksdb::Iterator* iter = db_->NewIterator(options);
     if (iter) {
         iter->Seek(rocksdb::Slice(start));
@@ -190,7 +283,7 @@ ResultCode RocksEngine::range(const std::string& start,
 
 ResultCode RocksEngine::prefix(const std::string& prefix,
                                std::unique_ptr<KVIterator>* storageIter) {
-    rocksdb::ReadOptions options;
+    auto options = prefixReadOptions(prefix);
     rocksdb::Iterator* iter = db_->NewIterator(options);
     if (iter) {
         iter->Seek(rocksdb::Slice(prefix));
@@ -200,6 +293,44 @@ ResultCode RocksEngine::prefix(const std::string& prefix,
 }
 
 
+bool RocksEngine::mayExist(const std::string& prefix) {
+    auto options = prefixReadOptions(prefix);
+    if (options.total_order_seek) {
+        // No filters to tell
+        return true;
+    }
+    // Settled by the bloom filters and the cached blocks, without touching the disk
+    options.read_tier = rocksdb::kBlockCacheTier;
+    std::unique_ptr<rocksdb::Iterator> iter(db_->NewIterator(options));
+    rocksdb::Slice pre(prefix.data(), prefix.size());
+    iter->Seek(pre);
+    if (iter->Valid()) {
+        return iter->key().starts_with(pre);
+    }
+    // Incomplete if any block needed is not cached
+    return !iter->status().ok();
+}
+
+
+std::unique_ptr<KVScanner> RocksEngine::scanner(bool pinData) {
+    return std::make_unique<RocksPrefixScanner>(db_.get(), extractor_, pinData);
+}
+
+
+rocksdb::ReadOptions RocksEngine::prefixReadOptions(const std::string& prefix) const {
+    rocksdb::ReadOptions options;
+    rocksdb::Slice pre(prefix.data(), prefix.size());
+    // All the keys with `pre' share its extracted prefix as long as it is in domain,
+    // i.e. no shorter than the fixed prefix length.
+    if (extractor_ != nullptr && extractor_->InDomain(pre)) {
+        options.prefix_same_as_start = true;
+    } else {
+        options.total_order_seek = true;
+    }
+    return options;
+}
+
+
 ResultCode RocksEngine::put(std::string key, std::string value) {
     rocksdb::WriteOptions options;
     options.disableWAL = FLAGS_rocksdb_disable_wal;
@@ -278,7 +409,7 @@ ResultCode RocksEngine::removeRange(const std::string& start,
 
 ResultCode RocksEngine::removePrefix(const std::string& prefix) {
     rocksdb::Slice pre(prefix.data(), prefix.size());
-    rocksdb::ReadOptions readOptions;
+    auto readOptions = prefixReadOptions(prefix);
     rocksdb::WriteBatch batch;
     std::unique_ptr<rocksdb::Iterator> iter(db_->NewIterator(readOptions));
     iter->Seek(pre);
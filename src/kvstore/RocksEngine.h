@@ -86,6 +86,47 @@ private:
 };
 
 
+/**
+ * Prefix scans over iterators reused by seeking again, see KVScanner.
+ *
+ * The scans are bounded by `iterate_upper_bound', which points to the end of the
+ * current prefix, so that RocksDB stops at the end of the prefix rather than
+ * at the first key beyond it, which might be in another file.
+ */
+class RocksPrefixScanner : public KVScanner {
+public:
+    RocksPrefixScanner(rocksdb::DB* db,
+                       std::shared_ptr<const rocksdb::SliceTransform> extractor,
+                       bool pinData)
+        : db_(db)
+        , extractor_(std::move(extractor))
+        , pinData_(pinData) {}
+
+    ResultCode prefix(PartitionID partId,
+                      const std::string& prefix,
+                      std::unique_ptr<KVIterator>* iter) override;
+
+private:
+    /**
+     * To create the iterator on the first use, by the prefix bloom filters or in the
+     * total order, see RocksEngine::prefixReadOptions.
+     */
+    rocksdb::Iterator* getIter(bool totalOrder);
+
+private:
+    rocksdb::DB* db_{nullptr};
+    std::shared_ptr<const rocksdb::SliceTransform> extractor_;
+    bool pinData_{false};
+    std::string prefix_;
+    std::string upperBound_;
+    rocksdb::Slice upperSlice_;
+    std::unique_ptr<rocksdb::Iterator> prefixIter_;
+    std::unique_ptr<rocksdb::Iterator> totalOrderIter_;
+    // Neither of the iterators above fits a prefix with no upper bound, i.e. all 0xFF
+    std::unique_ptr<rocksdb::Iterator> unboundedIter_;
+};
+
+
 /**************************************************************************
  *
  * An implementation of KVEngine based on Rocksdb
@@ -126,6 +167,10 @@ public:
     ResultCode prefix(const std::string& prefix,
                       std::unique_ptr<KVIterator>* iter) override;
 
+    bool mayExist(const std::string& prefix) override;
+
+    std::unique_ptr<KVScanner> scanner(bool pinData) override;
+
     /*********************
      * Data modification
      ********************/
@@ -168,9 +213,16 @@ public:
 private:
     std::string partKey(PartitionID partId);
 
+    /**
+     * To seek the keys with `prefix', by the prefix bloom filters if `prefix' covers
+     * the prefix extractor, or in the total order otherwise.
+     */
+    rocksdb::ReadOptions prefixReadOptions(const std::string& prefix) const;
+
 private:
     std::string  dataPath_;
     std::unique_ptr<rocksdb::DB> db_{nullptr};
+    std::shared_ptr<const rocksdb::SliceTransform> extractor_;
     int32_t partsNum_ = -1;
 };
 
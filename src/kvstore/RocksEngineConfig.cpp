@@ -11,6 +11,7 @@
 #include "rocksdb/convenience.h"
 #include "rocksdb/utilities/options_util.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/filter_policy.h"
 
 // [WAL]
 DEFINE_bool(rocksdb_disable_wal,
@@ -50,6 +51,14 @@ DEFINE_string(part_man_type,
 DEFINE_int64(rocksdb_block_cache, 4,
              "The default block cache size used in BlockBasedTable. The unit is MB");
 
+// The tags of a vertex, and the edges of a type out of a vertex, are looked up by
+// a prefix of partId(4) + vertexId(8) + tagId/edgeType(4), see NebulaKeyUtils.
+DEFINE_int32(rocksdb_filtering_prefix_length, 16,
+             "The length of the key prefix to build bloom filters on, 0 to disable");
+
+DEFINE_int32(rocksdb_bloom_bits_per_key, 10,
+             "The bits per key of the prefix bloom filters, 0 to disable");
+
 
 namespace nebula {
 namespace kvstore {
@@ -82,6 +91,22 @@ rocksdb::Status initRocksdbOptions(rocksdb::Options &baseOpts) {
     }
 
     bbtOpts.block_cache = rocksdb::NewLRUCache(FLAGS_rocksdb_block_cache * 1024 * 1024);
+    // Unless specified in the options above
+    if (FLAGS_rocksdb_filtering_prefix_length > 0 && baseOpts.prefix_extractor == nullptr) {
+        baseOpts.prefix_extractor.reset(
+            rocksdb::NewFixedPrefixTransform(FLAGS_rocksdb_filtering_prefix_length));
+        if (baseOpts.memtable_prefix_bloom_size_ratio == 0) {
+            baseOpts.memtable_prefix_bloom_size_ratio = 0.1;
+        }
+    }
+    if (FLAGS_rocksdb_bloom_bits_per_key > 0
+            && baseOpts.prefix_extractor != nullptr
+            && bbtOpts.filter_policy == nullptr) {
+        // The full filters hold the whole keys along with the prefixes, for the point
+        // lookups such as the degree counters
+        bbtOpts.filter_policy.reset(
+            rocksdb::NewBloomFilterPolicy(FLAGS_rocksdb_bloom_bits_per_key, false));
+    }
     baseOpts.table_factory.reset(NewBlockBasedTableFactory(bbtOpts));
     baseOpts.create_if_missing = true;
     return s;
@@ -31,6 +31,10 @@ DECLARE_bool(rocksdb_disable_wal);
 // BlockBasedTable block_cache
 DECLARE_int64(rocksdb_block_cache);
 
+DECLARE_int32(rocksdb_filtering_prefix_length);
+
+DECLARE_int32(rocksdb_bloom_bits_per_key);
+
 DECLARE_int32(rocksdb_batch_size);
 
 DECLARE_string(part_man_type);
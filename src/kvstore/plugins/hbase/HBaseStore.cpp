@@ -273,6 +273,38 @@ ResultCode HBaseStore::prefix(GraphSpaceID spaceId,
 }
 
 
+namespace {
+
+/**
+ * Nothing to reuse, each scan is just a `prefix'.
+ * */
+class HBaseScanner : public KVScanner {
+public:
+    HBaseScanner(HBaseStore* store, GraphSpaceID spaceId)
+        : store_(store)
+        , spaceId_(spaceId) {}
+
+    ResultCode prefix(PartitionID partId,
+                      const std::string& prefix,
+                      std::unique_ptr<KVIterator>* iter) override {
+        prefix_ = prefix;
+        return store_->prefix(spaceId_, partId, prefix_, iter);
+    }
+
+private:
+    HBaseStore*     store_;
+    GraphSpaceID    spaceId_;
+    std::string     prefix_;
+};
+
+}  // Anonymous namespace
+
+
+std::unique_ptr<KVScanner> HBaseStore::scanner(GraphSpaceID spaceId, bool) {
+    return std::make_unique<HBaseScanner>(this, spaceId);
+}
+
+
 void HBaseStore::asyncMultiPut(GraphSpaceID spaceId,
                                PartitionID partId,
                                std::vector<KV> keyValues,
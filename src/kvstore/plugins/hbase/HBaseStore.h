@@ -76,6 +76,15 @@ public:
         return {-1, -1};
     }
 
+    ResultCode partRetryAfterMs(GraphSpaceID spaceId,
+                                PartitionID partId,
+                                int32_t* retryAfterMs) override {
+        UNUSED(spaceId);
+        UNUSED(partId);
+        *retryAfterMs = 0;
+        return ResultCode::SUCCEEDED;
+    }
+
     ResultCode get(GraphSpaceID spaceId,
                    PartitionID  partId,
                    const std::string& key,
@@ -99,6 +108,14 @@ public:
                       const std::string& prefix,
                       std::unique_ptr<KVIterator>* iter) override;
 
+    bool mayExist(GraphSpaceID,
+                  PartitionID,
+                  const std::string&) override {
+        return true;
+    }
+
+    std::unique_ptr<KVScanner> scanner(GraphSpaceID spaceId, bool) override;
+
     // async batch put.
     void asyncMultiPut(GraphSpaceID spaceId,
                        PartitionID  partId,
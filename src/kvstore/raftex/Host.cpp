@@ -7,6 +7,7 @@
 #include "base/Base.h"
 #include "kvstore/raftex/Host.h"
 #include "kvstore/raftex/RaftPart.h"
+#include "kvstore/raftex/SnapshotManager.h"
 #include "kvstore/wal/FileBasedWal.h"
 #include "network/NetworkUtils.h"
 #include <folly/io/async/EventBase.h>
@@ -16,6 +17,9 @@ DEFINE_uint32(max_appendlog_batch_size, 128,
               "The max number of logs in each appendLog request batch");
 DEFINE_uint32(max_outstanding_requests, 1024,
               "The max number of outstanding appendLog requests");
+DEFINE_uint32(max_inflight_appendlog_requests, 4,
+              "The max number of appendLog requests in flight to each host, "
+              "1 means sending the next request after the previous one is responded");
 DEFINE_int32(raft_rpc_timeout_ms, 500, "rpc timeout for raft client");
 
 
@@ -32,8 +36,7 @@ Host::Host(const HostAddr& addr, std::shared_ptr<RaftPart> part, bool isLearner)
             "%s[Host: %s:%d] ",
             part_->idStr_.c_str(),
             NetworkUtils::intToIPv4(addr_.first).c_str(),
-            addr_.second))
-        , cachingPromise_(folly::SharedPromise<cpp2::AppendLogResponse>()) {
+            addr_.second)) {
 }
 
 
@@ -42,7 +45,7 @@ void Host::waitForStop() {
 
     CHECK(stopped_);
     noMoreRequestCV_.wait(g, [this] {
-        return !requestOnGoing_;
+        return inFlight_.empty();
     });
     LOG(INFO) << idStr_ << "The host has been stopped!";
 }
@@ -101,47 +104,28 @@ folly::Future<cpp2::AppendLogResponse> Host::appendLogs(
             << "]";
 
     auto ret = folly::Future<cpp2::AppendLogResponse>::makeEmpty();
-    std::shared_ptr<cpp2::AppendLogRequest> req;
+    RequestList reqs;
     {
         std::lock_guard<std::mutex> g(lock_);
 
         auto res = checkStatus();
 
-        if (logId == logIdToSend_) {
-            // This is a re-send or a heartbeat. If there is an
-            // ongoing request, we will just return SUCCEEDED
-            if (requestOnGoing_) {
-                LOG(INFO) << idStr_ << "Another request is onging,"
-                                       "ignore the re-send request";
-                cpp2::AppendLogResponse r;
-                r.set_error_code(cpp2::ErrorCode::SUCCEEDED);
-                return r;
-            }
-        } else {
-            // Otherwise, logId has to be greater
-            if (logId < logIdToSend_) {
+        if (logId <= logIdToSend_) {
+            // This is a re-send, of the batches the quorum did not accept
+            if (logId <= lastLogIdSent_) {
                 LOG(INFO) << idStr_ << "The log has been sended";
                 cpp2::AppendLogResponse r;
                 r.set_error_code(cpp2::ErrorCode::SUCCEEDED);
                 return r;
             }
-        }
-
-        if (requestOnGoing_ && res == cpp2::ErrorCode::SUCCEEDED) {
-            if (cachingPromise_.size() <= FLAGS_max_outstanding_requests) {
-                pendingReq_ = std::make_tuple(term,
-                                              logId,
-                                              committedLogId,
-                                              prevLogTerm,
-                                              prevLogId);
-                return cachingPromise_.getFuture();
-            } else {
-                LOG(INFO) << idStr_
-                          << "Too many requests are waiting, return error";
-                cpp2::AppendLogResponse r;
-                r.set_error_code(cpp2::ErrorCode::E_TOO_MANY_REQUESTS);
-                return r;
+            for (auto& p : promises_) {
+                if (p.first >= logId) {
+                    LOG(INFO) << idStr_ << "Another request is onging,"
+                                           " wait for it instead of sending again";
+                    return p.second.getFuture();
+                }
             }
+            // The requests failed, send the logs again
         }
 
         if (res != cpp2::ErrorCode::SUCCEEDED) {
@@ -152,169 +136,239 @@ folly::Future<cpp2::AppendLogResponse> Host::appendLogs(
             return r;
         }
 
-        VLOG(2) << idStr_ << "About to send the AppendLog request";
+        if (sendingSnapshot_) {
+            VLOG(2) << idStr_ << "The host is receiving the snapshot, just return";
+            cpp2::AppendLogResponse r;
+            r.set_error_code(cpp2::ErrorCode::E_WAITING_SNAPSHOT);
+            return r;
+        }
+
+        if (promises_.size() > FLAGS_max_outstanding_requests) {
+            LOG(INFO) << idStr_
+                      << "Too many requests are waiting, return error";
+            cpp2::AppendLogResponse r;
+            r.set_error_code(cpp2::ErrorCode::E_TOO_MANY_REQUESTS);
+            return r;
+        }
 
-        // No request is ongoing, let's send a new request
-        CHECK_GE(prevLogTerm, lastLogTermSent_);
-        CHECK_GE(prevLogId, lastLogIdSent_);
+        if (promises_.empty()) {
+            // Nothing is being sent, start from the previous log of the leader, unless
+            // the host has accepted some logs after it, when the batches are sent again
+            VLOG(2) << idStr_ << "About to send the AppendLog request";
+            discardInFlight();
+            if (prevLogId >= lastLogIdSent_) {
+                CHECK_GE(prevLogTerm, lastLogTermSent_);
+                lastLogTermSent_ = prevLogTerm;
+                lastLogIdSent_ = prevLogId;
+            }
+            lastLogTermInFlight_ = lastLogTermSent_;
+            lastLogIdInFlight_ = lastLogIdSent_;
+        } else {
+            // The logs are sent right after the ones in flight
+            VLOG(2) << idStr_ << "Append the logs after the ones in flight, from "
+                    << lastLogIdInFlight_ + 1 << " to " << logId;
+        }
         logTermToSend_ = term;
         logIdToSend_ = logId;
-        lastLogTermSent_ = prevLogTerm;
-        lastLogIdSent_ = prevLogId;
         committedLogId_ = committedLogId;
-        pendingReq_ = std::make_tuple(0, 0, 0, 0, 0);
-        promise_ = std::move(cachingPromise_);
-        cachingPromise_ = folly::SharedPromise<cpp2::AppendLogResponse>();
-        ret = promise_.getFuture();
 
-        requestOnGoing_ = true;
+        promises_.emplace_back(logId, folly::SharedPromise<cpp2::AppendLogResponse>());
+        ret = promises_.back().second.getFuture();
 
-        req = prepareAppendLogRequest();
+        reqs = fillWindow();
     }
 
-    // Get a new promise
-    appendLogsInternal(eb, std::move(req));
+    appendLogsInternal(eb, std::move(reqs));
 
     return ret;
 }
 
+
+void Host::setResponse(LogID logId, const cpp2::AppendLogResponse& r) {
+    CHECK(!lock_.try_lock());
+    while (!promises_.empty() && promises_.front().first <= logId) {
+        VLOG(2) << idStr_ << "Fulfill the promise of the log " << promises_.front().first
+                << ", size = " << promises_.front().second.size();
+        promises_.front().second.setValue(r);
+        promises_.pop_front();
+    }
+}
+
+
 void Host::setResponse(const cpp2::AppendLogResponse& r) {
     CHECK(!lock_.try_lock());
-    promise_.setValue(r);
-    cachingPromise_.setValue(r);
-    cachingPromise_ = folly::SharedPromise<cpp2::AppendLogResponse>();
-    pendingReq_ = std::make_tuple(0, 0, 0, 0, 0);
-    requestOnGoing_ = false;
+    for (auto& p : promises_) {
+        p.second.setValue(r);
+    }
+    promises_.clear();
+    discardInFlight();
 }
 
-void Host::appendLogsInternal(folly::EventBase* eb,
-                              std::shared_ptr<cpp2::AppendLogRequest> req) {
-    sendAppendLogRequest(eb, std::move(req)).via(eb).then(
-            [eb, self = shared_from_this()] (folly::Try<cpp2::AppendLogResponse>&& t) {
-        VLOG(3) << self->idStr_ << "appendLogs() call got response";
-        if (t.hasException()) {
-            LOG(ERROR) << self->idStr_ << t.exception().what();
-            cpp2::AppendLogResponse r;
-            r.set_error_code(cpp2::ErrorCode::E_EXCEPTION);
+
+void Host::discardInFlight() {
+    CHECK(!lock_.try_lock());
+    for (auto& req : inFlight_) {
+        req.discarded_ = true;
+    }
+}
+
+
+void Host::startSendSnapshot() {
+    CHECK(!lock_.try_lock());
+    LOG(INFO) << idStr_ << "The log " << lastLogIdInFlight_ + 1
+              << " is not in the WAL any more, send the snapshot instead";
+    sendingSnapshot_ = true;
+    cpp2::AppendLogResponse r;
+    r.set_error_code(cpp2::ErrorCode::E_WAITING_SNAPSHOT);
+    setResponse(r);
+
+    // The callback should not run inline, since the lock is held
+    part_->snapshot_->sendSnapshot(part_, addr_)
+        .via(part_->executor_.get())
+        .then([self = shared_from_this()] (StatusOr<std::pair<LogID, TermID>>&& res) {
+            std::lock_guard<std::mutex> g(self->lock_);
+            self->sendingSnapshot_ = false;
+            if (!res.ok()) {
+                LOG(ERROR) << self->idStr_ << "Failed to send the snapshot: " << res.status()
+                           << ", it will be sent again later";
+                return;
+            }
+            // Replicate the logs after the snapshot
+            auto committed = res.value();
+            self->lastLogIdSent_ = committed.first;
+            self->lastLogTermSent_ = committed.second;
+            self->lastLogIdInFlight_ = committed.first;
+            self->lastLogTermInFlight_ = committed.second;
+            LOG(INFO) << self->idStr_ << "The snapshot has been sent, resume from the log "
+                      << committed.first + 1;
+        });
+}
+
+
+Host::RequestList Host::fillWindow() {
+    CHECK(!lock_.try_lock());
+    RequestList reqs;
+    size_t window = std::max(FLAGS_max_inflight_appendlog_requests, 1U);
+    while (inFlight_.size() < window && lastLogIdInFlight_ < logIdToSend_) {
+        auto firstLogId = part_->wal()->firstLogId();
+        if (firstLogId == 0 || lastLogIdInFlight_ + 1 < firstLogId) {
+            startSendSnapshot();
+            break;
+        }
+        auto req = prepareAppendLogRequest();
+        InFlightRequest inFlight;
+        inFlight.seq_ = nextSeq_++;
+        inFlight.lastLogId_ = lastLogIdInFlight_ + req->get_log_str_list().size();
+        inFlight.lastLogTerm_ = req->get_log_term();
+        lastLogIdInFlight_ = inFlight.lastLogId_;
+        lastLogTermInFlight_ = inFlight.lastLogTerm_;
+        reqs.emplace_back(inFlight.seq_, std::move(req));
+        inFlight_.emplace_back(std::move(inFlight));
+    }
+    return reqs;
+}
+
+
+void Host::appendLogsInternal(folly::EventBase* eb, RequestList reqs) {
+    for (auto& req : reqs) {
+        sendAppendLogRequest(eb, std::move(req.second)).via(eb).then(
+                [eb, seq = req.first, self = shared_from_this()]
+                (folly::Try<cpp2::AppendLogResponse>&& t) {
+            VLOG(3) << self->idStr_ << "appendLogs() call got response";
+            cpp2::AppendLogResponse resp;
+            if (t.hasException()) {
+                LOG(ERROR) << self->idStr_ << t.exception().what();
+                resp.set_error_code(cpp2::ErrorCode::E_EXCEPTION);
+            } else {
+                resp = std::move(t).value();
+            }
+
+            RequestList newReqs;
+            bool noMoreRequest = false;
             {
                 std::lock_guard<std::mutex> g(self->lock_);
-                self->setResponse(r);
+                newReqs = self->onResponse(seq, std::move(resp));
+                noMoreRequest = self->inFlight_.empty();
             }
-            self->noMoreRequestCV_.notify_all();
-            return r;
-        }
+            if (!newReqs.empty()) {
+                self->appendLogsInternal(eb, std::move(newReqs));
+            } else if (noMoreRequest) {
+                self->noMoreRequestCV_.notify_all();
+            }
+        });
+    }
+}
 
-        cpp2::AppendLogResponse resp = std::move(t).value();
-        VLOG(3) << self->idStr_ << "AppendLogResponse "
-                << "code " << static_cast<int32_t>(resp.get_error_code())
-                << ", currTerm " << resp.get_current_term()
-                << ", lastLogId " << resp.get_last_log_id()
-                << ", lastLogTerm " << resp.get_last_log_term()
-                << ", commitLogId " << resp.get_committed_log_id();
-        switch (resp.get_error_code()) {
-            case cpp2::ErrorCode::SUCCEEDED: {
-                VLOG(2) << self->idStr_
-                        << "AppendLog request sent successfully";
 
-                std::shared_ptr<cpp2::AppendLogRequest> newReq;
-                cpp2::AppendLogResponse r;
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    auto res = self->checkStatus();
-                    if (res != cpp2::ErrorCode::SUCCEEDED) {
-                        VLOG(2) << self->idStr_
-                                << "The host is not in a proper status,"
-                                   " just return";
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else {
-                        self->lastLogIdSent_ = resp.get_last_log_id();
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        if (self->lastLogIdSent_ < self->logIdToSend_) {
-                            // More to send
-                            VLOG(2) << self->idStr_
-                                    << "There are more logs to send";
-                            newReq = self->prepareAppendLogRequest();
-                        } else {
-                            VLOG(2) << self->idStr_
-                                    << "Fulfill the promise, size = " << self->promise_.size();
-                            // Fulfill the promise
-                            self->promise_.setValue(resp);
-
-                            if (self->noRequest()) {
-                                VLOG(2) << self->idStr_ << "No request any more!";
-                                self->requestOnGoing_ = false;
-                            } else {
-                                auto& tup = self->pendingReq_;
-                                self->logTermToSend_ = std::get<0>(tup);
-                                self->logIdToSend_ = std::get<1>(tup);
-                                self->committedLogId_ = std::get<2>(tup);
-                                VLOG(2) << self->idStr_
-                                        << "Sending the pending request in the queue"
-                                        << ", from " << self->lastLogIdSent_ + 1
-                                        << " to " << self->logIdToSend_;
-                                newReq = self->prepareAppendLogRequest();
-                                self->promise_ = std::move(self->cachingPromise_);
-                                self->cachingPromise_
-                                    = folly::SharedPromise<cpp2::AppendLogResponse>();
-                                self->pendingReq_ = std::make_tuple(0, 0, 0, 0, 0);
-                            }
-                        }
-
-                        r = std::move(resp);
-                    }
-                }
+Host::RequestList Host::onResponse(uint64_t seq, cpp2::AppendLogResponse resp) {
+    CHECK(!lock_.try_lock());
+    CHECK(!inFlight_.empty());
+    // The sequences in flight are consecutive
+    auto& inFlight = inFlight_[seq - inFlight_.front().seq_];
+    CHECK_EQ(seq, inFlight.seq_);
+    inFlight.resp_ = std::move(resp);
+
+    while (!inFlight_.empty() && inFlight_.front().resp_.hasValue()) {
+        auto req = std::move(inFlight_.front());
+        inFlight_.pop_front();
+        if (req.discarded_) {
+            continue;
+        }
 
-                if (newReq) {
-                    self->appendLogsInternal(eb, newReq);
-                } else {
-                    self->noMoreRequestCV_.notify_all();
-                }
-                return r;
+        auto& r = req.resp_.value();
+        VLOG(3) << idStr_ << "AppendLogResponse "
+                << "code " << static_cast<int32_t>(r.get_error_code())
+                << ", currTerm " << r.get_current_term()
+                << ", lastLogId " << r.get_last_log_id()
+                << ", lastLogTerm " << r.get_last_log_term()
+                << ", commitLogId " << r.get_committed_log_id();
+        auto res = checkStatus();
+        if (res != cpp2::ErrorCode::SUCCEEDED) {
+            VLOG(2) << idStr_ << "The host is not in a proper status, just return";
+            r.set_error_code(res);
+            setResponse(r);
+            continue;
+        }
+
+        switch (r.get_error_code()) {
+            case cpp2::ErrorCode::SUCCEEDED: {
+                VLOG(2) << idStr_ << "AppendLog request sent successfully";
+                lastLogIdSent_ = req.lastLogId_;
+                lastLogTermSent_ = req.lastLogTerm_;
+                setResponse(lastLogIdSent_, r);
+                break;
             }
             case cpp2::ErrorCode::E_LOG_GAP: {
-                VLOG(2) << self->idStr_
-                        << "The host's log is behind, need to catch up";
-                std::shared_ptr<cpp2::AppendLogRequest> newReq;
-                cpp2::AppendLogResponse r;
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    auto res = self->checkStatus();
-                    if (res != cpp2::ErrorCode::SUCCEEDED) {
-                        VLOG(2) << self->idStr_
-                                << "The host is not in a proper status,"
-                                   " skip catching up the gap";
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else {
-                        self->lastLogIdSent_ = resp.get_last_log_id();
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        newReq = self->prepareAppendLogRequest();
-                        r = std::move(resp);
-                    }
+                VLOG(2) << idStr_ << "The host's log is behind, need to catch up";
+                // The requests after it would fail too, send the logs again from the last one
+                // of the host. It might have been reported before some previous requests were
+                // received, so it is no more than the last log accepted.
+                discardInFlight();
+                if (r.get_last_log_id() < lastLogIdSent_) {
+                    lastLogIdSent_ = r.get_last_log_id();
+                    lastLogTermSent_ = r.get_last_log_term();
                 }
-                if (newReq) {
-                    self->appendLogsInternal(eb, newReq);
-                } else {
-                    self->noMoreRequestCV_.notify_all();
-                }
-                return r;
+                lastLogIdInFlight_ = lastLogIdSent_;
+                lastLogTermInFlight_ = lastLogTermSent_;
+                break;
             }
             default: {
                 PLOG_EVERY_N(ERROR, 100)
-                           << self->idStr_
+                           << idStr_
                            << "Failed to append logs to the host (Err: "
-                           << static_cast<int32_t>(resp.get_error_code())
+                           << static_cast<int32_t>(r.get_error_code())
                            << ")";
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    self->setResponse(resp);
-                }
-                self->noMoreRequestCV_.notify_all();
-                return resp;
+                setResponse(r);
+                break;
             }
         }
-    });
+    }
+
+    if (promises_.empty()) {
+        VLOG(2) << idStr_ << "No request any more!";
+        return {};
+    }
+    return fillWindow();
 }
 
 
@@ -329,33 +383,31 @@ Host::prepareAppendLogRequest() const {
     req->set_leader_ip(part_->address().first);
     req->set_leader_port(part_->address().second);
     req->set_committed_log_id(committedLogId_);
-    req->set_last_log_term_sent(lastLogTermSent_);
-    req->set_last_log_id_sent(lastLogIdSent_);
+    req->set_last_log_term_sent(lastLogTermInFlight_);
+    req->set_last_log_id_sent(lastLogIdInFlight_);
 
     VLOG(2) << idStr_ << "Prepare AppendLogs request from Log "
-                      << lastLogIdSent_ + 1 << " to " << logIdToSend_;
-    auto it = part_->wal()->iterator(lastLogIdSent_ + 1, logIdToSend_);
-    if (it->valid()) {
-        VLOG(2) << idStr_ << "Prepare the list of log entries to send";
-
-        auto term = it->logTerm();
-        req->set_log_term(term);
-
-        std::vector<cpp2::LogEntry> logs;
-        for (size_t cnt = 0;
-             it->valid()
-                && it->logTerm() == term
-                && cnt < FLAGS_max_appendlog_batch_size;
-             ++(*it), ++cnt) {
-            cpp2::LogEntry le;
-            le.set_cluster(it->logSource());
-            le.set_log_str(it->logMsg().toString());
-            logs.emplace_back(std::move(le));
-        }
-        req->set_log_str_list(std::move(logs));
-    } else {
-        LOG(FATAL) << idStr_ << "We have not support snapshot yet";
+                      << lastLogIdInFlight_ + 1 << " to " << logIdToSend_;
+    auto it = part_->wal()->iterator(lastLogIdInFlight_ + 1, logIdToSend_);
+    // The caller has checked the logs are in the WAL
+    CHECK(it->valid()) << idStr_ << "The log " << lastLogIdInFlight_ + 1 << " is missing";
+    VLOG(2) << idStr_ << "Prepare the list of log entries to send";
+
+    auto term = it->logTerm();
+    req->set_log_term(term);
+
+    std::vector<cpp2::LogEntry> logs;
+    for (size_t cnt = 0;
+         it->valid()
+            && it->logTerm() == term
+            && cnt < FLAGS_max_appendlog_batch_size;
+         ++(*it), ++cnt) {
+        cpp2::LogEntry le;
+        le.set_cluster(it->logSource());
+        le.set_log_str(it->logMsg().toString());
+        logs.emplace_back(std::move(le));
     }
+    req->set_log_str_list(std::move(logs));
 
     return req;
 }
@@ -390,12 +442,6 @@ folly::Future<cpp2::AppendLogResponse> Host::sendAppendLogRequest(
     return client->future_appendLog(*req);
 }
 
-bool Host::noRequest() const {
-    CHECK(!lock_.try_lock());
-    static auto emptyTup = std::make_tuple(0, 0, 0, 0, 0);
-    return pendingReq_ == emptyTup;
-}
-
 }  // namespace raftex
 }  // namespace nebula
 
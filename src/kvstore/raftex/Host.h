@@ -61,7 +61,8 @@ public:
     folly::Future<cpp2::AskForVoteResponse> askForVote(
         const cpp2::AskForVoteRequest& req);
 
-    // When logId == lastLogIdSent, it is a heartbeat
+    // Send the logs up to logId after the ones in flight. If they are being sent
+    // already, e.g. sent again by the leader, it waits for the ongoing requests
     folly::Future<cpp2::AppendLogResponse> appendLogs(
         folly::EventBase* eb,
         TermID term,                // Current term
@@ -75,20 +76,53 @@ public:
     }
 
 private:
+    // An AppendLog request which has been sent, but not responded yet
+    struct InFlightRequest {
+        uint64_t seq_;
+        // The last log in the request, and its term
+        LogID lastLogId_;
+        TermID lastLogTerm_;
+        // The requests after a failed one are discarded, their responses are just ignored
+        bool discarded_{false};
+        // The response is held until the ones of all the previous requests have been handled
+        folly::Optional<cpp2::AppendLogResponse> resp_;
+    };
+
+    using RequestList = std::vector<std::pair<uint64_t, std::shared_ptr<cpp2::AppendLogRequest>>>;
+
     cpp2::ErrorCode checkStatus() const;
 
     folly::Future<cpp2::AppendLogResponse> sendAppendLogRequest(
         folly::EventBase* eb,
         std::shared_ptr<cpp2::AppendLogRequest> req);
 
-    void appendLogsInternal(
-        folly::EventBase* eb,
-        std::shared_ptr<cpp2::AppendLogRequest> req);
+    void appendLogsInternal(folly::EventBase* eb, RequestList reqs);
+
+    /**
+     * Handle the response of the request `seq'. The responses are handled in the order
+     * the requests were sent, so the ones arrived early wait for the previous ones.
+     * It returns the requests to send next.
+     * */
+    RequestList onResponse(uint64_t seq, cpp2::AppendLogResponse resp);
+
+    /**
+     * Prepare the requests for the logs not sent yet, as many as the window allows.
+     * */
+    RequestList fillWindow();
 
+    // Prepare the request of the logs right after lastLogIdInFlight_
     std::shared_ptr<cpp2::AppendLogRequest> prepareAppendLogRequest() const;
 
-    bool noRequest() const;
+    // Discard all the requests in flight
+    void discardInFlight();
 
+    // Send the snapshot instead, since the logs after lastLogIdInFlight_ are not in the WAL
+    void startSendSnapshot();
+
+    // Fulfill the promises waiting for the logs up to logId
+    void setResponse(LogID logId, const cpp2::AppendLogResponse& r);
+
+    // Fulfill all the promises
     void setResponse(const cpp2::AppendLogResponse& r);
 
     thrift::ThriftClientManager<cpp2::RaftexServiceAsyncClient>& tcManager() {
@@ -97,9 +131,6 @@ private:
     }
 
 private:
-    // <term, logId, committedLogId, lastLogTermSent, lastLogIdSent>
-    using Request = std::tuple<TermID, LogID, LogID, TermID, LogID>;
-
     std::shared_ptr<RaftPart> part_;
     const HostAddr addr_;
     bool isLearner_ = false;
@@ -109,22 +140,28 @@ private:
 
     bool paused_{false};
     bool stopped_{false};
+    bool sendingSnapshot_{false};
 
-    bool requestOnGoing_{false};
+    // In the order of sending, at most FLAGS_max_inflight_appendlog_requests ones
+    std::deque<InFlightRequest> inFlight_;
+    uint64_t nextSeq_{0};
     std::condition_variable noMoreRequestCV_;
-    folly::SharedPromise<cpp2::AppendLogResponse> promise_;
-    folly::SharedPromise<cpp2::AppendLogResponse> cachingPromise_;
-
-    Request pendingReq_{0, 0, 0, 0, 0};
+    // Each promise is fulfilled when the host has accepted the logs up to its log id,
+    // in the ascending order of the log id
+    std::deque<std::pair<LogID, folly::SharedPromise<cpp2::AppendLogResponse>>> promises_;
 
     // These logId and term pointing to the latest log we need to send
     LogID logIdToSend_{0};
     TermID logTermToSend_{0};
 
-    // The previous log before this batch
+    // The last log the host has accepted
     LogID lastLogIdSent_{0};
     TermID lastLogTermSent_{0};
 
+    // The last log of the requests in flight, the next request starts right after it
+    LogID lastLogIdInFlight_{0};
+    TermID lastLogTermInFlight_{0};
+
     LogID committedLogId_{0};
 };
 
@@ -0,0 +1,43 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef RAFTEX_PIPELINESTATS_H_
+#define RAFTEX_PIPELINESTATS_H_
+
+#include "base/Base.h"
+
+namespace nebula {
+namespace raftex {
+
+/**
+ * The stats of the write pipeline on the leader. Raftex only reports them, it is up to
+ * the user where they go, e.g. the storage service reports them to the StatsManager.
+ * The latencies are in microseconds.
+ * */
+class PipelineStats {
+public:
+    virtual ~PipelineStats() = default;
+
+    // Appending a batch to the WAL
+    virtual void appendWal(int64_t latencyUs) = 0;
+
+    // Replicating a batch to the quorum, since it is written to the WAL
+    virtual void replicate(int64_t latencyUs) = 0;
+
+    // A committed batch waiting in the apply queue
+    virtual void applyWait(int64_t latencyUs) = 0;
+
+    // Applying a batch to the state machine
+    virtual void apply(int64_t latencyUs) = 0;
+
+    // The apply queue is full, no more batch is sent until it has room
+    virtual void applyQueueFull() = 0;
+};
+
+}  // namespace raftex
+}  // namespace nebula
+
+#endif  // RAFTEX_PIPELINESTATS_H_
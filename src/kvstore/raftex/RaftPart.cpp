@@ -15,6 +15,7 @@
 #include "network/NetworkUtils.h"
 #include "thread/NamedThread.h"
 #include "kvstore/wal/FileBasedWal.h"
+#include "kvstore/wal/SharedWal.h"
 #include "kvstore/raftex/LogStrListIterator.h"
 #include "kvstore/raftex/Host.h"
 
@@ -24,6 +25,17 @@ DEFINE_bool(accept_log_append_during_pulling, false,
 DEFINE_uint32(raft_heartbeat_interval_secs, 5,
              "Seconds between each heartbeat");
 DEFINE_uint32(max_batch_size, 256, "The max number of logs in a batch");
+DEFINE_uint64(max_batch_bytes, 16 * 1024 * 1024, "The max bytes of the logs in a batch");
+DEFINE_uint64(max_waiting_bytes, 64 * 1024 * 1024,
+              "The max bytes of the logs waiting for the next batch when the current one "
+              "is full, beyond which the logs are rejected with a retry-after hint");
+DEFINE_uint32(max_replicating_batches, 4,
+              "The max number of batches being replicated at the same time, the next batch "
+              "is sent before the previous ones are committed. 1 means sending the next batch "
+              "after the previous one is committed");
+DEFINE_uint32(max_apply_queue_size, 16,
+              "The max number of committed batches waiting to be applied on the leader, "
+              "no more batch is sent when the queue is full until it has room");
 
 DEFINE_int32(wal_ttl, 86400, "Default wal ttl");
 DEFINE_int64(wal_file_size, 128 * 1024 * 1024, "Default wal file size");
@@ -39,6 +51,25 @@ using nebula::thrift::ThriftClientManager;
 using nebula::wal::FileBasedWal;
 using nebula::wal::FileBasedWalPolicy;
 
+namespace {
+
+// Return the future of the log just added to the promises
+template<class Promises>
+folly::Future<AppendLogResult> getLogFuture(Promises& promises, LogType logType) {
+    switch (logType) {
+        case LogType::ATOMIC_OP:
+            return promises.getSingleFuture();
+        case LogType::COMMAND:
+            return promises.getAndRollSharedFuture();
+        case LogType::NORMAL:
+            return promises.getSharedFuture();
+    }
+    LOG(FATAL) << "Unknown log type " << static_cast<int32_t>(logType);
+    return folly::Future<AppendLogResult>::makeEmpty();
+}
+
+}  // Anonymous namespace
+
 class AppendLogsIterator final : public LogIterator {
 public:
     AppendLogsIterator(LogID firstLogId,
@@ -50,12 +81,8 @@ public:
             , logId_(firstLogId)
             , logs_(std::move(logs))
             , opCB_(std::move(opCB)) {
-        leadByAtomicOp_ = processAtomicOp();
-        valid_ = idx_ < logs_.size();
-        hasNonAtomicOpLogs_ = !leadByAtomicOp_ && valid_;
-        if (valid_) {
-            currLogType_ = lastLogType_ = logType();
-        }
+        // The first batch is started by resume(), so the AtomicOp leading it is
+        // evaluated when the logs before it have been committed
     }
 
     AppendLogsIterator(const AppendLogsIterator&) = delete;
@@ -72,6 +99,11 @@ public:
         return hasNonAtomicOpLogs_;
     }
 
+    // Whether the logs iterated end up with a COMMAND log
+    bool hasCommandLog() const {
+        return hasCommandLog_;
+    }
+
     LogID firstLogId() const {
         return firstLogId_;
     }
@@ -113,6 +145,9 @@ public:
             }
             valid_ = valid_ && lastLogType_ != LogType::COMMAND;
             lastLogType_ = currLogType_;
+            if (valid_ && currLogType_ == LogType::COMMAND) {
+                hasCommandLog_ = true;
+            }
         } else {
             valid_ = false;
         }
@@ -153,6 +188,11 @@ public:
         return idx_ >= logs_.size();
     }
 
+    // Whether the next batch, started by resume(), is led by an AtomicOp
+    bool nextIsAtomicOp() const {
+        return !valid_ && !empty() && logType() == LogType::ATOMIC_OP;
+    }
+
     // Resume the iterator so that we can continue to process the remaining logs
     void resume() {
         CHECK(!valid_);
@@ -163,6 +203,7 @@ public:
             if (valid_) {
                 currLogType_ = lastLogType_ = logType();
             }
+            hasCommandLog_ = valid_ && currLogType_ == LogType::COMMAND;
         }
     }
 
@@ -174,7 +215,8 @@ private:
     size_t idx_{0};
     bool leadByAtomicOp_{false};
     bool hasNonAtomicOpLogs_{false};
-    bool valid_{true};
+    bool hasCommandLog_{false};
+    bool valid_{false};
     LogType lastLogType_{LogType::NORMAL};
     LogType currLogType_{LogType::NORMAL};
     std::string opResult_;
@@ -198,7 +240,10 @@ RaftPart::RaftPart(ClusterID clusterId,
                    const folly::StringPiece walRoot,
                    std::shared_ptr<folly::IOThreadPoolExecutor> pool,
                    std::shared_ptr<thread::GenericThreadPool> workers,
-                   std::shared_ptr<folly::Executor> executor)
+                   std::shared_ptr<folly::Executor> executor,
+                   std::shared_ptr<SnapshotManager> snapshot,
+                   std::shared_ptr<wal::SharedWal> sharedWal,
+                   std::shared_ptr<PipelineStats> stats)
         : idStr_{folly::stringPrintf("[Port: %d, Space: %d, Part: %d] ",
                                      localAddr.second, spaceId, partId)}
         , clusterId_{clusterId}
@@ -210,27 +255,33 @@ RaftPart::RaftPart(ClusterID clusterId,
         , leader_{0, 0}
         , ioThreadPool_{pool}
         , bgWorkers_{workers}
-        , executor_(executor) {
-    FileBasedWalPolicy policy;
-    policy.ttl = FLAGS_wal_ttl;
-    policy.fileSize = FLAGS_wal_file_size;
-    policy.bufferSize = FLAGS_wal_buffer_size;
-    policy.numBuffers = FLAGS_wal_buffer_num;
-    wal_ = FileBasedWal::getWal(walRoot,
-                                policy,
-                                [this] (LogID logId,
-                                        TermID logTermId,
-                                        ClusterID logClusterId,
-                                        const std::string& log) {
-                                    return this->preProcessLog(logId,
-                                                               logTermId,
-                                                               logClusterId,
-                                                               log);
-                                });
+        , executor_(executor)
+        , snapshot_(snapshot)
+        , stats_(std::move(stats)) {
+    // All the batches are replicated on the same event base, so the hosts are called
+    // in the order of the batches
+    eb_ = ioThreadPool_->getEventBase();
+    auto preProcessor = [this] (LogID logId,
+                                TermID logTermId,
+                                ClusterID logClusterId,
+                                const std::string& log) {
+        return this->preProcessLog(logId, logTermId, logClusterId, log);
+    };
+    if (sharedWal != nullptr) {
+        wal_ = sharedWal->partWal(spaceId, partId, std::move(preProcessor));
+    } else {
+        FileBasedWalPolicy policy;
+        policy.ttl = FLAGS_wal_ttl;
+        policy.fileSize = FLAGS_wal_file_size;
+        policy.bufferSize = FLAGS_wal_buffer_size;
+        policy.numBuffers = FLAGS_wal_buffer_num;
+        wal_ = FileBasedWal::getWal(walRoot, policy, std::move(preProcessor));
+    }
     lastLogId_ = wal_->lastLogId();
     lastLogTerm_ = wal_->lastLogTerm();
     logs_.reserve(FLAGS_max_batch_size);
     CHECK(!!executor_) << idStr_ << "Should not be nullptr";
+    CHECK(!!snapshot_) << idStr_ << "Should not be nullptr";
 }
 
 
@@ -273,7 +324,7 @@ void RaftPart::start(std::vector<HostAddr>&& peers, bool asLearner) {
                         << ", as learner " << asLearner;
 
     auto logIdAndTerm = lastCommittedLogId();
-    committedLogId_ = logIdAndTerm.first;
+    committedLogId_ = appliedLogId_ = logIdAndTerm.first;
     term_ = proposedTerm_ = logIdAndTerm.second;
 
     if (lastLogId_ < committedLogId_) {
@@ -451,32 +502,31 @@ folly::Future<AppendLogResult> RaftPart::appendLogAsync(ClusterID source,
 
         VLOG(2) << idStr_ << "Checking whether buffer overflow";
 
-        if (logs_.size() >= FLAGS_max_batch_size) {
-            // Buffer is full
-            LOG(WARNING) << idStr_
-                         << "The appendLog buffer is full."
-                            " Please slow down the log appending rate."
-                         << "replicatingLogs_ :" << replicatingLogs_;
-            bufferOverFlow_ = true;
-            return AppendLogResult::E_BUFFER_OVERFLOW;
+        if (!waitingLogs_.empty() || !hasRoomInBuffer(log.size())) {
+            // Buffer is full, the log waits until the batch being replicated is done
+            if (waitingBytes_ + log.size() > FLAGS_max_waiting_bytes) {
+                LOG(WARNING) << idStr_
+                             << "The appendLog buffer is full."
+                                " Please slow down the log appending rate."
+                             << "replicatingLogs_ :" << replicatingLogs_;
+                bufferOverFlow_ = true;
+                return AppendLogResult::E_BUFFER_OVERFLOW;
+            }
+            VLOG(2) << idStr_ << "The appendLog buffer is full, waiting for the room";
+            DCHECK_GE(source, 0);
+            waitingBytes_ += log.size();
+            waitingLogs_.emplace_back(
+                WaitingLog{source, logType, std::move(log), std::move(op), {}});
+            return waitingLogs_.back().promise.getFuture();
         }
 
         VLOG(2) << idStr_ << "Appending logs to the buffer";
 
         // Append new logs to the buffer
         DCHECK_GE(source, 0);
+        logsBytes_ += log.size();
         logs_.emplace_back(source, logType, std::move(log), std::move(op));
-        switch (logType) {
-            case LogType::ATOMIC_OP:
-                retFuture = cachingPromise_.getSingleFuture();
-                break;
-            case LogType::COMMAND:
-                retFuture = cachingPromise_.getAndRollSharedFuture();
-                break;
-            case LogType::NORMAL:
-                retFuture = cachingPromise_.getSharedFuture();
-                break;
-        }
+        retFuture = getLogFuture(cachingPromise_, logType);
 
         bool expected = false;
         if (replicatingLogs_.compare_exchange_strong(expected, true)) {
@@ -485,6 +535,7 @@ folly::Future<AppendLogResult> RaftPart::appendLogAsync(ClusterID source,
             sendingPromise_ = std::move(cachingPromise_);
             cachingPromise_.reset();
             std::swap(swappedOutLogs, logs_);
+            logsBytes_ = 0;
             bufferOverFlow_ = false;
         } else {
             VLOG(2) << idStr_
@@ -521,34 +572,111 @@ folly::Future<AppendLogResult> RaftPart::appendLogAsync(ClusterID source,
         termId,
         std::move(swappedOutLogs),
         [this] (AtomicOp opCB) -> std::string {
-            CHECK(opCB != nullptr);
-            auto opRet = opCB();
-            if (opRet.empty()) {
-                // Failed
-                sendingPromise_.setOneSingleValue(AppendLogResult::E_ATOMIC_OP_FAILURE);
-            }
-            return opRet;
+            return evalAtomicOp(std::move(opCB));
         });
     appendLogsInternal(std::move(it), termId);
 
     return retFuture;
 }
 
+std::string RaftPart::evalAtomicOp(AtomicOp op) {
+    CHECK(op != nullptr);
+    // The op reads the state machine, so the logs before it need to be applied
+    applyCommittedLogs();
+    auto opRet = op();
+    if (opRet.empty()) {
+        // Failed
+        sendingPromise_.setOneSingleValue(AppendLogResult::E_ATOMIC_OP_FAILURE);
+    }
+    return opRet;
+}
+
+
+bool RaftPart::readyToSend(const AppendLogsIterator& iter) const {
+    CHECK(!batchesLock_.try_lock());
+    if (applyQueueFull()) {
+        // The apply stage falls behind, the batches are held back until it has room,
+        // see drainApplyQueue()
+        return false;
+    }
+    bool afterCommand = std::any_of(batches_.begin(), batches_.end(), [] (const auto& b) {
+        return b.hasCommandLog;
+    });
+    if (afterCommand || iter.nextIsAtomicOp()) {
+        // The command takes effect when it is applied, and the AtomicOp reads the state
+        // machine, so all the logs before them need to be committed first
+        return batches_.empty();
+    }
+    return batches_.size() < std::max(FLAGS_max_replicating_batches, 1U);
+}
+
+
 void RaftPart::appendLogsInternal(AppendLogsIterator iter, TermID termId) {
-    TermID currTerm = 0;
-    LogID prevLogId = 0;
-    TermID prevLogTerm = 0;
-    LogID committed = 0;
-    LogID lastId = 0;
-    if (iter.valid()) {
-        VLOG(2) << idStr_ << "Ready to append logs from id "
-                << iter.logId() << " (Current term is "
-                << currTerm << ")";
-    } else {
-        LOG(ERROR) << idStr_ << "Only happend when Atomic op failed";
-        replicatingLogs_ = false;
-        return;
+    // Send the batches one after another, without waiting for the previous ones to be
+    // committed, until there is no log left or the next batch has to wait
+    while (true) {
+        if (iter.empty()) {
+            LogCache logs;
+            {
+                std::lock_guard<std::mutex> lck(logsLock_);
+                VLOG(2) << idStr_ << "logs size " << logs_.size();
+                if (logs_.empty()) {
+                    replicatingLogs_ = false;
+                    VLOG(2) << idStr_ << "No more log to be replicated";
+                    return;
+                }
+                // continue to replicate the logs
+                sendingPromise_ = std::move(cachingPromise_);
+                cachingPromise_.reset();
+                std::swap(logs, logs_);
+                logsBytes_ = 0;
+                // Make room for the logs waiting
+                admitWaitingLogs();
+                bufferOverFlow_ = false;
+            }
+            LogID firstId = 0;
+            {
+                std::lock_guard<std::mutex> g(raftLock_);
+                firstId = lastLogId_ + 1;
+            }
+            iter = AppendLogsIterator(
+                firstId,
+                termId,
+                std::move(logs),
+                [this] (AtomicOp op) -> std::string {
+                    return evalAtomicOp(std::move(op));
+                });
+        }
+
+        {
+            std::lock_guard<std::mutex> lck(batchesLock_);
+            if (!readyToSend(iter)) {
+                // It is sent when the batches before it are committed, see commitBatches(),
+                // or the apply queue has room, see drainApplyQueue()
+                VLOG(2) << idStr_ << "Wait for the batches being replicated";
+                parkedIter_ = std::make_unique<AppendLogsIterator>(std::move(iter));
+                parkedTerm_ = termId;
+                return;
+            }
+        }
+
+        // The AtomicOps leading the batch are evaluated here
+        iter.resume();
+        if (!iter.valid()) {
+            VLOG(2) << idStr_ << "All the AtomicOps failed";
+            continue;
+        }
+        if (!sendBatch(iter, termId)) {
+            return;
+        }
     }
+}
+
+
+bool RaftPart::sendBatch(AppendLogsIterator& iter, TermID termId) {
+    VLOG(2) << idStr_ << "Ready to append logs from id " << iter.logId()
+            << " (Current term is " << termId << ")";
+    ReplicatingBatch batch;
     AppendLogResult res = AppendLogResult::SUCCEEDED;
     do {
         std::lock_guard<std::mutex> g(raftLock_);
@@ -571,40 +699,57 @@ void RaftPart::appendLogsInternal(AppendLogsIterator iter, TermID termId) {
             res = AppendLogResult::E_TERM_OUT_OF_DATE;
             break;
         }
-        currTerm = term_;
-        prevLogId = lastLogId_;
-        prevLogTerm = lastLogTerm_;
-        committed = committedLogId_;
+        batch.term = term_;
+        batch.prevLogId = lastLogId_;
+        batch.prevLogTerm = lastLogTerm_;
+        batch.committedId = committedLogId_;
         // Step 1: Write WAL
+        batch.batchDur.reset();
+        time::Duration walDur;
         if (!wal_->appendLogs(iter)) {
             LOG(ERROR) << idStr_ << "Failed to write into WAL";
             res = AppendLogResult::E_WAL_FAILURE;
             break;
         }
-        lastId = wal_->lastLogId();
+        if (stats_ != nullptr) {
+            stats_->appendWal(walDur.elapsedInUSec());
+        }
+        batch.replicateDur.reset();
+        // The next batch follows the logs written, before they are committed
+        lastLogId_ = wal_->lastLogId();
+        lastLogTerm_ = term_;
+        batch.lastLogId = lastLogId_;
         VLOG(2) << idStr_ << "Succeeded writing logs ["
-                << iter.firstLogId() << ", " << lastId << "] to WAL";
+                << iter.firstLogId() << ", " << batch.lastLogId << "] to WAL";
     } while (false);
 
     if (!checkAppendLogResult(res)) {
         LOG(ERROR) << idStr_ << "Failed append logs";
-        return;
+        return false;
     }
-    // Step 2: Replicate to followers
-    auto* eb = ioThreadPool_->getEventBase();
-    replicateLogs(eb,
-                  std::move(iter),
-                  currTerm,
-                  lastId,
-                  committed,
-                  prevLogTerm,
-                  prevLogId);
-    return;
+
+    batch.hasCommandLog = iter.hasCommandLog();
+    if (iter.hasNonAtomicOpLogs()) {
+        sendingPromise_.moveOneSharedTo(batch.promises);
+    }
+    if (iter.leadByAtomicOp()) {
+        sendingPromise_.moveOneSingleTo(batch.promises);
+    }
+    {
+        std::lock_guard<std::mutex> lck(batchesLock_);
+        batch.sendSeq = nextSendSeq_++;
+        batches_.emplace_back(std::move(batch));
+        auto& b = batches_.back();
+        // Step 2: Replicate to followers. The hosts are called in the order of the
+        // batches, on the same event base
+        replicateLogs(b.sendSeq, b.term, b.lastLogId, b.committedId, b.prevLogTerm,
+                      b.prevLogId);
+    }
+    return true;
 }
 
 
-void RaftPart::replicateLogs(folly::EventBase* eb,
-                             AppendLogsIterator iter,
+void RaftPart::replicateLogs(uint64_t sendSeq,
                              TermID currTerm,
                              LogID lastLogId,
                              LogID committedId,
@@ -613,34 +758,14 @@ void RaftPart::replicateLogs(folly::EventBase* eb,
     using namespace folly;  // NOLINT since the fancy overload of | operator
 
     decltype(hosts_) hosts;
-    AppendLogResult res = AppendLogResult::SUCCEEDED;
-    do {
+    {
         std::lock_guard<std::mutex> g(raftLock_);
-
-        if (status_ != Status::RUNNING) {
-            // The partition is not running
-            VLOG(2) << idStr_ << "The partition is stopped";
-            res = AppendLogResult::E_STOPPED;
-            break;
-        }
-
-        if (role_ != Role::LEADER) {
-            // Is not a leader any more
-            VLOG(2) << idStr_ << "The leader has changed";
-            res = AppendLogResult::E_NOT_A_LEADER;
-            break;
-        }
-
         hosts = hosts_;
-    } while (false);
-
-    if (!checkAppendLogResult(res)) {
-        LOG(ERROR) << idStr_ << "Replicate logs failed";
-        return;
     }
 
     VLOG(2) << idStr_ << "About to replicate logs to all peer hosts";
 
+    auto* eb = eb_;
     collectNSucceeded(
         gen::from(hosts)
         | gen::map([self = shared_from_this(),
@@ -671,150 +796,182 @@ void RaftPart::replicateLogs(folly::EventBase* eb,
                     && !hosts[index]->isLearner();
         })
         .then(executor_.get(), [self = shared_from_this(),
-                   eb,
-                   it = std::move(iter),
-                   currTerm,
-                   lastLogId,
-                   committedId,
-                   prevLogId,
-                   prevLogTerm,
-                   pHosts = std::move(hosts)] (folly::Try<AppendLogResponses>&& result) mutable {
+                                sendSeq,
+                                pHosts = std::move(hosts)]
+                               (folly::Try<AppendLogResponses>&& result) mutable {
             VLOG(2) << self->idStr_ << "Received enough response";
             CHECK(!result.hasException());
 
-            self->processAppendLogResponses(*result,
-                                            eb,
-                                            std::move(it),
-                                            currTerm,
-                                            lastLogId,
-                                            committedId,
-                                            prevLogTerm,
-                                            prevLogId,
-                                            std::move(pHosts));
+            // Make sure majority have succeeded
+            size_t numSucceeded = 0;
+            for (auto& res : *result) {
+                if (!pHosts[res.first]->isLearner()
+                        && res.second.get_error_code() == cpp2::ErrorCode::SUCCEEDED) {
+                    ++numSucceeded;
+                }
+            }
+            VLOG(2) << self->idStr_ << numSucceeded << " hosts have accepted the logs";
+            self->onBatchReplicated(sendSeq, numSucceeded >= self->quorum_);
 
             return *result;
         });
 }
 
 
-void RaftPart::processAppendLogResponses(
-        const AppendLogResponses& resps,
-        folly::EventBase* eb,
-        AppendLogsIterator iter,
-        TermID currTerm,
-        LogID lastLogId,
-        LogID committedId,
-        TermID prevLogTerm,
-        LogID prevLogId,
-        std::vector<std::shared_ptr<Host>> hosts) {
-    // Make sure majority have succeeded
-    size_t numSucceeded = 0;
-    for (auto& res : resps) {
-        if (!hosts[res.first]->isLearner()
-                && res.second.get_error_code() == cpp2::ErrorCode::SUCCEEDED) {
-            ++numSucceeded;
+void RaftPart::onBatchReplicated(uint64_t sendSeq, bool accepted) {
+    {
+        std::lock_guard<std::mutex> lck(batchesLock_);
+        bool found = false;
+        for (auto& batch : batches_) {
+            if (batch.sendSeq == sendSeq) {
+                batch.accepted = accepted;
+                found = true;
+            }
+        }
+        if (!found || committingBatches_) {
+            // The batch has been sent again, or failed, or the batches before it
+            // are being committed, which commit it too
+            return;
         }
+        committingBatches_ = true;
     }
+    commitBatches();
+}
 
-    if (numSucceeded >= quorum_) {
-        // Majority have succeeded
-        VLOG(2) << idStr_ << numSucceeded
-                << " hosts have accepted the logs";
-
-        LogID firstLogId = 0;
-        AppendLogResult res = AppendLogResult::SUCCEEDED;
-        do {
-            std::lock_guard<std::mutex> g(raftLock_);
-            if (status_ != Status::RUNNING) {
-                LOG(INFO) << idStr_ << "The partition is stopped";
-                res = AppendLogResult::E_STOPPED;
+
+void RaftPart::commitBatches() {
+    // The batches are committed in the order they were sent
+    std::unique_ptr<AppendLogsIterator> iter;
+    TermID termId = 0;
+    while (true) {
+        ReplicatingBatch* batch = nullptr;
+        {
+            std::lock_guard<std::mutex> lck(batchesLock_);
+            if (batches_.empty() || !batches_.front().accepted.hasValue()) {
+                committingBatches_ = false;
+                if (parkedIter_ != nullptr && readyToSend(*parkedIter_)) {
+                    iter = std::move(parkedIter_);
+                    termId = parkedTerm_;
+                }
                 break;
             }
-            if (role_ != Role::LEADER) {
-                LOG(INFO) << idStr_ << "The leader has changed";
-                res = AppendLogResult::E_NOT_A_LEADER;
-                break;
+            // Only the committing thread pops the batches, so the reference is kept
+            batch = &batches_.front();
+        }
+
+        AppendLogResult res;
+        if (batch->accepted.value()) {
+            res = commitBatch(*batch);
+        } else {
+            res = resendBatches();
+            if (res == AppendLogResult::SUCCEEDED) {
+                return;
             }
-            if (currTerm != term_) {
-                LOG(INFO) << idStr_ << "The leader has changed, ABA problem.";
-                res = AppendLogResult::E_TERM_OUT_OF_DATE;
-                break;
+        }
+
+        std::unique_ptr<AppendLogsIterator> failedIter;
+        {
+            std::lock_guard<std::mutex> lck(batchesLock_);
+            if (res == AppendLogResult::SUCCEEDED) {
+                batches_.pop_front();
+                continue;
+            }
+            // The leadership has changed, the batches of the term fail, the ones of a
+            // later term are committed as usual
+            auto term = batch->term;
+            while (!batches_.empty() && batches_.front().term == term) {
+                batches_.front().promises.setValue(res);
+                batches_.pop_front();
             }
-            lastLogId_ = lastLogId;
-            lastLogTerm_ = currTerm;
+            if (parkedIter_ != nullptr && parkedTerm_ == term) {
+                failedIter = std::move(parkedIter_);
+            }
+        }
+        if (failedIter != nullptr) {
+            // The logs waiting to be sent fail too
+            LOG(ERROR) << idStr_ << "Failed to commit the logs";
+            checkAppendLogResult(res);
+        }
+    }
 
-            lastMsgSentDur_.reset();
+    if (iter != nullptr) {
+        appendLogsInternal(std::move(*iter), termId);
+    }
+}
 
-            auto walIt = wal_->iterator(committedId + 1, lastLogId);
-            // Step 3: Commit the batch
-            if (commitLogs(std::move(walIt))) {
-                committedLogId_ = lastLogId;
-                firstLogId = lastLogId_ + 1;
-            } else {
-                LOG(FATAL) << idStr_ << "Failed to commit logs";
-            }
-            VLOG(2) << idStr_ << "Leader succeeded in committing the logs "
-                              << committedId + 1 << " to " << lastLogId;
-        } while (false);
 
-        if (!checkAppendLogResult(res)) {
-            LOG(ERROR) << idStr_ << "processAppendLogResponses failed!";
-            return;
+AppendLogResult RaftPart::resendBatches() {
+    std::lock_guard<std::mutex> lck(batchesLock_);
+    auto& first = batches_.front();
+    auto& last = batches_.back();
+    {
+        std::lock_guard<std::mutex> g(raftLock_);
+        auto res = canAppendLogs();
+        if (res != AppendLogResult::SUCCEEDED) {
+            return res;
         }
-        // Step 4: Fulfill the promise
-        if (iter.hasNonAtomicOpLogs()) {
-            sendingPromise_.setOneSharedValue(AppendLogResult::SUCCEEDED);
+        if (term_ != first.term) {
+            LOG(INFO) << idStr_ << "The leader has changed, ABA problem.";
+            return AppendLogResult::E_TERM_OUT_OF_DATE;
         }
-        if (iter.leadByAtomicOp()) {
-            sendingPromise_.setOneSingleValue(AppendLogResult::SUCCEEDED);
+    }
+    // Send all the batches not committed again, up to the last one, whose result
+    // commits all of them
+    LOG(WARNING) << idStr_ << "Not enough hosts accepted the logs up to " << first.lastLogId
+                 << ", need to try again up to " << last.lastLogId;
+    auto sendSeq = nextSendSeq_++;
+    for (auto& b : batches_) {
+        b.sendSeq = sendSeq;
+        b.accepted.clear();
+    }
+    committingBatches_ = false;
+    replicateLogs(sendSeq, last.term, last.lastLogId, first.committedId,
+                  first.prevLogTerm, first.prevLogId);
+    return AppendLogResult::SUCCEEDED;
+}
+
+
+AppendLogResult RaftPart::commitBatch(ReplicatingBatch& batch) {
+    do {
+        std::lock_guard<std::mutex> g(raftLock_);
+        if (status_ != Status::RUNNING) {
+            LOG(INFO) << idStr_ << "The partition is stopped";
+            return AppendLogResult::E_STOPPED;
         }
-        // Step 5: Check whether need to continue
-        // the log replication
-        CHECK(replicatingLogs_);
-        // Continue to process the original AppendLogsIterator if necessary
-        iter.resume();
-        if (iter.empty()) {
-            std::lock_guard<std::mutex> lck(logsLock_);
-            VLOG(2) << idStr_ << "logs size " << logs_.size();
-            if (logs_.size() > 0) {
-                // continue to replicate the logs
-                sendingPromise_ = std::move(cachingPromise_);
-                cachingPromise_.reset();
-                iter = AppendLogsIterator(
-                    firstLogId,
-                    currTerm,
-                    std::move(logs_),
-                    [this] (AtomicOp op) -> std::string {
-                        auto opRet = op();
-                        if (opRet.empty()) {
-                            // Failed
-                            sendingPromise_.setOneSingleValue(
-                                AppendLogResult::E_ATOMIC_OP_FAILURE);
-                        }
-                        return opRet;
-                    });
-                logs_.clear();
-                bufferOverFlow_ = false;
-            } else {
-                replicatingLogs_ = false;
-                VLOG(2) << idStr_ << "No more log to be replicated";
-            }
+        if (role_ != Role::LEADER) {
+            LOG(INFO) << idStr_ << "The leader has changed";
+            return AppendLogResult::E_NOT_A_LEADER;
         }
-        if (!iter.empty()) {
-           this->appendLogsInternal(std::move(iter), currTerm);
+        if (batch.term != term_) {
+            LOG(INFO) << idStr_ << "The leader has changed, ABA problem.";
+            return AppendLogResult::E_TERM_OUT_OF_DATE;
         }
-    } else {
-        // Not enough hosts accepted the log, re-try
-        LOG(WARNING) << idStr_ << "Only " << numSucceeded
-                     << " hosts succeeded, Need to try again";
-        replicateLogs(eb,
-                      std::move(iter),
-                      currTerm,
-                      lastLogId,
-                      committedId,
-                      prevLogTerm,
-                      prevLogId);
+
+        lastMsgSentDur_.reset();
+        if (stats_ != nullptr) {
+            stats_->replicate(batch.replicateDur.elapsedInUSec());
+        }
+        batchDurMs_ = batch.batchDur.elapsedInMSec();
+
+        // Step 3: Commit the batch, it will be applied to the state machine
+        // by the apply stage
+        VLOG(2) << idStr_ << "Leader succeeded in committing the logs "
+                          << committedLogId_ + 1 << " to " << batch.lastLogId;
+        committedLogId_ = batch.lastLogId;
+        if (batch.hasCommandLog) {
+            lastCommandLogId_ = batch.lastLogId;
+        }
+    } while (false);
+
+    // Step 4: Hand the batch over to the apply stage, which fulfills
+    // the promise after applying it
+    enqueueApply(batch.lastLogId, std::move(batch.promises));
+    if (batch.hasCommandLog) {
+        // The command takes effect when it is applied, e.g. the leader gives up
+        // the leadership, so it should be applied before the logs after it
+        applyCommittedLogs();
     }
+    return AppendLogResult::SUCCEEDED;
 }
 
 
@@ -1186,7 +1343,10 @@ void RaftPart::processAppendLogRequest(
         return;
     }
     // Check leadership
-    cpp2::ErrorCode err = verifyLeader(req, g);
+    cpp2::ErrorCode err = verifyLeader(req.get_current_term(),
+                                       req.get_leader_ip(),
+                                       req.get_leader_port(),
+                                       g);
     if (err != cpp2::ErrorCode::SUCCEEDED) {
         // Wrong leadership
         VLOG(2) << idStr_ << "Will not follow the leader";
@@ -1197,22 +1357,24 @@ void RaftPart::processAppendLogRequest(
     // Reset the timeout timer
     lastMsgRecvDur_.reset();
 
-    // TODO Check snapshot pulling status
-//      if (hasSnapshot && !isPullingSnapshot()) {
-//          // We need to pull the snapshot
-//          startSnapshotPullingThread(std::move(req.get_snapshot_uri()));
-//      }
-//      if (isPullingSnapshot()) {
-//          CHECK_NE(oldRole, Role::LEADER);
-//          resp.set_pulling_snapshot(true);
-//          if (!FLAGS_accept_log_append_during_pulling) {
-//              VLOG(2) << idStr_
-//                      << "Pulling the snapshot and not allowed to accept"
-//                         " the LogAppend Requests";
-//              resp.set_error_code(cpp2::ErrorCode::E_PULLING_SNAPSHOT);
-//              return;
-//          }
-//      }
+    // When the logs needed have been removed from the leader's WAL, the leader sends
+    // a snapshot instead, see processSendSnapshotRequest()
+
+    // The leader sends several requests at a time, so one could arrive after the ones
+    // sent later. If its logs have been appended, just skip it, rather than rolling back
+    // the logs after them.
+    LogID lastLogIdInReq = req.get_last_log_id_sent() + req.get_log_str_list().size();
+    if (req.get_last_log_id_sent() < lastLogId_
+            && !req.get_log_str_list().empty()
+            && lastLogIdInReq <= lastLogId_) {
+        auto it = wal_->iterator(lastLogIdInReq, lastLogIdInReq);
+        if (it->valid() && it->logTerm() == req.get_log_term()) {
+            VLOG(2) << idStr_ << "The logs [" << req.get_last_log_id_sent() + 1
+                    << ", " << lastLogIdInReq << "] have been appended, skip them";
+            resp.set_error_code(cpp2::ErrorCode::SUCCEEDED);
+            return;
+        }
+    }
 
     if (req.get_last_log_id_sent() < committedLogId_) {
         LOG(INFO) << idStr_ << "The log " << req.get_last_log_id_sent()
@@ -1275,7 +1437,10 @@ void RaftPart::processAppendLogRequest(
         // follower can't always commit to leader's commit id because of lack of log
         LogID lastLogIdCanCommit = std::min(lastLogId_, req.get_committed_log_id());
         CHECK(committedLogId_ + 1 <= lastLogIdCanCommit);
-        if (commitLogs(wal_->iterator(committedLogId_ + 1, lastLogIdCanCommit))) {
+        // The logs committed when it was the leader could be still waiting
+        // to be applied, they are applied together
+        std::lock_guard<std::mutex> lck(appliedLock_);
+        if (applyLogs(lastLogIdCanCommit)) {
             VLOG(2) << idStr_ << "Follower succeeded committing log "
                               << committedLogId_ + 1 << " to "
                               << lastLogIdCanCommit;
@@ -1294,17 +1459,128 @@ void RaftPart::processAppendLogRequest(
 }
 
 
+void RaftPart::processSendSnapshotRequest(
+        const cpp2::SendSnapshotRequest& req,
+        cpp2::SendSnapshotResponse& resp) {
+    VLOG(2) << idStr_
+            << "Received snapshot " << req.get_snapshot_id()
+            << ": term = " << req.get_term()
+            << ", leaderIp = " << req.get_leader_ip()
+            << ", leaderPort = " << req.get_leader_port()
+            << ", num_rows = " << req.get_rows().size()
+            << ", done = " << req.get_done();
+
+    std::lock_guard<std::mutex> g(raftLock_);
+
+    // Check status
+    if (UNLIKELY(status_ == Status::STOPPED)) {
+        VLOG(2) << idStr_ << "The part has been stopped, skip the request";
+        resp.set_error_code(cpp2::ErrorCode::E_BAD_STATE);
+        return;
+    }
+    if (UNLIKELY(status_ == Status::STARTING)) {
+        VLOG(2) << idStr_ << "The partition is still starting";
+        resp.set_error_code(cpp2::ErrorCode::E_NOT_READY);
+        return;
+    }
+    // Check leadership, the snapshot is from a leader of a newer term if the part has
+    // missed its election, then the part follows it, the same as receiving the logs
+    auto err = verifyLeader(req.get_term(), req.get_leader_ip(), req.get_leader_port(), g);
+    if (err != cpp2::ErrorCode::SUCCEEDED) {
+        LOG(INFO) << idStr_ << "The snapshot is from the term " << req.get_term()
+                  << ", will not follow the leader";
+        resp.set_error_code(err);
+        return;
+    }
+    if (req.get_snapshot_id() < snapshotId_) {
+        LOG(INFO) << idStr_ << "The snapshot " << req.get_snapshot_id()
+                  << " is older than the one being received " << snapshotId_;
+        resp.set_error_code(cpp2::ErrorCode::E_LOG_STALE);
+        return;
+    }
+
+    // Reset the timeout timer, the leader sends no heartbeat during sending the snapshot
+    lastMsgRecvDur_.reset();
+
+    if (req.get_snapshot_id() > snapshotId_) {
+        // A new snapshot, drop all the rows and logs, replace them with the snapshot
+        LOG(INFO) << idStr_ << "Start receiving the snapshot " << req.get_snapshot_id()
+                  << " from " << NetworkUtils::intToIPv4(req.get_leader_ip())
+                  << ":" << req.get_leader_port();
+        {
+            // Wait for the logs being applied, the batches waiting to be applied
+            // are dropped along with the logs
+            std::lock_guard<std::mutex> lck(appliedLock_);
+            if (!cleanup()) {
+                LOG(ERROR) << idStr_ << "Failed to clean up the part";
+                resp.set_error_code(cpp2::ErrorCode::E_PERSIST_SNAPSHOT_FAILED);
+                return;
+            }
+            appliedLogId_ = 0;
+            applyEpoch_++;
+        }
+        wal_->reset();
+        lastLogId_ = 0;
+        lastLogTerm_ = 0;
+        committedLogId_ = 0;
+        snapshotId_ = req.get_snapshot_id();
+        snapshotRows_ = 0;
+        snapshotSize_ = 0;
+    }
+
+    if (!req.get_done()) {
+        if (!commitSnapshot(req.get_rows(), 0, 0, false)) {
+            LOG(ERROR) << idStr_ << "Failed to write the rows of the snapshot";
+            resp.set_error_code(cpp2::ErrorCode::E_PERSIST_SNAPSHOT_FAILED);
+            return;
+        }
+        snapshotRows_ += req.get_rows().size();
+        for (auto& row : req.get_rows()) {
+            snapshotSize_ += row.size();
+        }
+        resp.set_error_code(cpp2::ErrorCode::SUCCEEDED);
+        return;
+    }
+
+    if (req.get_total_count() != snapshotRows_ || req.get_total_size() != snapshotSize_) {
+        LOG(ERROR) << idStr_ << "Received " << snapshotRows_ << " rows, " << snapshotSize_
+                   << " bytes of the snapshot, but " << req.get_total_count() << " rows, "
+                   << req.get_total_size() << " bytes have been sent";
+        resp.set_error_code(cpp2::ErrorCode::E_PERSIST_SNAPSHOT_FAILED);
+        return;
+    }
+    if (!commitSnapshot({}, req.get_committed_log_id(), req.get_committed_log_term(), true)) {
+        LOG(ERROR) << idStr_ << "Failed to commit the snapshot";
+        resp.set_error_code(cpp2::ErrorCode::E_PERSIST_SNAPSHOT_FAILED);
+        return;
+    }
+    // The logs are replicated right after the snapshot
+    lastLogId_ = committedLogId_ = req.get_committed_log_id();
+    {
+        std::lock_guard<std::mutex> lck(appliedLock_);
+        appliedLogId_ = committedLogId_;
+    }
+    lastLogTerm_ = req.get_committed_log_term();
+    LOG(INFO) << idStr_ << "Finished receiving the snapshot " << snapshotId_
+              << ", " << snapshotRows_ << " rows, " << snapshotSize_ << " bytes"
+              << ", committed to the log " << committedLogId_;
+    resp.set_error_code(cpp2::ErrorCode::SUCCEEDED);
+}
+
+
 cpp2::ErrorCode RaftPart::verifyLeader(
-        const cpp2::AppendLogRequest& req,
+        TermID leaderTerm,
+        IPv4 leaderIp,
+        Port leaderPort,
         std::lock_guard<std::mutex>& lck) {
     VLOG(2) << idStr_ << "The current role is " << roleStr(role_);
     UNUSED(lck);
     switch (role_) {
         case Role::LEARNER:
         case Role::FOLLOWER: {
-            if (req.get_current_term() == term_ &&
-                req.get_leader_ip() == leader_.first &&
-                req.get_leader_port() == leader_.second) {
+            if (leaderTerm == term_ &&
+                leaderIp == leader_.first &&
+                leaderPort == leader_.second) {
                 VLOG(3) << idStr_ << "Same leader";
                 return cpp2::ErrorCode::SUCCEEDED;
             }
@@ -1324,7 +1600,7 @@ cpp2::ErrorCode RaftPart::verifyLeader(
     }
 
     // Make sure the remote term is greater than local's
-    if (req.get_current_term() < term_) {
+    if (leaderTerm < term_) {
         PLOG_EVERY_N(ERROR, 100) << idStr_
                                  << "The current role is " << roleStr(role_)
                                  << ". The local term is " << term_
@@ -1332,7 +1608,7 @@ cpp2::ErrorCode RaftPart::verifyLeader(
         return cpp2::ErrorCode::E_TERM_OUT_OF_DATE;
     }
     if (role_ == Role::FOLLOWER || role_ == Role::LEARNER) {
-        if (req.get_current_term() == term_ && leader_ != std::make_pair(0, 0)) {
+        if (leaderTerm == term_ && leader_ != std::make_pair(0, 0)) {
             LOG(ERROR) << idStr_ << "The local term is same as remote term " << term_
                        << ". But I believe leader exists.";
             return cpp2::ErrorCode::E_TERM_OUT_OF_DATE;
@@ -1344,16 +1620,15 @@ cpp2::ErrorCode RaftPart::verifyLeader(
     // Ok, no reason to refuse, just follow the leader
     LOG(INFO) << idStr_ << "The current role is " << roleStr(role_)
               << ". Will follow the new leader "
-              << network::NetworkUtils::intToIPv4(req.get_leader_ip())
-              << ":" << req.get_leader_port()
-              << " [Term: " << req.get_current_term() << "]";
+              << network::NetworkUtils::intToIPv4(leaderIp)
+              << ":" << leaderPort
+              << " [Term: " << leaderTerm << "]";
 
     if (role_ != Role::LEARNER) {
         role_ = Role::FOLLOWER;
     }
-    leader_ = std::make_pair(req.get_leader_ip(),
-                             req.get_leader_port());
-    term_ = proposedTerm_ = req.get_current_term();
+    leader_ = std::make_pair(leaderIp, leaderPort);
+    term_ = proposedTerm_ = leaderTerm;
     if (oldRole == Role::LEADER) {
         // Need to invoke onLostLeadership callback
         VLOG(2) << idStr_ << "Was a leader, need to do some clean-up";
@@ -1391,8 +1666,14 @@ bool RaftPart::checkAppendLogResult(AppendLogResult res) {
         {
             std::lock_guard<std::mutex> lck(logsLock_);
             logs_.clear();
+            logsBytes_ = 0;
             cachingPromise_.setValue(res);
             cachingPromise_.reset();
+            for (auto& w : waitingLogs_) {
+                w.promise.setValue(res);
+            }
+            waitingLogs_.clear();
+            waitingBytes_ = 0;
             bufferOverFlow_ = false;
         }
         sendingPromise_.setValue(res);
@@ -1403,6 +1684,185 @@ bool RaftPart::checkAppendLogResult(AppendLogResult res) {
 }
 
 
+bool RaftPart::hasRoomInBuffer(size_t logSize) const {
+    CHECK(!logsLock_.try_lock());
+    if (logs_.size() >= FLAGS_max_batch_size) {
+        return false;
+    }
+    // One log is always allowed, no matter how large it is
+    return logs_.empty() || logsBytes_ + logSize <= FLAGS_max_batch_bytes;
+}
+
+
+void RaftPart::admitWaitingLogs() {
+    CHECK(!logsLock_.try_lock());
+    while (!waitingLogs_.empty() && hasRoomInBuffer(waitingLogs_.front().log.size())) {
+        auto& w = waitingLogs_.front();
+        waitingBytes_ -= w.log.size();
+        logsBytes_ += w.log.size();
+        logs_.emplace_back(w.source, w.type, std::move(w.log), std::move(w.op));
+        getLogFuture(cachingPromise_, w.type)
+            .then([promise = std::move(w.promise)] (AppendLogResult res) mutable {
+                promise.setValue(res);
+            });
+        waitingLogs_.pop_front();
+    }
+}
+
+
+int32_t RaftPart::retryAfterMs() const {
+    size_t waitingBytes = 0;
+    {
+        std::lock_guard<std::mutex> lck(logsLock_);
+        waitingBytes = waitingBytes_;
+    }
+    // The batch being replicated, the one in the buffer, and the ones waiting
+    int64_t batches = 2 + waitingBytes / std::max<uint64_t>(FLAGS_max_batch_bytes, 1);
+    int64_t ms = std::max<int64_t>(batchDurMs_, 1) * batches;
+    return static_cast<int32_t>(std::min<int64_t>(ms, std::numeric_limits<int32_t>::max()));
+}
+
+
+bool RaftPart::applyLogs(LogID lastId) {
+    CHECK(!appliedLock_.try_lock());
+    if (lastId <= appliedLogId_) {
+        return true;
+    }
+    if (!commitLogs(wal_->iterator(appliedLogId_ + 1, lastId))) {
+        return false;
+    }
+    appliedLogId_ = lastId;
+    return true;
+}
+
+
+void RaftPart::enqueueApply(LogID lastLogId, PromiseSet<AppendLogResult>&& promises) {
+    ApplyTask task;
+    task.lastLogId = lastLogId;
+    task.promises = std::move(promises);
+
+    bool full = false;
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lck(applyLock_);
+        applyQueue_.emplace_back(std::move(task));
+        // The batches being replicated are still queued beyond the limit, but no more
+        // batch is sent, see readyToSend()
+        full = applyQueue_.size() == std::max(FLAGS_max_apply_queue_size, 1U);
+        if (!applying_) {
+            applying_ = true;
+            schedule = true;
+        }
+    }
+
+    if (full) {
+        VLOG(2) << idStr_ << "The apply queue is full, hold the batches after "
+                << lastLogId << " back until it has room";
+        if (stats_ != nullptr) {
+            stats_->applyQueueFull();
+        }
+    }
+    if (schedule) {
+        executor_->add([self = shared_from_this()] {
+            self->drainApplyQueue();
+        });
+    }
+}
+
+
+bool RaftPart::applyQueueFull() const {
+    std::lock_guard<std::mutex> lck(applyLock_);
+    return !applyQueue_.empty() && applyQueue_.size() >= FLAGS_max_apply_queue_size;
+}
+
+
+void RaftPart::drainApplyQueue() {
+    while (true) {
+        ApplyTask task;
+        {
+            std::lock_guard<std::mutex> lck(applyLock_);
+            if (applyQueue_.empty()) {
+                applying_ = false;
+                return;
+            }
+            task = std::move(applyQueue_.front());
+            applyQueue_.pop_front();
+        }
+        // The logs held back by the full queue could be sent along with applying the batch
+        resumeParkedLogs();
+        applyTask(task);
+    }
+}
+
+
+void RaftPart::resumeParkedLogs() {
+    std::unique_ptr<AppendLogsIterator> iter;
+    TermID termId = 0;
+    {
+        std::lock_guard<std::mutex> lck(batchesLock_);
+        if (parkedIter_ == nullptr || !readyToSend(*parkedIter_)) {
+            return;
+        }
+        iter = std::move(parkedIter_);
+        termId = parkedTerm_;
+    }
+    executor_->add([self = shared_from_this(), iter = std::move(iter), termId] () mutable {
+        self->appendLogsInternal(std::move(*iter), termId);
+    });
+}
+
+
+void RaftPart::applyTask(ApplyTask& task) {
+    if (stats_ != nullptr) {
+        stats_->applyWait(task.waitDur.elapsedInUSec());
+    }
+    time::Duration applyDur;
+    applyCommittedLogs(task.lastLogId);
+    if (stats_ != nullptr) {
+        stats_->apply(applyDur.elapsedInUSec());
+    }
+    VLOG(2) << idStr_ << "Leader succeeded in applying the logs up to " << task.lastLogId;
+    // Fulfill the promises of the batch
+    task.promises.setValue(AppendLogResult::SUCCEEDED);
+}
+
+
+void RaftPart::applyCommittedLogs(LogID lastId) {
+    int64_t epoch = 0;
+    LogID lastCommandLogId = 0;
+    {
+        // The logs could have been applied, when the ones after them are
+        // needed in the state machine, or the leadership has changed
+        std::lock_guard<std::mutex> g(raftLock_);
+        lastId = std::min(lastId, committedLogId_);
+        lastCommandLogId = lastCommandLogId_;
+        epoch = applyEpoch_;
+    }
+
+    std::unique_lock<std::mutex> raftGuard(raftLock_, std::defer_lock);
+    std::unique_lock<std::mutex> appliedGuard(appliedLock_);
+    if (lastCommandLogId > appliedLogId_) {
+        // The COMMAND logs change the state of the partition, e.g. the role, so the
+        // raftLock_ is needed to apply them, which is taken before the appliedLock_
+        appliedGuard.unlock();
+        raftGuard.lock();
+        appliedGuard.lock();
+    }
+    if (epoch != applyEpoch_) {
+        // The logs have been replaced by a snapshot
+        return;
+    }
+    if (!applyLogs(lastId)) {
+        LOG(FATAL) << idStr_ << "Failed to commit logs";
+    }
+}
+
+
+void RaftPart::applyCommittedLogs() {
+    applyCommittedLogs(std::numeric_limits<LogID>::max());
+}
+
+
 }  // namespace raftex
 }  // namespace nebula
 
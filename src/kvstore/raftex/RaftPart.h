@@ -8,12 +8,15 @@
 #define RAFTEX_RAFTPART_H_
 
 #include "base/Base.h"
+#include "base/StatusOr.h"
 #include <folly/futures/SharedPromise.h>
+#include <folly/Optional.h>
 #include <folly/Function.h>
 #include "gen-cpp2/raftex_types.h"
 #include "time/Duration.h"
 #include "thread/GenericThreadPool.h"
 #include "base/LogIterator.h"
+#include "kvstore/raftex/PipelineStats.h"
 
 namespace folly {
 class IOThreadPoolExecutor;
@@ -23,7 +26,8 @@ class EventBase;
 namespace nebula {
 
 namespace wal {
-class FileBasedWal;
+class Wal;
+class SharedWal;
 }  // namespace wal
 
 
@@ -56,6 +60,7 @@ enum class LogType {
 
 class Host;
 class AppendLogsIterator;
+class SnapshotManager;
 
 /**
  * The operation will be atomic, if the operation failed, empty string will be returned,
@@ -64,9 +69,15 @@ class AppendLogsIterator;
  * */
 using AtomicOp = folly::Function<std::string(void)>;
 
+/**
+ * It is called with each row of a snapshot, and returns false to stop the scan.
+ * */
+using SnapshotCallback = folly::Function<bool(std::string&& row)>;
+
 class RaftPart : public std::enable_shared_from_this<RaftPart> {
     friend class AppendLogsIterator;
     friend class Host;
+    friend class SnapshotManager;
 public:
     virtual ~RaftPart();
 
@@ -116,7 +127,7 @@ public:
         return leader_;
     }
 
-    std::shared_ptr<wal::FileBasedWal> wal() const {
+    std::shared_ptr<wal::Wal> wal() const {
         return wal_;
     }
 
@@ -161,6 +172,13 @@ public:
      * */
     folly::Future<AppendLogResult> sendCommandAsync(std::string log);
 
+    /**
+     * The suggested time (in milliseconds) to wait before appending logs again,
+     * after E_BUFFER_OVERFLOW is returned. It is about the time to replicate
+     * the logs buffered.
+     * */
+    int32_t retryAfterMs() const;
+
 
 
     /*****************************************************
@@ -178,9 +196,17 @@ public:
         const cpp2::AppendLogRequest& req,
         cpp2::AppendLogResponse& resp);
 
+    // Process a chunk of the snapshot
+    void processSendSnapshotRequest(
+        const cpp2::SendSnapshotRequest& req,
+        cpp2::SendSnapshotResponse& resp);
+
 
 protected:
     // Protected constructor to prevent from instantiating directly
+    // The logs are written to the sharedWal if it is not null,
+    // otherwise to a FileBasedWal under the walRoot.
+    // The stats of the write pipeline are reported to the stats if it is not null
     RaftPart(ClusterID clusterId,
              GraphSpaceID spaceId,
              PartitionID partId,
@@ -188,7 +214,10 @@ protected:
              const folly::StringPiece walRoot,
              std::shared_ptr<folly::IOThreadPoolExecutor> pool,
              std::shared_ptr<thread::GenericThreadPool> workers,
-             std::shared_ptr<folly::Executor> executor);
+             std::shared_ptr<folly::Executor> executor,
+             std::shared_ptr<SnapshotManager> snapshot,
+             std::shared_ptr<wal::SharedWal> sharedWal,
+             std::shared_ptr<PipelineStats> stats);
 
     const char* idStr() const {
         return idStr_.c_str();
@@ -220,6 +249,26 @@ protected:
                                ClusterID clusterId,
                                const std::string& log) = 0;
 
+    // The inherited classes need to implement the methods below to transfer snapshots
+    //
+    // Pass all the rows of the state machine to the callback, each of which is encoded
+    // as the inherited class likes. It returns the id and term of the last log committed
+    // in the rows, the rows could include a few later logs, since applying them again
+    // gets the same result. An error is returned if the rows could not be read completely.
+    virtual StatusOr<std::pair<LogID, TermID>>
+    accessAllRowsInSnapshot(SnapshotCallback cb) = 0;
+
+    // Remove all the rows of the state machine, and the committed log id,
+    // before receiving a snapshot
+    virtual bool cleanup() = 0;
+
+    // Write the rows of a snapshot. When it is finished, the id and term of the last log
+    // committed in the snapshot should be persisted too.
+    virtual bool commitSnapshot(const std::vector<std::string>& rows,
+                                LogID committedLogId,
+                                TermID committedLogTerm,
+                                bool finished) = 0;
+
 private:
     enum class Status {
         STARTING = 0,   // The part is starting, not ready for service
@@ -259,7 +308,11 @@ private:
      ***************************************************/
     const char* roleStr(Role role) const;
 
-    cpp2::ErrorCode verifyLeader(const cpp2::AppendLogRequest& req,
+    // Check the leader of the request, which is followed if it is of a newer term,
+    // e.g. it sends the logs or a snapshot
+    cpp2::ErrorCode verifyLeader(TermID leaderTerm,
+                                 IPv4 leaderIp,
+                                 Port leaderPort,
                                  std::lock_guard<std::mutex>& lck);
 
     /*****************************************************************
@@ -302,28 +355,22 @@ private:
                                                   std::string log,
                                                   AtomicOp cb = nullptr);
 
+    // Send the batches of the iterator, and then the logs appended meanwhile, until no
+    // log is left, or the next batch has to wait for the batches being replicated
     void appendLogsInternal(AppendLogsIterator iter, TermID termId);
 
+    // Evaluate the AtomicOp leading a batch, on the state machine with all the logs
+    // before it applied
+    std::string evalAtomicOp(AtomicOp op);
+
     void replicateLogs(
-        folly::EventBase* eb,
-        AppendLogsIterator iter,
+        uint64_t sendSeq,
         TermID currTerm,
         LogID lastLogId,
         LogID committedId,
         TermID prevLogTerm,
         LogID prevLogId);
 
-    void processAppendLogResponses(
-        const AppendLogResponses& resps,
-        folly::EventBase* eb,
-        AppendLogsIterator iter,
-        TermID currTerm,
-        LogID lastLogId,
-        LogID committedId,
-        TermID prevLogTerm,
-        LogID prevLogId,
-        std::vector<std::shared_ptr<Host>> hosts);
-
     std::vector<std::shared_ptr<Host>> followers() const;
 
     bool checkAppendLogResult(AppendLogResult res);
@@ -378,6 +425,20 @@ protected:
             sharedPromises_.pop_front();
         }
 
+        // Move the first shared promise to the other set
+        void moveOneSharedTo(PromiseSet& other) {
+            CHECK(!sharedPromises_.empty());
+            other.sharedPromises_.emplace_back(std::move(sharedPromises_.front()));
+            sharedPromises_.pop_front();
+        }
+
+        // Move the first single promise to the other set
+        void moveOneSingleTo(PromiseSet& other) {
+            CHECK(!singlePromises_.empty());
+            other.singlePromises_.emplace_back(std::move(singlePromises_.front()));
+            singlePromises_.pop_front();
+        }
+
         template<class VT>
         void setOneSingleValue(VT&& val) {
             CHECK(!singlePromises_.empty());
@@ -405,7 +466,123 @@ protected:
         std::list<folly::Promise<ValueType>> singlePromises_;
     };
 
+    // A log appended when logs_ is full, it is moved to logs_ when there is room
+    struct WaitingLog {
+        ClusterID source;
+        LogType type;
+        std::string log;
+        AtomicOp op;
+        folly::Promise<AppendLogResult> promise;
+    };
+
+    // A batch written to the WAL, which is being replicated
+    struct ReplicatingBatch {
+        // The batches sent again together share the same sequence
+        uint64_t sendSeq{0};
+        TermID term{0};
+        LogID prevLogId{0};
+        TermID prevLogTerm{0};
+        LogID lastLogId{0};
+        LogID committedId{0};
+        bool hasCommandLog{false};
+        PromiseSet<AppendLogResult> promises;
+        // Whether the quorum accepted the logs, set when enough hosts have responded
+        folly::Optional<bool> accepted;
+        // How long the batch has taken since written to the WAL, and since sent
+        time::Duration batchDur;
+        time::Duration replicateDur;
+    };
 
+    // A batch committed by the quorum, which is waiting to be applied
+    struct ApplyTask {
+        LogID lastLogId{0};
+        PromiseSet<AppendLogResult> promises;
+        // How long the batch has been waiting in the queue
+        time::Duration waitDur;
+    };
+
+private:
+    /****************************************************
+     *
+     * Methods of the replication pipeline
+     *
+     * Up to FLAGS_max_replicating_batches batches are replicated at the
+     * same time, each one is sent right after written to the WAL, and
+     * they are committed in the order of sending. The batches led by an
+     * AtomicOp, or after a COMMAND log, wait until all the batches before
+     * them have been committed. No batch is sent while the apply queue
+     * is full.
+     *
+     ***************************************************/
+    // Whether the next batch of the iterator could be sent now
+    // Pre-condition: The caller needs to hold the batchesLock_
+    bool readyToSend(const AppendLogsIterator& iter) const;
+
+    // Write the current batch of the iterator to the WAL, and replicate it
+    bool sendBatch(AppendLogsIterator& iter, TermID termId);
+
+    // Called when enough hosts have responded to the batches sent with the sequence
+    void onBatchReplicated(uint64_t sendSeq, bool accepted);
+
+    // Commit the batches responded, in the order of sending, and send the batch
+    // waiting if there is room
+    void commitBatches();
+
+    AppendLogResult commitBatch(ReplicatingBatch& batch);
+
+    // Send all the batches not committed again, when the quorum did not accept them
+    AppendLogResult resendBatches();
+
+    /****************************************************
+     *
+     * Methods of the apply stage
+     *
+     * The leader hands each batch committed by the quorum to the
+     * apply stage, and goes on replicating the next batch, while the
+     * batch is applied to the state machine on the executor_. The
+     * promises of the batch are fulfilled after it is applied.
+     *
+     ***************************************************/
+    // Move the waiting logs into logs_, as many as logs_ could hold
+    // Pre-condition: The caller needs to hold the logsLock_
+    void admitWaitingLogs();
+
+    // Whether logs_ could hold one more log of the given size
+    // Pre-condition: The caller needs to hold the logsLock_
+    bool hasRoomInBuffer(size_t logSize) const;
+
+    // Apply the committed logs in (appliedLogId_, lastId] to the state machine
+    // Pre-condition: The caller needs to hold the appliedLock_, and the raftLock_
+    // when there are COMMAND logs in them
+    bool applyLogs(LogID lastId);
+
+    // Queue the batch committed up to the lastLogId, it is applied by drainApplyQueue()
+    void enqueueApply(LogID lastLogId, PromiseSet<AppendLogResult>&& promises);
+
+    // Whether there are max_apply_queue_size batches waiting to be applied, then no more
+    // batch is sent, so that the apply stage is not left behind by the replication
+    bool applyQueueFull() const;
+
+    // Apply the queued batches one by one in order, until the queue is empty
+    void drainApplyQueue();
+
+    // Send the logs parked by the full apply queue, if they could be sent now
+    void resumeParkedLogs();
+
+    // Apply the batch and fulfill its promises
+    void applyTask(ApplyTask& task);
+
+    // Apply the committed logs up to lastId on the leader. The NORMAL logs are applied
+    // without the raftLock_, which is only taken when there are COMMAND logs among them
+    // The caller should **NOT** hold the raftLock_
+    void applyCommittedLogs(LogID lastId);
+
+    // Apply all the committed logs right away, for the ones which need to
+    // see them in the state machine, such as the AtomicOp
+    // The caller should **NOT** hold the raftLock_
+    void applyCommittedLogs();
+
+protected:
     const std::string idStr_;
 
     const ClusterID clusterId_;
@@ -415,12 +592,19 @@ protected:
     std::vector<std::shared_ptr<Host>> hosts_;
     size_t quorum_{0};
 
-    // The lock is used to protect logs_ and cachingPromise_
+    // The lock is used to protect logs_, cachingPromise_ and waitingLogs_
     mutable std::mutex logsLock_;
     std::atomic_bool replicatingLogs_{false};
     std::atomic_bool bufferOverFlow_{false};
     PromiseSet<AppendLogResult> cachingPromise_;
     LogCache logs_;
+    // The bytes of the logs in logs_
+    size_t logsBytes_{0};
+    // The logs waiting for the room in logs_, when it is full
+    std::deque<WaitingLog> waitingLogs_;
+    size_t waitingBytes_{0};
+    // How long the last batch took to be replicated (in ms)
+    std::atomic<int64_t> batchDurMs_{0};
 
     // Partition level lock to synchronize the access of the partition
     mutable std::mutex raftLock_;
@@ -449,6 +633,19 @@ protected:
     TermID lastLogTerm_{0};
     // The id for the last globally committed log (from the leader)
     LogID committedLogId_{0};
+    // The id of the last log of the latest committed batch which has a COMMAND log
+    LogID lastCommandLogId_{0};
+
+    // The lock serializes applying the logs, and protects appliedLogId_ and applyEpoch_,
+    // which are changed with both locks held. It is always taken after the raftLock_
+    std::mutex appliedLock_;
+    // The id of the last log applied to the state machine. On the leader, it falls
+    // behind the committedLogId_ while the batches are waiting in the applyQueue_
+    LogID appliedLogId_{0};
+    // Bumped when the applied logs are reset by a snapshot, so the batches committed
+    // before it are not applied any more
+    int64_t applyEpoch_{0};
+
 
     // To record how long ago when the last leader message received
     time::Duration lastMsgRecvDur_;
@@ -457,7 +654,7 @@ protected:
     time::Duration lastMsgSentDur_;
 
     // Write-ahead Log
-    std::shared_ptr<wal::FileBasedWal> wal_;
+    std::shared_ptr<wal::Wal> wal_;
 
     // IO Thread pool
     std::shared_ptr<folly::IOThreadPoolExecutor> ioThreadPool_;
@@ -465,6 +662,34 @@ protected:
     std::shared_ptr<thread::GenericThreadPool> bgWorkers_;
     // Workers pool
     std::shared_ptr<folly::Executor> executor_;
+
+    std::shared_ptr<SnapshotManager> snapshot_;
+    std::shared_ptr<PipelineStats> stats_;
+    // The snapshot being received, and the number and bytes of the rows received
+    int64_t snapshotId_{0};
+    int64_t snapshotRows_{0};
+    int64_t snapshotSize_{0};
+
+    // The event base to replicate the logs on
+    folly::EventBase* eb_{nullptr};
+    // The lock is used to protect batches_ and parkedIter_. It is taken before the
+    // raftLock_ when both are needed
+    mutable std::mutex batchesLock_;
+    // The batches being replicated, in the order of sending
+    std::deque<ReplicatingBatch> batches_;
+    uint64_t nextSendSeq_{0};
+    // Whether a thread is committing the batches
+    bool committingBatches_{false};
+    // The logs waiting for the batches being replicated or the apply queue, to be sent next
+    std::unique_ptr<AppendLogsIterator> parkedIter_;
+    TermID parkedTerm_{0};
+
+    // The batches committed on the leader, which are waiting to be applied.
+    // The lock is taken after the batchesLock_ when both are needed
+    mutable std::mutex applyLock_;
+    std::deque<ApplyTask> applyQueue_;
+    // Whether a drainApplyQueue() has been scheduled
+    bool applying_{false};
 };
 
 }  // namespace raftex
@@ -213,6 +213,20 @@ void RaftexService::appendLog(
     part->processAppendLogRequest(req, resp);
 }
 
+
+void RaftexService::sendSnapshot(
+        cpp2::SendSnapshotResponse& resp,
+        const cpp2::SendSnapshotRequest& req) {
+    auto part = findPart(req.get_space(), req.get_part());
+    if (!part) {
+        // Not found
+        resp.set_error_code(cpp2::ErrorCode::E_UNKNOWN_PART);
+        return;
+    }
+
+    part->processSendSnapshotRequest(req, resp);
+}
+
 }  // namespace raftex
 }  // namespace nebula
 
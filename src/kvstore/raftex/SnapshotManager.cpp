@@ -0,0 +1,191 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include "kvstore/raftex/SnapshotManager.h"
+#include "kvstore/raftex/RaftPart.h"
+#include "network/NetworkUtils.h"
+#include "time/WallClock.h"
+#include <folly/executors/IOThreadPoolExecutor.h>
+
+DEFINE_int32(snapshot_worker_threads, 4, "Threads number for sending the snapshots");
+DEFINE_int32(snapshot_batch_size, 512 * 1024,
+             "The max bytes of the rows in each request of sending a snapshot");
+DEFINE_int32(snapshot_send_concurrency, 4,
+             "The max number of requests in flight when sending a snapshot to a host");
+DEFINE_int32(snapshot_send_timeout_ms, 60000, "rpc timeout for sending a snapshot");
+
+namespace nebula {
+namespace raftex {
+
+using nebula::network::NetworkUtils;
+
+SnapshotManager::SnapshotManager() {
+    workers_ = std::make_unique<thread::GenericThreadPool>();
+    workers_->start(FLAGS_snapshot_worker_threads, "snapshot-worker");
+}
+
+
+SnapshotManager::~SnapshotManager() {
+    workers_->stop();
+    workers_->wait();
+}
+
+
+folly::SemiFuture<StatusOr<std::pair<LogID, TermID>>> SnapshotManager::sendSnapshot(
+        std::shared_ptr<RaftPart> part,
+        const HostAddr& dst) {
+    return workers_->addTask([this, part = std::move(part), dst] {
+        return doSendSnapshot(part, dst);
+    });
+}
+
+
+StatusOr<std::pair<LogID, TermID>> SnapshotManager::doSendSnapshot(
+        std::shared_ptr<RaftPart> part,
+        const HostAddr& dst) {
+    TermID term;
+    {
+        std::lock_guard<std::mutex> g(part->raftLock_);
+        term = part->term_;
+    }
+    // The later snapshot has the larger id, even from another leader
+    auto snapshotId = time::WallClock::fastNowInMicroSec();
+    auto idStr = folly::stringPrintf("%s[Snapshot %ld to %s:%d] ",
+                                     part->idStr_.c_str(),
+                                     snapshotId,
+                                     NetworkUtils::intToIPv4(dst.first).c_str(),
+                                     dst.second);
+    LOG(INFO) << idStr << "Start sending the snapshot";
+
+    auto newRequest = [&] () {
+        cpp2::SendSnapshotRequest req;
+        req.set_space(part->spaceId());
+        req.set_part(part->partitionId());
+        req.set_term(term);
+        req.set_leader_ip(part->address().first);
+        req.set_leader_port(part->address().second);
+        req.set_snapshot_id(snapshotId);
+        return req;
+    };
+
+    Status status = Status::OK();
+    std::deque<folly::Future<cpp2::SendSnapshotResponse>> inFlight;
+    // Wait for the request sent earliest
+    auto waitOne = [&] () {
+        auto resp = std::move(inFlight.front()).get();
+        inFlight.pop_front();
+        if (resp.get_error_code() != cpp2::ErrorCode::SUCCEEDED && status.ok()) {
+            status = Status::Error("The host failed to accept the snapshot, error %d",
+                                   static_cast<int32_t>(resp.get_error_code()));
+        }
+    };
+
+    // The part could be stopped, e.g. removed from the host, or lose the leadership
+    // while the snapshot is being sent, then it is aborted
+    auto checkPart = [&] () {
+        std::lock_guard<std::mutex> g(part->raftLock_);
+        if (part->status_ != RaftPart::Status::RUNNING) {
+            status = Status::Error("The part has been stopped");
+            return false;
+        }
+        if (part->role_ != RaftPart::Role::LEADER || part->term_ != term) {
+            status = Status::Error("Lost the leadership");
+            return false;
+        }
+        return true;
+    };
+
+    std::vector<std::string> rows;
+    int64_t batchSize = 0;
+    int64_t totalCount = 0;
+    int64_t totalSize = 0;
+    auto sendRows = [&] () {
+        if (!checkPart()) {
+            return false;
+        }
+        auto req = newRequest();
+        req.set_rows(std::move(rows));
+        rows.clear();
+        batchSize = 0;
+        inFlight.emplace_back(send(part, dst, std::move(req)));
+        size_t concurrency = std::max(FLAGS_snapshot_send_concurrency, 1);
+        while (inFlight.size() >= concurrency) {
+            waitOne();
+        }
+        return status.ok();
+    };
+
+    auto committed = part->accessAllRowsInSnapshot([&] (std::string&& row) {
+        totalCount++;
+        totalSize += row.size();
+        batchSize += row.size();
+        rows.emplace_back(std::move(row));
+        if (batchSize >= FLAGS_snapshot_batch_size) {
+            return sendRows();
+        }
+        return true;
+    });
+    if (!committed.ok() && status.ok()) {
+        // Some rows are missing, the snapshot must not be committed
+        status = committed.status();
+    }
+    if (status.ok() && !rows.empty()) {
+        sendRows();
+    }
+    while (!inFlight.empty()) {
+        waitOne();
+    }
+    if (!status.ok()) {
+        LOG(ERROR) << idStr << status;
+        return status;
+    }
+
+    // All the rows have been accepted, commit the snapshot
+    if (!checkPart()) {
+        LOG(ERROR) << idStr << status;
+        return status;
+    }
+    auto req = newRequest();
+    req.set_done(true);
+    req.set_committed_log_id(committed.value().first);
+    req.set_committed_log_term(committed.value().second);
+    req.set_total_count(totalCount);
+    req.set_total_size(totalSize);
+    inFlight.emplace_back(send(part, dst, std::move(req)));
+    waitOne();
+    if (!status.ok()) {
+        LOG(ERROR) << idStr << status;
+        return status;
+    }
+
+    LOG(INFO) << idStr << "Finished sending " << totalCount << " rows, "
+              << totalSize << " bytes, committed to the log " << committed.value().first;
+    return committed;
+}
+
+
+folly::Future<cpp2::SendSnapshotResponse> SnapshotManager::send(
+        std::shared_ptr<RaftPart> part,
+        const HostAddr& dst,
+        cpp2::SendSnapshotRequest req) {
+    auto* evb = part->ioThreadPool_->getEventBase();
+    return folly::via(evb, [this, evb, dst, req = std::move(req)] () mutable {
+        auto client = clientsMan_.client(dst, evb, false, FLAGS_snapshot_send_timeout_ms);
+        return client->future_sendSnapshot(req);
+    }).then([] (folly::Try<cpp2::SendSnapshotResponse>&& t) {
+        if (t.hasException()) {
+            LOG(ERROR) << "Send the snapshot failed: " << t.exception().what();
+            cpp2::SendSnapshotResponse resp;
+            resp.set_error_code(cpp2::ErrorCode::E_EXCEPTION);
+            return resp;
+        }
+        return std::move(t).value();
+    });
+}
+
+}  // namespace raftex
+}  // namespace nebula
@@ -0,0 +1,62 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef RAFTEX_SNAPSHOTMANAGER_H_
+#define RAFTEX_SNAPSHOTMANAGER_H_
+
+#include "base/Base.h"
+#include "base/StatusOr.h"
+#include <folly/futures/Future.h>
+#include "interface/gen-cpp2/raftex_types.h"
+#include "gen-cpp2/RaftexServiceAsyncClient.h"
+#include "thread/GenericThreadPool.h"
+#include "thrift/ThriftClientManager.h"
+
+namespace nebula {
+namespace raftex {
+
+class RaftPart;
+
+/**
+ * It sends the snapshot of a part to the host which is too far behind to catch up by the logs,
+ * i.e. the logs it needs have been removed from the leader's WAL.
+ *
+ * All the rows of the part are scanned on a worker thread, and sent by chunks of
+ * FLAGS_snapshot_batch_size bytes, at most FLAGS_snapshot_send_concurrency chunks at a time.
+ * It is shared by all the parts in a process.
+ * */
+class SnapshotManager final {
+public:
+    SnapshotManager();
+
+    ~SnapshotManager();
+
+    /**
+     * Send the snapshot of the part to the host.
+     * It returns the id and term of the last log committed in the snapshot,
+     * the log replication should resume right after it.
+     * */
+    folly::SemiFuture<StatusOr<std::pair<LogID, TermID>>> sendSnapshot(
+        std::shared_ptr<RaftPart> part,
+        const HostAddr& dst);
+
+private:
+    folly::Future<cpp2::SendSnapshotResponse> send(std::shared_ptr<RaftPart> part,
+                                                   const HostAddr& dst,
+                                                   cpp2::SendSnapshotRequest req);
+
+    StatusOr<std::pair<LogID, TermID>> doSendSnapshot(std::shared_ptr<RaftPart> part,
+                                                      const HostAddr& dst);
+
+private:
+    std::unique_ptr<thread::GenericThreadPool> workers_;
+    thrift::ThriftClientManager<cpp2::RaftexServiceAsyncClient> clientsMan_;
+};
+
+}  // namespace raftex
+}  // namespace nebula
+
+#endif  // RAFTEX_SNAPSHOTMANAGER_H_
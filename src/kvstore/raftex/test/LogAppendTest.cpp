@@ -17,6 +17,11 @@
 
 DECLARE_uint32(raft_heartbeat_interval_secs);
 DECLARE_uint32(max_batch_size);
+DECLARE_uint32(max_appendlog_batch_size);
+DECLARE_uint32(max_inflight_appendlog_requests);
+DECLARE_uint32(max_replicating_batches);
+DECLARE_uint32(max_apply_queue_size);
+DECLARE_uint64(max_waiting_bytes);
 
 namespace nebula {
 namespace raftex {
@@ -135,6 +140,167 @@ TEST(LogAppend, MultiThreadAppend) {
     finishRaft(services, copies, workers, leader);
 }
 
+
+TEST(LogAppend, PipelinedAppend) {
+    fs::TempDir walRoot("/tmp/pipelined_append.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    // Each batch is sent to the followers by several requests at a time
+    FLAGS_max_appendlog_batch_size = 3;
+    FLAGS_max_inflight_appendlog_requests = 8;
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    std::vector<std::string> msgs;
+    appendLogs(0, 299, leader, msgs);
+    checkConsensus(copies, 0, 299, msgs);
+
+    finishRaft(services, copies, workers, leader);
+    FLAGS_max_appendlog_batch_size = 128;
+    FLAGS_max_inflight_appendlog_requests = 4;
+}
+
+
+TEST(LogAppend, ReplicatingBatches) {
+    fs::TempDir walRoot("/tmp/replicating_batches.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    // Small batches, several of them are replicated before the first one is committed
+    FLAGS_max_batch_size = 4;
+    FLAGS_max_replicating_batches = 8;
+    std::vector<std::string> msgs;
+    std::vector<folly::Future<AppendLogResult>> futures;
+    for (int i = 0; i < 300; ++i) {
+        msgs.emplace_back(folly::stringPrintf("Test Log Message %03d", i));
+        futures.emplace_back(leader->appendAsync(0, msgs.back()));
+    }
+    // The batches are committed in order
+    for (auto& f : futures) {
+        ASSERT_EQ(AppendLogResult::SUCCEEDED, std::move(f).get());
+    }
+    checkConsensus(copies, 0, 299, msgs);
+
+    finishRaft(services, copies, workers, leader);
+    FLAGS_max_batch_size = 256;
+    FLAGS_max_replicating_batches = 4;
+}
+
+
+TEST(LogAppend, ApplyQueueFull) {
+    fs::TempDir walRoot("/tmp/apply_queue_full.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    // No batch could wait in the apply queue, the next batch is not sent until
+    // the previous one is taken out of the queue to be applied
+    FLAGS_max_apply_queue_size = 0;
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    const int numThreads = 4;
+    const int numLogs = 100;
+    FLAGS_max_batch_size = numThreads * numLogs + 1;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back(std::thread([i, leader] {
+            std::vector<folly::Future<AppendLogResult>> futures;
+            std::atomic<int> fulfilled{0};
+            for (int j = 1; j <= numLogs; ++j) {
+                futures.emplace_back(
+                    leader->appendAsync(0, folly::stringPrintf("Log %03d for t%d", j, i))
+                        .then([j, &fulfilled] (AppendLogResult res) {
+                            // The futures are fulfilled in the order of the logs
+                            EXPECT_EQ(j, ++fulfilled);
+                            return res;
+                        }));
+            }
+            // All the logs are applied when the futures are fulfilled
+            for (auto& f : futures) {
+                ASSERT_EQ(AppendLogResult::SUCCEEDED, std::move(f).get());
+            }
+        }));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(numThreads * numLogs, leader->getNumLogs());
+    ASSERT_LT(0, leader->applyQueueFullTimes());
+
+    finishRaft(services, copies, workers, leader);
+    FLAGS_max_apply_queue_size = 16;
+    FLAGS_max_batch_size = 256;
+}
+
+
+TEST(LogAppend, BufferFull) {
+    fs::TempDir walRoot("/tmp/buffer_full.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    // Only two logs fit in the buffer, the others wait for the room
+    FLAGS_max_batch_size = 2;
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    // The logs waiting are committed in the order they were appended
+    std::vector<std::string> msgs;
+    appendLogs(0, 99, leader, msgs);
+    checkConsensus(copies, 0, 99, msgs);
+
+    // Not even one more log could wait
+    FLAGS_max_waiting_bytes = 64;
+    std::vector<folly::Future<AppendLogResult>> futures;
+    int32_t overflows = 0;
+    for (int i = 100; i < 1000; ++i) {
+        auto fut = leader->appendAsync(0, folly::stringPrintf("Test Log Message %03d", i));
+        if (fut.isReady() && fut.value() == AppendLogResult::E_BUFFER_OVERFLOW) {
+            overflows++;
+            // The client is told how long to wait before retrying
+            ASSERT_LT(0, leader->retryAfterMs());
+        } else {
+            futures.emplace_back(std::move(fut));
+        }
+    }
+    ASSERT_LT(0, overflows);
+    for (auto& f : futures) {
+        ASSERT_EQ(AppendLogResult::SUCCEEDED, std::move(f).get());
+    }
+    ASSERT_EQ(msgs.size() + futures.size(), leader->getNumLogs());
+
+    finishRaft(services, copies, workers, leader);
+    FLAGS_max_waiting_bytes = 64 * 1024 * 1024;
+    FLAGS_max_batch_size = 256;
+}
+
 }  // namespace raftex
 }  // namespace nebula
 
@@ -0,0 +1,91 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include <folly/Benchmark.h>
+#include "fs/TempDir.h"
+#include "kvstore/raftex/RaftexService.h"
+#include "kvstore/raftex/test/RaftexTestBase.h"
+#include "kvstore/raftex/test/TestShard.h"
+
+DEFINE_int32(num_logs, 10000, "The number of logs appended in each iteration");
+DEFINE_int32(log_size, 128, "The size of each log");
+
+DECLARE_uint32(max_batch_size);
+DECLARE_uint32(max_appendlog_batch_size);
+DECLARE_uint32(max_inflight_appendlog_requests);
+DECLARE_uint32(max_replicating_batches);
+
+namespace nebula {
+namespace raftex {
+
+void appendFn(uint32_t inFlight, uint32_t batches = 1, uint32_t batchSize = 0) {
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+    std::shared_ptr<test::TestShard> leader;
+    std::unique_ptr<fs::TempDir> walRoot;
+    std::string msg;
+    BENCHMARK_SUSPEND {
+        FLAGS_max_inflight_appendlog_requests = inFlight;
+        FLAGS_max_replicating_batches = batches;
+        // All the logs of an iteration could be buffered by default
+        FLAGS_max_batch_size = batchSize > 0 ? batchSize : FLAGS_num_logs + 1;
+        walRoot = std::make_unique<fs::TempDir>("/tmp/raftex_benchmark.XXXXXX");
+        setupRaft(3, *walRoot, workers, wals, allHosts, services, copies, leader);
+        msg.assign(FLAGS_log_size, 'x');
+    }
+
+    auto fut = folly::Future<AppendLogResult>::makeEmpty();
+    for (int i = 0; i < FLAGS_num_logs; i++) {
+        fut = leader->appendAsync(0, msg);
+    }
+    CHECK(AppendLogResult::SUCCEEDED == std::move(fut).get());
+
+    BENCHMARK_SUSPEND {
+        finishRaft(services, copies, workers, leader);
+    }
+}
+
+BENCHMARK(InFlight1) {
+    appendFn(1);
+}
+
+BENCHMARK_RELATIVE(InFlight4) {
+    appendFn(4);
+}
+
+BENCHMARK_RELATIVE(InFlight16) {
+    appendFn(16);
+}
+
+BENCHMARK_DRAW_LINE();
+
+// Small batches, the next batch is waiting for the previous ones to be committed
+BENCHMARK(Batches1) {
+    appendFn(4, 1, 64);
+}
+
+BENCHMARK_RELATIVE(Batches4) {
+    appendFn(4, 4, 64);
+}
+
+BENCHMARK_RELATIVE(Batches16) {
+    appendFn(4, 16, 64);
+}
+
+}  // namespace raftex
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    folly::init(&argc, &argv, true);
+    // Small requests, so that a batch is sent by several requests
+    FLAGS_max_appendlog_batch_size = 16;
+    folly::runBenchmarks();
+    return 0;
+}
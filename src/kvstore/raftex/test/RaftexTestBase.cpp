@@ -7,6 +7,7 @@
 #include "base/Base.h"
 #include "kvstore/raftex/test/RaftexTestBase.h"
 #include "kvstore/raftex/RaftexService.h"
+#include "kvstore/raftex/SnapshotManager.h"
 #include "kvstore/raftex/test/TestShard.h"
 #include "thrift/ThriftClientManager.h"
 
@@ -20,6 +21,7 @@ using fs::FileUtils;
 
 std::mutex leaderMutex;
 std::condition_variable leaderCV;
+std::shared_ptr<SnapshotManager> snapshot;
 
 
 std::vector<HostAddr> getPeers(const std::vector<HostAddr>& all,
@@ -157,6 +159,7 @@ void setupRaft(
 
     workers = std::make_shared<thread::GenericThreadPool>();
     workers->start(4);
+    snapshot = std::make_shared<SnapshotManager>();
 
     // Set up WAL folders (Create one extra for leader crash test)
     for (int i = 0; i < numCopies + 1; ++i) {
@@ -190,6 +193,7 @@ void setupRaft(
             services[i]->getIOThreadPool(),
             workers,
             services[i]->getThreadManager(),
+            snapshot,
             std::bind(&onLeadershipLost,
                       std::ref(copies),
                       std::ref(leader),
@@ -219,6 +223,7 @@ void finishRaft(std::vector<std::shared_ptr<RaftexService>>& services,
                 std::shared_ptr<test::TestShard>& leader) {
     leader.reset();
     copies.clear();
+    snapshot.reset();
 
     // Done test case, stop all services
     for (auto& svc : services) {
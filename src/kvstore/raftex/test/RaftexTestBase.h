@@ -21,6 +21,7 @@ namespace nebula {
 namespace raftex {
 
 class RaftexService;
+class SnapshotManager;
 
 namespace test {
 class TestShard;
@@ -28,6 +29,7 @@ class TestShard;
 
 extern std::mutex leaderMutex;
 extern std::condition_variable leaderCV;
+extern std::shared_ptr<SnapshotManager> snapshot;
 
 
 std::vector<HostAddr> getPeers(const std::vector<HostAddr>& all,
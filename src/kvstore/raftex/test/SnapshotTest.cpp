@@ -0,0 +1,145 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include <gtest/gtest.h>
+#include <folly/String.h>
+#include "fs/TempDir.h"
+#include "time/WallClock.h"
+#include "thread/GenericThreadPool.h"
+#include "kvstore/raftex/RaftexService.h"
+#include "kvstore/raftex/test/RaftexTestBase.h"
+#include "kvstore/raftex/test/TestShard.h"
+
+DECLARE_uint32(raft_heartbeat_interval_secs);
+DECLARE_int32(wal_ttl);
+DECLARE_int64(wal_file_size);
+DECLARE_int32(snapshot_batch_size);
+
+
+namespace nebula {
+namespace raftex {
+
+TEST(SnapshotTest, LearnerCatchUpWithSnapshotTest) {
+    fs::TempDir walRoot("/tmp/snapshot_test.XXXXXX");
+    // Make the leader remove the old logs soon, so the learner could not catch up by the logs
+    FLAGS_wal_ttl = 0;
+    FLAGS_wal_file_size = 1024;
+    // Send the snapshot by several requests
+    FLAGS_snapshot_batch_size = 256;
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    std::vector<bool> isLearner = {false, false, false, true};
+    setupRaft(4, walRoot, workers, wals, allHosts, services, copies, leader, isLearner);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    std::vector<std::string> msgs;
+    appendLogs(0, 99, leader, msgs);
+    // Sleep a while to make sure the last log has been committed on followers,
+    // and the old wal files have been removed
+    sleep(FLAGS_raft_heartbeat_interval_secs + 1);
+
+    LOG(INFO) << "Add learner, it needs the snapshot to catch up data!";
+    auto f = leader->sendCommandAsync(test::encodeLearner(allHosts[3]));
+    f.wait();
+
+    // The logs after the snapshot are still replicated
+    appendLogs(100, 109, leader, msgs);
+    sleep(FLAGS_raft_heartbeat_interval_secs);
+
+    auto& learner = copies[3];
+    ASSERT_EQ(110, learner->getNumLogs());
+    for (int i = 0; i < 110; ++i) {
+        folly::StringPiece msg;
+        ASSERT_TRUE(learner->getLogMsg(i, msg));
+        ASSERT_EQ(msgs[i], msg.toString());
+    }
+
+    finishRaft(services, copies, workers, leader);
+}
+
+TEST(SnapshotTest, SnapshotFromNewLeaderTest) {
+    fs::TempDir walRoot("/tmp/snapshot_from_new_leader_test.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    std::shared_ptr<test::TestShard> follower;
+    HostAddr newLeader;
+    for (auto& c : copies) {
+        if (c == leader) {
+            continue;
+        }
+        if (follower == nullptr) {
+            follower = c;
+        } else {
+            newLeader = c->address();
+        }
+    }
+    auto newRequest = [&] (TermID term) {
+        cpp2::SendSnapshotRequest req;
+        req.set_space(follower->spaceId());
+        req.set_part(follower->partitionId());
+        req.set_term(term);
+        req.set_leader_ip(newLeader.first);
+        req.set_leader_port(newLeader.second);
+        req.set_snapshot_id(time::WallClock::fastNowInMicroSec());
+        req.set_rows({"row"});
+        req.set_done(false);
+        return req;
+    };
+
+    LOG(INFO) << "The snapshot from an old term is rejected";
+    {
+        cpp2::SendSnapshotResponse resp;
+        follower->processSendSnapshotRequest(newRequest(0), resp);
+        ASSERT_EQ(cpp2::ErrorCode::E_TERM_OUT_OF_DATE, resp.get_error_code());
+        ASSERT_EQ(leader->address(), follower->leader());
+    }
+
+    LOG(INFO) << "The snapshot from a newer term is received, and its leader is followed";
+    {
+        cpp2::SendSnapshotResponse resp;
+        follower->processSendSnapshotRequest(newRequest(1000), resp);
+        ASSERT_EQ(cpp2::ErrorCode::SUCCEEDED, resp.get_error_code());
+        ASSERT_EQ(newLeader, follower->leader());
+        ASSERT_TRUE(follower->isFollower());
+        // The requests of the old leader are rejected by the new term
+        cpp2::SendSnapshotResponse oldResp;
+        follower->processSendSnapshotRequest(newRequest(1), oldResp);
+        ASSERT_EQ(cpp2::ErrorCode::E_TERM_OUT_OF_DATE, oldResp.get_error_code());
+    }
+
+    follower.reset();
+    finishRaft(services, copies, workers, leader);
+}
+
+}  // namespace raftex
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+
+    return RUN_ALL_TESTS();
+}
@@ -61,6 +61,7 @@ TestShard::TestShard(size_t idx,
                      std::shared_ptr<folly::IOThreadPoolExecutor> ioPool,
                      std::shared_ptr<thread::GenericThreadPool> workers,
                      std::shared_ptr<folly::Executor> handlersPool,
+                     std::shared_ptr<SnapshotManager> snapshot,
                      std::function<void(size_t idx, const char*, TermID)>
                         leadershipLostCB,
                      std::function<void(size_t idx, const char*, TermID)>
@@ -72,7 +73,10 @@ TestShard::TestShard(size_t idx,
                    walRoot,
                    ioPool,
                    workers,
-                   handlersPool)
+                   handlersPool,
+                   snapshot,
+                   nullptr,
+                   std::make_shared<TestPipelineStats>())
         , idx_(idx)
         , service_(svc)
         , leadershipLostCB_(leadershipLostCB)
@@ -95,12 +99,14 @@ void TestShard::onElected(TermID term) {
 bool TestShard::commitLogs(std::unique_ptr<LogIterator> iter) {
     LogID firstId = -1;
     LogID lastId = -1;
+    TermID lastTerm = -1;
     int32_t commitLogsNum = 0;
     while (iter->valid()) {
         if (firstId < 0) {
             firstId = iter->logId();
         }
         lastId = iter->logId();
+        lastTerm = iter->logTerm();
         auto log = iter->logMsg();
         if (!log.empty()) {
             switch (static_cast<CommandType>(log[0])) {
@@ -127,7 +133,9 @@ bool TestShard::commitLogs(std::unique_ptr<LogIterator> iter) {
     }
     VLOG(2) << "TestShard: " << idStr_ << "Committed log " << firstId << " to " << lastId;
     if (lastId > -1) {
+        folly::RWSpinLock::WriteHolder wh(&lock_);
         lastCommittedLogId_ = lastId;
+        lastCommittedLogTerm_ = lastTerm;
     }
     if (commitLogsNum > 0) {
         commitTimes_++;
@@ -135,6 +143,57 @@ bool TestShard::commitLogs(std::unique_ptr<LogIterator> iter) {
     return true;
 }
 
+StatusOr<std::pair<LogID, TermID>> TestShard::accessAllRowsInSnapshot(SnapshotCallback cb) {
+    std::vector<std::pair<LogID, std::string>> data;
+    std::pair<LogID, TermID> committed;
+    {
+        folly::RWSpinLock::ReadHolder rh(&lock_);
+        data = data_;
+        committed = std::make_pair(lastCommittedLogId_, lastCommittedLogTerm_);
+    }
+    for (auto& row : data) {
+        std::string str;
+        str.reserve(sizeof(LogID) + row.second.size());
+        str.append(reinterpret_cast<const char*>(&row.first), sizeof(LogID));
+        str.append(row.second);
+        if (!cb(std::move(str))) {
+            break;
+        }
+    }
+    return committed;
+}
+
+bool TestShard::cleanup() {
+    folly::RWSpinLock::WriteHolder wh(&lock_);
+    data_.clear();
+    currLogId_ = -1;
+    lastCommittedLogId_ = 0;
+    lastCommittedLogTerm_ = 0;
+    return true;
+}
+
+bool TestShard::commitSnapshot(const std::vector<std::string>& rows,
+                               LogID committedLogId,
+                               TermID committedLogTerm,
+                               bool finished) {
+    folly::RWSpinLock::WriteHolder wh(&lock_);
+    for (auto& row : rows) {
+        LogID logId;
+        memcpy(&logId, row.data(), sizeof(LogID));
+        data_.emplace_back(logId, row.substr(sizeof(LogID)));
+    }
+    if (finished) {
+        // The chunks could arrive out of order
+        std::sort(data_.begin(), data_.end());
+        if (!data_.empty()) {
+            currLogId_ = data_.back().first;
+        }
+        lastCommittedLogId_ = committedLogId;
+        lastCommittedLogTerm_ = committedLogTerm;
+    }
+    return true;
+}
+
 size_t TestShard::getNumLogs() const {
     return data_.size();
 }
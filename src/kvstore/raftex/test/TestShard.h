@@ -32,6 +32,26 @@ std::string encodeTransferLeader(const HostAddr& addr);
 
 HostAddr decodeTransferLeader(const folly::StringPiece& log);
 
+// Only count the times of the apply queue being full
+class TestPipelineStats final : public PipelineStats {
+public:
+    void appendWal(int64_t) override {}
+    void replicate(int64_t) override {}
+    void applyWait(int64_t) override {}
+    void apply(int64_t) override {}
+
+    void applyQueueFull() override {
+        ++applyQueueFull_;
+    }
+
+    int64_t applyQueueFullTimes() const {
+        return applyQueueFull_.load();
+    }
+
+private:
+    std::atomic<int64_t> applyQueueFull_{0};
+};
+
 class TestShard : public RaftPart {
 public:
     TestShard(
@@ -43,6 +63,7 @@ public:
         std::shared_ptr<folly::IOThreadPoolExecutor> ioPool,
         std::shared_ptr<thread::GenericThreadPool> workers,
         std::shared_ptr<folly::Executor> handlersPool,
+        std::shared_ptr<SnapshotManager> snapshot,
         std::function<void(size_t idx, const char*, TermID)>
             leadershipLostCB,
         std::function<void(size_t idx, const char*, TermID)>
@@ -92,9 +113,22 @@ public:
         return true;
     }
 
+    StatusOr<std::pair<LogID, TermID>> accessAllRowsInSnapshot(SnapshotCallback cb) override;
+
+    bool cleanup() override;
+
+    bool commitSnapshot(const std::vector<std::string>& rows,
+                        LogID committedLogId,
+                        TermID committedLogTerm,
+                        bool finished) override;
+
     size_t getNumLogs() const;
     bool getLogMsg(size_t index, folly::StringPiece& msg);
 
+    int64_t applyQueueFullTimes() const {
+        return static_cast<const TestPipelineStats*>(stats_.get())->applyQueueFullTimes();
+    }
+
 public:
     int32_t commitTimes_ = 0;
     int32_t currLogId_ = -1;
@@ -106,6 +140,7 @@ private:
 
     std::vector<std::pair<LogID, std::string>> data_;
     LogID lastCommittedLogId_ = 0L;
+    TermID lastCommittedLogTerm_ = 0L;
     mutable folly::RWSpinLock lock_;
 
     std::function<void(size_t idx, const char*, TermID)>
@@ -9,6 +9,8 @@
 #include <rocksdb/db.h>
 #include <iostream>
 #include "fs/TempDir.h"
+#include "fs/FileUtils.h"
+#include "base/NebulaKeyUtils.h"
 #include "kvstore/NebulaStore.h"
 #include "kvstore/PartManager.h"
 #include "kvstore/RocksEngine.h"
@@ -509,6 +511,123 @@ TEST(NebulaStoreTest, TransLeaderTest) {
 }
 
 
+TEST(NebulaStoreTest, DegreesTest) {
+    fs::TempDir rootPath("/tmp/degrees_test.XXXXXX");
+    auto initNebulaStore = [](const std::vector<HostAddr>& peers,
+                              int32_t index,
+                              const std::string& path) -> std::unique_ptr<NebulaStore> {
+        LOG(INFO) << "Start nebula store on " << peers[index];
+        auto sIoThreadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+        auto partMan = std::make_unique<MemPartManager>();
+        PartMeta pm;
+        pm.spaceId_ = 0;
+        pm.partId_ = 1;
+        pm.peers_ = peers;
+        partMan->partsMap()[0][1] = std::move(pm);
+        partMan->degreesSpaces().emplace(0);
+        std::vector<std::string> paths;
+        paths.emplace_back(folly::stringPrintf("%s/disk%d", path.c_str(), index));
+        KVOptions options;
+        options.dataPaths_ = std::move(paths);
+        options.partMan_ = std::move(partMan);
+        HostAddr local = peers[index];
+        auto store = std::make_unique<NebulaStore>(std::move(options),
+                                                   sIoThreadPool,
+                                                   local,
+                                                   getHandlers());
+        store->init();
+        return store;
+    };
+    auto waitLeader = [] (NebulaStore* store) {
+        while (true) {
+            auto res = store->partLeader(0, 1);
+            CHECK(ok(res));
+            auto leader = value(std::move(res));
+            if (leader != HostAddr(0, 0)) {
+                return leader;
+            }
+            usleep(100000);
+        }
+    };
+    // The out-degree of vertex 1 along edge 101 on each replica, -1 if it is not found
+    auto getDegree = [] (NebulaStore* store) -> int64_t {
+        auto ret = store->engine(0, 1);
+        CHECK(ok(ret));
+        std::string val;
+        if (value(ret)->get(NebulaKeyUtils::degreeKey(1, 1, 101), &val)
+                != ResultCode::SUCCEEDED) {
+            return -1;
+        }
+        CHECK_EQ(sizeof(int64_t), val.size());
+        return NebulaKeyUtils::readInt<int64_t>(val.data(), val.size());
+    };
+    int32_t replicas = 3;
+    IPv4 ip;
+    CHECK(network::NetworkUtils::ipv4ToInt("127.0.0.1", ip));
+    std::vector<HostAddr> peers;
+    for (int32_t i = 0; i < replicas; i++) {
+        peers.emplace_back(ip, network::NetworkUtils::getAvailablePort());
+    }
+
+    std::vector<std::unique_ptr<NebulaStore>> stores;
+    for (int i = 0; i < replicas; i++) {
+        stores.emplace_back(initNebulaStore(peers, i, rootPath.path()));
+    }
+    LOG(INFO) << "Waiting for the leader elected!";
+    auto leader = waitLeader(stores[0].get());
+    size_t index = 0;
+    while (peers[index] != leader) {
+        index++;
+    }
+
+    LOG(INFO) << "Add the edges of vertex 1 in several batches...";
+    auto edge = [] (EdgeRanking rank, VertexID dst, EdgeVersion ver) {
+        return KV(NebulaKeyUtils::edgeKey(1, 1, 101, rank, dst, ver), "");
+    };
+    // Each batch is applied at once, the new versions of the edges are not counted again
+    std::vector<std::vector<KV>> batches = {
+        {edge(0, 10, 1), edge(0, 11, 1), edge(0, 12, 1), edge(0, 10, 2)},
+        {edge(0, 10, 3), edge(0, 13, 1)},
+        {edge(1, 13, 1), edge(0, 11, 2)},
+    };
+    for (auto& batch : batches) {
+        folly::Baton<true, std::atomic> baton;
+        stores[index]->asyncMultiPut(0, 1, std::move(batch), [&baton](ResultCode code) {
+            EXPECT_EQ(ResultCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    }
+    sleep(FLAGS_raft_heartbeat_interval_secs);
+    for (int i = 0; i < replicas; i++) {
+        LOG(INFO) << "Check the degree on " << stores[i]->raftAddr_;
+        EXPECT_EQ(5, getDegree(stores[i].get()));
+    }
+
+    LOG(INFO) << "Wipe a follower, it catches up from the leader...";
+    auto followerIndex = (index + 1) % replicas;
+    stores[followerIndex].reset();
+    CHECK(fs::FileUtils::remove(
+        folly::stringPrintf("%s/disk%lu", rootPath.path(), followerIndex).c_str(), true));
+    stores[followerIndex] = initNebulaStore(peers, followerIndex, rootPath.path());
+    for (int retry = 0; retry < 10 && getDegree(stores[followerIndex].get()) != 5; retry++) {
+        sleep(FLAGS_raft_heartbeat_interval_secs);
+    }
+    EXPECT_EQ(5, getDegree(stores[followerIndex].get()));
+
+    LOG(INFO) << "Restart all the replicas, the logs are not counted again...";
+    stores.clear();
+    for (int i = 0; i < replicas; i++) {
+        stores.emplace_back(initNebulaStore(peers, i, rootPath.path()));
+    }
+    waitLeader(stores[0].get());
+    sleep(FLAGS_raft_heartbeat_interval_secs);
+    for (int i = 0; i < replicas; i++) {
+        EXPECT_EQ(5, getDegree(stores[i].get()));
+    }
+}
+
+
 }  // namespace kvstore
 }  // namespace nebula
 
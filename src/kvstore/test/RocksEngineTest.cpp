@@ -8,6 +8,7 @@
 #include <gtest/gtest.h>
 #include <rocksdb/db.h>
 #include <folly/lang/Bits.h>
+#include "base/NebulaKeyUtils.h"
 #include "fs/TempDir.h"
 #include "kvstore/RocksEngine.h"
 
@@ -113,6 +114,104 @@ TEST(RocksEngineTest, PrefixTest) {
 }
 
 
+TEST(RocksEngineTest, PrefixBloomTest) {
+    fs::TempDir rootPath("/tmp/rocksdb_engine_PrefixBloomTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, rootPath.path());
+    // Only the even vertices have tag 1, all of them have tag 2
+    std::vector<KV> data;
+    for (VertexID vId = 0; vId < 100; vId++) {
+        if (vId % 2 == 0) {
+            data.emplace_back(NebulaKeyUtils::vertexKey(1, vId, 1, 0), "tag_1");
+        }
+        data.emplace_back(NebulaKeyUtils::vertexKey(1, vId, 2, 0), "tag_2");
+    }
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->multiPut(std::move(data)));
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->flush());
+
+    int32_t missed = 0;
+    for (VertexID vId = 0; vId < 100; vId++) {
+        auto prefix = NebulaKeyUtils::prefix(1, vId, 1);
+        std::unique_ptr<KVIterator> iter;
+        EXPECT_EQ(ResultCode::SUCCEEDED, engine->prefix(prefix, &iter));
+        if (vId % 2 == 0) {
+            // Never a false negative
+            EXPECT_TRUE(engine->mayExist(prefix));
+            ASSERT_TRUE(iter->valid());
+            EXPECT_EQ("tag_1", iter->val());
+            iter->next();
+            EXPECT_FALSE(iter->valid());
+        } else {
+            EXPECT_FALSE(iter->valid());
+            if (!engine->mayExist(prefix)) {
+                missed++;
+            }
+        }
+        // The whole keys are still found by get
+        std::string val;
+        auto key = NebulaKeyUtils::vertexKey(1, vId, 2, 0);
+        EXPECT_EQ(ResultCode::SUCCEEDED, engine->get(key, &val));
+        EXPECT_EQ("tag_2", val);
+    }
+    // Allow a few false positives of the bloom filters
+    EXPECT_LE(45, missed);
+
+    // Shorter than the prefix extractor, in the total order
+    std::unique_ptr<KVIterator> iter;
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->prefix(NebulaKeyUtils::prefix(1, 10), &iter));
+    int32_t num = 0;
+    while (iter->valid()) {
+        num++;
+        iter->next();
+    }
+    EXPECT_EQ(2, num);
+    EXPECT_TRUE(engine->mayExist(NebulaKeyUtils::prefix(1, 11)));
+}
+
+
+TEST(RocksEngineTest, ScannerTest) {
+    fs::TempDir rootPath("/tmp/rocksdb_engine_ScannerTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, rootPath.path());
+    std::vector<KV> data;
+    for (VertexID vId = 0; vId < 10; vId++) {
+        for (TagID tagId = 1; tagId <= 3; tagId++) {
+            data.emplace_back(NebulaKeyUtils::vertexKey(1, vId, tagId, 0),
+                              folly::stringPrintf("%ld_%d", vId, tagId));
+        }
+    }
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->multiPut(std::move(data)));
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->flush());
+
+    auto scanner = engine->scanner(false);
+    for (VertexID vId = 9; vId >= 0; vId--) {
+        // The vertex prefix is in the domain of the prefix extractor
+        std::unique_ptr<KVIterator> iter;
+        EXPECT_EQ(ResultCode::SUCCEEDED,
+                  scanner->prefix(1, NebulaKeyUtils::prefix(1, vId, 2), &iter));
+        ASSERT_TRUE(iter->valid());
+        EXPECT_EQ(folly::stringPrintf("%ld_2", vId), iter->val());
+        iter->next();
+        EXPECT_FALSE(iter->valid());
+
+        // Shorter than the prefix extractor
+        EXPECT_EQ(ResultCode::SUCCEEDED,
+                  scanner->prefix(1, NebulaKeyUtils::prefix(1, vId), &iter));
+        int32_t num = 0;
+        for (; iter->valid(); iter->next()) {
+            EXPECT_EQ(folly::stringPrintf("%ld_%d", vId, num + 1), iter->val());
+            num++;
+        }
+        EXPECT_EQ(3, num);
+    }
+
+    std::unique_ptr<KVIterator> iter;
+    EXPECT_EQ(ResultCode::SUCCEEDED,
+              scanner->prefix(1, NebulaKeyUtils::prefix(1, 100, 1), &iter));
+    EXPECT_FALSE(iter->valid());
+    EXPECT_EQ(ResultCode::SUCCEEDED, scanner->prefix(1, std::string(4, '\xFF'), &iter));
+    EXPECT_FALSE(iter->valid());
+}
+
+
 TEST(RocksEngineTest, RemoveTest) {
     fs::TempDir rootPath("/tmp/rocksdb_engine_RemoveTest.XXXXXX");
     auto engine = std::make_unique<RocksEngine>(0, rootPath.path());
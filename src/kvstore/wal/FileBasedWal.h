@@ -37,9 +37,6 @@ struct FileBasedWalPolicy {
 };
 
 
-using PreProcessor = folly::Function<bool(LogID, TermID, ClusterID, const std::string& log)>;
-
-
 class FileBasedWal final : public Wal
                          , public std::enable_shared_from_this<FileBasedWal> {
     FRIEND_TEST(FileBasedWal, TTLTest);
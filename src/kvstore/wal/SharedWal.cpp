@@ -0,0 +1,664 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include "kvstore/wal/SharedWal.h"
+#include "kvstore/wal/SharedWalIterator.h"
+#include "fs/FileUtils.h"
+#include "time/WallClock.h"
+
+namespace nebula {
+namespace wal {
+
+using nebula::fs::FileUtils;
+
+constexpr int32_t SharedWalRecord::kTruncateLen;
+constexpr size_t SharedWalRecord::kHeaderSize;
+
+namespace {
+
+// Discard all the logs after the given id
+void truncateIndex(SharedWalIndex& index, LogID id, TermID term) {
+    auto& segments = index.segments;
+    while (!segments.empty() && segments.back().firstId > id) {
+        segments.pop_back();
+    }
+    if (!segments.empty()) {
+        if (segments.back().lastId > id) {
+            segments.back().lastId = id;
+            segments.back().lastTerm = term;
+        }
+        segments.back().sealed = true;
+    }
+    index.lastLogId = id;
+    index.lastLogTerm = term;
+}
+
+
+// Add the logs [firstId, lastId] at the offset of the file to the index
+void appendIndex(SharedWalIndex& index,
+                 int64_t fileId,
+                 size_t offset,
+                 LogID firstId,
+                 LogID lastId,
+                 TermID lastTerm) {
+    auto& segments = index.segments;
+    if (!segments.empty()
+            && !segments.back().sealed
+            && segments.back().fileId == fileId
+            && segments.back().lastId + 1 == firstId) {
+        segments.back().lastId = lastId;
+        segments.back().lastTerm = lastTerm;
+    } else {
+        segments.emplace_back(SharedWalSegment{fileId, offset, firstId, lastId, lastTerm, false});
+    }
+    index.lastLogId = lastId;
+    index.lastLogTerm = lastTerm;
+}
+
+}  // Anonymous namespace
+
+
+/**********************************************
+ *
+ * Implementation of SharedWal
+ *
+ *********************************************/
+// static
+std::shared_ptr<SharedWal> SharedWal::getWal(const folly::StringPiece dir,
+                                             SharedWalPolicy policy) {
+    return std::shared_ptr<SharedWal>(new SharedWal(dir, std::move(policy)));
+}
+
+
+SharedWal::SharedWal(const folly::StringPiece dir, SharedWalPolicy policy)
+        : dir_(dir.toString())
+        , policy_(std::move(policy)) {
+    // Make sure WAL directory exist
+    if (FileUtils::fileType(dir_.c_str()) == fs::FileType::NOTEXIST) {
+        FileUtils::makeDir(dir_);
+    }
+
+    scanAllWalFiles();
+    // Always write to a new file, rather than the one which might end with a broken record
+    if (!files_.empty()) {
+        currFileId_ = files_.rbegin()->first + 1;
+    }
+    LOG(INFO) << "Opened the shared wal " << dir_ << ", " << files_.size() << " files, "
+              << indexes_.size() << " parts";
+}
+
+
+SharedWal::~SharedWal() {
+    closeCurrFile();
+    LOG(INFO) << "~SharedWal, dir = " << dir_;
+}
+
+
+std::string SharedWal::filePath(int64_t fileId) const {
+    return FileUtils::joinPath(dir_, folly::stringPrintf("%019ld.wal", fileId));
+}
+
+
+void SharedWal::scanAllWalFiles() {
+    std::vector<std::string> files =
+        FileUtils::listAllFilesInDir(dir_.c_str(), false, "*.wal");
+    // The file name convention is "<file id>.wal"
+    for (auto& fn : files) {
+        std::vector<std::string> parts;
+        folly::split('.', fn, parts);
+        if (parts.size() != 2) {
+            LOG(ERROR) << "Ignore unknown file \"" << fn << "\"";
+            continue;
+        }
+
+        int64_t fileId;
+        try {
+            fileId = folly::to<int64_t>(parts[0]);
+        } catch (const std::exception& ex) {
+            LOG(ERROR) << "Ignore bad file name \"" << fn << "\"";
+            continue;
+        }
+
+        auto path = FileUtils::joinPath(dir_, fn);
+        struct stat st;
+        if (lstat(path.c_str(), &st) < 0) {
+            LOG(ERROR) << "Failed to get the size and mtime for \""
+                       << fn << "\", ignore it";
+            continue;
+        }
+        files_.emplace(fileId, WalFile{std::move(path),
+                                       static_cast<size_t>(st.st_size),
+                                       st.st_mtime});
+    }
+
+    // The records have to be replayed in the order they were written
+    for (auto it = files_.begin(); it != files_.end(); ++it) {
+        auto validSize = scanWalFile(it->first, it->second.path, it->second.size);
+        if (validSize == it->second.size) {
+            continue;
+        }
+        if (std::next(it) == files_.end()) {
+            // The last record was being written when the process stopped
+            LOG(WARNING) << "Truncate the wal file \"" << it->second.path << "\" from "
+                         << it->second.size << " bytes to " << validSize << " bytes";
+            CHECK_EQ(truncate(it->second.path.c_str(), validSize), 0);
+        } else {
+            LOG(ERROR) << "It seems the wal file \"" << it->second.path
+                       << "\" is corrupted at " << validSize << ", ignore the rest of it";
+        }
+        it->second.size = validSize;
+    }
+}
+
+
+size_t SharedWal::scanWalFile(int64_t fileId, const std::string& path, size_t size) {
+    int32_t fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG(ERROR) << "Failed to open the file \"" << path << "\" ("
+                   << errno << "): " << strerror(errno);
+        return 0;
+    }
+
+    size_t pos = 0;
+    SharedWalRecord rec;
+    while (pos + SharedWalRecord::kHeaderSize + sizeof(int32_t) <= size) {
+        if (!readRecord(fd, pos, rec)
+                || rec.len < SharedWalRecord::kTruncateLen
+                || pos + rec.size() > size) {
+            break;
+        }
+        // Verify the msg len at the end of the record
+        int32_t len;
+        if (pread(fd, &len, sizeof(int32_t), pos + rec.size() - sizeof(int32_t))
+                != sizeof(int32_t)
+                || len != rec.len) {
+            break;
+        }
+
+        auto& index = indexes_[std::make_pair(rec.spaceId, rec.partId)];
+        if (rec.isTruncate()) {
+            truncateIndex(index, rec.logId, rec.term);
+        } else {
+            if (rec.logId <= index.lastLogId) {
+                // Only happens when the record rolling back the logs was lost
+                truncateIndex(index, rec.logId - 1, 0);
+            } else if (!index.segments.empty() && rec.logId > index.lastLogId + 1) {
+                LOG(ERROR) << "Found a log id gap of the space " << rec.spaceId
+                           << ", part " << rec.partId << " before " << rec.logId
+                           << ", the previous log id is " << index.lastLogId;
+                index.segments.clear();
+            }
+            appendIndex(index, fileId, pos, rec.logId, rec.logId, rec.term);
+        }
+        pos += rec.size();
+    }
+
+    close(fd);
+    return pos;
+}
+
+
+// static
+bool SharedWal::readRecord(int32_t fd, size_t pos, SharedWalRecord& rec) {
+    char buf[SharedWalRecord::kHeaderSize];
+    if (pread(fd, buf, sizeof(buf), pos) != static_cast<ssize_t>(sizeof(buf))) {
+        return false;
+    }
+    const char* p = buf;
+    memcpy(&rec.spaceId, p, sizeof(GraphSpaceID));
+    p += sizeof(GraphSpaceID);
+    memcpy(&rec.partId, p, sizeof(PartitionID));
+    p += sizeof(PartitionID);
+    memcpy(&rec.logId, p, sizeof(LogID));
+    p += sizeof(LogID);
+    memcpy(&rec.term, p, sizeof(TermID));
+    p += sizeof(TermID);
+    memcpy(&rec.len, p, sizeof(int32_t));
+    p += sizeof(int32_t);
+    memcpy(&rec.cluster, p, sizeof(ClusterID));
+    return true;
+}
+
+
+// static
+void SharedWal::encodeRecord(std::string& buf,
+                             const SharedWalRecord& rec,
+                             folly::StringPiece msg) {
+    DCHECK(!rec.isTruncate() || msg.empty());
+    buf.append(reinterpret_cast<const char*>(&rec.spaceId), sizeof(GraphSpaceID));
+    buf.append(reinterpret_cast<const char*>(&rec.partId), sizeof(PartitionID));
+    buf.append(reinterpret_cast<const char*>(&rec.logId), sizeof(LogID));
+    buf.append(reinterpret_cast<const char*>(&rec.term), sizeof(TermID));
+    buf.append(reinterpret_cast<const char*>(&rec.len), sizeof(int32_t));
+    buf.append(reinterpret_cast<const char*>(&rec.cluster), sizeof(ClusterID));
+    buf.append(msg.data(), msg.size());
+    buf.append(reinterpret_cast<const char*>(&rec.len), sizeof(int32_t));
+}
+
+
+std::shared_ptr<SharedWalPart> SharedWal::partWal(GraphSpaceID spaceId,
+                                                  PartitionID partId,
+                                                  PreProcessor preProcessor) {
+    SharedWalIndex index;
+    {
+        std::lock_guard<std::mutex> g(indexesMutex_);
+        auto it = indexes_.find(std::make_pair(spaceId, partId));
+        if (it != indexes_.end()) {
+            index = std::move(it->second);
+            indexes_.erase(it);
+        }
+    }
+    return std::make_shared<SharedWalPart>(shared_from_this(),
+                                           spaceId,
+                                           partId,
+                                           std::move(index),
+                                           std::move(preProcessor));
+}
+
+
+void SharedWal::release(GraphSpaceID spaceId, PartitionID partId, SharedWalIndex&& index) {
+    std::lock_guard<std::mutex> g(indexesMutex_);
+    indexes_[std::make_pair(spaceId, partId)] = std::move(index);
+}
+
+
+std::pair<int64_t, size_t> SharedWal::write(std::string&& records) {
+    std::unique_lock<std::mutex> g(writeMutex_);
+    if (currFileSize_ > 0 && currFileSize_ + records.size() > policy_.fileSize) {
+        // Need to roll over
+        ++currFileId_;
+        currFileSize_ = 0;
+    }
+    auto location = std::make_pair(currFileId_, currFileSize_);
+    currFileSize_ += records.size();
+    if (pending_.empty() || pending_.back().first != currFileId_) {
+        pending_.emplace_back(currFileId_, std::move(records));
+    } else {
+        pending_.back().second.append(records);
+    }
+
+    // Wait for the group which the records join to be synced,
+    // or flush it if no one else is flushing
+    auto group = nextGroup_;
+    while (syncedGroup_ < group) {
+        if (flushing_) {
+            writeCV_.wait(g);
+            continue;
+        }
+        flushing_ = true;
+        if (policy_.groupCommitWindowUs > 0) {
+            // Let the writes from the other parts join the group
+            g.unlock();
+            std::this_thread::sleep_for(std::chrono::microseconds(policy_.groupCommitWindowUs));
+            g.lock();
+        }
+        auto chunks = std::move(pending_);
+        pending_.clear();
+        auto flushingGroup = nextGroup_++;
+        g.unlock();
+
+        flush(chunks);
+
+        g.lock();
+        syncedGroup_ = flushingGroup;
+        flushing_ = false;
+        writeCV_.notify_all();
+    }
+    return location;
+}
+
+
+void SharedWal::flush(std::vector<std::pair<int64_t, std::string>>& chunks) {
+    for (auto& chunk : chunks) {
+        if (chunk.first != currFdFileId_) {
+            closeCurrFile();
+            openFile(chunk.first);
+        }
+        ssize_t bytesWritten = ::write(currFd_, chunk.second.data(), chunk.second.size());
+        CHECK_EQ(bytesWritten, chunk.second.size())
+            << "Failed to write the wal file " << filePath(chunk.first)
+            << " (errno: " << errno << "): " << strerror(errno);
+        std::lock_guard<std::mutex> g(filesMutex_);
+        auto& file = files_[chunk.first];
+        file.size += chunk.second.size();
+        file.mtime = ::time(nullptr);
+    }
+    if (currFd_ >= 0) {
+        CHECK_EQ(fdatasync(currFd_), 0)
+            << "Failed to sync the wal file " << filePath(currFdFileId_)
+            << " (errno: " << errno << "): " << strerror(errno);
+    }
+}
+
+
+void SharedWal::openFile(int64_t fileId) {
+    CHECK_LT(currFd_, 0) << "The current file needs to be closed first";
+    auto path = filePath(fileId);
+    VLOG(1) << "Write new file " << path;
+    currFd_ = open(path.c_str(),
+                   O_CREAT | O_EXCL | O_WRONLY | O_APPEND | O_CLOEXEC | O_LARGEFILE,
+                   0644);
+    if (currFd_ < 0) {
+        LOG(FATAL) << "Failed to open file \"" << path
+                   << "\" (errno: " << errno << "): "
+                   << strerror(errno);
+    }
+    currFdFileId_ = fileId;
+
+    std::lock_guard<std::mutex> g(filesMutex_);
+    files_.emplace(fileId, WalFile{std::move(path), 0, ::time(nullptr)});
+}
+
+
+void SharedWal::closeCurrFile() {
+    if (currFd_ < 0) {
+        // Already closed
+        return;
+    }
+    CHECK_EQ(fdatasync(currFd_), 0);
+    CHECK_EQ(close(currFd_), 0);
+    currFd_ = -1;
+    currFdFileId_ = -1;
+}
+
+
+void SharedWal::cleanWAL() {
+    std::lock_guard<std::mutex> g(filesMutex_);
+    if (files_.empty()) {
+        return;
+    }
+    auto now = time::WallClock::fastNowInSec();
+    // We skip the latest wal file because it is being written now.
+    auto last = std::prev(files_.end());
+    auto it = files_.begin();
+    while (it != last && now - it->second.mtime > policy_.ttl) {
+        VLOG(1) << "Clean wals, Remove " << it->second.path;
+        unlink(it->second.path.c_str());
+        it = files_.erase(it);
+    }
+}
+
+
+int64_t SharedWal::firstFileId() const {
+    std::lock_guard<std::mutex> g(filesMutex_);
+    if (files_.empty()) {
+        return 0;
+    }
+    return files_.begin()->first;
+}
+
+
+/**********************************************
+ *
+ * Implementation of SharedWalPart
+ *
+ *********************************************/
+SharedWalPart::SharedWalPart(std::shared_ptr<SharedWal> wal,
+                             GraphSpaceID spaceId,
+                             PartitionID partId,
+                             SharedWalIndex index,
+                             PreProcessor preProcessor)
+        : wal_(std::move(wal))
+        , spaceId_(spaceId)
+        , partId_(partId)
+        , preProcessor_(std::move(preProcessor))
+        , index_(std::move(index)) {
+    removeExpiredSegments();
+}
+
+
+SharedWalPart::~SharedWalPart() {
+    wal_->release(spaceId_, partId_, std::move(index_));
+}
+
+
+void SharedWalPart::removeExpiredSegments() {
+    auto firstFileId = wal_->firstFileId();
+    std::lock_guard<std::mutex> g(indexMutex_);
+    auto& segments = index_.segments;
+    while (!segments.empty() && segments.front().fileId < firstFileId) {
+        segments.pop_front();
+    }
+    firstLogId_ = segments.empty() ? 0 : segments.front().firstId;
+}
+
+
+BufferPtr SharedWalPart::getLastBuffer(LogID id, size_t expectedToWrite) {
+    std::unique_lock<std::mutex> g(buffersMutex_);
+    auto& policy = wal_->policy();
+    if (!buffers_.empty()) {
+        if (buffers_.back()->size() + expectedToWrite <= policy.bufferSize) {
+            return buffers_.back();
+        }
+
+        // Need to rollover to a new buffer
+        if (buffers_.size() == policy.numBuffers) {
+            // Need to pop the first one
+            buffers_.pop_front();
+        }
+        CHECK_LT(buffers_.size(), policy.numBuffers);
+    }
+    buffers_.emplace_back(std::make_shared<InMemoryLogBuffer>(id));
+    return buffers_.back();
+}
+
+
+bool SharedWalPart::prepareLog(LogID id,
+                               TermID term,
+                               ClusterID cluster,
+                               std::string&& msg,
+                               std::string& records,
+                               Logs& logs) {
+    LogID lastId = logs.empty() ? index_.lastLogId : std::get<0>(logs.back());
+    bool hasLogs = firstLogId_ != 0 || !logs.empty();
+    if (lastId != 0 && hasLogs && id != lastId + 1) {
+        LOG(ERROR) << "There is a gap in the log id. The last log id is "
+                   << lastId
+                   << ", and the id being appended is " << id;
+        return false;
+    }
+
+    if (!preProcessor_(id, term, cluster, msg)) {
+        LOG(ERROR) << "Pre process failed for log " << id;
+        return false;
+    }
+
+    SharedWalRecord rec{spaceId_, partId_, id, term, static_cast<int32_t>(msg.size()), cluster};
+    SharedWal::encodeRecord(records, rec, msg);
+    logs.emplace_back(id, term, cluster, std::move(msg));
+    return true;
+}
+
+
+void SharedWalPart::persistLogs(std::string&& records, Logs&& logs) {
+    if (logs.empty()) {
+        return;
+    }
+    auto location = wal_->write(std::move(records));
+
+    auto firstId = std::get<0>(logs.front());
+    {
+        std::lock_guard<std::mutex> g(indexMutex_);
+        appendIndex(index_,
+                    location.first,
+                    location.second,
+                    firstId,
+                    std::get<0>(logs.back()),
+                    std::get<1>(logs.back()));
+        if (firstLogId_ == 0) {
+            firstLogId_ = firstId;
+        }
+    }
+
+    // Append to the in-memory buffer
+    for (auto& log : logs) {
+        auto id = std::get<0>(log);
+        auto& msg = std::get<3>(log);
+        auto buffer = getLastBuffer(id, msg.size() + SharedWalRecord::kHeaderSize);
+        DCHECK_EQ(id, static_cast<int64_t>(buffer->firstLogId() + buffer->numLogs()));
+        buffer->push(std::get<1>(log), std::get<2>(log), std::move(msg));
+    }
+}
+
+
+bool SharedWalPart::appendLog(LogID id,
+                              TermID term,
+                              ClusterID cluster,
+                              std::string msg) {
+    std::string records;
+    Logs logs;
+    if (!prepareLog(id, term, cluster, std::move(msg), records, logs)) {
+        LOG(ERROR) << "Failed to append log for logId " << id;
+        return false;
+    }
+    persistLogs(std::move(records), std::move(logs));
+    return true;
+}
+
+
+bool SharedWalPart::appendLogs(LogIterator& iter) {
+    std::string records;
+    Logs logs;
+    bool succeeded = true;
+    for (; iter.valid(); ++iter) {
+        if (!prepareLog(iter.logId(),
+                        iter.logTerm(),
+                        iter.logSource(),
+                        iter.logMsg().toString(),
+                        records,
+                        logs)) {
+            LOG(ERROR) << "Failed to append log for logId "
+                       << iter.logId();
+            succeeded = false;
+            break;
+        }
+    }
+    // The logs before the failed one are still appended, as FileBasedWal does
+    persistLogs(std::move(records), std::move(logs));
+    return succeeded;
+}
+
+
+bool SharedWalPart::rollbackToLog(LogID id) {
+    if (id < firstLogId_ - 1 || id > index_.lastLogId) {
+        LOG(ERROR) << "Rollback target id " << id
+                   << " is not in the range of ["
+                   << firstLogId_ << ","
+                   << index_.lastLogId << "] of WAL";
+        return false;
+    }
+
+    TermID term = 0;
+    if (firstLogId_ == 0 || id < firstLogId_) {
+        // All the logs are gone
+        id = 0;
+    } else {
+        auto it = iterator(id, id);
+        if (!it->valid()) {
+            LOG(ERROR) << "Failed to read the log " << id;
+            return false;
+        }
+        term = it->logTerm();
+    }
+
+    // Persist the rollback first, so that the logs discarded will not come back
+    std::string records;
+    SharedWalRecord rec{spaceId_, partId_, id, term, SharedWalRecord::kTruncateLen, 0};
+    SharedWal::encodeRecord(records, rec, "");
+    wal_->write(std::move(records));
+
+    {
+        std::lock_guard<std::mutex> g(indexMutex_);
+        truncateIndex(index_, id, term);
+        firstLogId_ = index_.segments.empty() ? 0 : index_.segments.front().firstId;
+    }
+
+    {
+        std::unique_lock<std::mutex> g(buffersMutex_);
+        if (id == 0) {
+            // The next log could be any id
+            buffers_.clear();
+            return true;
+        }
+
+        // Remove all buffers that are rolled back
+        auto it = buffers_.begin();
+        while (it != buffers_.end() && (*it)->firstLogId() <= id) {
+            it++;
+        }
+        while (it != buffers_.end()) {
+            it = buffers_.erase(it);
+        }
+
+        // Need to rollover to a new buffer
+        if (buffers_.size() == wal_->policy().numBuffers) {
+            // Need to pop the first one
+            buffers_.pop_front();
+        }
+        buffers_.emplace_back(std::make_shared<InMemoryLogBuffer>(id + 1));
+    }
+
+    return true;
+}
+
+
+bool SharedWalPart::reset() {
+    std::string records;
+    SharedWalRecord rec{spaceId_, partId_, 0, 0, SharedWalRecord::kTruncateLen, 0};
+    SharedWal::encodeRecord(records, rec, "");
+    wal_->write(std::move(records));
+
+    {
+        std::lock_guard<std::mutex> g(indexMutex_);
+        truncateIndex(index_, 0, 0);
+        firstLogId_ = 0;
+    }
+    {
+        std::lock_guard<std::mutex> g(buffersMutex_);
+        buffers_.clear();
+    }
+    return true;
+}
+
+
+void SharedWalPart::cleanWAL() {
+    wal_->cleanWAL();
+    removeExpiredSegments();
+}
+
+
+std::unique_ptr<LogIterator> SharedWalPart::iterator(LogID firstLogId,
+                                                     LogID lastLogId) {
+    return std::unique_ptr<LogIterator>(
+        new SharedWalIterator(shared_from_this(),
+                              firstLogId,
+                              lastLogId));
+}
+
+
+std::deque<SharedWalSegment> SharedWalPart::segments() const {
+    std::lock_guard<std::mutex> g(indexMutex_);
+    return index_.segments;
+}
+
+
+size_t SharedWalPart::accessAllBuffers(std::function<bool(BufferPtr buffer)> fn) const {
+    std::lock_guard<std::mutex> g(buffersMutex_);
+
+    size_t count = 0;
+    for (auto it = buffers_.rbegin(); it != buffers_.rend(); ++it) {
+        ++count;
+        if (!fn(*it)) {
+            break;
+        }
+    }
+
+    return count;
+}
+
+}  // namespace wal
+}  // namespace nebula
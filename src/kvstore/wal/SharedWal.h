@@ -0,0 +1,323 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef WAL_SHAREDWAL_H_
+#define WAL_SHAREDWAL_H_
+
+#include "base/Base.h"
+#include "kvstore/wal/Wal.h"
+#include "kvstore/wal/InMemoryLogBuffer.h"
+
+namespace nebula {
+namespace wal {
+
+struct SharedWalPolicy {
+    // The life span of the log messages (number of seconds)
+    // A wal file is removed when it has not been written for ttl seconds,
+    // except the one being written
+    int32_t ttl = 86400;
+
+    // The maximum size of each wal file (in byte). When the existing
+    // wal file reaches this size, a new file will be created
+    size_t fileSize = 128 * 1024L * 1024L;
+
+    // Size of each in-memory buffer of a part (in byte)
+    size_t bufferSize = 8 * 1024L * 1024L;
+
+    // Number of in-memory buffers of a part
+    size_t numBuffers = 4;
+
+    // How long (in microseconds) a flush waits for the writes from the other parts
+    // before syncing the file. The writes arriving during a flush are always synced
+    // together by the next flush, so 0 still groups the concurrent writes
+    int32_t groupCommitWindowUs = 0;
+};
+
+
+// The header of each record in the shared wal files. The whole record is
+//   [space][part][log id][term][msg len][cluster][msg][msg len]
+struct SharedWalRecord {
+    // The msg len of the record which discards all the logs of the part after
+    // the log id, the term is the one of the log id
+    static constexpr int32_t kTruncateLen = -1;
+    static constexpr size_t kHeaderSize = sizeof(GraphSpaceID)
+                                          + sizeof(PartitionID)
+                                          + sizeof(LogID)
+                                          + sizeof(TermID)
+                                          + sizeof(int32_t)
+                                          + sizeof(ClusterID);
+
+    GraphSpaceID spaceId;
+    PartitionID partId;
+    LogID logId;
+    TermID term;
+    int32_t len;
+    ClusterID cluster;
+
+    bool isTruncate() const {
+        return len == kTruncateLen;
+    }
+
+    // The size of the whole record
+    size_t size() const {
+        return kHeaderSize + (isTruncate() ? 0 : len) + sizeof(int32_t);
+    }
+};
+
+
+// The logs of a part in a wal file, whose ids are consecutive
+struct SharedWalSegment {
+    int64_t fileId;
+    // The offset of the first log in the file
+    size_t offset;
+    LogID firstId;
+    LogID lastId;
+    TermID lastTerm;
+    // No more logs could be added to the segment after a rollback, since the logs
+    // rolled back are still in the file
+    bool sealed;
+};
+
+
+// All the logs of a part in the shared wal
+struct SharedWalIndex {
+    std::deque<SharedWalSegment> segments;
+    LogID lastLogId{0};
+    TermID lastLogTerm{0};
+};
+
+
+class SharedWalPart;
+
+/**
+ * The WAL shared by all the parts on the same disk.
+ *
+ * The logs of all the parts are appended to one sequence of files, so the disk sees
+ * large sequential writes rather than small ones to hundreds of files. The writes
+ * arriving at the same time are group committed: one of the writers writes them all
+ * and syncs the file once, while the others wait for it.
+ *
+ * The index of the logs of each part is rebuilt by scanning all the files on opening,
+ * and handed over to the SharedWalPart of the part, which is the Wal used by the part.
+ * */
+class SharedWal final : public std::enable_shared_from_this<SharedWal> {
+    friend class SharedWalPart;
+    friend class SharedWalIterator;
+public:
+    // A factory method to create a new shared WAL
+    static std::shared_ptr<SharedWal> getWal(const folly::StringPiece dir,
+                                             SharedWalPolicy policy);
+
+    ~SharedWal();
+
+    /**
+     * The wal of the given part. Only one wal of a part should be used at a time,
+     * its index is returned to the SharedWal when it is destroyed.
+     * */
+    std::shared_ptr<SharedWalPart> partWal(GraphSpaceID spaceId,
+                                           PartitionID partId,
+                                           PreProcessor preProcessor);
+
+    // Remove the wal files which expired, except the one being written
+    void cleanWAL();
+
+    // The id of the earliest wal file, the logs in the files before it are gone
+    int64_t firstFileId() const;
+
+    const SharedWalPolicy& policy() const {
+        return policy_;
+    }
+
+    // Read the header of the record at the given position of the file
+    static bool readRecord(int32_t fd, size_t pos, SharedWalRecord& rec);
+
+    static void encodeRecord(std::string& buf,
+                             const SharedWalRecord& rec,
+                             folly::StringPiece msg);
+
+private:
+    using PartKey = std::pair<GraphSpaceID, PartitionID>;
+
+    struct WalFile {
+        std::string path;
+        size_t size;
+        time_t mtime;
+    };
+
+    // Callers should use static method getWal() instead
+    SharedWal(const folly::StringPiece dir, SharedWalPolicy policy);
+
+    // Scan all WAL files, and rebuild the indexes of all the parts
+    void scanAllWalFiles();
+
+    // Scan the records in the file, return the size of the valid records
+    size_t scanWalFile(int64_t fileId, const std::string& path, size_t size);
+
+    std::string filePath(int64_t fileId) const;
+
+    /**
+     * Write the records to the wal and wait until they are synced to the disk.
+     * All the records are in one file, it returns the id of the file and the offset
+     * of the records in it.
+     * */
+    std::pair<int64_t, size_t> write(std::string&& records);
+
+    // Write the chunks to the files and sync them, it is called by one thread at a time
+    void flush(std::vector<std::pair<int64_t, std::string>>& chunks);
+
+    void openFile(int64_t fileId);
+    void closeCurrFile();
+
+    // Keep the index of a part whose wal is closed
+    void release(GraphSpaceID spaceId, PartitionID partId, SharedWalIndex&& index);
+
+private:
+    const std::string dir_;
+    const SharedWalPolicy policy_;
+
+    // fileId -> file
+    std::map<int64_t, WalFile> files_;
+    mutable std::mutex filesMutex_;
+
+    // The indexes of the parts whose wals are not opened
+    std::map<PartKey, SharedWalIndex> indexes_;
+    std::mutex indexesMutex_;
+
+    // The records waiting to be flushed, in the order of (fileId, records)
+    std::vector<std::pair<int64_t, std::string>> pending_;
+    // The group which the next write joins, and the last group synced
+    uint64_t nextGroup_{1};
+    uint64_t syncedGroup_{0};
+    bool flushing_{false};
+    // The file which the next write goes to, and its size including the pending records
+    int64_t currFileId_{0};
+    size_t currFileSize_{0};
+    std::mutex writeMutex_;
+    std::condition_variable writeCV_;
+
+    // The file being written, only accessed by the thread flushing
+    int32_t currFd_{-1};
+    int64_t currFdFileId_{-1};
+};
+
+
+/**
+ * The logs of one part in the SharedWal
+ *
+ * The recent logs are cached in the in-memory buffers as FileBasedWal does,
+ * the others are read from the shared files by the index of the part.
+ * */
+class SharedWalPart final : public Wal
+                          , public std::enable_shared_from_this<SharedWalPart> {
+public:
+    // Callers should use SharedWal::partWal() instead
+    SharedWalPart(std::shared_ptr<SharedWal> wal,
+                  GraphSpaceID spaceId,
+                  PartitionID partId,
+                  SharedWalIndex index,
+                  PreProcessor preProcessor);
+
+    ~SharedWalPart();
+
+    LogID firstLogId() const override {
+        return firstLogId_;
+    }
+
+    LogID lastLogId() const override {
+        return index_.lastLogId;
+    }
+
+    TermID lastLogTerm() const override {
+        return index_.lastLogTerm;
+    }
+
+    // Append one log messages to the WAL
+    // This method **IS NOT** thread-safe
+    bool appendLog(LogID id,
+                   TermID term,
+                   ClusterID cluster,
+                   std::string msg) override;
+
+    // Append a list of log messages to the WAL, they are written by one group commit
+    // This method **IS NOT** thread-safe
+    bool appendLogs(LogIterator& iter) override;
+
+    // Rollback to the given ID, all logs after the ID will be discarded
+    // This method **IS NOT** thread-safe
+    bool rollbackToLog(LogID id) override;
+
+    // Discard all the logs of the part
+    // This method is *NOT* thread safe
+    bool reset() override;
+
+    void cleanWAL() override;
+
+    // Scan [firstLogId, lastLogId]
+    // This method IS thread-safe
+    std::unique_ptr<LogIterator> iterator(LogID firstLogId,
+                                          LogID lastLogId) override;
+
+    GraphSpaceID spaceId() const {
+        return spaceId_;
+    }
+
+    PartitionID partId() const {
+        return partId_;
+    }
+
+    std::shared_ptr<SharedWal> sharedWal() const {
+        return wal_;
+    }
+
+    // Return the segments of the logs in the files
+    std::deque<SharedWalSegment> segments() const;
+
+    // Iterates through all log buffers in reversed order
+    // (from the latest to the earliest)
+    // The iteration finishes when the functor returns false or reaches
+    // the end
+    // The method returns the number of buffers being accessed
+    size_t accessAllBuffers(std::function<bool(BufferPtr buffer)> fn) const;
+
+private:
+    using Logs = std::vector<std::tuple<LogID, TermID, ClusterID, std::string>>;
+
+    // Check and encode the log into the records
+    bool prepareLog(LogID id,
+                    TermID term,
+                    ClusterID cluster,
+                    std::string&& msg,
+                    std::string& records,
+                    Logs& logs);
+
+    // Write the records of the logs, and add the logs to the index and buffers
+    void persistLogs(std::string&& records, Logs&& logs);
+
+    // Return the last buffer.
+    // If the last buffer is big enough, create a new one
+    BufferPtr getLastBuffer(LogID id, size_t expectedToWrite);
+
+    // Remove the segments in the files removed
+    void removeExpiredSegments();
+
+private:
+    std::shared_ptr<SharedWal> wal_;
+    const GraphSpaceID spaceId_;
+    const PartitionID partId_;
+    PreProcessor preProcessor_;
+
+    LogID firstLogId_{0};
+    SharedWalIndex index_;
+    mutable std::mutex indexMutex_;
+
+    // The purpose of the memory buffer is to provide a read cache
+    BufferList buffers_;
+    mutable std::mutex buffersMutex_;
+};
+
+}  // namespace wal
+}  // namespace nebula
+#endif  // WAL_SHAREDWAL_H_
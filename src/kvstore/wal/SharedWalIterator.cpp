@@ -0,0 +1,238 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include "kvstore/wal/SharedWalIterator.h"
+
+namespace nebula {
+namespace wal {
+
+SharedWalIterator::SharedWalIterator(
+    std::shared_ptr<SharedWalPart> wal,
+    LogID startId,
+    LogID lastId)
+        : wal_(std::move(wal))
+        , currId_(startId) {
+    if (lastId >= 0) {
+        lastId_ = lastId;
+    } else {
+        lastId_ = wal_->lastLogId();
+    }
+
+    if (currId_ > lastId_) {
+        return;
+    }
+
+    if (startId < wal_->firstLogId()) {
+        LOG(ERROR) << "The given log id " << startId
+                   << " is out of the range";
+        currId_ = lastId_ + 1;
+        return;
+    }
+
+    // Pick all buffers that match the range [currId_, lastId_]
+    wal_->accessAllBuffers([this] (BufferPtr buffer) {
+        if (buffer->empty()) {
+            // Skip th empty one.
+            return true;
+        }
+        if (lastId_ >= buffer->firstLogId()) {
+            buffers_.push_front(buffer);
+            firstIdInBuffer_ = buffer->firstLogId();
+        }
+        if (firstIdInBuffer_ <= currId_) {
+            // Go no futher
+            currIdx_ = currId_ - firstIdInBuffer_;
+            currTerm_ = buffers_.front()->getTerm(currIdx_);
+            nextFirstId_ = getFirstIdInNextBuffer();
+            return false;
+        } else {
+            return true;
+        }
+    });
+
+    if (firstIdInBuffer_ <= currId_) {
+        return;
+    }
+
+    // We need to read from the WAL files
+    for (auto& segment : wal_->segments()) {
+        if (segment.lastId < currId_ || segment.firstId >= firstIdInBuffer_) {
+            continue;
+        }
+        if (fds_.find(segment.fileId) == fds_.end()) {
+            auto path = wal_->sharedWal()->filePath(segment.fileId);
+            int32_t fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                LOG(ERROR) << "Failed to open wal file \"" << path
+                           << "\" (" << errno << "): " << strerror(errno);
+                currId_ = lastId_ + 1;
+                return;
+            }
+            fds_.emplace(segment.fileId, fd);
+        }
+        segments_.emplace_back(segment);
+    }
+
+    if (segments_.empty() || segments_.front().firstId > currId_) {
+        LOG(ERROR) << "LogID " << currId_
+                   << " is out of the wal files range";
+        currId_ = lastId_ + 1;
+        return;
+    }
+
+    // Find the correct position in the first segment
+    currPos_ = segments_.front().offset;
+    seek();
+}
+
+
+SharedWalIterator::~SharedWalIterator() {
+    for (auto& fd : fds_) {
+        close(fd.second);
+    }
+}
+
+
+void SharedWalIterator::seek() {
+    int32_t fd = fds_[segments_.front().fileId];
+    auto spaceId = wal_->spaceId();
+    auto partId = wal_->partId();
+    while (true) {
+        CHECK(SharedWal::readRecord(fd, currPos_, currRecord_))
+            << "Failed to read the log " << currId_ << " at " << currPos_
+            << " (errno: " << errno << "): " << strerror(errno);
+        if (currRecord_.spaceId == spaceId
+                && currRecord_.partId == partId
+                && !currRecord_.isTruncate()
+                && currRecord_.logId == currId_) {
+            break;
+        }
+        // Skip the records of the other parts
+        currPos_ += currRecord_.size();
+    }
+    currTerm_ = currRecord_.term;
+}
+
+
+LogIterator& SharedWalIterator::operator++() {
+    ++currId_;
+    if (currId_ > lastId_) {
+        return *this;
+    }
+
+    if (currId_ < firstIdInBuffer_) {
+        // Still in the WAL files
+        if (currId_ > segments_.front().lastId) {
+            // Need to move to the next segment
+            segments_.pop_front();
+            if (segments_.empty()) {
+                // Reached the end of wal files, only happens
+                // when there is no buffer to read
+                CHECK_EQ(std::numeric_limits<LogID>::max(),
+                         firstIdInBuffer_);
+                currId_ = lastId_ + 1;
+                return *this;
+            }
+            CHECK_EQ(currId_, segments_.front().firstId);
+            currPos_ = segments_.front().offset;
+        } else {
+            currPos_ += currRecord_.size();
+        }
+        seek();
+    } else {
+        // Need to adjust nextFirstId_, in case we just start
+        // reading buffers
+        if (currId_ == firstIdInBuffer_) {
+            nextFirstId_ = getFirstIdInNextBuffer();
+            CHECK_LT(firstIdInBuffer_, nextFirstId_);
+            currIdx_ = -1;
+        }
+
+        // Read from buffer
+        if (currId_ >= nextFirstId_) {
+            // Roll over to next buffer
+            buffers_.pop_front();
+            CHECK(!buffers_.empty());
+            CHECK_EQ(currId_, buffers_.front()->firstLogId());
+
+            nextFirstId_ = getFirstIdInNextBuffer();
+            currIdx_ = 0;
+        } else {
+            ++currIdx_;
+        }
+        currTerm_ = buffers_.front()->getTerm(currIdx_);
+    }
+
+    return *this;
+}
+
+
+bool SharedWalIterator::valid() const {
+    return currId_ <= lastId_;
+}
+
+
+LogID SharedWalIterator::logId() const {
+    return currId_;
+}
+
+
+TermID SharedWalIterator::logTerm() const {
+    return currTerm_;
+}
+
+
+ClusterID SharedWalIterator::logSource() const {
+    if (currId_ >= firstIdInBuffer_) {
+        // Retrieve from the buffer
+        DCHECK(!buffers_.empty());
+        return buffers_.front()->getCluster(currIdx_);
+    } else {
+        // Retrieve from the file
+        return currRecord_.cluster;
+    }
+}
+
+
+folly::StringPiece SharedWalIterator::logMsg() const {
+    if (currId_ >= firstIdInBuffer_) {
+        // Retrieve from the buffer
+        DCHECK(!buffers_.empty());
+        return buffers_.front()->getLog(currIdx_);
+    } else {
+        // Retrieve from the file
+        DCHECK(!segments_.empty());
+        auto it = fds_.find(segments_.front().fileId);
+        DCHECK(it != fds_.end());
+
+        currLog_.resize(currRecord_.len);
+        CHECK_EQ(pread(it->second,
+                       &(currLog_[0]),
+                       currRecord_.len,
+                       currPos_ + SharedWalRecord::kHeaderSize),
+                 static_cast<ssize_t>(currRecord_.len))
+            << "Failed to read. Curr position is " << currPos_
+            << ", expected read length is " << currRecord_.len
+            << " (errno: " << errno << "): " << strerror(errno);
+
+        return currLog_;
+    }
+}
+
+
+LogID SharedWalIterator::getFirstIdInNextBuffer() const {
+    auto it = buffers_.begin();
+    ++it;
+    if (it == buffers_.end()) {
+        return buffers_.front()->lastLogId() + 1;
+    } else {
+        return (*it)->firstLogId();
+    }
+}
+
+}  // namespace wal
+}  // namespace nebula
@@ -0,0 +1,80 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef WAL_SHAREDWALITERATOR_H_
+#define WAL_SHAREDWALITERATOR_H_
+
+#include "base/Base.h"
+#include "base/LogIterator.h"
+#include "kvstore/wal/InMemoryLogBuffer.h"
+#include "kvstore/wal/SharedWal.h"
+
+namespace nebula {
+namespace wal {
+
+/**
+ * Log message iterator of a part in the SharedWal
+ *
+ * The iterator tries to find the given log message either in the in-memory
+ * buffers, or in the segments of the shared wal files, skipping the records
+ * of the other parts. If the given log id is out of range, an invalid
+ * (valid() method will return false) iterator will be constructed
+ */
+class SharedWalIterator final : public LogIterator {
+public:
+    // The range is [startId, lastId]
+    // if the lastId < 0, the wal_->lastLogId() will be used
+    SharedWalIterator(std::shared_ptr<SharedWalPart> wal,
+                      LogID startId,
+                      LogID lastId = -1);
+    virtual ~SharedWalIterator();
+
+    LogIterator& operator++() override;
+
+    bool valid() const override;
+
+    LogID logId() const override;
+
+    TermID logTerm() const override;
+
+    ClusterID logSource() const override;
+
+    folly::StringPiece logMsg() const override;
+
+private:
+    LogID getFirstIdInNextBuffer() const;
+
+    // Move currPos_ forward to the record of currId_ in the current segment
+    void seek();
+
+private:
+    // Holds the Wal object, so that it will not be destroyed before the iterator
+    std::shared_ptr<SharedWalPart> wal_;
+
+    LogID lastId_;
+    LogID currId_;
+    TermID currTerm_;
+    LogID firstIdInBuffer_{std::numeric_limits<LogID>::max()};
+
+    // First id in next buffer
+    LogID nextFirstId_;
+
+    BufferList buffers_;
+    size_t currIdx_{0};
+
+    // The segments to read before the buffers
+    std::deque<SharedWalSegment> segments_;
+    // fileId -> fd
+    std::unordered_map<int64_t, int32_t> fds_;
+    size_t currPos_{0};
+    SharedWalRecord currRecord_;
+    mutable std::string currLog_;
+};
+
+}  // namespace wal
+}  // namespace nebula
+
+#endif  // WAL_SHAREDWALITERATOR_H_
@@ -8,11 +8,15 @@
 #define WAL_WAL_H_
 
 #include "base/Base.h"
+#include <folly/Function.h>
 #include "base/LogIterator.h"
 
 namespace nebula {
 namespace wal {
 
+using PreProcessor = folly::Function<bool(LogID, TermID, ClusterID, const std::string& log)>;
+
+
 /**
  * Base class for all WAL implementations
  */
@@ -0,0 +1,265 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include <gtest/gtest.h>
+#include "kvstore/wal/SharedWal.h"
+#include "fs/TempDir.h"
+
+namespace nebula {
+namespace wal {
+
+using nebula::fs::TempDir;
+
+std::shared_ptr<SharedWalPart> partWal(std::shared_ptr<SharedWal> wal, PartitionID partId) {
+    return wal->partWal(1,
+                        partId,
+                        [](LogID, TermID, ClusterID, const std::string&) {
+                            return true;
+                        });
+}
+
+
+void checkLogs(std::shared_ptr<SharedWalPart> wal,
+               LogID start,
+               LogID end,
+               const char* fmt) {
+    auto it = wal->iterator(start, end);
+    LogID id = start;
+    while (it->valid()) {
+        EXPECT_EQ(id, it->logId());
+        EXPECT_EQ(folly::stringPrintf(fmt, wal->partId(), id), it->logMsg());
+        ++(*it);
+        ++id;
+    }
+    EXPECT_EQ(end + 1, id);
+}
+
+
+TEST(SharedWal, AppendLogsOfParts) {
+    SharedWalPolicy policy;
+    TempDir walDir("/tmp/testSharedWal.XXXXXX");
+
+    auto wal = SharedWal::getWal(walDir.path(), policy);
+    auto part1 = partWal(wal, 1);
+    auto part2 = partWal(wal, 2);
+    EXPECT_EQ(0, part1->lastLogId());
+    EXPECT_EQ(0, part2->lastLogId());
+
+    // The logs of the two parts are interleaved in the file
+    for (int i = 1; i <= 10; i++) {
+        for (auto& part : {part1, part2}) {
+            EXPECT_TRUE(
+                part->appendLog(i /*id*/, 1 /*term*/, 0 /*cluster*/,
+                                folly::stringPrintf("Part %d, log %02d", part->partId(), i)));
+        }
+    }
+    EXPECT_EQ(10, part1->lastLogId());
+    EXPECT_EQ(10, part2->lastLogId());
+    checkLogs(part1, 1, 10, "Part %d, log %02ld");
+    checkLogs(part2, 1, 10, "Part %d, log %02ld");
+
+    // Close the wal
+    part1.reset();
+    part2.reset();
+    wal.reset();
+
+    // Now let's open it to read from the file
+    wal = SharedWal::getWal(walDir.path(), policy);
+    part1 = partWal(wal, 1);
+    part2 = partWal(wal, 2);
+    EXPECT_EQ(1, part1->firstLogId());
+    EXPECT_EQ(10, part1->lastLogId());
+    EXPECT_EQ(1, part1->lastLogTerm());
+    EXPECT_EQ(10, part2->lastLogId());
+    checkLogs(part1, 1, 10, "Part %d, log %02ld");
+    checkLogs(part2, 3, 8, "Part %d, log %02ld");
+
+    // Continue appending after reopening
+    EXPECT_TRUE(part1->appendLog(11, 2, 0, "Part 1, log 11"));
+    EXPECT_EQ(11, part1->lastLogId());
+    EXPECT_EQ(2, part1->lastLogTerm());
+    checkLogs(part1, 1, 11, "Part %d, log %02ld");
+}
+
+
+TEST(SharedWal, MultipleFilesAndBuffers) {
+    // Force to make each file 1KB, each buffer is 512 bytes, and there are two
+    // buffers at most
+    SharedWalPolicy policy;
+    policy.fileSize = 1024;
+    policy.bufferSize = 512;
+    policy.numBuffers = 2;
+    TempDir walDir("/tmp/testSharedWal.XXXXXX");
+
+    auto wal = SharedWal::getWal(walDir.path(), policy);
+    auto part1 = partWal(wal, 1);
+    auto part2 = partWal(wal, 2);
+    for (int i = 1; i <= 200; i++) {
+        for (auto& part : {part1, part2}) {
+            EXPECT_TRUE(
+                part->appendLog(i /*id*/, 1 /*term*/, 0 /*cluster*/,
+                                folly::stringPrintf("Part %d, log %03d", part->partId(), i)));
+        }
+    }
+    // Read across the files and the buffers
+    checkLogs(part1, 1, 200, "Part %d, log %03ld");
+    checkLogs(part2, 150, 200, "Part %d, log %03ld");
+
+    part1.reset();
+    part2.reset();
+    wal.reset();
+
+    wal = SharedWal::getWal(walDir.path(), policy);
+    part1 = partWal(wal, 1);
+    part2 = partWal(wal, 2);
+    EXPECT_EQ(200, part1->lastLogId());
+    EXPECT_EQ(200, part2->lastLogId());
+    checkLogs(part1, 1, 200, "Part %d, log %03ld");
+    checkLogs(part2, 1, 200, "Part %d, log %03ld");
+}
+
+
+TEST(SharedWal, Rollback) {
+    SharedWalPolicy policy;
+    policy.fileSize = 1024;
+    TempDir walDir("/tmp/testSharedWal.XXXXXX");
+
+    auto wal = SharedWal::getWal(walDir.path(), policy);
+    auto part1 = partWal(wal, 1);
+    auto part2 = partWal(wal, 2);
+    for (int i = 1; i <= 100; i++) {
+        for (auto& part : {part1, part2}) {
+            EXPECT_TRUE(
+                part->appendLog(i /*id*/, 1 /*term*/, 0 /*cluster*/,
+                                folly::stringPrintf("Part %d, log %03d", part->partId(), i)));
+        }
+    }
+
+    // Roll back the part 1, and append the logs of a new term
+    EXPECT_TRUE(part1->rollbackToLog(50));
+    EXPECT_EQ(50, part1->lastLogId());
+    EXPECT_EQ(1, part1->lastLogTerm());
+    for (int i = 51; i <= 80; i++) {
+        EXPECT_TRUE(
+            part1->appendLog(i /*id*/, 2 /*term*/, 0 /*cluster*/,
+                             folly::stringPrintf("Part %d, new log %03d", 1, i)));
+    }
+    // Roll back the part 2 without appending new logs
+    EXPECT_TRUE(part2->rollbackToLog(90));
+
+    auto check = [] (std::shared_ptr<SharedWalPart> part1, std::shared_ptr<SharedWalPart> part2) {
+        EXPECT_EQ(80, part1->lastLogId());
+        EXPECT_EQ(2, part1->lastLogTerm());
+        checkLogs(part1, 1, 50, "Part %d, log %03ld");
+        checkLogs(part1, 51, 80, "Part %d, new log %03ld");
+        EXPECT_EQ(90, part2->lastLogId());
+        checkLogs(part2, 1, 90, "Part %d, log %03ld");
+    };
+    check(part1, part2);
+
+    part1.reset();
+    part2.reset();
+    wal.reset();
+
+    // The logs rolled back should not come back
+    wal = SharedWal::getWal(walDir.path(), policy);
+    check(partWal(wal, 1), partWal(wal, 2));
+}
+
+
+TEST(SharedWal, Reset) {
+    SharedWalPolicy policy;
+    TempDir walDir("/tmp/testSharedWal.XXXXXX");
+
+    auto wal = SharedWal::getWal(walDir.path(), policy);
+    auto part1 = partWal(wal, 1);
+    for (int i = 1; i <= 10; i++) {
+        EXPECT_TRUE(part1->appendLog(i, 1, 0, folly::stringPrintf("Part 1, log %03d", i)));
+    }
+    EXPECT_TRUE(part1->reset());
+    EXPECT_EQ(0, part1->firstLogId());
+    EXPECT_EQ(0, part1->lastLogId());
+
+    // The logs could start from any id after reset
+    for (int i = 101; i <= 110; i++) {
+        EXPECT_TRUE(part1->appendLog(i, 1, 0, folly::stringPrintf("Part 1, log %03d", i)));
+    }
+    part1.reset();
+    wal.reset();
+
+    wal = SharedWal::getWal(walDir.path(), policy);
+    part1 = partWal(wal, 1);
+    EXPECT_EQ(101, part1->firstLogId());
+    EXPECT_EQ(110, part1->lastLogId());
+    checkLogs(part1, 101, 110, "Part %d, log %03ld");
+}
+
+
+TEST(SharedWal, GroupCommit) {
+    SharedWalPolicy policy;
+    policy.groupCommitWindowUs = 100;
+    TempDir walDir("/tmp/testSharedWal.XXXXXX");
+
+    const int32_t numParts = 16;
+    const int32_t numLogs = 200;
+    auto wal = SharedWal::getWal(walDir.path(), policy);
+    std::vector<std::thread> threads;
+    for (int32_t partId = 1; partId <= numParts; partId++) {
+        threads.emplace_back([wal, partId, numLogs] {
+            auto part = partWal(wal, partId);
+            for (int i = 1; i <= numLogs; i++) {
+                EXPECT_TRUE(
+                    part->appendLog(i, 1, 0, folly::stringPrintf("Part %d, log %03d", partId, i)));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    wal.reset();
+
+    wal = SharedWal::getWal(walDir.path(), policy);
+    for (int32_t partId = 1; partId <= numParts; partId++) {
+        auto part = partWal(wal, partId);
+        EXPECT_EQ(numLogs, part->lastLogId());
+        checkLogs(part, 1, numLogs, "Part %d, log %03ld");
+    }
+}
+
+
+TEST(SharedWal, TTLTest) {
+    SharedWalPolicy policy;
+    policy.ttl = 1;
+    policy.fileSize = 1024;
+    TempDir walDir("/tmp/testSharedWal.XXXXXX");
+
+    auto wal = SharedWal::getWal(walDir.path(), policy);
+    auto part1 = partWal(wal, 1);
+    for (int i = 1; i <= 100; i++) {
+        EXPECT_TRUE(part1->appendLog(i, 1, 0, folly::stringPrintf("Part 1, log %03d", i)));
+    }
+    EXPECT_EQ(1, part1->firstLogId());
+    sleep(policy.ttl + 1);
+
+    // All the files expired except the last one
+    part1->cleanWAL();
+    EXPECT_LT(1, part1->firstLogId());
+    EXPECT_EQ(100, part1->lastLogId());
+    checkLogs(part1, part1->firstLogId(), 100, "Part %d, log %03ld");
+}
+
+}  // namespace wal
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+
+    return RUN_ALL_TESTS();
+}
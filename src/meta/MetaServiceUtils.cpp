@@ -330,6 +330,10 @@ cpp2::ErrorCode MetaServiceUtils::alterSchemaProp(std::vector<nebula::cpp2::Colu
         // Graph check  <=0 to = 0
         schemaProp.set_ttl_duration(*alterSchemaProp.get_ttl_duration());
     }
+    if (alterSchemaProp.__isset.row_format) {
+        // The rows written before keep their format, since every row tells its own format
+        schemaProp.set_row_format(*alterSchemaProp.get_row_format());
+    }
     if (alterSchemaProp.__isset.ttl_col) {
         auto ttlCol = *alterSchemaProp.get_ttl_col();
         auto existed = false;
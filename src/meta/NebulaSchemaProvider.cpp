@@ -18,6 +18,11 @@ size_t NebulaSchemaProvider::getNumFields() const noexcept {
     return fields_.size();
 }
 
+nebula::cpp2::RowFormat NebulaSchemaProvider::getRowFormat() const noexcept {
+    auto* format = schemaProp_.get_row_format();
+    return format == nullptr ? nebula::cpp2::RowFormat::V1 : *format;
+}
+
 int64_t NebulaSchemaProvider::getFieldIndex(const folly::StringPiece name) const {
     auto it = fieldNameIndex_.find(name.toString());
     if (it == fieldNameIndex_.end()) {
@@ -43,6 +43,7 @@ public:
 
     SchemaVer getVersion() const noexcept override;
     size_t getNumFields() const noexcept override;
+    nebula::cpp2::RowFormat getRowFormat() const noexcept override;
 
     int64_t getFieldIndex(const folly::StringPiece name) const override;
     const char* getFieldName(int64_t index) const override;
@@ -88,6 +88,8 @@ public:
 
     virtual SchemaVer getVersion() const noexcept = 0;
     virtual size_t getNumFields() const noexcept = 0;
+    // The format in which the new rows of the schema are written
+    virtual nebula::cpp2::RowFormat getRowFormat() const noexcept = 0;
 
     virtual int64_t getFieldIndex(const folly::StringPiece name) const = 0;
     virtual const char* getFieldName(int64_t index) const = 0;
@@ -142,9 +142,17 @@ void MetaClient::loadData() {
             return;
         }
 
+        auto item = getSpace(space.second).get();
+        if (!item.ok()) {
+            LOG(ERROR) << "Get space failed for spaceId " << spaceId
+                       << ", status " << item.status();
+            return;
+        }
+
         auto spaceCache = std::make_shared<SpaceInfoCache>();
         auto partsAlloc = r.value();
         spaceCache->spaceName = space.second;
+        spaceCache->maintainDegrees_ = item.value().get_properties().get_maintain_degrees();
         spaceCache->partsOnHost_ = reverse(partsAlloc);
         spaceCache->partsAlloc_ = std::move(partsAlloc);
         VLOG(2) << "Load space " << spaceId
@@ -472,11 +480,15 @@ void MetaClient::diff(const LocalCache& oldCache, const LocalCache& newCache) {
 /// ================================== public methods =================================
 
 folly::Future<StatusOr<GraphSpaceID>>
-MetaClient::createSpace(std::string name, int32_t partsNum, int32_t replicaFactor) {
+MetaClient::createSpace(std::string name,
+                        int32_t partsNum,
+                        int32_t replicaFactor,
+                        bool maintainDegrees) {
     cpp2::SpaceProperties properties;
     properties.set_space_name(std::move(name));
     properties.set_partition_num(partsNum);
     properties.set_replica_factor(replicaFactor);
+    properties.set_maintain_degrees(maintainDegrees);
     cpp2::CreateSpaceReq req;
     req.set_properties(std::move(properties));
     folly::Promise<StatusOr<GraphSpaceID>> promise;
@@ -619,6 +631,19 @@ MetaClient::getSpaceIdByNameFromCache(const std::string& name) {
 }
 
 
+bool MetaClient::maintainDegreesFromCache(GraphSpaceID spaceId) {
+    if (!ready_) {
+        return false;
+    }
+    folly::RWSpinLock::ReadHolder holder(localCacheLock_);
+    auto it = localCache_.find(spaceId);
+    if (it != localCache_.end()) {
+        return it->second->maintainDegrees_;
+    }
+    return false;
+}
+
+
 StatusOr<TagID> MetaClient::getTagIDByNameFromCache(const GraphSpaceID& space,
                                                     const std::string& name) {
     if (!ready_) {
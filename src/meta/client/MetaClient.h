@@ -36,6 +36,7 @@ using EdgeTypeSchemas = std::unordered_map<std::pair<EdgeType, SchemaVer>,
 
 struct SpaceInfoCache {
     std::string spaceName;
+    bool maintainDegrees_{false};
     PartsAlloc partsAlloc_;
     std::unordered_map<HostAddr, std::vector<PartitionID>> partsOnHost_;
     TagIDSchemas tagSchemas_;
@@ -121,7 +122,10 @@ public:
      * TODO(dangleptr): Use one struct to represent space description.
      * */
     folly::Future<StatusOr<GraphSpaceID>>
-    createSpace(std::string name, int32_t partsNum, int32_t replicaFactor);
+    createSpace(std::string name,
+                int32_t partsNum,
+                int32_t replicaFactor,
+                bool maintainDegrees = false);
 
     folly::Future<StatusOr<std::vector<SpaceIdName>>>
     listSpaces();
@@ -226,6 +230,9 @@ public:
     // Opeartions for cache.
     StatusOr<GraphSpaceID> getSpaceIdByNameFromCache(const std::string& name);
 
+    // Whether the degree counters are maintained in the space, false if it is not found
+    bool maintainDegreesFromCache(GraphSpaceID spaceId);
+
     StatusOr<TagID> getTagIDByNameFromCache(const GraphSpaceID& space, const std::string& name);
 
     StatusOr<EdgeType> getEdgeTypeByNameFromCache(const GraphSpaceID& space,
@@ -68,6 +68,9 @@ std::string SpaceOptItem::toString() const {
             return folly::stringPrintf("partition_num = %ld", boost::get<int64_t>(optValue_));
         case REPLICA_FACTOR:
             return folly::stringPrintf("replica_factor = %ld", boost::get<int64_t>(optValue_));
+        case MAINTAIN_DEGREES:
+            return folly::stringPrintf("maintain_degrees = %s",
+                                       boost::get<bool>(optValue_) ? "true" : "false");
         default:
              FLOG_FATAL("Space parameter illegal");
     }
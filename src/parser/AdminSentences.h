@@ -130,10 +130,10 @@ private:
 
 class SpaceOptItem final {
 public:
-    using Value = boost::variant<int64_t, std::string>;
+    using Value = boost::variant<int64_t, std::string, bool>;
 
     enum OptionType : uint8_t {
-        PARTITION_NUM, REPLICA_FACTOR
+        PARTITION_NUM, REPLICA_FACTOR, MAINTAIN_DEGREES
     };
 
     SpaceOptItem(OptionType op, std::string val) {
@@ -146,6 +146,11 @@ public:
         optValue_ = val;
     }
 
+    SpaceOptItem(OptionType op, bool val) {
+        optType_ = op;
+        optValue_ = val;
+    }
+
     int64_t asInt() {
         return boost::get<int64_t>(optValue_);
     }
@@ -162,6 +167,10 @@ public:
         return optValue_.which() == 1;
     }
 
+    bool isBool() {
+        return optValue_.which() == 2;
+    }
+
     int64_t get_partition_num() {
         if (isInt()) {
             return asInt();
@@ -180,6 +189,15 @@ public:
         }
     }
 
+    bool get_maintain_degrees() {
+        if (isBool()) {
+            return boost::get<bool>(optValue_);
+        } else {
+            LOG(ERROR) << "maintain_degrees value illegal.";
+            return false;
+        }
+    }
+
     OptionType getOptType() {
         return optType_;
     }
@@ -61,21 +61,59 @@ std::string FromClause::toString() const {
 }
 
 
-std::string OverClause::toString() const {
+std::string OverEdge::toString() const {
     std::string buf;
     buf.reserve(256);
-    buf += "OVER ";
     buf += *edge_;
     if (alias_ != nullptr) {
         buf += " AS ";
         buf += *alias_;
     }
+    return buf;
+}
+
+
+std::string OverEdges::toString() const {
+    std::string buf;
+    buf.reserve(256);
+    for (auto &edge : edges_) {
+        buf += edge->toString();
+        buf += ",";
+    }
+    if (!buf.empty()) {
+        buf.resize(buf.size() - 1);
+    }
+    return buf;
+}
+
+
+std::string OverClause::toString() const {
+    std::string buf;
+    buf.reserve(256);
+    buf += "OVER ";
+    buf += overEdges_->toString();
     if (isReversely_) {
         buf += " REVERSELY";
     }
     return buf;
 }
 
+std::string SampleClause::toString() const {
+    std::string buf;
+    buf.reserve(32);
+    buf += "SAMPLE ";
+    buf += std::to_string(count_);
+    return buf;
+}
+
+std::string LimitClause::toString() const {
+    std::string buf;
+    buf.reserve(32);
+    buf += "LIMIT ";
+    buf += std::to_string(count_);
+    return buf;
+}
+
 std::string WhereClause::toString() const {
     std::string buf;
     buf.reserve(256);
@@ -104,18 +104,11 @@ private:
 };
 
 
-class OverClause final {
+class OverEdge final {
 public:
-    explicit OverClause(std::string *edge,
-                        std::string *alias = nullptr,
-                        bool isReversely = false) {
+    explicit OverEdge(std::string *edge, std::string *alias = nullptr) {
         edge_.reset(edge);
         alias_.reset(alias);
-        isReversely_ = isReversely;
-    }
-
-    bool isReversely() const {
-        return isReversely_;
     }
 
     std::string* edge() const {
@@ -129,12 +122,91 @@ public:
     std::string toString() const;
 
 private:
-    bool                                        isReversely_{false};
     std::unique_ptr<std::string>                edge_;
     std::unique_ptr<std::string>                alias_;
 };
 
 
+class OverEdges final {
+public:
+    void addEdge(OverEdge *edge) {
+        edges_.emplace_back(edge);
+    }
+
+    std::vector<OverEdge*> edges() const {
+        std::vector<OverEdge*> result;
+        result.resize(edges_.size());
+        auto get = [] (auto &edge) { return edge.get(); };
+        std::transform(edges_.begin(), edges_.end(), result.begin(), get);
+        return result;
+    }
+
+    std::string toString() const;
+
+private:
+    std::vector<std::unique_ptr<OverEdge>>      edges_;
+};
+
+
+class OverClause final {
+public:
+    explicit OverClause(OverEdges *edges, bool isReversely = false) {
+        overEdges_.reset(edges);
+        isReversely_ = isReversely;
+    }
+
+    bool isReversely() const {
+        return isReversely_;
+    }
+
+    std::vector<OverEdge*> edges() const {
+        return overEdges_->edges();
+    }
+
+    std::string toString() const;
+
+private:
+    bool                                        isReversely_{false};
+    std::unique_ptr<OverEdges>                  overEdges_;
+};
+
+
+// SAMPLE <count>, to choose at most `count' edges of each vertex randomly
+class SampleClause final {
+public:
+    explicit SampleClause(int64_t count) {
+        count_ = count;
+    }
+
+    int64_t count() const {
+        return count_;
+    }
+
+    std::string toString() const;
+
+private:
+    int64_t                                     count_{0};
+};
+
+
+// LIMIT <count>, to return at most `count' rows
+class LimitClause final {
+public:
+    explicit LimitClause(int64_t count) {
+        count_ = count;
+    }
+
+    int64_t count() const {
+        return count_;
+    }
+
+    std::string toString() const;
+
+private:
+    int64_t                                     count_{0};
+};
+
+
 class WhereClause final {
 public:
     explicit WhereClause(Expression *filter) {
@@ -24,6 +24,10 @@ std::string GoSentence::toString() const {
         buf += " ";
         buf += overClause_->toString();
     }
+    if (sampleClause_ != nullptr) {
+        buf += " ";
+        buf += sampleClause_->toString();
+    }
     if (whereClause_ != nullptr) {
         buf += " ";
         buf += whereClause_->toString();
@@ -32,6 +36,10 @@ std::string GoSentence::toString() const {
         buf += " ";
         buf += yieldClause_->toString();
     }
+    if (limitClause_ != nullptr) {
+        buf += " ";
+        buf += limitClause_->toString();
+    }
 
     return buf;
 }
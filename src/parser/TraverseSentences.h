@@ -31,6 +31,10 @@ public:
         overClause_.reset(clause);
     }
 
+    void setSampleClause(SampleClause *clause) {
+        sampleClause_.reset(clause);
+    }
+
     void setWhereClause(WhereClause *clause) {
         whereClause_.reset(clause);
     }
@@ -39,6 +43,10 @@ public:
         yieldClause_.reset(clause);
     }
 
+    void setLimitClause(LimitClause *clause) {
+        limitClause_.reset(clause);
+    }
+
     const StepClause* stepClause() const {
         return stepClause_.get();
     }
@@ -51,6 +59,10 @@ public:
         return overClause_.get();
     }
 
+    const SampleClause* sampleClause() const {
+        return sampleClause_.get();
+    }
+
     const WhereClause* whereClause() const {
         return whereClause_.get();
     }
@@ -59,14 +71,20 @@ public:
         return yieldClause_.get();
     }
 
+    const LimitClause* limitClause() const {
+        return limitClause_.get();
+    }
+
     std::string toString() const override;
 
 private:
     std::unique_ptr<StepClause>                 stepClause_;
     std::unique_ptr<FromClause>                 fromClause_;
     std::unique_ptr<OverClause>                 overClause_;
+    std::unique_ptr<SampleClause>               sampleClause_;
     std::unique_ptr<WhereClause>                whereClause_;
     std::unique_ptr<YieldClause>                yieldClause_;
+    std::unique_ptr<LimitClause>                limitClause_;
 };
 
 
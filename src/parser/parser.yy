@@ -45,6 +45,10 @@ class GraphScanner;
     nebula::FromClause                     *from_clause;
     nebula::VertexIDList                   *vid_list;
     nebula::OverClause                     *over_clause;
+    nebula::OverEdge                       *over_edge;
+    nebula::OverEdges                      *over_edges;
+    nebula::SampleClause                   *sample_clause;
+    nebula::LimitClause                    *limit_clause;
     nebula::WhereClause                    *where_clause;
     nebula::YieldClause                    *yield_clause;
     nebula::YieldColumns                   *yield_columns;
@@ -95,7 +99,7 @@ class GraphScanner;
 %token KW_EDGE KW_EDGES KW_UPDATE KW_STEPS KW_OVER KW_UPTO KW_REVERSELY KW_SPACE KW_DELETE KW_FIND
 %token KW_INT KW_BIGINT KW_DOUBLE KW_STRING KW_BOOL KW_TAG KW_TAGS KW_UNION KW_INTERSECT KW_MINUS
 %token KW_NO KW_OVERWRITE KW_IN KW_DESCRIBE KW_DESC KW_SHOW KW_HOSTS KW_TIMESTAMP KW_ADD
-%token KW_PARTITION_NUM KW_REPLICA_FACTOR KW_DROP KW_REMOVE KW_SPACES KW_INGEST
+%token KW_PARTITION_NUM KW_REPLICA_FACTOR KW_MAINTAIN_DEGREES KW_DROP KW_REMOVE KW_SPACES KW_INGEST
 %token KW_IF KW_NOT KW_EXISTS KW_WITH KW_FIRSTNAME KW_LASTNAME KW_EMAIL KW_PHONE KW_USER KW_USERS
 %token KW_PASSWORD KW_CHANGE KW_ROLE KW_GOD KW_ADMIN KW_GUEST KW_GRANT KW_REVOKE KW_ON
 %token KW_ROLES KW_BY KW_DOWNLOAD KW_HDFS
@@ -105,6 +109,7 @@ class GraphScanner;
 %token KW_FETCH KW_PROP
 %token KW_DISTINCT KW_ALL
 %token KW_BALANCE KW_LEADER
+%token KW_SAMPLE KW_LIMIT
 /* symbols */
 %token L_PAREN R_PAREN L_BRACKET R_BRACKET L_BRACE R_BRACE COMMA
 %token PIPE OR AND LT LE GT GE EQ NE PLUS MINUS MUL DIV MOD NOT NEG ASSIGN
@@ -135,6 +140,10 @@ class GraphScanner;
 %type <from_clause> from_clause
 %type <vid_list> vid_list
 %type <over_clause> over_clause
+%type <over_edge> over_edge
+%type <over_edges> over_edges
+%type <sample_clause> sample_clause
+%type <limit_clause> limit_clause
 %type <where_clause> where_clause
 %type <yield_clause> yield_clause
 %type <yield_columns> yield_columns
@@ -225,6 +234,7 @@ unreserved_keyword
      | KW_GOD                { $$ = new std::string("god"); }
      | KW_ADMIN              { $$ = new std::string("admin"); }
      | KW_GUEST              { $$ = new std::string("guest"); }
+     | KW_MAINTAIN_DEGREES   { $$ = new std::string("maintain_degrees"); }
      ;
 
 primary_expression
@@ -430,26 +440,42 @@ expression
     ;
 
 go_sentence
-    : KW_GO step_clause from_clause over_clause where_clause yield_clause {
+    : KW_GO step_clause from_clause over_clause sample_clause
+      where_clause yield_clause limit_clause {
         auto go = new GoSentence();
         go->setStepClause($2);
         go->setFromClause($3);
         go->setOverClause($4);
-        go->setWhereClause($5);
-        if ($6 == nullptr) {
-            auto *edge = new std::string(*$4->edge());
-            auto *expr = new EdgeDstIdExpression(edge);
-            auto *alias = new std::string("id");
-            auto *col = new YieldColumn(expr, alias);
+        go->setSampleClause($5);
+        go->setWhereClause($6);
+        if ($7 == nullptr) {
+            // Yield the dst id of each edge, which is named `id' if there is only one.
+            auto edges = $4->edges();
             auto *cols = new YieldColumns();
-            cols->addColumn(col);
-            $6 = new YieldClause(cols);
+            for (auto *e : edges) {
+                auto *edge = new std::string(e->alias() != nullptr ? *e->alias() : *e->edge());
+                auto *expr = new EdgeDstIdExpression(edge);
+                auto *alias = edges.size() == 1 ? new std::string("id") : nullptr;
+                cols->addColumn(new YieldColumn(expr, alias));
+            }
+            $7 = new YieldClause(cols);
         }
-        go->setYieldClause($6);
+        go->setYieldClause($7);
+        go->setLimitClause($8);
         $$ = go;
     }
     ;
 
+sample_clause
+    : %empty { $$ = nullptr; }
+    | KW_SAMPLE INTEGER { $$ = new SampleClause($2); }
+    ;
+
+limit_clause
+    : %empty { $$ = nullptr; }
+    | KW_LIMIT INTEGER { $$ = new LimitClause($2); }
+    ;
+
 step_clause
     : %empty { $$ = new StepClause(); }
     | INTEGER KW_STEPS { $$ = new StepClause($1); }
@@ -506,18 +532,32 @@ vid_ref_expression
     }
     ;
 
-over_clause
-    : KW_OVER name_label {
-        $$ = new OverClause($2);
+over_edge
+    : name_label {
+        $$ = new OverEdge($1);
     }
-    | KW_OVER name_label KW_REVERSELY {
-        $$ = new OverClause($2, nullptr, true);
+    | name_label KW_AS name_label {
+        $$ = new OverEdge($1, $3);
     }
-    | KW_OVER name_label KW_AS name_label {
-        $$ = new OverClause($2, $4);
+    ;
+
+over_edges
+    : over_edge {
+        $$ = new OverEdges();
+        $$->addEdge($1);
+    }
+    | over_edges COMMA over_edge {
+        $$ = $1;
+        $$->addEdge($3);
+    }
+    ;
+
+over_clause
+    : KW_OVER over_edges {
+        $$ = new OverClause($2);
     }
-    | KW_OVER name_label KW_AS name_label KW_REVERSELY {
-        $$ = new OverClause($2, $4, true);
+    | KW_OVER over_edges KW_REVERSELY {
+        $$ = new OverClause($2, true);
     }
     ;
 
@@ -1347,6 +1387,9 @@ space_opt_list
     | KW_REPLICA_FACTOR ASSIGN INTEGER {
         $$ = new SpaceOptItem(SpaceOptItem::REPLICA_FACTOR, $3);
     }
+    | KW_MAINTAIN_DEGREES ASSIGN BOOL {
+        $$ = new SpaceOptItem(SpaceOptItem::MAINTAIN_DEGREES, $3);
+    }
     // TODO(YT) Create Spaces for different engines
     // KW_ENGINE_TYPE ASSIGN name_label
     ;
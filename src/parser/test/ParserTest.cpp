@@ -55,6 +55,25 @@ TEST(Parser, Go) {
         auto result = parser.parse(query);
         ASSERT_TRUE(result.ok()) << result.status();
     }
+    {
+        GQLParser parser;
+        std::string query = "GO FROM 1 OVER friend, serve";
+        auto result = parser.parse(query);
+        ASSERT_TRUE(result.ok()) << result.status();
+    }
+    {
+        GQLParser parser;
+        std::string query = "GO FROM 1 OVER friend AS f, serve AS s REVERSELY "
+                            "YIELD f._dst, s._dst";
+        auto result = parser.parse(query);
+        ASSERT_TRUE(result.ok()) << result.status();
+    }
+    {
+        GQLParser parser;
+        std::string query = "GO FROM 1 OVER friend, YIELD friend._dst";
+        auto result = parser.parse(query);
+        ASSERT_FALSE(result.ok());
+    }
     {
         GQLParser parser;
         std::string query = "GO FROM 1 OVER friend "
@@ -69,6 +88,32 @@ TEST(Parser, Go) {
         auto result = parser.parse(query);
         ASSERT_TRUE(result.ok()) << result.status();
     }
+    {
+        GQLParser parser;
+        std::string query = "GO FROM 1 OVER friend SAMPLE 10";
+        auto result = parser.parse(query);
+        ASSERT_TRUE(result.ok()) << result.status();
+    }
+    {
+        GQLParser parser;
+        std::string query = "GO 2 STEPS FROM 1 OVER friend SAMPLE 10 "
+                            "WHERE friend.start > 2011 YIELD friend._dst LIMIT 5";
+        auto result = parser.parse(query);
+        ASSERT_TRUE(result.ok()) << result.status();
+    }
+    {
+        GQLParser parser;
+        std::string query = "GO FROM 1 OVER friend LIMIT 5 | "
+                            "GO FROM $-.id OVER friend SAMPLE 3";
+        auto result = parser.parse(query);
+        ASSERT_TRUE(result.ok()) << result.status();
+    }
+    {
+        GQLParser parser;
+        std::string query = "GO FROM 1 OVER friend LIMIT 5 SAMPLE 3";
+        auto result = parser.parse(query);
+        ASSERT_FALSE(result.ok());
+    }
     // Test wrong syntax
     {
         GQLParser parser;
@@ -116,6 +161,13 @@ TEST(Parser, SpaceOperation) {
         auto result = parser.parse(query);
         ASSERT_TRUE(result.ok()) << result.status();
     }
+    {
+        GQLParser parser;
+        std::string query = "CREATE SPACE default_space(partition_num=9, replica_factor=3, "
+                            "maintain_degrees=true)";
+        auto result = parser.parse(query);
+        ASSERT_TRUE(result.ok()) << result.status();
+    }
     {
         GQLParser parser;
         std::string query = "USE default_space";
@@ -256,6 +256,9 @@ TEST(Scanner, Basic) {
         CHECK_SEMANTIC_TYPE("REPLICA_FACTOR", TokenType::KW_REPLICA_FACTOR),
         CHECK_SEMANTIC_TYPE("replica_factor", TokenType::KW_REPLICA_FACTOR),
         CHECK_SEMANTIC_TYPE("Replica_factor", TokenType::KW_REPLICA_FACTOR),
+        CHECK_SEMANTIC_TYPE("MAINTAIN_DEGREES", TokenType::KW_MAINTAIN_DEGREES),
+        CHECK_SEMANTIC_TYPE("maintain_degrees", TokenType::KW_MAINTAIN_DEGREES),
+        CHECK_SEMANTIC_TYPE("Maintain_degrees", TokenType::KW_MAINTAIN_DEGREES),
         CHECK_SEMANTIC_TYPE("DROP", TokenType::KW_DROP),
         CHECK_SEMANTIC_TYPE("drop", TokenType::KW_DROP),
         CHECK_SEMANTIC_TYPE("Drop", TokenType::KW_DROP),
@@ -366,6 +369,12 @@ TEST(Scanner, Basic) {
         CHECK_SEMANTIC_TYPE("LEADER", TokenType::KW_LEADER),
         CHECK_SEMANTIC_TYPE("Leader", TokenType::KW_LEADER),
         CHECK_SEMANTIC_TYPE("leader", TokenType::KW_LEADER),
+        CHECK_SEMANTIC_TYPE("SAMPLE", TokenType::KW_SAMPLE),
+        CHECK_SEMANTIC_TYPE("Sample", TokenType::KW_SAMPLE),
+        CHECK_SEMANTIC_TYPE("sample", TokenType::KW_SAMPLE),
+        CHECK_SEMANTIC_TYPE("LIMIT", TokenType::KW_LIMIT),
+        CHECK_SEMANTIC_TYPE("Limit", TokenType::KW_LIMIT),
+        CHECK_SEMANTIC_TYPE("limit", TokenType::KW_LIMIT),
 
         CHECK_SEMANTIC_TYPE("_type", TokenType::TYPE_PROP),
         CHECK_SEMANTIC_TYPE("_id", TokenType::ID_PROP),
@@ -50,6 +50,12 @@ protected:
 
     void doPut(GraphSpaceID spaceId, PartitionID partId, std::vector<kvstore::KV> data);
 
+    /**
+     * Record the result of an asynchronous write on one part,
+     * and finish the request once all the parts are done.
+     * */
+    void handleAsync(GraphSpaceID spaceId, PartitionID partId, kvstore::ResultCode code);
+
     nebula::cpp2::ColumnDef columnDef(std::string name, nebula::cpp2::SupportedType type) {
         nebula::cpp2::ColumnDef column;
         column.set_name(std::move(name));
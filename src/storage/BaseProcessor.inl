@@ -21,6 +21,8 @@ cpp2::ErrorCode BaseProcessor<RESP>::to(kvstore::ResultCode code) {
         return cpp2::ErrorCode::E_SPACE_NOT_FOUND;
     case kvstore::ResultCode::ERR_PART_NOT_FOUND:
         return cpp2::ErrorCode::E_PART_NOT_FOUND;
+    case kvstore::ResultCode::ERR_BUFFER_OVERFLOW:
+        return cpp2::ErrorCode::E_BUFFER_OVERFLOW;
     default:
         return cpp2::ErrorCode::E_UNKNOWN;
     }
@@ -35,36 +37,50 @@ void BaseProcessor<RESP>::doPut(GraphSpaceID spaceId,
                                   partId,
                                   std::move(data),
                                   [spaceId, partId, this](kvstore::ResultCode code) {
-        VLOG(3) << "partId:" << partId << ", code:" << static_cast<int32_t>(code);
+        handleAsync(spaceId, partId, code);
+    });
+}
+
+
+template<typename RESP>
+void BaseProcessor<RESP>::handleAsync(GraphSpaceID spaceId,
+                                      PartitionID partId,
+                                      kvstore::ResultCode code) {
+    VLOG(3) << "partId:" << partId << ", code:" << static_cast<int32_t>(code);
 
-        cpp2::ResultCode thriftResult;
-        thriftResult.set_code(to(code));
-        thriftResult.set_part_id(partId);
-        if (code == kvstore::ResultCode::ERR_LEADER_CHANGED) {
-            nebula::cpp2::HostAddr leader;
-            auto addrRet = kvstore_->partLeader(spaceId, partId);
-            CHECK(ok(addrRet));
-            auto addr = value(std::move(addrRet));
-            leader.set_ip(addr.first);
-            leader.set_port(addr.second);
-            thriftResult.set_leader(leader);
+    cpp2::ResultCode thriftResult;
+    thriftResult.set_code(to(code));
+    thriftResult.set_part_id(partId);
+    if (code == kvstore::ResultCode::ERR_LEADER_CHANGED) {
+        nebula::cpp2::HostAddr leader;
+        auto addrRet = kvstore_->partLeader(spaceId, partId);
+        CHECK(ok(addrRet));
+        auto addr = value(std::move(addrRet));
+        leader.set_ip(addr.first);
+        leader.set_port(addr.second);
+        thriftResult.set_leader(leader);
+    } else if (code == kvstore::ResultCode::ERR_BUFFER_OVERFLOW) {
+        int32_t retryAfterMs = 0;
+        if (kvstore_->partRetryAfterMs(spaceId, partId, &retryAfterMs)
+                == kvstore::ResultCode::SUCCEEDED) {
+            thriftResult.set_retry_after_ms(retryAfterMs);
         }
-        bool finished = false;
-        {
-            std::lock_guard<std::mutex> lg(this->lock_);
-            if (thriftResult.code != cpp2::ErrorCode::SUCCEEDED) {
-                this->codes_.emplace_back(std::move(thriftResult));
-            }
-            this->callingNum_--;
-            if (this->callingNum_ == 0) {
-                result_.set_failed_codes(std::move(this->codes_));
-                finished = true;
-            }
+    }
+    bool finished = false;
+    {
+        std::lock_guard<std::mutex> lg(this->lock_);
+        if (thriftResult.code != cpp2::ErrorCode::SUCCEEDED) {
+            this->codes_.emplace_back(std::move(thriftResult));
         }
-        if (finished) {
-            this->onFinished();
+        this->callingNum_--;
+        if (this->callingNum_ == 0) {
+            result_.set_failed_codes(std::move(this->codes_));
+            finished = true;
         }
-    });
+    }
+    if (finished) {
+        this->onFinished();
+    }
 }
 
 }  // namespace storage
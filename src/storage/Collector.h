@@ -8,8 +8,11 @@
 #define STORAGE_COLLECTOR_H_
 
 #include "base/Base.h"
+#include "base/HyperLogLog.h"
 #include "dataman/RowWriter.h"
+#include "dataman/ColumnWriter.h"
 #include <boost/variant.hpp>
+#include <folly/stats/TDigest.h>
 #include "storage/CommonUtils.h"
 
 namespace nebula {
@@ -27,7 +30,7 @@ public:
 
     virtual void collectDouble(double v, const PropContext& prop) = 0;
 
-    virtual void collectString(const std::string& v, const PropContext& prop) = 0;
+    virtual void collectString(folly::StringPiece v, const PropContext& prop) = 0;
 };
 
 
@@ -49,8 +52,8 @@ public:
         collect<double>(v, prop);
     }
 
-    void collectString(const std::string& v, const PropContext& prop) override {
-        collect<const std::string>(v, prop);
+    void collectString(folly::StringPiece v, const PropContext& prop) override {
+        collect<folly::StringPiece>(v, prop);
     }
 
     template<typename V>
@@ -63,34 +66,353 @@ private:
 };
 
 
+/**
+ * The stats of one prop, only the parts needed by its StatType are filled.
+ * */
+struct PropStats {
+    using Number = boost::variant<int64_t, double>;
+
+    // Valid only if count_ is positive
+    Number sum_ = 0L;
+    Number min_ = 0L;
+    Number max_ = 0L;
+    int64_t count_ = 0;
+    // For COUNT_DISTINCT, it is created on the first value
+    std::unique_ptr<HyperLogLog> distinct_;
+    // For PERCENTILE, values are buffered and merged into the digest in batches
+    folly::TDigest digest_;
+    std::vector<double> buffer_;
+
+    template<typename V>
+    void add(V v, cpp2::StatType stat) {
+        switch (stat) {
+            case cpp2::StatType::SUM:
+            case cpp2::StatType::AVG:
+                sum_ = count_ == 0 ? v : boost::get<V>(sum_) + v;
+                break;
+            case cpp2::StatType::MIN:
+                min_ = count_ == 0 ? v : std::min(boost::get<V>(min_), v);
+                break;
+            case cpp2::StatType::MAX:
+                max_ = count_ == 0 ? v : std::max(boost::get<V>(max_), v);
+                break;
+            case cpp2::StatType::COUNT_DISTINCT:
+                addDistinct(v);
+                break;
+            case cpp2::StatType::PERCENTILE:
+                buffer_.emplace_back(static_cast<double>(v));
+                if (buffer_.size() >= kBufferSize) {
+                    flushBuffer();
+                }
+                break;
+            case cpp2::StatType::COUNT:
+                break;
+        }
+        count_++;
+    }
+
+    template<typename V>
+    void addDistinct(V v) {
+        if (distinct_ == nullptr) {
+            distinct_ = std::make_unique<HyperLogLog>();
+        }
+        distinct_->add(v);
+    }
+
+    void flushBuffer() {
+        if (buffer_.empty()) {
+            return;
+        }
+        std::sort(buffer_.begin(), buffer_.end());
+        digest_ = digest_.merge(folly::Range<const double*>(buffer_.data(), buffer_.size()));
+        buffer_.clear();
+    }
+
+    void merge(PropStats&& other) {
+        if (other.count_ == 0) {
+            return;
+        }
+        if (count_ == 0) {
+            *this = std::move(other);
+            return;
+        }
+        sum_ = plus(sum_, other.sum_);
+        min_ = less(other.min_, min_) ? other.min_ : min_;
+        max_ = less(max_, other.max_) ? other.max_ : max_;
+        count_ += other.count_;
+        if (other.distinct_ != nullptr) {
+            if (distinct_ == nullptr) {
+                distinct_ = std::move(other.distinct_);
+            } else {
+                distinct_->merge(*other.distinct_);
+            }
+        }
+        other.flushBuffer();
+        if (other.digest_.count() > 0) {
+            flushBuffer();
+            std::array<folly::TDigest, 2> digests{{std::move(digest_),
+                                                   std::move(other.digest_)}};
+            digest_ = folly::TDigest::merge(
+                folly::Range<const folly::TDigest*>(digests.data(), digests.size()));
+        }
+    }
+
+    static double toDouble(const Number& n) {
+        return n.which() == 0 ? boost::get<int64_t>(n) : boost::get<double>(n);
+    }
+
+    static Number plus(const Number& l, const Number& r) {
+        if (l.which() == 0 && r.which() == 0) {
+            return boost::get<int64_t>(l) + boost::get<int64_t>(r);
+        }
+        return toDouble(l) + toDouble(r);
+    }
+
+    static bool less(const Number& l, const Number& r) {
+        if (l.which() == 0 && r.which() == 0) {
+            return boost::get<int64_t>(l) < boost::get<int64_t>(r);
+        }
+        return toDouble(l) < toDouble(r);
+    }
+
+    static constexpr size_t kBufferSize = 1024;
+};
+
+
+/**
+ * It collects the stats of one bucket without any lock, the partial stats of all buckets
+ * are merged once they are done.
+ * */
 class StatsCollector : public Collector {
 public:
     StatsCollector() = default;
 
-    void collectBool(bool, const PropContext& prop) override {
-        std::lock_guard<std::mutex> lg(lock_);
-        prop.count_++;
+    void collectBool(bool v, const PropContext& prop) override {
+        auto& s = stats(prop);
+        if (prop.prop_.stat == cpp2::StatType::COUNT_DISTINCT) {
+            s.addDistinct(static_cast<int64_t>(v));
+        }
+        s.count_++;
     }
 
     void collectInt64(int64_t v, const PropContext& prop) override {
-        std::lock_guard<std::mutex> lg(lock_);
-        prop.sum_ = boost::get<int64_t>(prop.sum_) + v;
-        prop.count_++;
+        stats(prop).add(v, prop.prop_.stat);
     }
 
     void collectDouble(double v, const PropContext& prop) override {
-        std::lock_guard<std::mutex> lg(lock_);
-        prop.sum_ = boost::get<double>(prop.sum_) + v;
-        prop.count_++;
+        stats(prop).add(v, prop.prop_.stat);
+    }
+
+    void collectString(folly::StringPiece v, const PropContext& prop) override {
+        auto& s = stats(prop);
+        if (prop.prop_.stat == cpp2::StatType::COUNT_DISTINCT) {
+            s.addDistinct(v);
+        }
+        s.count_++;
+    }
+
+    void merge(StatsCollector&& other) {
+        if (stats_.size() < other.stats_.size()) {
+            stats_.resize(other.stats_.size());
+        }
+        for (size_t i = 0; i < other.stats_.size(); i++) {
+            stats_[i].merge(std::move(other.stats_[i]));
+        }
+    }
+
+    /**
+     * The stats of the prop, with all the buffered values merged.
+     * */
+    PropStats& finish(const PropContext& prop) {
+        auto& s = stats(prop);
+        s.flushBuffer();
+        return s;
+    }
+
+private:
+    PropStats& stats(const PropContext& prop) {
+        DCHECK_GE(prop.retIndex_, 0);
+        if (static_cast<size_t>(prop.retIndex_) >= stats_.size()) {
+            stats_.resize(prop.retIndex_ + 1);
+        }
+        return stats_[prop.retIndex_];
+    }
+
+private:
+    // Indexed by the retIndex_ of the prop
+    std::vector<PropStats> stats_;
+};
+
+
+/**
+ * It collects the vertices of one bucket and their edges by columns, see cpp2::ColumnarData.
+ * The vertex columns are the returned tag props in the order of the tag contexts,
+ * and the edge columns are the props of the edge context.
+ *
+ * A missing value is filled with the default value of its type, once the row is done.
+ * */
+class ColumnsCollector : public Collector {
+public:
+    ColumnsCollector(const std::vector<TagContext>& tagContexts, const EdgeContext& edgeContext) {
+        for (auto& tc : tagContexts) {
+            for (auto& prop : tc.props_) {
+                if (prop.returned_) {
+                    vertexColumns_.emplace_back(prop.type_.type);
+                }
+            }
+        }
+        for (auto& prop : edgeContext.props_) {
+            edgeColumns_.emplace_back(prop.type_.type);
+        }
+        // The columns are never added again, so the pointers are stable
+        size_t i = 0;
+        for (auto& tc : tagContexts) {
+            for (auto& prop : tc.props_) {
+                if (prop.returned_) {
+                    mapColumn(prop.retIndex_, &vertexColumns_[i++]);
+                }
+            }
+        }
+        for (size_t j = 0; j < edgeContext.props_.size(); j++) {
+            mapColumn(edgeContext.props_[j].retIndex_, &edgeColumns_[j]);
+        }
+    }
+
+    void collectBool(bool v, const PropContext& prop) override {
+        column(prop)->appendBool(v);
+    }
+
+    void collectInt64(int64_t v, const PropContext& prop) override {
+        column(prop)->appendInt(v);
+    }
+
+    void collectDouble(double v, const PropContext& prop) override {
+        column(prop)->appendDouble(v);
+    }
+
+    void collectString(folly::StringPiece v, const PropContext& prop) override {
+        column(prop)->appendString(v);
+    }
+
+    /**
+     * Start a new vertex, its props and edges are collected next.
+     * */
+    void addVertex(VertexID vId) {
+        fill(&vertexColumns_, vertexIds_.size());
+        vertexIds_.emplace_back(vId);
+        edgeOffsets_.emplace_back(edgesNum_);
+    }
+
+    /**
+     * Start a new edge of the current vertex.
+     * */
+    void addEdge() {
+        DCHECK(!vertexIds_.empty());
+        fill(&edgeColumns_, edgesNum_);
+        edgesNum_++;
+        edgeOffsets_.back() = edgesNum_;
+    }
+
+    int32_t edgesOfLastVertex() const {
+        DCHECK(!vertexIds_.empty());
+        return edgeOffsets_.back() - edgeOffsets_[edgeOffsets_.size() - 2];
+    }
+
+    /**
+     * Remove the current vertex along with its props and edges.
+     * */
+    void removeVertex() {
+        DCHECK(!vertexIds_.empty());
+        vertexIds_.pop_back();
+        edgeOffsets_.pop_back();
+        edgesNum_ = edgeOffsets_.back();
+        for (auto& col : vertexColumns_) {
+            col.truncate(vertexIds_.size());
+        }
+        for (auto& col : edgeColumns_) {
+            col.truncate(edgesNum_);
+        }
+    }
+
+    /**
+     * Append the vertices of another bucket.
+     * */
+    void merge(ColumnsCollector&& other) {
+        CHECK_EQ(vertexColumns_.size(), other.vertexColumns_.size());
+        CHECK_EQ(edgeColumns_.size(), other.edgeColumns_.size());
+        fillAll();
+        other.fillAll();
+        vertexIds_.insert(vertexIds_.end(), other.vertexIds_.begin(), other.vertexIds_.end());
+        for (size_t i = 1; i < other.edgeOffsets_.size(); i++) {
+            edgeOffsets_.emplace_back(edgesNum_ + other.edgeOffsets_[i]);
+        }
+        edgesNum_ += other.edgesNum_;
+        for (size_t i = 0; i < vertexColumns_.size(); i++) {
+            vertexColumns_[i].append(other.vertexColumns_[i]);
+        }
+        for (size_t i = 0; i < edgeColumns_.size(); i++) {
+            edgeColumns_[i].append(other.edgeColumns_[i]);
+        }
+    }
+
+    void finish(cpp2::ColumnarData* data) {
+        fillAll();
+        data->set_vertex_ids(std::move(vertexIds_));
+        data->set_edge_offsets(std::move(edgeOffsets_));
+        data->set_vertex_columns(toColumnData(&vertexColumns_));
+        data->set_edge_columns(toColumnData(&edgeColumns_));
+    }
+
+private:
+    void mapColumn(int32_t retIndex, ColumnWriter* col) {
+        CHECK_GE(retIndex, 0);
+        if (static_cast<size_t>(retIndex) >= columns_.size()) {
+            columns_.resize(retIndex + 1, nullptr);
+        }
+        columns_[retIndex] = col;
+    }
+
+    ColumnWriter* column(const PropContext& prop) {
+        DCHECK(prop.retIndex_ >= 0
+                && static_cast<size_t>(prop.retIndex_) < columns_.size()
+                && columns_[prop.retIndex_] != nullptr);
+        return columns_[prop.retIndex_];
+    }
+
+    static void fill(std::vector<ColumnWriter>* cols, size_t rows) {
+        for (auto& col : *cols) {
+            while (col.size() < rows) {
+                col.appendDefault();
+            }
+        }
+    }
+
+    void fillAll() {
+        fill(&vertexColumns_, vertexIds_.size());
+        fill(&edgeColumns_, edgesNum_);
     }
 
-    void collectString(const std::string&, const PropContext& prop) override {
-        std::lock_guard<std::mutex> lg(lock_);
-        prop.count_++;
+    static std::vector<cpp2::ColumnData> toColumnData(std::vector<ColumnWriter>* cols) {
+        std::vector<cpp2::ColumnData> data;
+        data.reserve(cols->size());
+        for (auto& col : *cols) {
+            cpp2::ColumnData d;
+            d.set_values(std::move(col.values()));
+            d.set_offsets(std::move(col.offsets()));
+            data.emplace_back(std::move(d));
+        }
+        return data;
     }
 
 private:
-    std::mutex lock_;
+    std::vector<VertexID> vertexIds_;
+    // The end of the edges of each vertex, led by 0
+    std::vector<int32_t> edgeOffsets_{0};
+    int32_t edgesNum_ = 0;
+    std::vector<ColumnWriter> vertexColumns_;
+    std::vector<ColumnWriter> edgeColumns_;
+    // Indexed by the retIndex_ of the prop
+    std::vector<ColumnWriter*> columns_;
 };
 
 }  // namespace storage
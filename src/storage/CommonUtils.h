@@ -8,16 +8,58 @@
 #define STORAGE_COMMON_H_
 
 #include "base/Base.h"
+#include "base/Arena.h"
+#include <folly/futures/Future.h>
 #include "filter/Expressions.h"
+#include "filter/ExpressionProgram.h"
+#include "kvstore/KVIterator.h"
+#include "dataman/RowProjection.h"
+#include "dataman/RowSetWriter.h"
 
 namespace nebula {
 namespace storage {
 
 using TagProp = std::pair<std::string, std::string>;
 
+class StatsCollector;
+class ColumnsCollector;
+
 struct FilterContext {
     // key: <tagName, propName> -> propValue
     std::unordered_map<TagProp, VariantType> tagFilters_;
+    // The filter is decoded for each bucket, so the getters could be
+    // rebound for every edge without any lock.
+    std::unique_ptr<ExpressionContext> expCtx_;
+    std::unique_ptr<Expression> exp_;
+    // Slot values of the compiled filter, it is used instead of exp_ if the filter compiled.
+    ExpressionProgram::SlotValues slotValues_;
+    // The field index of each edge prop slot, resolved against edge schema of edgeSchemaVer_
+    std::vector<int64_t> edgeFieldIndexes_;
+    SchemaVer edgeSchemaVer_ = -1;
+};
+
+// The buffers to encode rows into a row set, the arena is reset after each vertex.
+struct RowSetBuffer {
+    Arena arena_;
+    RowSetWriter rowSet_;
+};
+
+/**
+ * The state of one bucket, which is owned by the thread processing its vertices.
+ * */
+struct BucketContext {
+    FilterContext filter_;
+    // The prefix scans of the bucket share the iterators of the scanner.
+    std::unique_ptr<kvstore::KVScanner> scanner_;
+    // The partial stats of the bucket, see QueryStatsProcessor.
+    std::unique_ptr<StatsCollector> stats_;
+    // The vertices of the bucket by columns, see QueryBoundProcessor.
+    std::unique_ptr<ColumnsCollector> columns_;
+    // The rows of one vertex, the buffers are reused for every vertex of the bucket.
+    RowSetBuffer rows_;
+    // The vertices of the bucket which are finished by the workers later,
+    // i.e. the supernodes whose edges are split.
+    std::vector<folly::Future<std::tuple<PartitionID, VertexID, kvstore::ResultCode>>> pending_;
 };
 
 class PropContext {
@@ -64,8 +106,6 @@ public:
     cpp2::PropDef prop_;
     nebula::cpp2::ValueType type_;
     PropInKeyType pikType_ = PropInKeyType::NONE;
-    mutable boost::variant<int64_t, double> sum_ = 0L;
-    mutable int32_t count_    = 0;
     // The index in request return columns.
     int32_t retIndex_ = -1;
     // The prop should be returned
@@ -87,6 +127,8 @@ struct TagContext {
     TagID tagId_ = 0;
     std::vector<PropContext> props_;
     std::unordered_map<std::string, int32_t> propNameIndex_;
+    // The field indexes of props_ in the latest schema of the tag
+    std::unique_ptr<RowProjection> projection_;
 
     PropContext* findProp(const std::string& propName) {
         auto it = propNameIndex_.find(propName);
@@ -118,6 +160,13 @@ struct EdgeContext {
 
     EdgeType edgeType_ = 0;
     std::vector<PropContext> props_;
+    // The field indexes of props_ in the latest schema of the edge
+    std::unique_ptr<RowProjection> projection_;
+    // If it is not negative, the props are some props in key, followed by the first fields
+    // of the edge schema of this version, in order. So the values of this version could be
+    // forwarded as they are, with the props in key put in front of them.
+    SchemaVer rawSchemaVer_ = -1;
+    int32_t rawKeyProps_ = 0;
 };
 
 }  // namespace storage
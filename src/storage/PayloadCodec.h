@@ -0,0 +1,140 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_PAYLOADCODEC_H_
+#define STORAGE_PAYLOADCODEC_H_
+
+#include "base/Base.h"
+#include <folly/compression/Compression.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+#include <thrift/lib/cpp2/protocol/CompactProtocol.h>
+#include "interface/gen-cpp2/storage_types.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * It compresses a response into its CompressedPayload, and back.
+ *
+ * All the fields but the result are serialized by the compact protocol and compressed at once,
+ * so it works for any response with the `compressed' field. The result is kept as it is,
+ * so the failed parts could be read before the payload is uncompressed.
+ * */
+class PayloadCodec final {
+public:
+    /**
+     * The first one of the accepted compressions which is built in, or NONE.
+     * */
+    static cpp2::CompressionType negotiate(const std::vector<cpp2::CompressionType>& accepted) {
+        for (auto type : accepted) {
+            folly::io::CodecType codecType;
+            if (toCodecType(type, &codecType) && folly::io::hasCodec(codecType)) {
+                return type;
+            }
+        }
+        return cpp2::CompressionType::NONE;
+    }
+
+    /**
+     * Compress the response if its payload is at least `minBytes', and gets smaller.
+     * It returns the size of the payload before compression, or 0 if it is left as it is.
+     * */
+    template<class RESP>
+    static size_t compress(cpp2::CompressionType type, size_t minBytes, RESP* resp) {
+        auto codec = getCodec(type);
+        if (codec == nullptr) {
+            return 0;
+        }
+        cpp2::ResponseCommon result;
+        std::swap(result, resp->result);
+        // Most responses are small, so the size is walked through before any copy
+        apache::thrift::CompactProtocolWriter writer;
+        auto size = resp->serializedSize(&writer);
+        if (size < minBytes) {
+            std::swap(result, resp->result);
+            return 0;
+        }
+        std::string raw;
+        raw.reserve(size);
+        apache::thrift::CompactSerializer::serialize(*resp, &raw);
+        std::string data;
+        try {
+            data = codec->compress(raw);
+        } catch (const std::exception& e) {
+            LOG(ERROR) << "Compress the response failed: " << e.what();
+            data.clear();
+        }
+        if (data.empty() || data.size() >= raw.size()) {
+            std::swap(result, resp->result);
+            return 0;
+        }
+        cpp2::CompressedPayload payload;
+        payload.set_type(type);
+        payload.set_raw_size(raw.size());
+        payload.set_data(std::move(data));
+        RESP compressed;
+        compressed.set_result(std::move(result));
+        compressed.set_compressed(std::move(payload));
+        *resp = std::move(compressed);
+        return raw.size();
+    }
+
+    /**
+     * Restore the fields of a compressed response, it returns false if the payload corrupts.
+     * */
+    template<class RESP>
+    static bool uncompress(RESP* resp) {
+        if (!resp->__isset.compressed) {
+            return true;
+        }
+        const auto& payload = resp->compressed;
+        auto codec = getCodec(payload.get_type());
+        if (codec == nullptr) {
+            LOG(ERROR) << "Unsupported compression "
+                       << static_cast<int32_t>(payload.get_type());
+            return false;
+        }
+        RESP raw;
+        try {
+            auto data = codec->uncompress(payload.get_data(),
+                                          static_cast<uint64_t>(payload.get_raw_size()));
+            apache::thrift::CompactSerializer::deserialize(data, raw);
+        } catch (const std::exception& e) {
+            LOG(ERROR) << "Uncompress the response failed: " << e.what();
+            return false;
+        }
+        raw.set_result(std::move(resp->result));
+        *resp = std::move(raw);
+        return true;
+    }
+
+private:
+    static bool toCodecType(cpp2::CompressionType type, folly::io::CodecType* codecType) {
+        switch (type) {
+            case cpp2::CompressionType::LZ4:
+                *codecType = folly::io::CodecType::LZ4;
+                return true;
+            case cpp2::CompressionType::ZSTD:
+                *codecType = folly::io::CodecType::ZSTD;
+                return true;
+            case cpp2::CompressionType::NONE:
+                return false;
+        }
+        return false;
+    }
+
+    static std::unique_ptr<folly::io::Codec> getCodec(cpp2::CompressionType type) {
+        folly::io::CodecType codecType;
+        if (!toCodecType(type, &codecType) || !folly::io::hasCodec(codecType)) {
+            return nullptr;
+        }
+        return folly::io::getCodec(codecType);
+    }
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_PAYLOADCODEC_H_
@@ -0,0 +1,66 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_PIPELINESTATS_H_
+#define STORAGE_PIPELINESTATS_H_
+
+#include "base/Base.h"
+#include "kvstore/raftex/PipelineStats.h"
+#include "stats/StatsManager.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * Report the stats of the raft write pipeline to the StatsManager
+ * */
+class RaftPipelineStats final : public raftex::PipelineStats {
+public:
+    RaftPipelineStats()
+        : appendWal_(registerLatency("raft_append_wal_latency_us"))
+        , replicate_(registerLatency("raft_replicate_latency_us"))
+        , applyWait_(registerLatency("raft_apply_wait_latency_us"))
+        , apply_(registerLatency("raft_apply_latency_us"))
+        , applyQueueFull_(stats::StatsManager::registerStats("raft_apply_queue_full")) {
+    }
+
+    void appendWal(int64_t latencyUs) override {
+        stats::StatsManager::addValue(appendWal_, latencyUs);
+    }
+
+    void replicate(int64_t latencyUs) override {
+        stats::StatsManager::addValue(replicate_, latencyUs);
+    }
+
+    void applyWait(int64_t latencyUs) override {
+        stats::StatsManager::addValue(applyWait_, latencyUs);
+    }
+
+    void apply(int64_t latencyUs) override {
+        stats::StatsManager::addValue(apply_, latencyUs);
+    }
+
+    void applyQueueFull() override {
+        stats::StatsManager::addValue(applyQueueFull_);
+    }
+
+private:
+    static int32_t registerLatency(folly::StringPiece name) {
+        return stats::StatsManager::registerHisto(name, 1000, 0, 200000);
+    }
+
+private:
+    const int32_t appendWal_;
+    const int32_t replicate_;
+    const int32_t applyWait_;
+    const int32_t apply_;
+    const int32_t applyQueueFull_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_PIPELINESTATS_H_
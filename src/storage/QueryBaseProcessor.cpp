@@ -8,6 +8,8 @@
 
 DEFINE_int32(max_handlers_per_req, 10, "The max handlers used to handle one request");
 DEFINE_int32(min_vertices_per_bucket, 3, "The min vertices number in one bucket");
+DEFINE_int32(edges_per_split, 10000, "The edges of one vertex are split into parts of this size, "
+                                     "which are scanned in parallel, no split if non-positive");
 
 namespace nebula {
 namespace storage {
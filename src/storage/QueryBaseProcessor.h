@@ -33,10 +33,63 @@ using EdgeProcessor
     = std::function<void(RowReader* reader,
                          folly::StringPiece key,
                          const std::vector<PropContext>& props)>;
+/**
+ * The edges of a supernode beyond the first edges_per_split ones are handed to the workers
+ * in batches as they are scanned, and `batchProcessor_' returns the processor for the i-th batch.
+ *
+ * The scanning does not wait for the batches. Once it returns, `rest_' is set to be fulfilled
+ * after all of them are processed, so what the processors refer to should be kept until then.
+ * */
+struct EdgeSplitter {
+    std::function<EdgeProcessor(size_t batchIndex)> batchProcessor_;
+    folly::Optional<folly::Future<kvstore::ResultCode>> rest_;
+};
+
 struct Bucket {
     std::vector<std::pair<PartitionID, VertexID>> vertices_;
 };
 
+/**
+ * The buckets of one request, each of which is handled by its own thread.
+ *
+ * The vertices are taken one by one, the handler takes the vertices of its own bucket first,
+ * and then the ones left in the other buckets. So a bucket with some supernodes does not
+ * hold the whole request, its vertices are shared by the handlers which have been idle.
+ * */
+class BucketQueue final {
+public:
+    explicit BucketQueue(std::vector<Bucket> buckets)
+        : buckets_(std::move(buckets))
+        , cursors_(buckets_.size()) {}
+
+    size_t size() const {
+        return buckets_.size();
+    }
+
+    /**
+     * Take the next vertex for the handler of the bucket, nullptr if all vertices are taken.
+     * */
+    const std::pair<PartitionID, VertexID>* take(size_t bucketIndex) {
+        for (size_t i = 0; i < buckets_.size(); i++) {
+            auto b = (bucketIndex + i) % buckets_.size();
+            auto& vertices = buckets_[b].vertices_;
+            if (cursors_[b].load(std::memory_order_relaxed) >= vertices.size()) {
+                continue;
+            }
+            auto next = cursors_[b].fetch_add(1, std::memory_order_relaxed);
+            if (next < vertices.size()) {
+                return &vertices[next];
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    std::vector<Bucket> buckets_;
+    // The index of the next vertex to take in each bucket
+    std::vector<std::atomic<size_t>> cursors_;
+};
+
 using OneVertexResp = std::tuple<PartitionID, VertexID, kvstore::ResultCode>;
 
 template<typename REQ, typename RESP>
@@ -57,12 +110,23 @@ protected:
     /**
      * Check whether current operation on the data is valid or not.
      * */
-    bool validOperation(nebula::cpp2::SupportedType vType, cpp2::StatType statType);
+    bool validOperation(nebula::cpp2::SupportedType vType, const cpp2::PropDef& col);
 
     /**
      * Check request meta is illegal or not and build contexts for tag and edge.
      * */
     cpp2::ErrorCode checkAndBuildContexts(const REQ& req);
+
+    /**
+     * Check one edge prop and add it into the context of its edge type.
+     * */
+    cpp2::ErrorCode addEdgeProp(const cpp2::PropDef& col, int32_t retIndex, EdgeContext* ec);
+
+    /**
+     * Check whether the stored edge values could be returned without decoding,
+     * see EdgeContext::rawSchemaVer_.
+     * */
+    void checkRawEdgeProps(EdgeContext* ec);
     /**
      * collect props in one row, you could define custom behavior by implement your own collector.
      * */
@@ -70,47 +134,150 @@ protected:
                       folly::StringPiece key,
                       const std::vector<PropContext>& props,
                       FilterContext* fcontext,
-                      Collector* collector);
+                      Collector* collector,
+                      const RowProjection* projection = nullptr);
+
+    /**
+     * Collect the field by its typed getter, without building a VariantType.
+     * */
+    ResultType collectField(RowReader* reader,
+                            int64_t index,
+                            const PropContext& prop,
+                            Collector* collector);
+
+    /**
+     * Resolve the field indexes of the props of each tag and edge once for the request.
+     * */
+    void buildProjections();
 
     virtual kvstore::ResultCode processVertex(PartitionID partID,
-                                              VertexID vId) = 0;
+                                              VertexID vId,
+                                              BucketContext* bcontext) = 0;
 
     virtual void onProcessFinished(int32_t retNum) = 0;
 
+    /**
+     * Called once all the vertices of the bucket are processed, in the thread of the bucket,
+     * or of the last split supernode of it.
+     * */
+    virtual void onBucketFinished(BucketContext*) {}
+
     kvstore::ResultCode collectVertexProps(
                             PartitionID partId,
                             VertexID vId,
                             TagID tagId,
                             const std::vector<PropContext>& props,
-                            FilterContext* fcontext,
-                            Collector* collector);
+                            BucketContext* bcontext,
+                            Collector* collector,
+                            const RowProjection* projection = nullptr);
     /**
      * Collect props for one vertex edge.
+     * If the splitter is given, the edges of a supernode beyond the first edges_per_split ones
+     * are split and processed by the workers, see EdgeSplitter.
      * */
     kvstore::ResultCode collectEdgeProps(
                                PartitionID partId,
                                VertexID vId,
                                EdgeType edgeType,
                                const std::vector<PropContext>& props,
-                               FilterContext* fcontext,
-                               EdgeProcessor proc);
+                               BucketContext* bcontext,
+                               EdgeProcessor proc,
+                               EdgeSplitter* splitter = nullptr);
+
+    /**
+     * Hand the rest edges from the iterator to the workers of executor_ in batches of
+     * edges_per_split edges as they are scanned, so the edges are read only once.
+     * The returned future is fulfilled once all the batches are processed.
+     * */
+    folly::Future<kvstore::ResultCode> splitEdges(VertexID vId,
+                                                  EdgeType edgeType,
+                                                  const std::vector<PropContext>& props,
+                                                  FilterContext* fcontext,
+                                                  kvstore::KVIterator* iter,
+                                                  const EdgeSplitter& splitter);
+
+    /**
+     * Check whether one edge passes the filter, by the compiled filter if useProgram,
+     * otherwise by evaluating the expression.
+     * */
+    bool acceptEdge(FilterContext* fcontext,
+                    bool useProgram,
+                    RowReader* reader,
+                    VertexID vId,
+                    EdgeType edgeType,
+                    VertexID dstId,
+                    EdgeRanking rank);
+
+    /**
+     * Seek to the keys with the prefix, by the scanner of the bucket if there is one.
+     * */
+    kvstore::ResultCode prefix(PartitionID partId,
+                               const std::string& prefix,
+                               kvstore::KVScanner* scanner,
+                               std::unique_ptr<kvstore::KVIterator>* iter);
 
     std::vector<Bucket> genBuckets(const cpp2::GetNeighborsRequest& req);
 
-    folly::Future<std::vector<OneVertexResp>> asyncProcessBucket(Bucket bucket);
+    std::vector<Bucket> genBuckets(
+            const std::unordered_map<PartitionID, std::vector<VertexID>>& parts);
+
+    /**
+     * Process the vertices taken from the queue, starting from the bucket `bucketIndex'.
+     * */
+    folly::Future<std::vector<OneVertexResp>> asyncProcessBucket(size_t bucketIndex);
 
     int32_t getBucketsNum(int32_t verticesNum, int32_t minVerticesPerBucket, int32_t handlerNum);
 
     bool checkExp(const Expression* exp);
 
+    /**
+     * Decode the filter for one bucket, it returns false if the filter is illegal.
+     * */
+    bool buildFilter(FilterContext* fcontext);
+
+    /**
+     * Load the src tag props of current vertex into the slots of the compiled filter,
+     * it returns false if any of them is missing.
+     * */
+    bool loadSrcSlots(FilterContext* fcontext);
+
+    /**
+     * Evaluate the compiled filter on one edge,
+     * it returns false only if the edge should be filtered out.
+     * */
+    bool evalEdgeFilter(FilterContext* fcontext,
+                        RowReader* reader,
+                        VertexID vId,
+                        EdgeType edgeType,
+                        VertexID dstId,
+                        EdgeRanking rank);
+
 protected:
     GraphSpaceID  spaceId_;
     BoundType     type_;
-    std::unique_ptr<ExpressionContext> expCtx_;
-    std::unique_ptr<Expression> exp_;
+    // The encoded filter, which has been checked in checkAndBuildContexts.
+    std::string filter_;
+    // The compiled filter, it is null if the filter could not be compiled.
+    std::unique_ptr<ExpressionProgram> program_;
+    // Which part of the edge key each slot of program_ comes from, NONE if not in key.
+    std::vector<PropContext::PropInKeyType> slotsInKey_;
     std::vector<TagContext> tagContexts_;
     EdgeContext edgeContext_;
+    // One context for each type, when several edge types are requested at once.
+    std::vector<EdgeContext> edgeContexts_;
     folly::Executor* executor_ = nullptr;
+    // At most limitPerVertex_ edges which pass the filter are returned for each vertex,
+    // no limit if non-positive.
+    int64_t limitPerVertex_ = 0;
+    // Pick the edges of one vertex by reservoir sampling instead of the first ones.
+    bool randomSample_ = false;
+    // The number of edges could still be returned for the whole request,
+    // shared by all buckets.
+    std::atomic<int64_t> edgesLeft_{std::numeric_limits<int64_t>::max()};
+    // The vertices of the request, shared by all buckets.
+    std::unique_ptr<BucketQueue> bucketQueue_;
+    // Return the vertices and edges by columns, only for one edge type.
+    bool columnar_ = false;
 };
 
 }  // namespace storage
@@ -11,23 +11,32 @@
 
 DECLARE_int32(max_handlers_per_req);
 DECLARE_int32(min_vertices_per_bucket);
+DECLARE_int32(edges_per_split);
 
 namespace nebula {
 namespace storage {
 
 template<typename REQ, typename RESP>
 bool QueryBaseProcessor<REQ, RESP>::validOperation(nebula::cpp2::SupportedType vType,
-                                                   cpp2::StatType statType) {
-    switch (statType) {
+                                                   const cpp2::PropDef& col) {
+    switch (col.stat) {
         case cpp2::StatType::SUM:
-        case cpp2::StatType::AVG: {
+        case cpp2::StatType::AVG:
+        case cpp2::StatType::MIN:
+        case cpp2::StatType::MAX:
+        case cpp2::StatType::PERCENTILE: {
+            if (col.stat == cpp2::StatType::PERCENTILE
+                    && (col.percentile < 0 || col.percentile > 100)) {
+                return false;
+            }
             return vType == nebula::cpp2::SupportedType::INT
                     || vType == nebula::cpp2::SupportedType::VID
                     || vType == nebula::cpp2::SupportedType::TIMESTAMP
                     || vType == nebula::cpp2::SupportedType::FLOAT
                     || vType == nebula::cpp2::SupportedType::DOUBLE;
         }
-        case cpp2::StatType::COUNT: {
+        case cpp2::StatType::COUNT:
+        case cpp2::StatType::COUNT_DISTINCT: {
              break;
         }
     }
@@ -59,7 +68,7 @@ cpp2::ErrorCode QueryBaseProcessor<REQ, RESP>::checkAndBuildContexts(const REQ&
                 }
                 prop.type_ = ftype;
                 prop.retIndex_ = index++;
-                if (col.__isset.stat && !validOperation(ftype.type, col.stat)) {
+                if (col.__isset.stat && !validOperation(ftype.type, col)) {
                     return cpp2::ErrorCode::E_IMPROPER_DATA_TYPE;
                 }
                 VLOG(3) << "tagId " << tagId << ", prop " << col.name;
@@ -78,63 +87,276 @@ cpp2::ErrorCode QueryBaseProcessor<REQ, RESP>::checkAndBuildContexts(const REQ&
                 break;
             }
             case cpp2::PropOwner::EDGE: {
-                auto it = kPropsInKey_.find(col.name);
-                if (it != kPropsInKey_.end()) {
-                    prop.pikType_ = it->second;
-                    prop.type_.type = nebula::cpp2::SupportedType::INT;
-                } else if (type_ == BoundType::OUT_BOUND) {
-                    // Only outBound have properties on edge.
-                    auto schema = this->schemaMan_->getEdgeSchema(spaceId_,
-                                                                  edgeContext_.edgeType_);
-                    if (!schema) {
-                        return cpp2::ErrorCode::E_EDGE_PROP_NOT_FOUND;
-                    }
-                    const auto& ftype = schema->getFieldType(col.name);
-                    if (UNLIKELY(ftype == CommonConstants::kInvalidValueType())) {
-                        return cpp2::ErrorCode::E_IMPROPER_DATA_TYPE;
+                if (!edgeContexts_.empty()) {
+                    for (auto& ec : edgeContexts_) {
+                        if (col.edge_type != 0 && col.edge_type != ec.edgeType_) {
+                            continue;
+                        }
+                        auto code = addEdgeProp(col, ec.props_.size(), &ec);
+                        if (code != cpp2::ErrorCode::SUCCEEDED) {
+                            return code;
+                        }
                     }
-                    prop.type_ = ftype;
-                } else {
-                    VLOG(3) << "InBound has none props, skip it!";
                     break;
                 }
-                if (col.__isset.stat && !validOperation(prop.type_.type, col.stat)) {
-                    return cpp2::ErrorCode::E_IMPROPER_DATA_TYPE;
+                auto propsNum = edgeContext_.props_.size();
+                auto code = addEdgeProp(col, index, &edgeContext_);
+                if (code != cpp2::ErrorCode::SUCCEEDED) {
+                    return code;
+                }
+                if (edgeContext_.props_.size() > propsNum) {
+                    index++;
                 }
-                prop.retIndex_ = index++;
-                prop.prop_ = std::move(col);
-                prop.returned_ = true;
-                edgeContext_.props_.emplace_back(std::move(prop));
                 break;
             }
         }
     }
+    if (type_ == BoundType::OUT_BOUND) {
+        checkRawEdgeProps(&edgeContext_);
+        for (auto& ec : edgeContexts_) {
+            checkRawEdgeProps(&ec);
+        }
+    }
     const auto& filterStr = req.get_filter();
     if (!filterStr.empty()) {
         StatusOr<std::unique_ptr<Expression>> expRet = Expression::decode(filterStr);
         if (!expRet.ok()) {
             return cpp2::ErrorCode::E_INVALID_FILTER;
         }
-        exp_ = std::move(expRet).value();
-        if (!checkExp(exp_.get())) {
+        auto exp = std::move(expRet).value();
+        if (!checkExp(exp.get())) {
             return cpp2::ErrorCode::E_INVALID_FILTER;
         }
-        expCtx_ = std::make_unique<ExpressionContext>();
-        exp_->setContext(expCtx_.get());
-        auto& getters = expCtx_->getters();
-        getters.getDstTagProp = [] (const std::string& alias,
-                                    const std::string& prop) -> VariantType {
-            LOG(FATAL) << "Unsupport get dst tag " << alias << " prop " << prop;
-            return false;
-        };
-        getters.getInputProp = [] (const std::string& prop) -> VariantType {
-            LOG(FATAL) << "Unsupport get input prop " << prop;
+        filter_ = filterStr;
+        auto programRet = ExpressionProgram::compile(exp.get());
+        if (programRet.ok()) {
+            program_ = std::move(programRet).value();
+            for (auto& slot : program_->slots()) {
+                auto inKey = PropContext::PropInKeyType::NONE;
+                switch (slot.kind) {
+                    case Expression::kEdgeSrcId:
+                        inKey = PropContext::PropInKeyType::SRC;
+                        break;
+                    case Expression::kEdgeDstId:
+                        inKey = PropContext::PropInKeyType::DST;
+                        break;
+                    case Expression::kEdgeRank:
+                        inKey = PropContext::PropInKeyType::RANK;
+                        break;
+                    case Expression::kAliasProp: {
+                        auto it = kPropsInKey_.find(slot.prop);
+                        if (it != kPropsInKey_.end()) {
+                            inKey = it->second;
+                        }
+                        break;
+                    }
+                    default:
+                        break;
+                }
+                slotsInKey_.emplace_back(inKey);
+            }
+        } else {
+            VLOG(1) << "Evaluate the filter by tree, " << programRet.status();
+        }
+    }
+    buildProjections();
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+template<typename REQ, typename RESP>
+void QueryBaseProcessor<REQ, RESP>::buildProjections() {
+    auto names = [] (const std::vector<PropContext>& props) {
+        std::vector<std::string> result;
+        result.reserve(props.size());
+        for (auto& prop : props) {
+            result.emplace_back(prop.prop_.get_name());
+        }
+        return result;
+    };
+    for (auto& tc : tagContexts_) {
+        auto schema = this->schemaMan_->getTagSchema(spaceId_, tc.tagId_);
+        tc.projection_ = std::make_unique<RowProjection>(schema.get(), names(tc.props_));
+    }
+    if (type_ != BoundType::OUT_BOUND) {
+        // No props on the in-bound edges
+        return;
+    }
+    auto buildEdge = [&, this] (EdgeContext* ec) {
+        auto schema = this->schemaMan_->getEdgeSchema(spaceId_, ec->edgeType_);
+        ec->projection_ = std::make_unique<RowProjection>(schema.get(), names(ec->props_));
+    };
+    buildEdge(&edgeContext_);
+    for (auto& ec : edgeContexts_) {
+        buildEdge(&ec);
+    }
+}
+
+template<typename REQ, typename RESP>
+bool QueryBaseProcessor<REQ, RESP>::buildFilter(FilterContext* fcontext) {
+    if (filter_.empty()) {
+        return true;
+    }
+    if (program_ != nullptr) {
+        fcontext->slotValues_.resize(program_->slots().size());
+        fcontext->edgeFieldIndexes_.assign(program_->slots().size(), -1);
+        return true;
+    }
+    auto expRet = Expression::decode(filter_);
+    if (!expRet.ok()) {
+        return false;
+    }
+    fcontext->exp_ = std::move(expRet).value();
+    fcontext->expCtx_ = std::make_unique<ExpressionContext>();
+    fcontext->exp_->setContext(fcontext->expCtx_.get());
+    auto& getters = fcontext->expCtx_->getters();
+    getters.getDstTagProp = [] (const std::string& alias,
+                                const std::string& prop) -> VariantType {
+        LOG(FATAL) << "Unsupport get dst tag " << alias << " prop " << prop;
+        return false;
+    };
+    getters.getInputProp = [] (const std::string& prop) -> VariantType {
+        LOG(FATAL) << "Unsupport get input prop " << prop;
+        return false;
+    };
+    return true;
+}
+
+template<typename REQ, typename RESP>
+bool QueryBaseProcessor<REQ, RESP>::loadSrcSlots(FilterContext* fcontext) {
+    const auto& slots = program_->slots();
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (slots[i].kind != Expression::kSourceProp) {
+            continue;
+        }
+        auto it = fcontext->tagFilters_.find(std::make_pair(slots[i].alias, slots[i].prop));
+        if (it == fcontext->tagFilters_.end()) {
             return false;
-        };
+        }
+        fcontext->slotValues_[i] = it->second;
     }
+    return true;
+}
+
+template<typename REQ, typename RESP>
+bool QueryBaseProcessor<REQ, RESP>::evalEdgeFilter(FilterContext* fcontext,
+                                                   RowReader* reader,
+                                                   VertexID vId,
+                                                   EdgeType edgeType,
+                                                   VertexID dstId,
+                                                   EdgeRanking rank) {
+    const auto& slots = program_->slots();
+    auto& values = fcontext->slotValues_;
+    auto& indexes = fcontext->edgeFieldIndexes_;
+    if (reader != nullptr && reader->getSchema()->getVersion() != fcontext->edgeSchemaVer_) {
+        // Resolve the field indexes once for each schema version
+        fcontext->edgeSchemaVer_ = reader->getSchema()->getVersion();
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (slots[i].kind == Expression::kAliasProp
+                    && slotsInKey_[i] == PropContext::PropInKeyType::NONE) {
+                indexes[i] = reader->getSchema()->getFieldIndex(slots[i].prop);
+            }
+        }
+    }
+    for (size_t i = 0; i < slots.size(); i++) {
+        switch (slotsInKey_[i]) {
+            case PropContext::PropInKeyType::SRC:
+                values[i] = vId;
+                continue;
+            case PropContext::PropInKeyType::DST:
+                values[i] = dstId;
+                continue;
+            case PropContext::PropInKeyType::TYPE:
+                values[i] = static_cast<int64_t>(edgeType);
+                continue;
+            case PropContext::PropInKeyType::RANK:
+                values[i] = rank;
+                continue;
+            case PropContext::PropInKeyType::NONE:
+                break;
+        }
+        if (slots[i].kind != Expression::kAliasProp) {
+            // Src tag props have been loaded for the vertex
+            continue;
+        }
+        // Keep the edge if any prop is missing, the same as the tree evaluation does.
+        if (reader == nullptr || indexes[i] < 0) {
+            return true;
+        }
+        auto res = RowReader::getPropByIndex(reader, indexes[i]);
+        if (!ok(res)) {
+            return true;
+        }
+        values[i] = value(std::move(res));
+    }
+    auto result = program_->eval(values);
+    return !result.ok() || Expression::asBool(result.value());
+}
+
+template<typename REQ, typename RESP>
+cpp2::ErrorCode QueryBaseProcessor<REQ, RESP>::addEdgeProp(const cpp2::PropDef& col,
+                                                           int32_t retIndex,
+                                                           EdgeContext* ec) {
+    PropContext prop;
+    auto it = kPropsInKey_.find(col.name);
+    if (it != kPropsInKey_.end()) {
+        prop.pikType_ = it->second;
+        prop.type_.type = nebula::cpp2::SupportedType::INT;
+    } else if (type_ == BoundType::OUT_BOUND) {
+        // Only outBound have properties on edge.
+        auto schema = this->schemaMan_->getEdgeSchema(spaceId_, ec->edgeType_);
+        if (!schema) {
+            return cpp2::ErrorCode::E_EDGE_PROP_NOT_FOUND;
+        }
+        const auto& ftype = schema->getFieldType(col.name);
+        if (UNLIKELY(ftype == CommonConstants::kInvalidValueType())) {
+            return cpp2::ErrorCode::E_IMPROPER_DATA_TYPE;
+        }
+        prop.type_ = ftype;
+    } else {
+        VLOG(3) << "InBound has none props, skip it!";
+        return cpp2::ErrorCode::SUCCEEDED;
+    }
+    if (col.__isset.stat && !validOperation(prop.type_.type, col)) {
+        return cpp2::ErrorCode::E_IMPROPER_DATA_TYPE;
+    }
+    prop.retIndex_ = retIndex;
+    prop.prop_ = col;
+    prop.returned_ = true;
+    ec->props_.emplace_back(std::move(prop));
     return cpp2::ErrorCode::SUCCEEDED;
 }
 
+template<typename REQ, typename RESP>
+void QueryBaseProcessor<REQ, RESP>::checkRawEdgeProps(EdgeContext* ec) {
+    const auto& props = ec->props_;
+    int32_t keyProps = 0;
+    while (keyProps < static_cast<int32_t>(props.size())
+            && props[keyProps].pikType_ != PropContext::PropInKeyType::NONE) {
+        keyProps++;
+    }
+    int32_t fields = props.size() - keyProps;
+    // The data of the props in key is inserted in front of the fields, so it only works
+    // if there is no block offset in the row, i.e. less than 16 fields.
+    if (fields == 0 || (keyProps > 0 && keyProps + fields >= 16)) {
+        return;
+    }
+    auto schema = this->schemaMan_->getEdgeSchema(spaceId_, ec->edgeType_);
+    if (!schema || fields > static_cast<int32_t>(schema->getNumFields())) {
+        return;
+    }
+    for (int32_t i = 0; i < fields; i++) {
+        const auto& prop = props[keyProps + i];
+        if (prop.pikType_ != PropContext::PropInKeyType::NONE
+                || prop.prop_.name != schema->getFieldName(i)) {
+            return;
+        }
+    }
+    VLOG(3) << "Forward the values of edge " << ec->edgeType_
+            << " with schema version " << schema->getVersion();
+    ec->rawSchemaVer_ = schema->getVersion();
+    ec->rawKeyProps_ = keyProps;
+}
+
 template<typename REQ, typename RESP>
 bool QueryBaseProcessor<REQ, RESP>::checkExp(const Expression* exp) {
     switch (exp->kind()) {
@@ -205,10 +427,18 @@ bool QueryBaseProcessor<REQ, RESP>::checkExp(const Expression* exp) {
         case Expression::kEdgeDstId:
         case Expression::kEdgeSrcId:
         case Expression::kEdgeType: {
+            if (!edgeContexts_.empty()) {
+                VLOG(1) << "Not support filter on edges of several types";
+                return false;
+            }
             return true;
         }
         case Expression::kAliasProp:
         case Expression::kEdgeProp: {
+            if (!edgeContexts_.empty()) {
+                VLOG(1) << "Not support filter on edges of several types";
+                return false;
+            }
             if (type_ != BoundType::OUT_BOUND) {
                 VLOG(1) << "Only support filter on out bound props";
                 return false;
@@ -249,8 +479,11 @@ void QueryBaseProcessor<REQ, RESP>::collectProps(RowReader* reader,
                                                  folly::StringPiece key,
                                                  const std::vector<PropContext>& props,
                                                  FilterContext* fcontext,
-                                                 Collector* collector) {
-    for (auto& prop : props) {
+                                                 Collector* collector,
+                                                 const RowProjection* projection) {
+    DCHECK(projection == nullptr || projection->size() == props.size());
+    for (size_t i = 0; i < props.size(); i++) {
+        auto& prop = props[i];
         switch (prop.pikType_) {
             case PropContext::PropInKeyType::NONE:
                 break;
@@ -272,39 +505,125 @@ void QueryBaseProcessor<REQ, RESP>::collectProps(RowReader* reader,
                 collector->collectInt64(NebulaKeyUtils::getRank(key), prop);
                 continue;
         }
-        if (reader != nullptr) {
-            const auto& name = prop.prop_.get_name();
-            auto res = RowReader::getPropByName(reader, name);
-            if (!ok(res)) {
+        if (reader == nullptr) {
+            continue;
+        }
+        const auto& name = prop.prop_.get_name();
+        auto index = projection != nullptr
+                        ? projection->index(reader, i)
+                        : reader->getSchema()->getFieldIndex(name);
+        if (index < 0) {
+            VLOG(1) << "Skip the missing prop " << name;
+            continue;
+        }
+        if (!prop.fromTagFilter()) {
+            if (prop.returned_ && collectField(reader, index, prop, collector)
+                                        != ResultType::SUCCEEDED) {
                 VLOG(1) << "Skip the bad value for prop " << name;
-                continue;
-            }
-            auto&& v = value(std::move(res));
-            if (prop.fromTagFilter()) {
-                fcontext->tagFilters_.emplace(std::make_pair(prop.tagOrEdgeName(), name), v);
             }
-            if (prop.returned_) {
-                switch (v.which()) {
-                    case VAR_INT64:
-                        collector->collectInt64(boost::get<int64_t>(v), prop);
-                        break;
-                    case VAR_DOUBLE:
-                        collector->collectDouble(boost::get<double>(v), prop);
-                        break;
-                    case VAR_BOOL:
-                        collector->collectBool(boost::get<bool>(v), prop);
-                        break;
-                    case VAR_STR:
-                        collector->collectString(boost::get<std::string>(v), prop);
-                        break;
-                    default:
-                        LOG(FATAL) << "Unknown VariantType: " << v.which();
-                }  // switch
-            }  // if returned
-        }  // if reader != nullptr
+            continue;
+        }
+        // The value is kept for the filter
+        auto res = RowReader::getPropByIndex(reader, index);
+        if (!ok(res)) {
+            VLOG(1) << "Skip the bad value for prop " << name;
+            continue;
+        }
+        auto&& v = value(std::move(res));
+        DCHECK(fcontext != nullptr);
+        fcontext->tagFilters_.emplace(std::make_pair(prop.tagOrEdgeName(), name), v);
+        if (prop.returned_) {
+            switch (v.which()) {
+                case VAR_INT64:
+                    collector->collectInt64(boost::get<int64_t>(v), prop);
+                    break;
+                case VAR_DOUBLE:
+                    collector->collectDouble(boost::get<double>(v), prop);
+                    break;
+                case VAR_BOOL:
+                    collector->collectBool(boost::get<bool>(v), prop);
+                    break;
+                case VAR_STR:
+                    collector->collectString(boost::get<std::string>(v), prop);
+                    break;
+                default:
+                    LOG(FATAL) << "Unknown VariantType: " << v.which();
+            }  // switch
+        }  // if returned
     }  // for
 }
 
+template<typename REQ, typename RESP>
+ResultType QueryBaseProcessor<REQ, RESP>::collectField(RowReader* reader,
+                                                       int64_t index,
+                                                       const PropContext& prop,
+                                                       Collector* collector) {
+    ResultType ret = ResultType::E_DATA_INVALID;
+    switch (reader->getSchema()->getFieldType(index).get_type()) {
+        case nebula::cpp2::SupportedType::BOOL: {
+            bool v;
+            ret = reader->getBool(index, v);
+            if (ret == ResultType::SUCCEEDED) {
+                collector->collectBool(v, prop);
+            }
+            break;
+        }
+        case nebula::cpp2::SupportedType::INT: {
+            int64_t v;
+            ret = reader->getInt(index, v);
+            if (ret == ResultType::SUCCEEDED) {
+                collector->collectInt64(v, prop);
+            }
+            break;
+        }
+        case nebula::cpp2::SupportedType::VID: {
+            int64_t v;
+            ret = reader->getVid(index, v);
+            if (ret == ResultType::SUCCEEDED) {
+                collector->collectInt64(v, prop);
+            }
+            break;
+        }
+        case nebula::cpp2::SupportedType::TIMESTAMP: {
+            int64_t v;
+            ret = reader->getTimestamp(index, v);
+            if (ret == ResultType::SUCCEEDED) {
+                collector->collectInt64(v, prop);
+            }
+            break;
+        }
+        case nebula::cpp2::SupportedType::FLOAT: {
+            float v;
+            ret = reader->getFloat(index, v);
+            if (ret == ResultType::SUCCEEDED) {
+                collector->collectDouble(v, prop);
+            }
+            break;
+        }
+        case nebula::cpp2::SupportedType::DOUBLE: {
+            double v;
+            ret = reader->getDouble(index, v);
+            if (ret == ResultType::SUCCEEDED) {
+                collector->collectDouble(v, prop);
+            }
+            break;
+        }
+        case nebula::cpp2::SupportedType::STRING: {
+            // A view of the row, no copy
+            folly::StringPiece v;
+            ret = reader->getString(index, v);
+            if (ret == ResultType::SUCCEEDED) {
+                collector->collectString(v, prop);
+            }
+            break;
+        }
+        default:
+            LOG(ERROR) << "Unsupported type of prop " << prop.prop_.get_name();
+            break;
+    }
+    return ret;
+}
+
 
 template<typename REQ, typename RESP>
 kvstore::ResultCode QueryBaseProcessor<REQ, RESP>::collectVertexProps(
@@ -312,11 +631,17 @@ kvstore::ResultCode QueryBaseProcessor<REQ, RESP>::collectVertexProps(
                             VertexID vId,
                             TagID tagId,
                             const std::vector<PropContext>& props,
-                            FilterContext* fcontext,
-                            Collector* collector) {
+                            BucketContext* bcontext,
+                            Collector* collector,
+                            const RowProjection* projection) {
     auto prefix = NebulaKeyUtils::prefix(partId, vId, tagId);
+    // Most vertices might lack the tag, which is told by the bloom filters
+    if (!this->kvstore_->mayExist(spaceId_, partId, prefix)) {
+        VLOG(3) << "Missed partId " << partId << ", vId " << vId << ", tagId " << tagId;
+        return kvstore::ResultCode::SUCCEEDED;
+    }
     std::unique_ptr<kvstore::KVIterator> iter;
-    auto ret = this->kvstore_->prefix(spaceId_, partId, prefix, &iter);
+    auto ret = this->prefix(partId, prefix, bcontext->scanner_.get(), &iter);
     if (ret != kvstore::ResultCode::SUCCEEDED) {
         VLOG(3) << "Error! ret = " << static_cast<int32_t>(ret) << ", spaceId " << spaceId_;
         return ret;
@@ -325,31 +650,125 @@ kvstore::ResultCode QueryBaseProcessor<REQ, RESP>::collectVertexProps(
     // stored along with the properties
     if (iter && iter->valid()) {
         auto reader = RowReader::getTagPropReader(this->schemaMan_, iter->val(), spaceId_, tagId);
-        this->collectProps(reader.get(), iter->key(), props, fcontext, collector);
+        this->collectProps(reader.get(), iter->key(), props, &bcontext->filter_,
+                           collector, projection);
     } else {
         VLOG(3) << "Missed partId " << partId << ", vId " << vId << ", tagId " << tagId;
     }
     return ret;
 }
 
+template<typename REQ, typename RESP>
+bool QueryBaseProcessor<REQ, RESP>::acceptEdge(FilterContext* fcontext,
+                                               bool useProgram,
+                                               RowReader* reader,
+                                               VertexID vId,
+                                               EdgeType edgeType,
+                                               VertexID dstId,
+                                               EdgeRanking rank) {
+    if (useProgram) {
+        return evalEdgeFilter(fcontext, reader, vId, edgeType, dstId, rank);
+    }
+    if (type_ != BoundType::OUT_BOUND || fcontext == nullptr || fcontext->exp_ == nullptr) {
+        return true;
+    }
+    auto& getters = fcontext->expCtx_->getters();
+    getters.getAliasProp =
+        [&] (const std::string&, const std::string &prop) -> OptVariantType {
+            // The props encoded in key, e.g. _dst, _rank, could be
+            // evaluated without decoding the value.
+            auto it = kPropsInKey_.find(prop);
+            if (it != kPropsInKey_.end()) {
+                switch (it->second) {
+                    case PropContext::PropInKeyType::SRC:
+                        return vId;
+                    case PropContext::PropInKeyType::DST:
+                        return dstId;
+                    case PropContext::PropInKeyType::TYPE:
+                        return static_cast<int64_t>(edgeType);
+                    case PropContext::PropInKeyType::RANK:
+                        return rank;
+                    default:
+                        break;
+                }
+            }
+            if (reader == nullptr
+                    || reader->getSchema()->getFieldIndex(prop) < 0) {
+                return Status::Error("Invalid Prop");
+            }
+            auto res = RowReader::getPropByName(reader, prop);
+            if (!ok(res)) {
+                return Status::Error("Invalid Prop");
+            }
+            return value(std::move(res));
+        };
+    getters.getEdgeRank = [&] () -> VariantType {
+        return rank;
+    };
+    getters.getSrcTagProp = [fcontext] (const std::string& tag,
+                                        const std::string& prop) -> OptVariantType {
+        auto it = fcontext->tagFilters_.find(std::make_pair(tag, prop));
+        if (it == fcontext->tagFilters_.end()) {
+            return Status::Error("Invalid Tag Filter");
+        }
+        VLOG(1) << "Hit srcProp filter for tag " << tag << ", prop "
+                << prop << ", value " << it->second;
+        return it->second;
+    };
+    auto value = fcontext->exp_->eval();
+    return !value.ok() || Expression::asBool(value.value());
+}
+
 template<typename REQ, typename RESP>
 kvstore::ResultCode QueryBaseProcessor<REQ, RESP>::collectEdgeProps(
                                                PartitionID partId,
                                                VertexID vId,
                                                EdgeType edgeType,
                                                const std::vector<PropContext>& props,
-                                               FilterContext* fcontext,
-                                               EdgeProcessor proc) {
+                                               BucketContext* bcontext,
+                                               EdgeProcessor proc,
+                                               EdgeSplitter* splitter) {
     auto prefix = NebulaKeyUtils::prefix(partId, vId, edgeType);
     std::unique_ptr<kvstore::KVIterator> iter;
-    auto ret = this->kvstore_->prefix(spaceId_, partId, prefix, &iter);
+    auto ret = this->prefix(partId,
+                            prefix,
+                            bcontext != nullptr ? bcontext->scanner_.get() : nullptr,
+                            &iter);
     if (ret != kvstore::ResultCode::SUCCEEDED || !iter) {
         return ret;
     }
+    auto* fcontext = bcontext != nullptr ? &bcontext->filter_ : nullptr;
+    // The src tag props are the same for all edges of the vertex, so load them once.
+    bool useProgram = type_ == BoundType::OUT_BOUND
+                        && fcontext != nullptr
+                        && program_ != nullptr
+                        && loadSrcSlots(fcontext);
+    // Emit one edge unless the limit of the whole request has been reached.
+    auto emit = [&] (RowReader* reader, folly::StringPiece key) {
+        if (edgesLeft_.fetch_sub(1, std::memory_order_relaxed) <= 0) {
+            return false;
+        }
+        proc(reader, key, props);
+        return true;
+    };
+    bool sampling = randomSample_ && limitPerVertex_ > 0;
+    // The edges of a supernode could be split only if they are not limited for each vertex.
+    bool splittable = splitter != nullptr
+                        && fcontext != nullptr
+                        && FLAGS_edges_per_split > 0
+                        && limitPerVertex_ <= 0
+                        && type_ == BoundType::OUT_BOUND;
+    // The sampled edges, as pairs of key and value.
+    std::vector<std::pair<std::string, std::string>> reservoir;
+    int64_t     passed    = 0;
+    int64_t     scanned   = 0;
     EdgeRanking lastRank  = -1;
     VertexID    lastDstId = 0;
     bool        firstLoop = true;
     for (; iter->valid(); iter->next()) {
+        if (!sampling && limitPerVertex_ > 0 && passed >= limitPerVertex_) {
+            break;
+        }
         auto key = iter->key();
         auto val = iter->val();
         auto rank = NebulaKeyUtils::getRank(key);
@@ -358,70 +777,201 @@ kvstore::ResultCode QueryBaseProcessor<REQ, RESP>::collectEdgeProps(
             VLOG(3) << "Only get the latest version for each edge.";
             continue;
         }
+        if (splittable && scanned >= FLAGS_edges_per_split) {
+            // It is a supernode, the rest of its edges are processed by the workers
+            splitter->rest_ = splitEdges(vId, edgeType, props, fcontext, iter.get(), *splitter);
+            return ret;
+        }
         lastRank = rank;
         lastDstId = dstId;
+        firstLoop = false;
+        ++scanned;
         std::unique_ptr<RowReader> reader;
         if (type_ == BoundType::OUT_BOUND && !val.empty()) {
             reader = RowReader::getEdgePropReader(this->schemaMan_, val, spaceId_, edgeType);
-            if (exp_ != nullptr) {
-                // TODO(heng): We could remove the lock with one filter one bucket.
-                std::lock_guard<std::mutex> lg(this->lock_);
-                auto& getters = expCtx_->getters();
-                getters.getAliasProp =
-                    [&] (const std::string&, const std::string &prop) -> OptVariantType {
-                        auto res = RowReader::getPropByName(reader.get(), prop);
-                        if (!ok(res)) {
-                            return Status::Error("Invalid Prop");
-                        }
-                        return value(std::move(res));
-                    };
-                getters.getEdgeRank = [&] () -> VariantType {
-                    return rank;
-                };
-                getters.getSrcTagProp = [&fcontext] (const std::string& tag,
-                                                     const std::string& prop) -> OptVariantType {
-                    auto it = fcontext->tagFilters_.find(std::make_pair(tag, prop));
-                    if (it == fcontext->tagFilters_.end()) {
-                        return Status::Error("Invalid Tag Filter");
-                    }
-                    VLOG(1) << "Hit srcProp filter for tag " << tag << ", prop "
-                            << prop << ", value " << it->second;
-                    return it->second;
-                };
-                auto value = exp_->eval();
-                if (value.ok() && !Expression::asBool(value.value())) {
-                    VLOG(1) << "Filter the edge "
-                            << vId << "-> " << dstId << "@" << rank << ":" << edgeType;
-                    continue;
+        }
+        if (!acceptEdge(fcontext, useProgram, reader.get(), vId, edgeType, dstId, rank)) {
+            VLOG(1) << "Filter the edge "
+                    << vId << "-> " << dstId << "@" << rank << ":" << edgeType;
+            continue;
+        }
+        ++passed;
+        if (sampling) {
+            if (passed <= limitPerVertex_) {
+                reservoir.emplace_back(key.str(), val.str());
+            } else {
+                auto i = folly::Random::rand64(passed);
+                if (static_cast<int64_t>(i) < limitPerVertex_) {
+                    reservoir[i] = std::make_pair(key.str(), val.str());
                 }
             }
+            continue;
         }
-        proc(reader.get(), key, props);
-        if (firstLoop) {
-            firstLoop = false;
+        if (!emit(reader.get(), key)) {
+            break;
+        }
+    }
+    for (auto& kv : reservoir) {
+        std::unique_ptr<RowReader> reader;
+        if (type_ == BoundType::OUT_BOUND && !kv.second.empty()) {
+            reader = RowReader::getEdgePropReader(this->schemaMan_, kv.second, spaceId_, edgeType);
+        }
+        if (!emit(reader.get(), kv.first)) {
+            break;
         }
     }
     return ret;
 }
 
+template<typename REQ, typename RESP>
+folly::Future<kvstore::ResultCode> QueryBaseProcessor<REQ, RESP>::splitEdges(
+                                               VertexID vId,
+                                               EdgeType edgeType,
+                                               const std::vector<PropContext>& props,
+                                               FilterContext* fcontext,
+                                               kvstore::KVIterator* iter,
+                                               const EdgeSplitter& splitter) {
+    // The edges of a batch, as pairs of key and value.
+    using Edges = std::vector<std::pair<std::string, std::string>>;
+    // Every batch filters its edges on its own context, with the src tag props of the vertex
+    auto tagFilters = std::make_shared<const std::unordered_map<TagProp, VariantType>>(
+        fcontext->tagFilters_);
+    // The props are of the contexts of the processor, which outlives all the batches
+    const auto* propsPtr = &props;
+    std::vector<folly::Future<kvstore::ResultCode>> batches;
+    auto dispatch = [&] (Edges edges) {
+        auto proc = splitter.batchProcessor_(batches.size());
+        auto batch = [this, vId, edgeType, propsPtr, tagFilters,
+                      proc = std::move(proc), edges = std::move(edges)] () {
+            FilterContext ctx;
+            if (!buildFilter(&ctx)) {
+                return kvstore::ResultCode::ERR_UNKNOWN;
+            }
+            ctx.tagFilters_ = *tagFilters;
+            bool useProgram = program_ != nullptr && loadSrcSlots(&ctx);
+            for (auto& kv : edges) {
+                auto rank = NebulaKeyUtils::getRank(kv.first);
+                auto dstId = NebulaKeyUtils::getDstId(kv.first);
+                std::unique_ptr<RowReader> reader;
+                if (!kv.second.empty()) {
+                    reader = RowReader::getEdgePropReader(this->schemaMan_,
+                                                          kv.second,
+                                                          spaceId_,
+                                                          edgeType);
+                }
+                if (!acceptEdge(&ctx, useProgram, reader.get(), vId, edgeType, dstId, rank)) {
+                    continue;
+                }
+                if (edgesLeft_.fetch_sub(1, std::memory_order_relaxed) <= 0) {
+                    break;
+                }
+                proc(reader.get(), kv.first, *propsPtr);
+            }
+            return kvstore::ResultCode::SUCCEEDED;
+        };
+        batches.emplace_back(folly::via(executor_, std::move(batch)));
+    };
+
+    // Only the latest version of each edge is handed to the workers
+    Edges       edges;
+    EdgeRanking lastRank  = -1;
+    VertexID    lastDstId = 0;
+    bool        firstLoop = true;
+    for (; iter->valid(); iter->next()) {
+        auto key = iter->key();
+        auto rank = NebulaKeyUtils::getRank(key);
+        auto dstId = NebulaKeyUtils::getDstId(key);
+        if (!firstLoop && rank == lastRank && lastDstId == dstId) {
+            continue;
+        }
+        lastRank = rank;
+        lastDstId = dstId;
+        firstLoop = false;
+        if (edges.size() >= static_cast<size_t>(FLAGS_edges_per_split)) {
+            dispatch(std::move(edges));
+            edges = Edges();
+            edges.reserve(FLAGS_edges_per_split);
+        }
+        edges.emplace_back(key.str(), iter->val().str());
+    }
+    if (!edges.empty()) {
+        dispatch(std::move(edges));
+    }
+
+    return folly::collectAll(batches).via(executor_).thenValue([] (auto&& tries) {
+        for (auto& t : tries) {
+            if (t.hasException()) {
+                LOG(ERROR) << "Process the edges failed: " << t.exception().what();
+                return kvstore::ResultCode::ERR_UNKNOWN;
+            }
+            if (t.value() != kvstore::ResultCode::SUCCEEDED) {
+                return t.value();
+            }
+        }
+        return kvstore::ResultCode::SUCCEEDED;
+    });
+}
+
 template<typename REQ, typename RESP>
 folly::Future<std::vector<OneVertexResp>>
-QueryBaseProcessor<REQ, RESP>::asyncProcessBucket(Bucket bucket) {
+QueryBaseProcessor<REQ, RESP>::asyncProcessBucket(size_t bucketIndex) {
     folly::Promise<std::vector<OneVertexResp>> pro;
     auto f = pro.getFuture();
-    executor_->add([this, p = std::move(pro), b = std::move(bucket)] () mutable {
+    executor_->add([this, p = std::move(pro), bucketIndex] () mutable {
         std::vector<OneVertexResp> codes;
-        codes.reserve(b.vertices_.size());
-        for (auto& pv : b.vertices_) {
-            codes.emplace_back(pv.first,
-                               pv.second,
-                               processVertex(pv.first, pv.second));
+        // It is kept until the split supernodes of the bucket are finished
+        auto bcontext = std::make_unique<BucketContext>();
+        if (!buildFilter(&bcontext->filter_)) {
+            LOG(ERROR) << "Decode the filter failed";
+            while (auto* pv = bucketQueue_->take(bucketIndex)) {
+                codes.emplace_back(pv->first, pv->second, kvstore::ResultCode::ERR_UNKNOWN);
+            }
+            p.setValue(std::move(codes));
+            return;
+        }
+        bcontext->scanner_ = this->kvstore_->scanner(spaceId_, false);
+        while (auto* pv = bucketQueue_->take(bucketIndex)) {
+            bcontext->filter_.tagFilters_.clear();
+            codes.emplace_back(pv->first,
+                               pv->second,
+                               processVertex(pv->first, pv->second, bcontext.get()));
+            bcontext->rows_.arena_.reset();
         }
-        p.setValue(std::move(codes));
+        if (bcontext->pending_.empty()) {
+            onBucketFinished(bcontext.get());
+            p.setValue(std::move(codes));
+            return;
+        }
+        // Finish the bucket along with its last supernode, rather than blocking the thread
+        auto pending = std::move(bcontext->pending_);
+        folly::collectAll(pending).via(executor_).thenValue([
+                        this,
+                        bcontext = std::move(bcontext),
+                        codes = std::move(codes),
+                        p = std::move(p)] (auto&& tries) mutable {
+            for (auto& t : tries) {
+                CHECK(!t.hasException());
+                codes.emplace_back(std::move(t).value());
+            }
+            onBucketFinished(bcontext.get());
+            p.setValue(std::move(codes));
+        });
     });
     return f;
 }
 
+template<typename REQ, typename RESP>
+kvstore::ResultCode QueryBaseProcessor<REQ, RESP>::prefix(
+                                                PartitionID partId,
+                                                const std::string& prefix,
+                                                kvstore::KVScanner* scanner,
+                                                std::unique_ptr<kvstore::KVIterator>* iter) {
+    if (scanner != nullptr) {
+        return scanner->prefix(partId, prefix, iter);
+    }
+    return this->kvstore_->prefix(spaceId_, partId, prefix, iter);
+}
+
 template<typename REQ, typename RESP>
 int32_t QueryBaseProcessor<REQ, RESP>::getBucketsNum(int32_t verticesNum,
                                                      int32_t minVerticesPerBucket,
@@ -432,9 +982,15 @@ int32_t QueryBaseProcessor<REQ, RESP>::getBucketsNum(int32_t verticesNum,
 template<typename REQ, typename RESP>
 std::vector<Bucket> QueryBaseProcessor<REQ, RESP>::genBuckets(
                                                     const cpp2::GetNeighborsRequest& req) {
+    return genBuckets(req.get_parts());
+}
+
+template<typename REQ, typename RESP>
+std::vector<Bucket> QueryBaseProcessor<REQ, RESP>::genBuckets(
+            const std::unordered_map<PartitionID, std::vector<VertexID>>& parts) {
     std::vector<Bucket> buckets;
     int32_t verticesNum = 0;
-    for (auto& pv : req.get_parts()) {
+    for (auto& pv : parts) {
         verticesNum += pv.second.size();
     }
     auto bucketsNum = getBucketsNum(verticesNum,
@@ -445,7 +1001,7 @@ std::vector<Bucket> QueryBaseProcessor<REQ, RESP>::genBuckets(
     auto leftVertices = verticesNum % bucketsNum;
     int32_t bucketIndex = -1;
     size_t thresHold = vNumPerBucket;
-    for (auto& pv : req.get_parts()) {
+    for (auto& pv : parts) {
         for (auto& vId : pv.second) {
             if (bucketIndex < 0 || buckets[bucketIndex].vertices_.size() >= thresHold) {
                 ++bucketIndex;
@@ -466,6 +1022,20 @@ void QueryBaseProcessor<REQ, RESP>::process(const cpp2::GetNeighborsRequest& req
     int32_t returnColumnsNum = req.get_return_columns().size();
     VLOG(3) << "Receive request, spaceId " << spaceId_ << ", return cols " << returnColumnsNum;
     tagContexts_.reserve(returnColumnsNum);
+    for (auto edgeType : req.get_edge_types()) {
+        EdgeContext ec;
+        ec.edgeType_ = edgeType;
+        edgeContexts_.emplace_back(std::move(ec));
+    }
+    columnar_ = req.get_columnar() && edgeContexts_.empty();
+    if (req.__isset.edge_limit) {
+        const auto& limit = req.get_edge_limit();
+        limitPerVertex_ = limit->get_per_vertex();
+        randomSample_ = limit->get_random_sample();
+        if (limit->get_total() > 0) {
+            edgesLeft_ = limit->get_total();
+        }
+    }
 
     auto retCode = checkAndBuildContexts(req);
     if (retCode != cpp2::ErrorCode::SUCCEEDED) {
@@ -477,10 +1047,10 @@ void QueryBaseProcessor<REQ, RESP>::process(const cpp2::GetNeighborsRequest& req
     }
 
     // const auto& filter = req.get_filter();
-    auto buckets = genBuckets(req);
+    bucketQueue_ = std::make_unique<BucketQueue>(genBuckets(req));
     std::vector<folly::Future<std::vector<OneVertexResp>>> results;
-    for (auto& bucket : buckets) {
-        results.emplace_back(asyncProcessBucket(std::move(bucket)));
+    for (size_t i = 0; i < bucketQueue_->size(); i++) {
+        results.emplace_back(asyncProcessBucket(i));
     }
     folly::collectAll(results).via(executor_).thenTry([
                      this,
@@ -9,22 +9,27 @@
 #include "time/Duration.h"
 #include "dataman/RowReader.h"
 #include "dataman/RowWriter.h"
+#include "base/NebulaKeyUtils.h"
 
 namespace nebula {
 namespace storage {
 
 kvstore::ResultCode QueryBoundProcessor::processVertex(PartitionID partId,
-                                                       VertexID vId) {
-    FilterContext fcontext;
+                                                       VertexID vId,
+                                                       BucketContext* bcontext) {
+    if (columnar_) {
+        return processVertexByColumns(partId, vId, bcontext);
+    }
     cpp2::VertexData vResp;
     vResp.set_vertex_id(vId);
     if (!tagContexts_.empty()) {
-        RowWriter writer;
+        RowWriter writer(nullptr, &bcontext->rows_.arena_);
         PropsCollector collector(&writer);
         for (auto& tc : tagContexts_) {
             VLOG(3) << "partId " << partId << ", vId " << vId
                     << ", tagId " << tc.tagId_ << ", prop size " << tc.props_.size();
-            auto ret = collectVertexProps(partId, vId, tc.tagId_, tc.props_, &fcontext, &collector);
+            auto ret = collectVertexProps(partId, vId, tc.tagId_, tc.props_,
+                                          bcontext, &collector, tc.projection_.get());
             if (ret != kvstore::ResultCode::SUCCEEDED) {
                 return ret;
             }
@@ -39,41 +44,295 @@ kvstore::ResultCode QueryBoundProcessor::processVertex(PartitionID partId,
         return kvstore::ResultCode::SUCCEEDED;
     }
 
+    if (!edgeContexts_.empty()) {
+        std::vector<cpp2::EdgeData> edges;
+        // The rows of the split types are completed later, by their indexes in `edges'
+        std::vector<size_t> splitIndexes;
+        std::vector<folly::Future<EdgeRows>> rests;
+        auto ret = kvstore::ResultCode::SUCCEEDED;
+        for (auto& ec : edgeContexts_) {
+            if (ec.props_.empty()) {
+                continue;
+            }
+            std::string edgeData;
+            folly::Optional<folly::Future<EdgeRows>> rest;
+            ret = collectEdges(partId, vId, ec, bcontext, &edgeData, &rest);
+            if (ret != kvstore::ResultCode::SUCCEEDED) {
+                break;
+            }
+            if (rest.hasValue()) {
+                splitIndexes.emplace_back(edges.size());
+                rests.emplace_back(std::move(rest).value());
+            } else if (edgeData.empty()) {
+                continue;
+            }
+            cpp2::EdgeData edata;
+            edata.set_type(ec.edgeType_);
+            edata.set_data(std::move(edgeData));
+            edges.emplace_back(std::move(edata));
+        }
+        if (!rests.empty()) {
+            // Even if it fails, the bucket waits for the batches, which refer to the processor
+            auto f = folly::collectAll(rests).via(executor_).thenValue([
+                        this,
+                        partId,
+                        vId,
+                        ret,
+                        vResp = std::move(vResp),
+                        edges = std::move(edges),
+                        splitIndexes = std::move(splitIndexes)] (auto&& tries) mutable {
+                for (size_t i = 0; i < tries.size(); i++) {
+                    CHECK(!tries[i].hasException());
+                    auto& rows = tries[i].value();
+                    if (ret == kvstore::ResultCode::SUCCEEDED) {
+                        ret = rows.first;
+                    }
+                    edges[splitIndexes[i]].data.append(rows.second);
+                }
+                edges.erase(std::remove_if(edges.begin(), edges.end(), [] (const auto& edata) {
+                    return edata.data.empty();
+                }), edges.end());
+                if (ret == kvstore::ResultCode::SUCCEEDED && !edges.empty()) {
+                    vResp.set_edges(std::move(edges));
+                    std::lock_guard<std::mutex> lg(this->lock_);
+                    vertices_.emplace_back(std::move(vResp));
+                }
+                return std::make_tuple(partId, vId, ret);
+            });
+            bcontext->pending_.emplace_back(std::move(f));
+            return kvstore::ResultCode::SUCCEEDED;
+        }
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+        if (!edges.empty()) {
+            vResp.set_edges(std::move(edges));
+            std::lock_guard<std::mutex> lg(this->lock_);
+            vertices_.emplace_back(std::move(vResp));
+        }
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+
     if (!edgeContext_.props_.empty()) {
         CHECK(!onlyVertexProps_);
-        RowSetWriter rsWriter;
+        std::string edgeData;
+        folly::Optional<folly::Future<EdgeRows>> rest;
+        auto ret = collectEdges(partId, vId, edgeContext_, bcontext, &edgeData, &rest);
+        if (rest.hasValue()) {
+            auto f = std::move(rest).value().thenValue([
+                        this,
+                        partId,
+                        vId,
+                        vResp = std::move(vResp),
+                        edgeData = std::move(edgeData)] (EdgeRows&& rows) mutable {
+                edgeData.append(rows.second);
+                if (rows.first == kvstore::ResultCode::SUCCEEDED && !edgeData.empty()) {
+                    vResp.set_edge_data(std::move(edgeData));
+                    std::lock_guard<std::mutex> lg(this->lock_);
+                    vertices_.emplace_back(std::move(vResp));
+                }
+                return std::make_tuple(partId, vId, rows.first);
+            });
+            bcontext->pending_.emplace_back(std::move(f));
+            return ret;
+        }
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+        if (!edgeData.empty()) {
+            vResp.set_edge_data(std::move(edgeData));
+            // Only return the vertex if edges existed.
+            std::lock_guard<std::mutex> lg(this->lock_);
+            vertices_.emplace_back(std::move(vResp));
+        }
+    }
+    return kvstore::ResultCode::SUCCEEDED;
+}
+
+
+kvstore::ResultCode QueryBoundProcessor::processVertexByColumns(PartitionID partId,
+                                                                VertexID vId,
+                                                                BucketContext* bcontext) {
+    if (bcontext->columns_ == nullptr) {
+        bcontext->columns_ = std::make_unique<ColumnsCollector>(tagContexts_, edgeContext_);
+    }
+    auto* columns = bcontext->columns_.get();
+    columns->addVertex(vId);
+    for (auto& tc : tagContexts_) {
+        auto ret = collectVertexProps(partId, vId, tc.tagId_, tc.props_,
+                                      bcontext, columns, tc.projection_.get());
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            columns->removeVertex();
+            return ret;
+        }
+    }
+    if (onlyVertexProps_) {
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+    if (!edgeContext_.props_.empty()) {
         auto ret = collectEdgeProps(partId, vId,
                                     edgeContext_.edgeType_,
                                     edgeContext_.props_,
-                                    &fcontext,
+                                    bcontext,
                                     [&, this] (RowReader* reader,
                                                folly::StringPiece key,
                                                const std::vector<PropContext>& props) {
-                                        RowWriter writer(rsWriter.schema());
-                                        PropsCollector collector(&writer);
+                                        columns->addEdge();
                                         this->collectProps(reader,
                                                            key,
                                                            props,
-                                                           &fcontext,
-                                                           &collector);
-                                        rsWriter.addRow(writer);
+                                                           &bcontext->filter_,
+                                                           columns,
+                                                           edgeContext_.projection_.get());
                                     });
         if (ret != kvstore::ResultCode::SUCCEEDED) {
+            columns->removeVertex();
             return ret;
         }
-        if (!rsWriter.data().empty()) {
-            vResp.set_edge_data(std::move(rsWriter.data()));
-            // Only return the vertex if edges existed.
-            std::lock_guard<std::mutex> lg(this->lock_);
-            vertices_.emplace_back(std::move(vResp));
-        }
+    }
+    // Only return the vertex if edges existed.
+    if (columns->edgesOfLastVertex() == 0) {
+        columns->removeVertex();
     }
     return kvstore::ResultCode::SUCCEEDED;
 }
 
 
+kvstore::ResultCode QueryBoundProcessor::collectEdges(
+                                    PartitionID partId,
+                                    VertexID vId,
+                                    const EdgeContext& ec,
+                                    BucketContext* bcontext,
+                                    std::string* edgeData,
+                                    folly::Optional<folly::Future<EdgeRows>>* rest) {
+    // Encode into the buffer of the bucket, and copy the rows out in the exact size,
+    // rather than allocating (and keeping in the response) a new buffer for every vertex
+    auto& rsWriter = bcontext->rows_.rowSet_;
+    rsWriter.clear();
+    // The encoder into the row set and arena of the buffer, and the buffer of the raw row.
+    // The edge props never feed the tag filters, so no filter context is needed.
+    auto encoder = [&ec, this] (RowSetBuffer* buf, std::string* row) -> EdgeProcessor {
+        return [&ec, buf, row, this] (RowReader* reader,
+                                      folly::StringPiece key,
+                                      const std::vector<PropContext>& props) {
+            if (ec.rawSchemaVer_ >= 0
+                    && reader != nullptr
+                    && reader->schemaVer() == ec.rawSchemaVer_
+                    && encodeRawRow(reader, key, ec, row)) {
+                buf->rowSet_.addRow(*row);
+                return;
+            }
+            RowWriter writer(buf->rowSet_.schema(), &buf->arena_);
+            PropsCollector collector(&writer);
+            this->collectProps(reader, key, props, nullptr, &collector, ec.projection_.get());
+            buf->rowSet_.addRow(writer);
+        };
+    };
+    std::string row;
+    // The batches of a supernode are encoded each into the buffers of its own,
+    // which are kept until all of them are processed.
+    auto batches = std::make_shared<std::deque<std::pair<RowSetBuffer, std::string>>>();
+    EdgeSplitter splitter;
+    splitter.batchProcessor_ = [&encoder, batches] (size_t) {
+        batches->emplace_back();
+        auto& batch = batches->back();
+        return encoder(&batch.first, &batch.second);
+    };
+    auto ret = collectEdgeProps(partId, vId,
+                                ec.edgeType_,
+                                ec.props_,
+                                bcontext,
+                                encoder(&bcontext->rows_, &row),
+                                &splitter);
+    if (splitter.rest_.hasValue()) {
+        // The rows of the batches follow the ones scanned before splitting, in the key order
+        *rest = std::move(splitter.rest_).value().thenValue([batches] (kvstore::ResultCode code) {
+            std::string rows;
+            if (code == kvstore::ResultCode::SUCCEEDED) {
+                for (auto& batch : *batches) {
+                    rows.append(batch.first.rowSet_.data());
+                }
+            }
+            return std::make_pair(code, std::move(rows));
+        });
+    }
+    if (ret == kvstore::ResultCode::SUCCEEDED) {
+        edgeData->assign(rsWriter.data());
+    }
+    return ret;
+}
+
+
+bool QueryBoundProcessor::encodeRawRow(RowReader* reader,
+                                       folly::StringPiece key,
+                                       const EdgeContext& ec,
+                                       std::string* row) {
+    if (!reader->encodePrefix(ec.props_.size() - ec.rawKeyProps_, row)) {
+        return false;
+    }
+    if (ec.rawKeyProps_ > 0) {
+        RowWriter writer;
+        for (int32_t i = 0; i < ec.rawKeyProps_; i++) {
+            switch (ec.props_[i].pikType_) {
+                case PropContext::PropInKeyType::SRC:
+                    writer << NebulaKeyUtils::getSrcId(key);
+                    break;
+                case PropContext::PropInKeyType::DST:
+                    writer << NebulaKeyUtils::getDstId(key);
+                    break;
+                case PropContext::PropInKeyType::TYPE:
+                    writer << static_cast<int64_t>(NebulaKeyUtils::getEdgeType(key));
+                    break;
+                case PropContext::PropInKeyType::RANK:
+                    writer << NebulaKeyUtils::getRank(key);
+                    break;
+                case PropContext::PropInKeyType::NONE:
+                    LOG(FATAL) << "Not a prop in key";
+            }
+        }
+        // Neither of the rows has any block offset, so the data just follows the header
+        auto keys = writer.encode();
+        row->insert(1, keys, 1, std::string::npos);
+    }
+    return true;
+}
+
+
+nebula::cpp2::Schema QueryBoundProcessor::toSchema(std::vector<PropContext>& props) {
+    nebula::cpp2::Schema respEdge;
+    decltype(respEdge.columns) cols;
+    cols.reserve(props.size());
+    for (auto& prop : props) {
+        CHECK(prop.returned_);
+        cols.emplace_back(columnDef(std::move(prop.prop_.name),
+                                              prop.type_.type));
+    }
+    respEdge.set_columns(std::move(cols));
+    return respEdge;
+}
+
+
+void QueryBoundProcessor::onBucketFinished(BucketContext* bcontext) {
+    if (bcontext->columns_ != nullptr) {
+        std::lock_guard<std::mutex> lg(this->lock_);
+        columns_.emplace_back(std::move(bcontext->columns_));
+    }
+}
+
+
 void QueryBoundProcessor::onProcessFinished(int32_t retNum) {
     resp_.set_vertices(std::move(vertices_));
+    if (columnar_) {
+        // All the buckets are done, no lock needed
+        ColumnsCollector columns(this->tagContexts_, this->edgeContext_);
+        for (auto& partial : columns_) {
+            columns.merge(std::move(*partial));
+        }
+        columns_.clear();
+        cpp2::ColumnarData data;
+        columns.finish(&data);
+        resp_.set_columnar(std::move(data));
+    }
     if (!this->tagContexts_.empty()) {
         nebula::cpp2::Schema respTag;
         respTag.columns.reserve(retNum - this->edgeContext_.props_.size());
@@ -90,19 +349,20 @@ void QueryBoundProcessor::onProcessFinished(int32_t retNum) {
         }
     }
     if (!this->edgeContext_.props_.empty()) {
-        nebula::cpp2::Schema respEdge;
-        decltype(respEdge.columns) cols;
-        cols.reserve(this->edgeContext_.props_.size());
-        for (auto& prop : this->edgeContext_.props_) {
-            CHECK(prop.returned_);
-            cols.emplace_back(columnDef(std::move(prop.prop_.name),
-                                                  prop.type_.type));
-        }
-        respEdge.set_columns(std::move(cols));
+        auto respEdge = toSchema(this->edgeContext_.props_);
         if (!respEdge.get_columns().empty()) {
             resp_.set_edge_schema(std::move(respEdge));
         }
     }
+    if (!this->edgeContexts_.empty()) {
+        std::unordered_map<EdgeType, nebula::cpp2::Schema> edgeSchemas;
+        for (auto& ec : this->edgeContexts_) {
+            if (!ec.props_.empty()) {
+                edgeSchemas.emplace(ec.edgeType_, toSchema(ec.props_));
+            }
+        }
+        resp_.set_edge_schemas(std::move(edgeSchemas));
+    }
 }
 
 }  // namespace storage
@@ -36,12 +36,49 @@ protected:
                              cpp2::QueryResponse>(kvstore, schemaMan, executor, type) {}
 
     kvstore::ResultCode processVertex(PartitionID partID,
-                                      VertexID vId) override;
+                                      VertexID vId,
+                                      BucketContext* bcontext) override;
 
     void onProcessFinished(int32_t retNum) override;
 
+    void onBucketFinished(BucketContext* bcontext) override;
+
+private:
+    /**
+     * Collect the vertex and its edges into the columns of the bucket.
+     * */
+    kvstore::ResultCode processVertexByColumns(PartitionID partId,
+                                               VertexID vId,
+                                               BucketContext* bcontext);
+
+    // The result and the rows of the rest edges of a split supernode
+    using EdgeRows = std::pair<kvstore::ResultCode, std::string>;
+
+    /**
+     * Collect the edges of one type into a row set. If the edges of the supernode are split,
+     * `rest' is set to be fulfilled with the rows following edgeData, see EdgeSplitter.
+     * */
+    kvstore::ResultCode collectEdges(PartitionID partId,
+                                     VertexID vId,
+                                     const EdgeContext& ec,
+                                     BucketContext* bcontext,
+                                     std::string* edgeData,
+                                     folly::Optional<folly::Future<EdgeRows>>* rest);
+
+    /**
+     * Encode the edge by the data of the stored value as it is, see EdgeContext::rawSchemaVer_.
+     * */
+    bool encodeRawRow(RowReader* reader,
+                      folly::StringPiece key,
+                      const EdgeContext& ec,
+                      std::string* row);
+
+    nebula::cpp2::Schema toSchema(std::vector<PropContext>& props);
+
 private:
     std::vector<cpp2::VertexData> vertices_;
+    // The columns of the finished buckets, when columnar_ is set
+    std::vector<std::unique_ptr<ColumnsCollector>> columns_;
 
 protected:
     // Indicate the request only get vertex props.
@@ -0,0 +1,71 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/QueryDegreeProcessor.h"
+#include "base/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+kvstore::ResultCode QueryDegreeProcessor::collectDegrees(PartitionID partId,
+                                                         VertexID vId,
+                                                         const std::vector<EdgeType>& edgeTypes,
+                                                         std::vector<int64_t>* degrees) {
+    degrees->reserve(edgeTypes.size());
+    for (auto edgeType : edgeTypes) {
+        std::string val;
+        auto ret = kvstore_->get(spaceId_,
+                                 partId,
+                                 NebulaKeyUtils::degreeKey(partId, vId, edgeType),
+                                 &val);
+        if (ret == kvstore::ResultCode::ERR_KEY_NOT_FOUND) {
+            degrees->emplace_back(0);
+            continue;
+        }
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+        if (val.size() != sizeof(int64_t)) {
+            LOG(ERROR) << "Bad degree of vertex " << vId << ", edge type " << edgeType;
+            return kvstore::ResultCode::ERR_UNKNOWN;
+        }
+        degrees->emplace_back(NebulaKeyUtils::readInt<int64_t>(val.data(), val.size()));
+    }
+    return kvstore::ResultCode::SUCCEEDED;
+}
+
+void QueryDegreeProcessor::process(const cpp2::DegreeRequest& req) {
+    spaceId_ = req.get_space_id();
+    const auto& edgeTypes = req.get_edge_types();
+    std::vector<cpp2::VertexDegrees> vertices;
+    for (auto& part : req.get_parts()) {
+        auto partId = part.first;
+        auto ret = kvstore::ResultCode::SUCCEEDED;
+        std::vector<cpp2::VertexDegrees> partVertices;
+        partVertices.reserve(part.second.size());
+        for (auto vId : part.second) {
+            std::vector<int64_t> degrees;
+            ret = collectDegrees(partId, vId, edgeTypes, &degrees);
+            if (ret != kvstore::ResultCode::SUCCEEDED) {
+                break;
+            }
+            cpp2::VertexDegrees vd;
+            vd.set_vertex_id(vId);
+            vd.set_degrees(std::move(degrees));
+            partVertices.emplace_back(std::move(vd));
+        }
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            this->pushResultCode(this->to(ret), partId);
+            continue;
+        }
+        std::move(partVertices.begin(), partVertices.end(), std::back_inserter(vertices));
+    }
+    resp_.set_vertices(std::move(vertices));
+    this->onFinished();
+}
+
+}  // namespace storage
+}  // namespace nebula
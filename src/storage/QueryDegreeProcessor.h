@@ -0,0 +1,44 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_QUERYDEGREEPROCESSOR_H_
+#define STORAGE_QUERYDEGREEPROCESSOR_H_
+
+#include "base/Base.h"
+#include "storage/BaseProcessor.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * Get the degrees of the vertices from their counters, which are maintained
+ * by kvstore::Part when the edges are applied. The degree of a vertex without any counter is 0.
+ * */
+class QueryDegreeProcessor : public BaseProcessor<cpp2::DegreeResponse> {
+public:
+    static QueryDegreeProcessor* instance(kvstore::KVStore* kvstore,
+                                          meta::SchemaManager* schemaMan) {
+        return new QueryDegreeProcessor(kvstore, schemaMan);
+    }
+
+    void process(const cpp2::DegreeRequest& req);
+
+private:
+    explicit QueryDegreeProcessor(kvstore::KVStore* kvstore, meta::SchemaManager* schemaMan)
+            : BaseProcessor<cpp2::DegreeResponse>(kvstore, schemaMan) {}
+
+    kvstore::ResultCode collectDegrees(PartitionID partId,
+                                       VertexID vId,
+                                       const std::vector<EdgeType>& edgeTypes,
+                                       std::vector<int64_t>* degrees);
+
+private:
+    GraphSpaceID spaceId_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_QUERYDEGREEPROCESSOR_H_
@@ -18,14 +18,15 @@ kvstore::ResultCode QueryEdgePropsProcessor::collectEdgesProps(
                                        PartitionID partId,
                                        const cpp2::EdgeKey& edgeKey,
                                        std::vector<PropContext>& props,
-                                       RowSetWriter& rsWriter) {
+                                       RowSetWriter& rsWriter,
+                                       Arena* arena) {
     auto prefix = NebulaKeyUtils::prefix(partId, edgeKey.src, edgeKey.edge_type,
                                          edgeKey.ranking, edgeKey.dst);
     std::unique_ptr<kvstore::KVIterator> iter;
     auto ret = kvstore_->prefix(spaceId_, partId, prefix, &iter);
     // Only use the latest version.
     if (iter && iter->valid()) {
-        RowWriter writer(rsWriter.schema());
+        RowWriter writer(rsWriter.schema(), arena);
         PropsCollector collector(&writer);
         auto reader = RowReader::getEdgePropReader(schemaMan_,
                                                    iter->val(),
@@ -60,11 +61,15 @@ void QueryEdgePropsProcessor::process(const cpp2::EdgePropRequest& req) {
     }
 
     RowSetWriter rsWriter;
+    // The row of each edge is encoded in the same memory
+    Arena arena;
     std::for_each(req.get_parts().begin(), req.get_parts().end(), [&](auto& partE) {
         auto partId = partE.first;
         kvstore::ResultCode ret;
         for (auto& edgeKey : partE.second) {
-            ret = this->collectEdgesProps(partId, edgeKey, this->edgeContext_.props_, rsWriter);
+            ret = this->collectEdgesProps(partId, edgeKey, this->edgeContext_.props_,
+                                          rsWriter, &arena);
+            arena.reset();
             if (ret != kvstore::ResultCode::SUCCEEDED) {
                 break;
             }
@@ -31,11 +31,12 @@ private:
     kvstore::ResultCode collectEdgesProps(PartitionID partId,
                                           const cpp2::EdgeKey& edgeKey,
                                           std::vector<PropContext>& props,
-                                          RowSetWriter& rsWriter);
+                                          RowSetWriter& rsWriter,
+                                          Arena* arena);
 
     void addDefaultProps();
 
-    kvstore::ResultCode processVertex(PartitionID, VertexID) override {
+    kvstore::ResultCode processVertex(PartitionID, VertexID, BucketContext*) override {
         LOG(FATAL) << "Unimplement!";
         return kvstore::ResultCode::SUCCEEDED;
     }
@@ -13,46 +13,68 @@
 namespace nebula {
 namespace storage {
 
-void QueryStatsProcessor::calcResult(std::vector<PropContext>&& props) {
+void QueryStatsProcessor::writeNumber(const PropStats::Number& n,
+                                      PropContext* prop,
+                                      RowWriter* writer,
+                                      std::vector<nebula::cpp2::ColumnDef>* cols) {
+    // It is still an integer zero if there is no value at all
+    if (n.which() == 1
+            || prop->type_.type == nebula::cpp2::SupportedType::DOUBLE
+            || prop->type_.type == nebula::cpp2::SupportedType::FLOAT) {
+        (*writer) << PropStats::toDouble(n);
+        cols->emplace_back(columnDef(std::move(prop->prop_.name),
+                                     nebula::cpp2::SupportedType::DOUBLE));
+    } else {
+        (*writer) << boost::get<int64_t>(n);
+        cols->emplace_back(columnDef(std::move(prop->prop_.name),
+                                     nebula::cpp2::SupportedType::INT));
+    }
+}
+
+
+void QueryStatsProcessor::calcResult(std::vector<PropContext>&& props, StatsCollector* stats) {
     RowWriter writer;
     decltype(resp_.schema) s;
     decltype(resp_.schema.columns) cols;
     for (auto& prop : props) {
+        auto& ps = stats->finish(prop);
         switch (prop.prop_.stat) {
             case cpp2::StatType::SUM: {
-                switch (prop.sum_.which()) {
-                    case 0:
-                        writer << boost::get<int64_t>(prop.sum_);
-                        cols.emplace_back(
-                                columnDef(std::move(prop.prop_.name),
-                                          nebula::cpp2::SupportedType::INT));
-                        break;
-                    case 1:
-                        writer << boost::get<double>(prop.sum_);
-                        cols.emplace_back(
-                                columnDef(std::move(prop.prop_.name),
-                                          nebula::cpp2::SupportedType::DOUBLE));
-                        break;
-                }
+                writeNumber(ps.sum_, &prop, &writer, &cols);
                 break;
             }
             case cpp2::StatType::COUNT: {
-                writer << prop.count_;
+                writer << ps.count_;
                 cols.emplace_back(
                             columnDef(std::move(prop.prop_.name),
                                       nebula::cpp2::SupportedType::INT));
                 break;
             }
             case cpp2::StatType::AVG: {
-                switch (prop.sum_.which()) {
-                    case 0:
-                        writer << static_cast<double>(boost::get<int64_t>(prop.sum_))
-                                  / prop.count_;
-                        break;
-                    case 1:
-                        writer << boost::get<double>(prop.sum_) / prop.count_;
-                        break;
-                }
+                writer << PropStats::toDouble(ps.sum_) / ps.count_;
+                cols.emplace_back(
+                        columnDef(std::move(prop.prop_.name),
+                                  nebula::cpp2::SupportedType::DOUBLE));
+                break;
+            }
+            case cpp2::StatType::MIN: {
+                writeNumber(ps.min_, &prop, &writer, &cols);
+                break;
+            }
+            case cpp2::StatType::MAX: {
+                writeNumber(ps.max_, &prop, &writer, &cols);
+                break;
+            }
+            case cpp2::StatType::COUNT_DISTINCT: {
+                int64_t num = ps.distinct_ == nullptr ? 0 : ps.distinct_->estimate();
+                writer << num;
+                cols.emplace_back(
+                            columnDef(std::move(prop.prop_.name),
+                                      nebula::cpp2::SupportedType::INT));
+                break;
+            }
+            case cpp2::StatType::PERCENTILE: {
+                writer << ps.digest_.estimateQuantile(prop.prop_.percentile / 100);
                 cols.emplace_back(
                         columnDef(std::move(prop.prop_.name),
                                   nebula::cpp2::SupportedType::DOUBLE));
@@ -67,15 +89,20 @@ void QueryStatsProcessor::calcResult(std::vector<PropContext>&& props) {
 
 
 kvstore::ResultCode QueryStatsProcessor::processVertex(PartitionID partId,
-                                                       VertexID vId) {
-    FilterContext fcontext;
+                                                       VertexID vId,
+                                                       BucketContext* bcontext) {
+    if (bcontext->stats_ == nullptr) {
+        bcontext->stats_ = std::make_unique<StatsCollector>();
+    }
+    auto* collector = bcontext->stats_.get();
     for (auto& tc : tagContexts_) {
         auto ret = this->collectVertexProps(partId,
                                             vId,
                                             tc.tagId_,
                                             tc.props_,
-                                            &fcontext,
-                                            &collector_);
+                                            bcontext,
+                                            collector,
+                                            tc.projection_.get());
         if (ret != kvstore::ResultCode::SUCCEEDED) {
             return ret;
         }
@@ -86,15 +113,16 @@ kvstore::ResultCode QueryStatsProcessor::processVertex(PartitionID partId,
                                        vId,
                                        this->edgeContext_.edgeType_,
                                        this->edgeContext_.props_,
-                                       &fcontext,
+                                       bcontext,
                                        [&, this] (RowReader* reader,
                                                   folly::StringPiece key,
                                                   const std::vector<PropContext>& props) {
                                            this->collectProps(reader,
                                                               key,
                                                               props,
-                                                              &fcontext,
-                                                              &collector_);
+                                                              &bcontext->filter_,
+                                                              collector,
+                                                              this->edgeContext_.projection_.get());
                                        });
     }
     return kvstore::ResultCode::SUCCEEDED;
@@ -118,7 +146,21 @@ void QueryStatsProcessor::onProcessFinished(int32_t retNum) {
     std::sort(props.begin(), props.end(), [](auto& l, auto& r){
         return l.retIndex_ < r.retIndex_;
     });
-    calcResult(std::move(props));
+    // All the buckets are done, no lock needed
+    StatsCollector stats;
+    for (auto& partial : partials_) {
+        stats.merge(std::move(*partial));
+    }
+    partials_.clear();
+    calcResult(std::move(props), &stats);
+}
+
+
+void QueryStatsProcessor::onBucketFinished(BucketContext* bcontext) {
+    if (bcontext->stats_ != nullptr) {
+        std::lock_guard<std::mutex> lg(lock_);
+        partials_.emplace_back(std::move(bcontext->stats_));
+    }
 }
 
 }  // namespace storage
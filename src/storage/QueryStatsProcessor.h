@@ -32,14 +32,27 @@ private:
                              cpp2::QueryStatsResponse>(kvstore, schemaMan, executor, type) {}
 
     kvstore::ResultCode processVertex(PartitionID partID,
-                                      VertexID vId) override;
+                                      VertexID vId,
+                                      BucketContext* bcontext) override;
 
     void onProcessFinished(int32_t retNum) override;
 
-    void calcResult(std::vector<PropContext>&& props);
+    void onBucketFinished(BucketContext* bcontext) override;
+
+    void calcResult(std::vector<PropContext>&& props, StatsCollector* stats);
+
+    /**
+     * Write the number as INT or DOUBLE, by the type of the prop.
+     * */
+    void writeNumber(const PropStats::Number& n,
+                     PropContext* prop,
+                     RowWriter* writer,
+                     std::vector<nebula::cpp2::ColumnDef>* cols);
 
 private:
-    StatsCollector collector_;
+    std::mutex lock_;
+    // The partial stats of the finished buckets
+    std::vector<std::unique_ptr<StatsCollector>> partials_;
 };
 
 }  // namespace storage
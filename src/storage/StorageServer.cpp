@@ -14,6 +14,7 @@
 #include "kvstore/PartManager.h"
 #include "webservice/WebService.h"
 #include "storage/CompactionFilter.h"
+#include "storage/PipelineStats.h"
 #include "hdfs/HdfsCommandHelper.h"
 #include "thread/GenericThreadPool.h"
 #include <thrift/lib/cpp/concurrency/ThreadManager.h>
@@ -39,6 +40,7 @@ std::unique_ptr<kvstore::KVStore> StorageServer::getStoreInstance() {
                                                 metaClient_.get());
     options.cfFactory_ = std::shared_ptr<kvstore::KVCompactionFilterFactory>(
                                 new storage::NebulaCompactionFilterFactory(schemaMan_.get()));
+    options.raftStats_ = std::make_shared<RaftPipelineStats>();
     if (FLAGS_store_type == "nebula") {
         auto nbStore = std::make_unique<kvstore::NebulaStore>(std::move(options),
                                                               ioThreadPool_,
@@ -12,20 +12,61 @@
 #include "storage/QueryVertexPropsProcessor.h"
 #include "storage/QueryEdgePropsProcessor.h"
 #include "storage/QueryStatsProcessor.h"
+#include "storage/QueryDegreeProcessor.h"
+#include "storage/TraverseProcessor.h"
 #include "storage/AdminProcessor.h"
+#include "storage/PayloadCodec.h"
+#include "stats/StatsManager.h"
 
 #define RETURN_FUTURE(processor) \
     auto f = processor->getFuture(); \
     processor->process(req); \
     return f;
 
+#define RETURN_COMPRESSED_FUTURE(processor) \
+    auto f = processor->getFuture(); \
+    processor->process(req); \
+    return compressResponse(std::move(f), req.get_accept_compression());
+
+DEFINE_int32(rpc_compress_min_bytes, 8192,
+             "The min bytes of a response to be compressed, if the client accepts any compression");
+
 namespace nebula {
 namespace storage {
 
+namespace {
+
+void addCompressedBytes(size_t rawSize, size_t compressedSize) {
+    static const int32_t rawBytes = stats::StatsManager::registerStats("rpc_raw_bytes");
+    static const int32_t compressedBytes
+        = stats::StatsManager::registerStats("rpc_compressed_bytes");
+    stats::StatsManager::addValue(rawBytes, rawSize);
+    stats::StatsManager::addValue(compressedBytes, compressedSize);
+}
+
+}  // Anonymous namespace
+
+template<class RESP>
+folly::Future<RESP> StorageServiceHandler::compressResponse(
+        folly::Future<RESP> f,
+        const std::vector<cpp2::CompressionType>& accepted) {
+    auto type = PayloadCodec::negotiate(accepted);
+    if (type == cpp2::CompressionType::NONE) {
+        return f;
+    }
+    return std::move(f).thenValue([type] (RESP&& resp) {
+        auto rawSize = PayloadCodec::compress(type, FLAGS_rpc_compress_min_bytes, &resp);
+        if (rawSize > 0) {
+            addCompressedBytes(rawSize, resp.get_compressed()->get_data().size());
+        }
+        return std::move(resp);
+    });
+}
+
 folly::Future<cpp2::QueryResponse>
 StorageServiceHandler::future_getOutBound(const cpp2::GetNeighborsRequest& req) {
     auto* processor = QueryBoundProcessor::instance(kvstore_, schemaMan_, getThreadManager());
-    RETURN_FUTURE(processor);
+    RETURN_COMPRESSED_FUTURE(processor);
 }
 
 folly::Future<cpp2::QueryResponse>
@@ -34,6 +75,12 @@ StorageServiceHandler::future_getInBound(const cpp2::GetNeighborsRequest& req) {
                                                     schemaMan_,
                                                     getThreadManager(),
                                                     BoundType::IN_BOUND);
+    RETURN_COMPRESSED_FUTURE(processor);
+}
+
+folly::Future<cpp2::QueryResponse>
+StorageServiceHandler::future_traverse(const cpp2::TraverseRequest& req) {
+    auto* processor = TraverseProcessor::instance(kvstore_, schemaMan_, getThreadManager());
     RETURN_FUTURE(processor);
 }
 
@@ -57,12 +104,18 @@ StorageServiceHandler::future_getProps(const cpp2::VertexPropRequest& req) {
     auto* processor = QueryVertexPropsProcessor::instance(kvstore_,
                                                           schemaMan_,
                                                           getThreadManager());
-    RETURN_FUTURE(processor);
+    RETURN_COMPRESSED_FUTURE(processor);
 }
 
 folly::Future<cpp2::EdgePropResponse>
 StorageServiceHandler::future_getEdgeProps(const cpp2::EdgePropRequest& req) {
     auto* processor = QueryEdgePropsProcessor::instance(kvstore_, schemaMan_);
+    RETURN_COMPRESSED_FUTURE(processor);
+}
+
+folly::Future<cpp2::DegreeResponse>
+StorageServiceHandler::future_getDegrees(const cpp2::DegreeRequest& req) {
+    auto* processor = QueryDegreeProcessor::instance(kvstore_, schemaMan_);
     RETURN_FUTURE(processor);
 }
 
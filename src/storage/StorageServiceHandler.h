@@ -31,6 +31,9 @@ public:
     folly::Future<cpp2::QueryResponse>
     future_getInBound(const cpp2::GetNeighborsRequest& req) override;
 
+    folly::Future<cpp2::QueryResponse>
+    future_traverse(const cpp2::TraverseRequest& req) override;
+
     folly::Future<cpp2::QueryStatsResponse>
     future_outBoundStats(const cpp2::GetNeighborsRequest& req) override;
 
@@ -43,6 +46,9 @@ public:
     folly::Future<cpp2::EdgePropResponse>
     future_getEdgeProps(const cpp2::EdgePropRequest& req) override;
 
+    folly::Future<cpp2::DegreeResponse>
+    future_getDegrees(const cpp2::DegreeRequest& req) override;
+
     folly::Future<cpp2::ExecResponse>
     future_addVertices(const cpp2::AddVerticesRequest& req) override;
 
@@ -71,6 +77,14 @@ public:
     folly::Future<cpp2::GetLeaderResp>
     future_getLeaderPart(const cpp2::GetLeaderReq& req) override;
 
+private:
+    /**
+     * Compress the response by the first accepted compression, if it is large enough.
+     * */
+    template<class RESP>
+    folly::Future<RESP> compressResponse(folly::Future<RESP> f,
+                                         const std::vector<cpp2::CompressionType>& accepted);
+
 private:
     kvstore::KVStore* kvstore_ = nullptr;
     meta::SchemaManager* schemaMan_;
@@ -0,0 +1,161 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/TraverseProcessor.h"
+#include "base/NebulaKeyUtils.h"
+#include "kvstore/Part.h"
+
+namespace nebula {
+namespace storage {
+
+void TraverseProcessor::process(const cpp2::TraverseRequest& req) {
+    CHECK_NOTNULL(executor_);
+    spaceId_ = req.get_space_id();
+    partsNum_ = req.get_parts_num();
+    edgeType_ = req.get_edge_type();
+    if (req.__isset.edge_limit) {
+        limit_ = req.get_edge_limit()->get_per_vertex();
+        randomSample_ = req.get_edge_limit()->get_random_sample();
+    }
+
+    finalReq_.set_space_id(spaceId_);
+    finalReq_.set_edge_type(edgeType_);
+    finalReq_.set_filter(req.get_filter());
+    finalReq_.set_return_columns(req.get_return_columns());
+    if (req.__isset.edge_limit) {
+        finalReq_.set_edge_limit(*req.get_edge_limit());
+    }
+    expandStep(req.get_steps(), req.get_parts());
+}
+
+
+void TraverseProcessor::expandStep(int32_t steps, PartVertices parts) {
+    if (steps <= 1 || parts.empty()) {
+        if (!frontier_.empty()) {
+            resp_.set_frontier(std::move(frontier_));
+        }
+        finalReq_.set_parts(std::move(parts));
+        QueryBoundProcessor::process(finalReq_);
+        return;
+    }
+
+    auto queue = std::make_shared<BucketQueue>(genBuckets(parts));
+    std::vector<folly::Future<StepResult>> results;
+    for (size_t i = 0; i < queue->size(); i++) {
+        results.emplace_back(asyncExpandBucket(queue, i));
+    }
+    folly::collectAll(results).via(executor_).thenTry([this, steps] (auto&& t) {
+        CHECK(!t.hasException());
+        std::unordered_set<VertexID> dstIds;
+        for (auto& bucketTry : t.value()) {
+            CHECK(!bucketTry.hasException());
+            auto& result = bucketTry.value();
+            for (auto& part : result.failedParts_) {
+                if (failedParts_.emplace(part.first).second) {
+                    this->pushResultCode(this->to(part.second), part.first);
+                }
+            }
+            dstIds.insert(result.dstIds_.begin(), result.dstIds_.end());
+        }
+        VLOG(3) << "Reach " << dstIds.size() << " vertices with " << steps - 1 << " steps left";
+        PartVertices next;
+        for (auto dstId : dstIds) {
+            auto dstPart = partId(dstId);
+            if (failedParts_.count(dstPart) != 0) {
+                continue;
+            }
+            if (isLocal(dstPart)) {
+                next[dstPart].emplace_back(dstId);
+            } else {
+                frontier_[steps - 1].emplace_back(dstId);
+            }
+        }
+        expandStep(steps - 1, std::move(next));
+    });
+}
+
+
+folly::Future<TraverseProcessor::StepResult>
+TraverseProcessor::asyncExpandBucket(std::shared_ptr<BucketQueue> queue, size_t bucketIndex) {
+    folly::Promise<StepResult> pro;
+    auto f = pro.getFuture();
+    executor_->add([this, p = std::move(pro), queue = std::move(queue), bucketIndex] ()
+                   mutable {
+        StepResult result;
+        auto scanner = this->kvstore_->scanner(spaceId_, false);
+        while (auto* pv = queue->take(bucketIndex)) {
+            if (result.failedParts_.count(pv->first) != 0) {
+                continue;
+            }
+            // The dst ids of a failed vertex are not taken, its part is dropped anyway
+            std::unordered_set<VertexID> dstIds;
+            auto ret = collectDstIds(scanner.get(), pv->first, pv->second, &dstIds);
+            if (ret != kvstore::ResultCode::SUCCEEDED) {
+                result.failedParts_.emplace(pv->first, ret);
+                continue;
+            }
+            result.dstIds_.insert(dstIds.begin(), dstIds.end());
+        }
+        p.setValue(std::move(result));
+    });
+    return f;
+}
+
+
+kvstore::ResultCode TraverseProcessor::collectDstIds(kvstore::KVScanner* scanner,
+                                                     PartitionID partId,
+                                                     VertexID vId,
+                                                     std::unordered_set<VertexID>* dstIds) {
+    auto prefix = NebulaKeyUtils::prefix(partId, vId, edgeType_);
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto ret = scanner->prefix(partId, prefix, &iter);
+    if (ret != kvstore::ResultCode::SUCCEEDED || !iter) {
+        return ret;
+    }
+    std::vector<VertexID> reservoir;
+    int64_t     count     = 0;
+    EdgeRanking lastRank  = -1;
+    VertexID    lastDstId = 0;
+    bool        firstLoop = true;
+    for (; iter->valid(); iter->next()) {
+        auto key = iter->key();
+        auto rank = NebulaKeyUtils::getRank(key);
+        auto dstId = NebulaKeyUtils::getDstId(key);
+        if (!firstLoop && rank == lastRank && lastDstId == dstId) {
+            continue;
+        }
+        lastRank = rank;
+        lastDstId = dstId;
+        firstLoop = false;
+        ++count;
+        if (limit_ <= 0) {
+            dstIds->emplace(dstId);
+        } else if (!randomSample_) {
+            dstIds->emplace(dstId);
+            if (count >= limit_) {
+                break;
+            }
+        } else if (count <= limit_) {
+            reservoir.emplace_back(dstId);
+        } else {
+            auto i = folly::Random::rand64(count);
+            if (static_cast<int64_t>(i) < limit_) {
+                reservoir[i] = dstId;
+            }
+        }
+    }
+    dstIds->insert(reservoir.begin(), reservoir.end());
+    return ret;
+}
+
+
+bool TraverseProcessor::isLocal(PartitionID partId) {
+    auto ret = this->kvstore_->part(spaceId_, partId);
+    return ok(ret) && nebula::value(ret)->isLeader();
+}
+
+}  // namespace storage
+}  // namespace nebula
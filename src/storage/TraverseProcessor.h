@@ -0,0 +1,97 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_TRAVERSEPROCESSOR_H_
+#define STORAGE_TRAVERSEPROCESSOR_H_
+
+#include "base/Base.h"
+#include "storage/QueryBoundProcessor.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * Step out several times from the given vertices.
+ *
+ * The intermediate steps are expanded within this host, as long as the vertices reached are
+ * in the partitions it leads. The others are returned as the frontier, along with the
+ * number of steps left, to be stepped out from by their own hosts.
+ * The final step is the same as getNeighbors.
+ * */
+class TraverseProcessor : public QueryBoundProcessor {
+public:
+    static TraverseProcessor* instance(kvstore::KVStore* kvstore,
+                                       meta::SchemaManager* schemaMan,
+                                       folly::Executor* executor) {
+        return new TraverseProcessor(kvstore, schemaMan, executor);
+    }
+
+    void process(const cpp2::TraverseRequest& req);
+
+private:
+    using PartVertices = std::unordered_map<PartitionID, std::vector<VertexID>>;
+
+    /**
+     * The dst ids reached by the vertices of one bucket, and the parts failed.
+     * */
+    struct StepResult {
+        std::unordered_set<VertexID> dstIds_;
+        std::unordered_map<PartitionID, kvstore::ResultCode> failedParts_;
+    };
+
+    explicit TraverseProcessor(kvstore::KVStore* kvstore,
+                               meta::SchemaManager* schemaMan,
+                               folly::Executor* executor)
+        : QueryBoundProcessor(kvstore, schemaMan, executor, BoundType::OUT_BOUND) {}
+
+    /**
+     * Expand one intermediate step from the vertices in `parts', by the buckets in executor_,
+     * and go on with the next step once all of them are done. The final step is run
+     * by QueryBoundProcessor.
+     * */
+    void expandStep(int32_t steps, PartVertices parts);
+
+    /**
+     * Expand the vertices taken from the queue, starting from the bucket `bucketIndex'.
+     * The rest vertices of a part are skipped once one of its vertices failed.
+     * */
+    folly::Future<StepResult> asyncExpandBucket(std::shared_ptr<BucketQueue> queue,
+                                                size_t bucketIndex);
+
+    /**
+     * Collect the dst ids of one vertex, at most `limit_' of them if positive.
+     * */
+    kvstore::ResultCode collectDstIds(kvstore::KVScanner* scanner,
+                                      PartitionID partId,
+                                      VertexID vId,
+                                      std::unordered_set<VertexID>* dstIds);
+
+    // Same as the StorageClient
+    PartitionID partId(VertexID vId) const {
+        return static_cast<uint64_t>(vId) % partsNum_ + 1;
+    }
+
+    /**
+     * Whether the partition is led by this host.
+     * */
+    bool isLocal(PartitionID partId);
+
+private:
+    int32_t partsNum_ = 0;
+    EdgeType edgeType_ = 0;
+    int64_t limit_ = 0;
+    bool randomSample_ = false;
+    // The request of the final step, except its parts
+    cpp2::GetNeighborsRequest finalReq_;
+    // The vertices of the other hosts reached, keyed by the steps left
+    std::unordered_map<int32_t, std::vector<VertexID>> frontier_;
+    // The parts failed in any step, which are not stepped into any more
+    std::unordered_set<PartitionID> failedParts_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_TRAVERSEPROCESSOR_H_
@@ -10,6 +10,14 @@
 #define ID_HASH(id, numShards) \
     ((static_cast<uint64_t>(id)) % numShards + 1)
 
+DEFINE_string(storage_client_compression, "lz4",
+              "The compressions accepted for the large responses of storage, "
+              "in the order of preference, e.g. \"lz4,zstd\". Empty to disable it");
+DEFINE_int32(storage_client_overflow_retry_times, 3,
+             "How many times to send the parts again when their raft buffers are full");
+DEFINE_int32(storage_client_max_retry_after_ms, 1000,
+             "The longest time to wait before sending the parts again, in milliseconds");
+
 namespace nebula {
 namespace storage {
 
@@ -94,10 +102,12 @@ folly::SemiFuture<StorageRpcResponse<cpp2::ExecResponse>> StorageClient::addEdge
 folly::SemiFuture<StorageRpcResponse<cpp2::QueryResponse>> StorageClient::getNeighbors(
         GraphSpaceID space,
         std::vector<VertexID> vertices,
-        EdgeType edgeType,
+        std::vector<EdgeType> edgeTypes,
         bool isOutBound,
         std::string filter,
         std::vector<cpp2::PropDef> returnCols,
+        cpp2::EdgeLimit limit,
+        bool columnar,
         folly::EventBase* evb) {
     auto clusters = clusterIdsToHosts(
         space,
@@ -106,16 +116,32 @@ folly::SemiFuture<StorageRpcResponse<cpp2::QueryResponse>> StorageClient::getNei
             return v;
         });
 
+    DCHECK(!edgeTypes.empty());
+    // Make edge type a negative number when query in-bound
+    if (!isOutBound) {
+        for (auto& edgeType : edgeTypes) {
+            edgeType = -edgeType;
+        }
+    }
+    bool limited = limit.per_vertex > 0 || limit.total > 0;
     std::unordered_map<HostAddr, cpp2::GetNeighborsRequest> requests;
     for (auto& c : clusters) {
         auto& host = c.first;
         auto& req = requests[host];
         req.set_space_id(space);
         req.set_parts(std::move(c.second));
-        // Make edge type a negative number when query in-bound
-        req.set_edge_type(isOutBound ? edgeType : -edgeType);
+        if (edgeTypes.size() == 1) {
+            req.set_edge_type(edgeTypes.front());
+        } else {
+            req.set_edge_types(edgeTypes);
+        }
         req.set_filter(filter);
         req.set_return_columns(returnCols);
+        if (limited) {
+            req.set_edge_limit(limit);
+        }
+        req.set_columnar(columnar);
+        req.set_accept_compression(acceptCompression());
     }
 
     return collectResponse(
@@ -131,6 +157,51 @@ folly::SemiFuture<StorageRpcResponse<cpp2::QueryResponse>> StorageClient::getNei
 }
 
 
+folly::SemiFuture<StorageRpcResponse<cpp2::QueryResponse>> StorageClient::traverse(
+        GraphSpaceID space,
+        std::vector<VertexID> vertices,
+        EdgeType edgeType,
+        bool isOutBound,
+        int32_t steps,
+        std::string filter,
+        std::vector<cpp2::PropDef> returnCols,
+        cpp2::EdgeLimit limit,
+        folly::EventBase* evb) {
+    auto clusters = clusterIdsToHosts(
+        space,
+        vertices,
+        [] (const VertexID& v) {
+            return v;
+        });
+
+    auto partsNum = this->partsNum(space);
+    bool limited = limit.per_vertex > 0 || limit.total > 0;
+    std::unordered_map<HostAddr, cpp2::TraverseRequest> requests;
+    for (auto& c : clusters) {
+        auto& host = c.first;
+        auto& req = requests[host];
+        req.set_space_id(space);
+        req.set_parts(std::move(c.second));
+        // Make edge type a negative number when query in-bound
+        req.set_edge_type(isOutBound ? edgeType : -edgeType);
+        req.set_steps(steps);
+        req.set_parts_num(partsNum);
+        req.set_filter(filter);
+        req.set_return_columns(returnCols);
+        if (limited) {
+            req.set_edge_limit(limit);
+        }
+    }
+
+    return collectResponse(
+        evb, std::move(requests),
+        [](cpp2::StorageServiceAsyncClient* client,
+           const cpp2::TraverseRequest& r) {
+            return client->future_traverse(r);
+        });
+}
+
+
 folly::SemiFuture<StorageRpcResponse<cpp2::QueryStatsResponse>> StorageClient::neighborStats(
         GraphSpaceID space,
         std::vector<VertexID> vertices,
@@ -190,6 +261,7 @@ folly::SemiFuture<StorageRpcResponse<cpp2::QueryResponse>> StorageClient::getVer
         req.set_space_id(space);
         req.set_parts(std::move(c.second));
         req.set_return_columns(returnCols);
+        req.set_accept_compression(acceptCompression());
     }
 
     return collectResponse(
@@ -224,6 +296,7 @@ folly::SemiFuture<StorageRpcResponse<cpp2::EdgePropResponse>> StorageClient::get
         }
         req.set_parts(std::move(c.second));
         req.set_return_columns(returnCols);
+        req.set_accept_compression(acceptCompression());
     }
 
     return collectResponse(
@@ -235,6 +308,55 @@ folly::SemiFuture<StorageRpcResponse<cpp2::EdgePropResponse>> StorageClient::get
 }
 
 
+folly::SemiFuture<StorageRpcResponse<cpp2::DegreeResponse>> StorageClient::getDegrees(
+        GraphSpaceID space,
+        std::vector<VertexID> vertices,
+        std::vector<EdgeType> edgeTypes,
+        folly::EventBase* evb) {
+    auto clusters = clusterIdsToHosts(
+        space,
+        vertices,
+        [] (const VertexID& v) {
+            return v;
+        });
+
+    std::unordered_map<HostAddr, cpp2::DegreeRequest> requests;
+    for (auto& c : clusters) {
+        auto& host = c.first;
+        auto& req = requests[host];
+        req.set_space_id(space);
+        req.set_parts(std::move(c.second));
+        req.set_edge_types(edgeTypes);
+    }
+
+    return collectResponse(
+        evb, std::move(requests),
+        [](cpp2::StorageServiceAsyncClient* client,
+           const cpp2::DegreeRequest& r) {
+            return client->future_getDegrees(r);
+        });
+}
+
+
+// static
+std::vector<cpp2::CompressionType> StorageClient::acceptCompression() {
+    std::vector<std::string> names;
+    folly::split(",", FLAGS_storage_client_compression, names, true);
+    std::vector<cpp2::CompressionType> types;
+    for (auto& name : names) {
+        auto n = folly::trimWhitespace(name);
+        if (n == "lz4") {
+            types.emplace_back(cpp2::CompressionType::LZ4);
+        } else if (n == "zstd") {
+            types.emplace_back(cpp2::CompressionType::ZSTD);
+        } else {
+            LOG(WARNING) << "Unknown compression " << n;
+        }
+    }
+    return types;
+}
+
+
 PartitionID StorageClient::partId(GraphSpaceID spaceId, int64_t id) const {
     auto parts = partsNum(spaceId);
     auto s = ID_HASH(id, parts);
@@ -14,6 +14,10 @@
 #include "gen-cpp2/StorageServiceAsyncClient.h"
 #include "meta/client/MetaClient.h"
 #include "thrift/ThriftClientManager.h"
+#include "storage/PayloadCodec.h"
+
+DECLARE_int32(storage_client_overflow_retry_times);
+DECLARE_int32(storage_client_max_retry_after_ms);
 
 namespace nebula {
 namespace storage {
@@ -97,13 +101,38 @@ public:
         bool overwritable,
         folly::EventBase* evb = nullptr);
 
+    /**
+     * Going along several edge types at once if `edgeTypes' has more than one element,
+     * the edges are returned in blocks of each type, i.e. VertexData.edges.
+     * With `columnar' set and only one edge type, they are returned in QueryResponse.columnar
+     * instead of row by row.
+     */
     folly::SemiFuture<StorageRpcResponse<storage::cpp2::QueryResponse>> getNeighbors(
+        GraphSpaceID space,
+        std::vector<VertexID> vertices,
+        std::vector<EdgeType> edgeTypes,
+        bool isOutBound,
+        std::string filter,
+        std::vector<storage::cpp2::PropDef> returnCols,
+        storage::cpp2::EdgeLimit limit = storage::cpp2::EdgeLimit(),
+        bool columnar = false,
+        folly::EventBase* evb = nullptr);
+
+    /**
+     * Step out `steps' times along `edgeType', the intermediate steps are expanded by
+     * the storage hosts themselves. The vertices reached in partitions of other hosts
+     * are returned in QueryResponse.frontier, keyed by the steps left, which the caller
+     * should traverse from again.
+     */
+    folly::SemiFuture<StorageRpcResponse<storage::cpp2::QueryResponse>> traverse(
         GraphSpaceID space,
         std::vector<VertexID> vertices,
         EdgeType edgeType,
         bool isOutBound,
+        int32_t steps,
         std::string filter,
         std::vector<storage::cpp2::PropDef> returnCols,
+        storage::cpp2::EdgeLimit limit = storage::cpp2::EdgeLimit(),
         folly::EventBase* evb = nullptr);
 
     folly::SemiFuture<StorageRpcResponse<storage::cpp2::QueryStatsResponse>> neighborStats(
@@ -127,6 +156,17 @@ public:
         std::vector<storage::cpp2::PropDef> returnCols,
         folly::EventBase* evb = nullptr);
 
+    /**
+     * Get the degree of each vertex along each of `edgeTypes', out-degree for a positive type
+     * and in-degree for a negative one. They are counted by the storage hosts on write,
+     * so it costs no scan.
+     */
+    folly::SemiFuture<StorageRpcResponse<storage::cpp2::DegreeResponse>> getDegrees(
+        GraphSpaceID space,
+        std::vector<VertexID> vertices,
+        std::vector<EdgeType> edgeTypes,
+        folly::EventBase* evb = nullptr);
+
 protected:
     // Calculate the partition id for the given vertex id
     PartitionID partId(GraphSpaceID spaceId, int64_t id) const;
@@ -157,6 +197,25 @@ protected:
         }
     }
 
+    /**
+     * The compressions to accept for the responses, by FLAGS_storage_client_compression.
+     */
+    static std::vector<cpp2::CompressionType> acceptCompression();
+
+    static bool uncompress(cpp2::QueryResponse* resp) {
+        return PayloadCodec::uncompress(resp);
+    }
+
+    static bool uncompress(cpp2::EdgePropResponse* resp) {
+        return PayloadCodec::uncompress(resp);
+    }
+
+    // The other responses are never compressed
+    template<class Response>
+    static bool uncompress(Response*) {
+        return true;
+    }
+
     template<class Request,
              class RemoteFunc,
              class Response =
@@ -169,6 +228,16 @@ protected:
         std::unordered_map<HostAddr, Request> requests,
         RemoteFunc&& remoteFunc);
 
+    // Send the request kept in the context to the host, and send the parts whose raft
+    // buffers are full to it again after the time the host hints
+    template<class Context>
+    void sendRequest(folly::EventBase* evb,
+                     std::shared_ptr<Context> context,
+                     const HostAddr& host,
+                     GraphSpaceID spaceId,
+                     int32_t retry,
+                     bool failedBefore);
+
     // Cluster given ids into the host they belong to
     // The method returns a map
     //  host_addr (A host, but in most case, the leader will be chosen)
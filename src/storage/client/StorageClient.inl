@@ -11,9 +11,22 @@ namespace storage {
 
 namespace {
 
+// Only the writes go through the raft buffers, which could overflow
+template<class Request>
+struct IsWriteRequest : std::false_type {};
+
+template<>
+struct IsWriteRequest<cpp2::AddVerticesRequest> : std::true_type {};
+
+template<>
+struct IsWriteRequest<cpp2::AddEdgesRequest> : std::true_type {};
+
 template<class Request, class RemoteFunc, class Response>
 struct ResponseContext {
 public:
+    using RequestType = Request;
+    using ResponseType = Response;
+
     ResponseContext(size_t reqsSent, RemoteFunc&& remoteFunc)
         : resp(reqsSent)
         , serverMethod(std::move(remoteFunc)) {}
@@ -43,6 +56,21 @@ public:
         return it->second;
     }
 
+    // Keep only the given parts in the request to the host, for sending it again
+    void retainParts(HostAddr host, const std::unordered_set<PartitionID>& parts) {
+        std::lock_guard<std::mutex> g(lock_);
+        auto it = ongoingRequests_.find(host);
+        DCHECK(it != ongoingRequests_.end());
+        auto& reqParts = it->second.parts;
+        for (auto partIt = reqParts.begin(); partIt != reqParts.end();) {
+            if (parts.find(partIt->first) == parts.end()) {
+                partIt = reqParts.erase(partIt);
+            } else {
+                ++partIt;
+            }
+        }
+    }
+
     // Return true if processed all responses
     bool removeRequest(HostAddr host) {
         std::lock_guard<std::mutex> g(lock_);
@@ -89,73 +117,128 @@ folly::SemiFuture<StorageRpcResponse<Response>> StorageClient::collectResponse(
         auto spaceId = req.second.get_space_id();
         auto res = context->insertRequest(host, std::move(req.second));
         DCHECK(res.second);
-        // Invoke the remote method
-        folly::via(evb, [this, evb, context, host, spaceId, res] () mutable {
-            auto client = clientsMan_->client(host, evb);
-            // Result is a pair of <Request&, bool>
-            context->serverMethod(client.get(), *res.first)
-            // Future process code will be executed on the IO thread
-            // Since all requests are sent using the same eventbase, all then-callback
-            // will be executed on the same IO thread
-            .then(evb, [this, context, host, spaceId] (folly::Try<Response>&& val) {
-                auto& r = context->findRequest(host);
-                if (val.hasException()) {
-                    LOG(ERROR) << "Request to " << host << " failed: " << val.exception().what();
-                    for (auto& part : r.parts) {
-                        VLOG(3) << "Exception! Failed part " << part.first;
-                        context->resp.failedParts().emplace(
-                            part.first,
-                            storage::cpp2::ErrorCode::E_RPC_FAILURE);
-                        invalidLeader(spaceId, part.first);
-                    }
-                    context->resp.markFailure();
-                } else {
-                    auto resp = std::move(val.value());
-                    auto& result = resp.get_result();
-                    bool hasFailure{false};
-                    for (auto& code : result.get_failed_codes()) {
-                        VLOG(3) << "Failure! Failed part " << code.get_part_id()
-                                << ", failed code " << static_cast<int32_t>(code.get_code());
-                        hasFailure = true;
-                        if (code.get_code() == storage::cpp2::ErrorCode::E_LEADER_CHANGED) {
-                            auto* leader = code.get_leader();
-                            if (leader != nullptr
-                                    && leader->get_ip() != 0
-                                    && leader->get_port() != 0) {
-                                updateLeader(spaceId,
-                                             code.get_part_id(),
-                                             HostAddr(leader->get_ip(), leader->get_port()));
-                            }
-                        } else {
-                            // Simply keep the result
-                            context->resp.failedParts().emplace(code.get_part_id(),
-                                                                code.get_code());
+        sendRequest(evb, context, host, spaceId, 0, false);
+    }  // for
+    if (context->finishSending()) {
+        // Received all responses, most likely, all rpc failed
+        context->promise.setValue(std::move(context->resp));
+    }
+
+    return context->promise.getSemiFuture();
+}
+
+
+template<class Context>
+void StorageClient::sendRequest(folly::EventBase* evb,
+                                std::shared_ptr<Context> context,
+                                const HostAddr& host,
+                                GraphSpaceID spaceId,
+                                int32_t retry,
+                                bool failedBefore) {
+    using Request = typename Context::RequestType;
+    using Response = typename Context::ResponseType;
+    // Invoke the remote method
+    folly::via(evb, [this, evb, context, host, spaceId, retry, failedBefore] () mutable {
+        auto client = clientsMan_->client(host, evb);
+        context->serverMethod(client.get(), context->findRequest(host))
+        // Future process code will be executed on the IO thread
+        // Since all requests are sent using the same eventbase, all then-callback
+        // will be executed on the same IO thread
+        .then(evb, [this, evb, context, host, spaceId, retry, failedBefore]
+                   (folly::Try<Response>&& val) {
+            auto& r = context->findRequest(host);
+            if (val.hasValue() && !uncompress(&val.value())) {
+                val = folly::Try<Response>(folly::make_exception_wrapper<std::runtime_error>(
+                    "Uncompress the response failed"));
+            }
+            if (val.hasException()) {
+                LOG(ERROR) << "Request to " << host << " failed: " << val.exception().what();
+                for (auto& part : r.parts) {
+                    VLOG(3) << "Exception! Failed part " << part.first;
+                    context->resp.failedParts().emplace(
+                        part.first,
+                        storage::cpp2::ErrorCode::E_RPC_FAILURE);
+                    invalidLeader(spaceId, part.first);
+                }
+                context->resp.markFailure();
+            } else {
+                auto resp = std::move(val.value());
+                auto& result = resp.get_result();
+                bool hasFailure = failedBefore;
+                // The parts whose raft buffers are full, and the time to wait before
+                // sending them again
+                std::unordered_set<PartitionID> overflowParts;
+                int32_t retryAfterMs = 0;
+                for (auto& code : result.get_failed_codes()) {
+                    VLOG(3) << "Failure! Failed part " << code.get_part_id()
+                            << ", failed code " << static_cast<int32_t>(code.get_code());
+                    if (IsWriteRequest<Request>::value
+                            && code.get_code() == storage::cpp2::ErrorCode::E_BUFFER_OVERFLOW
+                            && retry < FLAGS_storage_client_overflow_retry_times) {
+                        overflowParts.emplace(code.get_part_id());
+                        auto* after = code.get_retry_after_ms();
+                        if (after != nullptr && *after > retryAfterMs) {
+                            retryAfterMs = *after;
                         }
+                        continue;
                     }
-                    if (hasFailure) {
-                        context->resp.markFailure();
+                    hasFailure = true;
+                    if (code.get_code() == storage::cpp2::ErrorCode::E_LEADER_CHANGED) {
+                        auto* leader = code.get_leader();
+                        if (leader != nullptr
+                                && leader->get_ip() != 0
+                                && leader->get_port() != 0) {
+                            updateLeader(spaceId,
+                                         code.get_part_id(),
+                                         HostAddr(leader->get_ip(), leader->get_port()));
+                        }
+                    } else {
+                        // Simply keep the result
+                        context->resp.failedParts().emplace(code.get_part_id(),
+                                                            code.get_code());
                     }
+                }
 
-                    // Adjust the latency
-                    context->resp.setLatency(result.get_latency_in_us());
-
-                    // Keep the response
+                // Adjust the latency
+                context->resp.setLatency(result.get_latency_in_us());
+
+                if (!overflowParts.empty()) {
+                    // Keep the results of the other parts, the parts overflowed
+                    // report theirs when they are sent again
+                    auto& codes = resp.result.failed_codes;
+                    codes.erase(std::remove_if(codes.begin(), codes.end(),
+                                               [&overflowParts] (const auto& code) {
+                                    return overflowParts.count(code.get_part_id()) > 0;
+                                }),
+                                codes.end());
                     context->resp.responses().emplace_back(std::move(resp));
+                    // Back off, then send the parts overflowed to the host again in one
+                    // request, the failures so far are counted after the last retry
+                    VLOG(1) << "The buffers of " << overflowParts.size() << " parts on "
+                            << host << " are full, retry after " << retryAfterMs << "ms";
+                    context->retainParts(host, overflowParts);
+                    evb->runAfterDelay(
+                        [this, evb, context, host, spaceId, retry, hasFailure] () {
+                            sendRequest(evb, context, host, spaceId, retry + 1, hasFailure);
+                        },
+                        std::min(retryAfterMs, FLAGS_storage_client_max_retry_after_ms));
+                    return;
                 }
 
-                if (context->removeRequest(host)) {
-                    // Received all responses
-                    context->promise.setValue(std::move(context->resp));
+                if (hasFailure) {
+                    context->resp.markFailure();
                 }
-            });
-        });  // via
-    }  // for
-    if (context->finishSending()) {
-        // Received all responses, most likely, all rpc failed
-        context->promise.setValue(std::move(context->resp));
-    }
 
-    return context->promise.getSemiFuture();
+                // Keep the response
+                context->resp.responses().emplace_back(std::move(resp));
+            }
+
+            if (context->removeRequest(host)) {
+                // Received all responses
+                context->promise.setValue(std::move(context->resp));
+            }
+        });
+    });  // via
 }
 
 }   // namespace storage
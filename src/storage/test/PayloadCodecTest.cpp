@@ -0,0 +1,100 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include <gtest/gtest.h>
+#include "storage/PayloadCodec.h"
+
+namespace nebula {
+namespace storage {
+
+cpp2::QueryResponse mockResponse(int32_t vertexNum) {
+    cpp2::QueryResponse resp;
+    cpp2::ResultCode code;
+    code.set_code(cpp2::ErrorCode::E_LEADER_CHANGED);
+    code.set_part_id(3);
+    resp.result.failed_codes.emplace_back(std::move(code));
+    resp.result.set_latency_in_us(100);
+    std::vector<cpp2::VertexData> vertices;
+    for (int32_t i = 0; i < vertexNum; i++) {
+        cpp2::VertexData vdata;
+        vdata.set_vertex_id(i);
+        vdata.set_edge_data(folly::stringPrintf("edge_data_of_vertex_%d", i % 10));
+        vertices.emplace_back(std::move(vdata));
+    }
+    resp.set_vertices(std::move(vertices));
+    return resp;
+}
+
+TEST(PayloadCodecTest, NegotiateTest) {
+    EXPECT_EQ(cpp2::CompressionType::NONE, PayloadCodec::negotiate({}));
+    EXPECT_EQ(cpp2::CompressionType::NONE,
+              PayloadCodec::negotiate({cpp2::CompressionType::NONE}));
+    auto type = PayloadCodec::negotiate({cpp2::CompressionType::LZ4,
+                                         cpp2::CompressionType::ZSTD});
+    EXPECT_NE(cpp2::CompressionType::NONE, type);
+}
+
+TEST(PayloadCodecTest, CompressTest) {
+    for (auto type : {cpp2::CompressionType::LZ4, cpp2::CompressionType::ZSTD}) {
+        if (PayloadCodec::negotiate({type}) != type) {
+            LOG(INFO) << "Compression " << static_cast<int32_t>(type) << " is not built in";
+            continue;
+        }
+        {
+            // Too small to compress
+            auto resp = mockResponse(2);
+            EXPECT_EQ(0, PayloadCodec::compress(type, 4096, &resp));
+            EXPECT_FALSE(resp.__isset.compressed);
+            EXPECT_EQ(2, resp.vertices.size());
+            EXPECT_EQ(1, resp.result.failed_codes.size());
+            EXPECT_TRUE(PayloadCodec::uncompress(&resp));
+            EXPECT_EQ(2, resp.vertices.size());
+        }
+        {
+            auto resp = mockResponse(1000);
+            auto rawSize = PayloadCodec::compress(type, 4096, &resp);
+            EXPECT_LT(4096UL, rawSize);
+            ASSERT_TRUE(resp.__isset.compressed);
+            EXPECT_EQ(type, resp.compressed.get_type());
+            EXPECT_EQ(rawSize, static_cast<size_t>(resp.compressed.get_raw_size()));
+            EXPECT_GT(rawSize, resp.compressed.get_data().size());
+            EXPECT_TRUE(resp.vertices.empty());
+            // The result is left as it is
+            ASSERT_EQ(1, resp.result.failed_codes.size());
+            EXPECT_EQ(3, resp.result.failed_codes[0].get_part_id());
+
+            ASSERT_TRUE(PayloadCodec::uncompress(&resp));
+            EXPECT_FALSE(resp.__isset.compressed);
+            EXPECT_EQ(1, resp.result.failed_codes.size());
+            EXPECT_EQ(100, resp.result.get_latency_in_us());
+            ASSERT_EQ(1000, resp.vertices.size());
+            for (int32_t i = 0; i < 1000; i++) {
+                EXPECT_EQ(i, resp.vertices[i].get_vertex_id());
+                EXPECT_EQ(folly::stringPrintf("edge_data_of_vertex_%d", i % 10),
+                          resp.vertices[i].get_edge_data());
+            }
+        }
+        {
+            // The payload corrupts
+            auto resp = mockResponse(1000);
+            ASSERT_LT(0UL, PayloadCodec::compress(type, 4096, &resp));
+            resp.compressed.data.resize(resp.compressed.data.size() / 2);
+            EXPECT_FALSE(PayloadCodec::uncompress(&resp));
+        }
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
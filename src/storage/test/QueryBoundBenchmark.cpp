@@ -22,6 +22,8 @@
 DEFINE_int32(req_parts, 3, "parts requested");
 DEFINE_int32(vrpp, 100, "vertices requested per part");
 DEFINE_int32(handler_num, 10, "The Executor's handler number");
+DEFINE_int32(supernodes, 5, "The number of supernodes in part 0, for the skewed benchmarks");
+DEFINE_int32(supernode_degree, 5000, "The out-degree of each supernode");
 DECLARE_int32(max_handlers_per_req);
 
 std::unique_ptr<nebula::kvstore::KVStore> gKV;
@@ -84,19 +86,54 @@ void mockData(kvstore::KVStore* kv) {
     }
 }
 
+/**
+ * The edges of type 102 are skewed, the first few vertices of part 0 are supernodes,
+ * and each of the others has 7 out-edges, just like type 101.
+ * */
+void mockSkewedData(kvstore::KVStore* kv) {
+    for (auto partId = 0; partId < 6; partId++) {
+        std::vector<kvstore::KV> data;
+        for (auto vertexId = 1; vertexId < 1000; vertexId++) {
+            auto degree = partId == 0 && vertexId <= FLAGS_supernodes
+                            ? FLAGS_supernode_degree : 7;
+            for (auto dstId = 10001; dstId < 10001 + degree; dstId++) {
+                auto key = NebulaKeyUtils::edgeKey(partId, vertexId, 102,
+                                                   0, dstId,
+                                                   std::numeric_limits<int>::max());
+                RowWriter writer(nullptr);
+                for (uint64_t numInt = 0; numInt < 10; numInt++) {
+                    writer << numInt;
+                }
+                for (auto numString = 10; numString < 20; numString++) {
+                    writer << folly::stringPrintf("string_col_%d", numString);
+                }
+                data.emplace_back(std::move(key), writer.encode());
+            }
+        }
+        kv->asyncMultiPut(
+            0, partId, std::move(data),
+            [&](kvstore::ResultCode code) {
+                CHECK_EQ(code, kvstore::ResultCode::SUCCEEDED);
+            });
+    }
+}
+
 void setUp(const char* path) {
     gKV = TestUtils::initKV(path);
     schema.reset(new storage::AdHocSchemaManager());
     schema->addEdgeSchema(
         0 /*space id*/, 101 /*edge type*/, TestUtils::genEdgeSchemaProvider(10, 10));
+    schema->addEdgeSchema(
+        0 /*space id*/, 102 /*edge type*/, TestUtils::genEdgeSchemaProvider(10, 10));
     for (auto tagId = 3001; tagId < 3010; tagId++) {
         schema->addTagSchema(
             0 /*space id*/, tagId, TestUtils::genTagSchemaProvider(tagId, 3, 3));
     }
     mockData(gKV.get());
+    mockSkewedData(gKV.get());
 }
 
-cpp2::GetNeighborsRequest buildRequest(bool outBound = true) {
+cpp2::GetNeighborsRequest buildRequest(bool outBound = true, EdgeType edgeType = 101) {
     cpp2::GetNeighborsRequest req;
     req.set_space_id(0);
     decltype(req.parts) tmpIds;
@@ -106,7 +143,7 @@ cpp2::GetNeighborsRequest buildRequest(bool outBound = true) {
         }
     }
     req.set_parts(std::move(tmpIds));
-    req.set_edge_type(outBound ? 101 : -101);
+    req.set_edge_type(outBound ? edgeType : -edgeType);
     // Return tag props col_0, col_2, col_4
     decltype(req.return_columns) tmpColumns;
     for (int i = 0; i < 3; i++) {
@@ -129,14 +166,34 @@ cpp2::GetNeighborsRequest buildRequest(bool outBound = true) {
     return req;
 }
 
+std::string buildFilter() {
+    // $^.3001.tag_3001_col_0 >= 0 && e101.col_0 >= 0, which keeps all edges
+    auto* srcExp = new SourcePropertyExpression(new std::string("3001"),
+                                                new std::string("tag_3001_col_0"));
+    auto* left = new RelationalExpression(srcExp,
+                                          RelationalExpression::Operator::GE,
+                                          new PrimaryExpression(0L));
+    auto* edgeExp = new AliasPropertyExpression(new std::string(""),
+                                                new std::string("e101"),
+                                                new std::string("col_0"));
+    auto* right = new RelationalExpression(edgeExp,
+                                           RelationalExpression::Operator::GE,
+                                           new PrimaryExpression(0L));
+    auto logExp = std::make_unique<LogicalExpression>(left, LogicalExpression::AND, right);
+    return Expression::encode(logExp.get());
+}
+
 }  // namespace storage
 }  // namespace nebula
 
-void run(int32_t iters, int32_t handlerNum) {
+void run(int32_t iters, int32_t handlerNum, bool withFilter = false, bool skewed = false) {
     FLAGS_max_handlers_per_req = handlerNum;
     nebula::storage::cpp2::GetNeighborsRequest req;
     BENCHMARK_SUSPEND {
-        req = nebula::storage::buildRequest();
+        req = nebula::storage::buildRequest(true, skewed ? 102 : 101);
+        if (withFilter) {
+            req.set_filter(nebula::storage::buildFilter());
+        }
     }
     auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(FLAGS_handler_num);
     for (decltype(iters) i = 0; i < iters; i++) {
@@ -163,6 +220,30 @@ BENCHMARK(query_bound_3, iters) {
 BENCHMARK(query_bound_10, iters) {
     run(iters, 10);
 }
+
+BENCHMARK(query_bound_with_filter_1, iters) {
+    run(iters, 1, true);
+}
+
+BENCHMARK(query_bound_with_filter_3, iters) {
+    run(iters, 3, true);
+}
+
+BENCHMARK(query_bound_with_filter_10, iters) {
+    run(iters, 10, true);
+}
+
+BENCHMARK(query_bound_skewed_1, iters) {
+    run(iters, 1, false, true);
+}
+
+BENCHMARK(query_bound_skewed_3, iters) {
+    run(iters, 3, false, true);
+}
+
+BENCHMARK(query_bound_skewed_10, iters) {
+    run(iters, 10, false, true);
+}
 /*************************
  * End of benchmarks
  ************************/
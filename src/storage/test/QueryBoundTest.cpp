@@ -14,9 +14,11 @@
 #include "storage/QueryBoundProcessor.h"
 #include "dataman/RowSetReader.h"
 #include "dataman/RowReader.h"
+#include "dataman/ColumnReader.h"
 
 DECLARE_int32(max_handlers_per_req);
 DECLARE_int32(min_vertices_per_bucket);
+DECLARE_int32(edges_per_split);
 
 namespace nebula {
 namespace storage {
@@ -257,6 +259,38 @@ TEST(QueryBoundTest, FilterTest_OnlyEdgeFilter) {
     checkResponse(resp, 30, 12, 10007, 1, true);
 }
 
+TEST(QueryBoundTest, FilterTest_EdgeKeyFilter) {
+    fs::TempDir rootPath("/tmp/QueryBoundTest.XXXXXX");
+    LOG(INFO) << "Prepare meta...";
+    std::unique_ptr<kvstore::KVStore> kv(TestUtils::initKV(rootPath.path()));
+    auto schemaMan = TestUtils::mockSchemaMan();
+    mockData(kv.get());
+
+    LOG(INFO) << "Build filter...";
+    auto* alias = new std::string("e101");
+    auto* dstExp = new EdgeDstIdExpression(alias);
+    auto* priExp = new PrimaryExpression(10007L);
+    auto relExp = std::make_unique<RelationalExpression>(dstExp,
+                                                         RelationalExpression::Operator::GE,
+                                                         priExp);
+    cpp2::GetNeighborsRequest req;
+    buildRequest(req);
+    req.set_filter(Expression::encode(relExp.get()));
+
+    LOG(INFO) << "Test QueryOutBoundRequest...";
+    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(3);
+    auto* processor = QueryBoundProcessor::instance(kv.get(),
+                                                    schemaMan.get(),
+                                                    executor.get(),
+                                                    BoundType::OUT_BOUND);
+    auto f = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(f).get();
+
+    LOG(INFO) << "Check the results...";
+    checkResponse(resp, 30, 12, 10007, 1, true);
+}
+
 TEST(QueryBoundTest, FilterTest_OnlyTagFilter) {
     fs::TempDir rootPath("/tmp/QueryBoundTest.XXXXXX");
     LOG(INFO) << "Prepare meta...";
@@ -342,6 +376,56 @@ TEST(QueryBoundTest,  GenBucketsTest) {
     }
 }
 
+TEST(QueryBoundTest, BucketQueueTest) {
+    cpp2::GetNeighborsRequest req;
+    buildRequest(req);
+    FLAGS_max_handlers_per_req = 3;
+    FLAGS_min_vertices_per_bucket = 1;
+    QueryBoundProcessor pro(nullptr, nullptr, nullptr, BoundType::OUT_BOUND);
+    auto buckets = pro.genBuckets(req);
+    ASSERT_EQ(3, buckets.size());
+    auto firstOfBucket2 = buckets[2].vertices_[0];
+    {
+        BucketQueue queue(buckets);
+        // The handler of bucket 2 takes its own vertices first, then the ones of the others
+        std::vector<std::pair<PartitionID, VertexID>> taken;
+        while (auto* pv = queue.take(2)) {
+            taken.emplace_back(*pv);
+        }
+        ASSERT_EQ(30, taken.size());
+        EXPECT_EQ(firstOfBucket2, taken[0]);
+        EXPECT_EQ(buckets[2].vertices_.back(), taken[9]);
+        EXPECT_EQ(buckets[0].vertices_[0], taken[10]);
+        EXPECT_EQ(nullptr, queue.take(0));
+        EXPECT_EQ(nullptr, queue.take(1));
+    }
+    {
+        // Every vertex is taken exactly once among the threads
+        BucketQueue queue(buckets);
+        std::vector<std::vector<std::pair<PartitionID, VertexID>>> taken(3);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < 3; i++) {
+            threads.emplace_back([&, i] {
+                while (auto* pv = queue.take(i)) {
+                    taken[i].emplace_back(*pv);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        std::set<std::pair<PartitionID, VertexID>> all;
+        size_t total = 0;
+        for (auto& t : taken) {
+            all.insert(t.begin(), t.end());
+            total += t.size();
+        }
+        EXPECT_EQ(30, total);
+        EXPECT_EQ(30, all.size());
+    }
+}
+
+
 TEST(QueryBoundTest, FilterTest_TagAndEdgeFilter) {
     fs::TempDir rootPath("/tmp/QueryBoundTest.XXXXXX");
     LOG(INFO) << "Prepare meta...";
@@ -384,6 +468,52 @@ TEST(QueryBoundTest, FilterTest_TagAndEdgeFilter) {
     checkResponse(resp, 10, 12, 10007, 1, true);
 }
 
+TEST(QueryBoundTest, SupernodeSplitTest) {
+    fs::TempDir rootPath("/tmp/QueryBoundTest.XXXXXX");
+    LOG(INFO) << "Prepare meta...";
+    std::unique_ptr<kvstore::KVStore> kv(TestUtils::initKV(rootPath.path()));
+    auto schemaMan = TestUtils::mockSchemaMan();
+    mockData(kv.get());
+    // The 7 edges of each vertex are scanned as 2 edges, then the batches of 2, 2 and 1 edges
+    auto edgesPerSplit = FLAGS_edges_per_split;
+    FLAGS_edges_per_split = 2;
+    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(3);
+    {
+        LOG(INFO) << "Test without filter...";
+        cpp2::GetNeighborsRequest req;
+        buildRequest(req);
+        auto* processor = QueryBoundProcessor::instance(kv.get(), schemaMan.get(), executor.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        checkResponse(resp, 30, 12, 10001, 7, true);
+    }
+    {
+        LOG(INFO) << "Test with the tag and edge filter...";
+        auto* srcExp = new SourcePropertyExpression(new std::string("3001"),
+                                                    new std::string("tag_3001_col_0"));
+        auto* left = new RelationalExpression(srcExp,
+                                              RelationalExpression::Operator::GE,
+                                              new PrimaryExpression(20 + 3001L));
+        auto* edgeExp = new AliasPropertyExpression(new std::string(""),
+                                                    new std::string("e101"),
+                                                    new std::string("col_0"));
+        auto* right = new RelationalExpression(edgeExp,
+                                               RelationalExpression::Operator::GE,
+                                               new PrimaryExpression(10003L));
+        auto logExp = std::make_unique<LogicalExpression>(left, LogicalExpression::AND, right);
+        cpp2::GetNeighborsRequest req;
+        buildRequest(req);
+        req.set_filter(Expression::encode(logExp.get()));
+        auto* processor = QueryBoundProcessor::instance(kv.get(), schemaMan.get(), executor.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        checkResponse(resp, 10, 12, 10003, 5, true);
+    }
+    FLAGS_edges_per_split = edgesPerSplit;
+}
+
 TEST(QueryBoundTest, FilterTest_InvalidFilter) {
     fs::TempDir rootPath("/tmp/QueryBoundTest.XXXXXX");
     LOG(INFO) << "Prepare meta...";
@@ -414,6 +544,320 @@ TEST(QueryBoundTest, FilterTest_InvalidFilter) {
     EXPECT_TRUE(nebula::storage::cpp2::ErrorCode::E_INVALID_FILTER
                     == resp.result.failed_codes[0].code);
 }
+
+TEST(QueryBoundTest, EdgeLimitTest) {
+    fs::TempDir rootPath("/tmp/QueryBoundTest.XXXXXX");
+    LOG(INFO) << "Prepare meta...";
+    std::unique_ptr<kvstore::KVStore> kv(TestUtils::initKV(rootPath.path()));
+    auto schemaMan = TestUtils::mockSchemaMan();
+    mockData(kv.get());
+    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(3);
+    {
+        LOG(INFO) << "Take the first 3 edges of each vertex...";
+        cpp2::GetNeighborsRequest req;
+        buildRequest(req);
+        cpp2::EdgeLimit limit;
+        limit.set_per_vertex(3);
+        req.set_edge_limit(limit);
+
+        auto* processor = QueryBoundProcessor::instance(kv.get(), schemaMan.get(),
+                                                        executor.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        checkResponse(resp, 30, 12, 10001, 3, true);
+    }
+    {
+        LOG(INFO) << "Sample 3 edges of each vertex...";
+        cpp2::GetNeighborsRequest req;
+        buildRequest(req);
+        cpp2::EdgeLimit limit;
+        limit.set_per_vertex(3);
+        limit.set_random_sample(true);
+        req.set_edge_limit(limit);
+
+        auto* processor = QueryBoundProcessor::instance(kv.get(), schemaMan.get(),
+                                                        executor.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        EXPECT_EQ(0, resp.result.failed_codes.size());
+        EXPECT_EQ(30, resp.vertices.size());
+        auto provider = std::make_shared<ResultSchemaProvider>(resp.edge_schema);
+        for (auto& vp : resp.vertices) {
+            RowSetReader rsReader(provider, vp.edge_data);
+            std::unordered_set<int64_t> dstIds;
+            for (auto it = rsReader.begin(); it != rsReader.end(); ++it) {
+                int64_t dstId;
+                EXPECT_EQ(ResultType::SUCCEEDED, it->getInt<int64_t>(0, dstId));
+                EXPECT_LE(10001, dstId);
+                EXPECT_GE(10007, dstId);
+                // The props should be read from the latest version
+                int64_t col0;
+                EXPECT_EQ(ResultType::SUCCEEDED, it->getInt<int64_t>(2, col0));
+                EXPECT_EQ(dstId, col0);
+                dstIds.emplace(dstId);
+            }
+            EXPECT_EQ(3, dstIds.size());
+        }
+    }
+    {
+        LOG(INFO) << "Take 10 edges in total...";
+        cpp2::GetNeighborsRequest req;
+        buildRequest(req);
+        cpp2::EdgeLimit limit;
+        limit.set_total(10);
+        req.set_edge_limit(limit);
+
+        auto* processor = QueryBoundProcessor::instance(kv.get(), schemaMan.get(),
+                                                        executor.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        EXPECT_EQ(0, resp.result.failed_codes.size());
+        EXPECT_EQ(30, resp.vertices.size());
+        auto provider = std::make_shared<ResultSchemaProvider>(resp.edge_schema);
+        int32_t edgeNum = 0;
+        for (auto& vp : resp.vertices) {
+            RowSetReader rsReader(provider, vp.edge_data);
+            for (auto it = rsReader.begin(); it != rsReader.end(); ++it) {
+                edgeNum++;
+            }
+        }
+        EXPECT_EQ(10, edgeNum);
+    }
+}
+
+
+TEST(QueryBoundTest, MultiEdgeTypesTest) {
+    fs::TempDir rootPath("/tmp/QueryBoundTest.XXXXXX");
+    LOG(INFO) << "Prepare meta...";
+    std::unique_ptr<kvstore::KVStore> kv(TestUtils::initKV(rootPath.path()));
+    auto schemaMan = TestUtils::mockSchemaMan();
+    static_cast<AdHocSchemaManager*>(schemaMan.get())->addEdgeSchema(
+        0 /*space id*/, 102 /*edge type*/, TestUtils::genEdgeSchemaProvider(5, 5));
+    mockData(kv.get());
+    {
+        LOG(INFO) << "Write 3 edges of type 102 for the vertices in part 0...";
+        std::vector<kvstore::KV> data;
+        for (auto vertexId = 0; vertexId < 10; vertexId++) {
+            for (auto dstId = 30001; dstId <= 30003; dstId++) {
+                auto key = NebulaKeyUtils::edgeKey(0, vertexId, 102, 0, dstId, 0);
+                RowWriter writer(nullptr);
+                for (uint64_t numInt = 0; numInt < 5; numInt++) {
+                    writer << (dstId + numInt);
+                }
+                for (auto numString = 5; numString < 10; numString++) {
+                    writer << folly::stringPrintf("string_col_%d", numString);
+                }
+                data.emplace_back(std::move(key), writer.encode());
+            }
+        }
+        folly::Baton<true, std::atomic> baton;
+        kv->asyncMultiPut(0, 0, std::move(data), [&](kvstore::ResultCode code) {
+            EXPECT_EQ(code, kvstore::ResultCode::SUCCEEDED);
+            baton.post();
+        });
+        baton.wait();
+    }
+
+    cpp2::GetNeighborsRequest req;
+    buildRequest(req);
+    req.set_edge_types(std::vector<EdgeType>{101, 102});
+    decltype(req.return_columns) tmpColumns;
+    tmpColumns.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "_dst"));
+    tmpColumns.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "col_0"));
+    tmpColumns.back().set_edge_type(101);
+    tmpColumns.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "col_1"));
+    tmpColumns.back().set_edge_type(102);
+    req.set_return_columns(std::move(tmpColumns));
+
+    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(3);
+    auto* processor = QueryBoundProcessor::instance(kv.get(), schemaMan.get(), executor.get());
+    auto f = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(f).get();
+
+    LOG(INFO) << "Check the results...";
+    EXPECT_EQ(0, resp.result.failed_codes.size());
+    ASSERT_TRUE(resp.__isset.edge_schemas);
+    ASSERT_EQ(2, resp.edge_schemas.size());
+    std::unordered_map<EdgeType, std::shared_ptr<ResultSchemaProvider>> providers;
+    for (auto& schema : resp.edge_schemas) {
+        ASSERT_EQ(2, schema.second.columns.size());
+        EXPECT_EQ("_dst", schema.second.columns[0].name);
+        EXPECT_EQ(schema.first == 101 ? "col_0" : "col_1", schema.second.columns[1].name);
+        providers.emplace(schema.first, std::make_shared<ResultSchemaProvider>(schema.second));
+    }
+    EXPECT_EQ(30, resp.vertices.size());
+    for (auto& vp : resp.vertices) {
+        EXPECT_TRUE(vp.edge_data.empty());
+        EXPECT_EQ(vp.vertex_id < 10 ? 2 : 1, vp.edges.size());
+        for (auto& edata : vp.edges) {
+            RowSetReader rsReader(providers[edata.type], edata.data);
+            int32_t rowNum = 0;
+            for (auto it = rsReader.begin(); it != rsReader.end(); ++it) {
+                int64_t dstId;
+                EXPECT_EQ(ResultType::SUCCEEDED, it->getInt<int64_t>(0, dstId));
+                int64_t v;
+                EXPECT_EQ(ResultType::SUCCEEDED, it->getInt<int64_t>(1, v));
+                if (edata.type == 101) {
+                    EXPECT_EQ(10001 + rowNum, dstId);
+                    EXPECT_EQ(dstId, v);
+                } else {
+                    EXPECT_EQ(30001 + rowNum, dstId);
+                    EXPECT_EQ(dstId + 1, v);
+                }
+                rowNum++;
+            }
+            EXPECT_EQ(edata.type == 101 ? 7 : 3, rowNum);
+        }
+    }
+}
+
+TEST(QueryBoundTest, RawEdgePropsTest) {
+    fs::TempDir rootPath("/tmp/QueryBoundTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv(TestUtils::initKV(rootPath.path()));
+    auto schemaMan = TestUtils::mockSchemaMan();
+    mockData(kv.get());
+    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(3);
+
+    // The props in key followed by the first 10 fields, all the 20 fields with a block offset,
+    // and the first 17 fields of them.
+    std::vector<std::pair<int32_t, int32_t>> cases = {{2, 10}, {0, 20}, {0, 17}};
+    for (auto& c : cases) {
+        auto keyProps = c.first;
+        auto fields = c.second;
+        LOG(INFO) << "Return " << keyProps << " props in key and " << fields << " fields";
+        cpp2::GetNeighborsRequest req;
+        buildRequest(req);
+        decltype(req.return_columns) cols;
+        if (keyProps > 0) {
+            cols.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "_dst"));
+            cols.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "_rank"));
+        }
+        for (int i = 0; i < fields; i++) {
+            cols.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE,
+                                                 folly::stringPrintf("col_%d", i)));
+        }
+        req.set_return_columns(std::move(cols));
+
+        auto* processor = QueryBoundProcessor::instance(kv.get(), schemaMan.get(),
+                                                        executor.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+
+        EXPECT_EQ(0, resp.result.failed_codes.size());
+        ASSERT_EQ(keyProps + fields, resp.edge_schema.columns.size());
+        EXPECT_EQ(30, resp.vertices.size());
+        auto provider = std::make_shared<ResultSchemaProvider>(resp.edge_schema);
+        for (auto& vp : resp.vertices) {
+            RowSetReader rsReader(provider, vp.edge_data);
+            int64_t dstId = 10001;
+            for (auto it = rsReader.begin(); it != rsReader.end(); ++it, ++dstId) {
+                if (keyProps > 0) {
+                    int64_t v;
+                    EXPECT_EQ(ResultType::SUCCEEDED, it->getInt<int64_t>("_dst", v));
+                    EXPECT_EQ(dstId, v);
+                    EXPECT_EQ(ResultType::SUCCEEDED, it->getInt<int64_t>("_rank", v));
+                    EXPECT_EQ(0, v);
+                }
+                for (int i = 0; i < fields; i++) {
+                    auto name = folly::stringPrintf("col_%d", i);
+                    if (i < 10) {
+                        int64_t v;
+                        EXPECT_EQ(ResultType::SUCCEEDED, it->getInt<int64_t>(name, v));
+                        EXPECT_EQ(dstId + i, v);
+                    } else {
+                        folly::StringPiece v;
+                        EXPECT_EQ(ResultType::SUCCEEDED, it->getString(name, v));
+                        EXPECT_EQ(folly::stringPrintf("string_col_%d_%d", i, 2), v);
+                    }
+                }
+            }
+            EXPECT_EQ(10008, dstId);
+        }
+    }
+}
+
+
+TEST(QueryBoundTest, ColumnarTest) {
+    fs::TempDir rootPath("/tmp/QueryBoundTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv(TestUtils::initKV(rootPath.path()));
+    auto schemaMan = TestUtils::mockSchemaMan();
+    mockData(kv.get());
+
+    cpp2::GetNeighborsRequest req;
+    buildRequest(req);
+    req.set_columnar(true);
+
+    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(3);
+    auto* processor = QueryBoundProcessor::instance(kv.get(), schemaMan.get(), executor.get());
+    auto f = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(f).get();
+
+    EXPECT_EQ(0, resp.result.failed_codes.size());
+    EXPECT_EQ(0, resp.vertices.size());
+    ASSERT_TRUE(resp.__isset.columnar);
+    auto& data = resp.columnar;
+    ASSERT_EQ(3, resp.vertex_schema.columns.size());
+    ASSERT_EQ(12, resp.edge_schema.columns.size());
+    ASSERT_EQ(3, data.vertex_columns.size());
+    ASSERT_EQ(12, data.edge_columns.size());
+    ASSERT_EQ(30, data.vertex_ids.size());
+    ASSERT_EQ(31, data.edge_offsets.size());
+
+    auto getReader = [] (const nebula::cpp2::ColumnDef& col, const cpp2::ColumnData& d) {
+        auto reader = ColumnReader::getColumnReader(col.get_type().get_type(),
+                                                    d.get_values(),
+                                                    d.get_offsets());
+        CHECK(reader != nullptr);
+        return reader;
+    };
+    std::vector<std::unique_ptr<ColumnReader>> vertexCols;
+    for (size_t i = 0; i < data.vertex_columns.size(); i++) {
+        vertexCols.emplace_back(getReader(resp.vertex_schema.columns[i],
+                                          data.vertex_columns[i]));
+        EXPECT_EQ(30, vertexCols.back()->size());
+    }
+    std::vector<std::unique_ptr<ColumnReader>> edgeCols;
+    for (size_t i = 0; i < data.edge_columns.size(); i++) {
+        edgeCols.emplace_back(getReader(resp.edge_schema.columns[i], data.edge_columns[i]));
+        EXPECT_EQ(30 * 7, edgeCols.back()->size());
+    }
+
+    std::vector<int64_t> dstIds;
+    ASSERT_TRUE(edgeCols[0]->decodeInts(&dstIds));
+    for (size_t v = 0; v < data.vertex_ids.size(); v++) {
+        auto vId = data.vertex_ids[v];
+        EXPECT_EQ(vId + 3001, vertexCols[0]->getInt(v));
+        EXPECT_EQ(vId + 3003 + 2, vertexCols[1]->getInt(v));
+        EXPECT_EQ("tag_string_col_4", vertexCols[2]->getString(v));
+
+        auto from = data.edge_offsets[v];
+        auto to = data.edge_offsets[v + 1];
+        ASSERT_EQ(7, to - from);
+        for (auto e = from; e < to; e++) {
+            auto dstId = dstIds[e];
+            EXPECT_EQ(10001 + e - from, dstId);
+            // _rank
+            EXPECT_EQ(0, edgeCols[1]->getInt(e));
+            // col_0, col_2 ... col_8
+            for (auto i = 2; i < 7; i++) {
+                EXPECT_EQ((i - 2) * 2 + dstId, edgeCols[i]->getInt(e));
+            }
+            // col_10, col_12 ... col_18
+            for (auto i = 7; i < 12; i++) {
+                EXPECT_EQ(folly::stringPrintf("string_col_%d_%d", (i - 7 + 5) * 2, 2),
+                          edgeCols[i]->getString(e));
+            }
+        }
+    }
+}
+
+
 }  // namespace storage
 }  // namespace nebula
 
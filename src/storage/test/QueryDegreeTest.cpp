@@ -0,0 +1,126 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include "base/NebulaKeyUtils.h"
+#include <gtest/gtest.h>
+#include <rocksdb/db.h>
+#include "fs/TempDir.h"
+#include "storage/test/TestUtils.h"
+#include "storage/AddEdgesProcessor.h"
+#include "storage/QueryDegreeProcessor.h"
+
+namespace nebula {
+namespace storage {
+
+namespace {
+
+// Add the out-edges src -> dst@rank, and the in-edges back, of edge type 101
+void addEdges(kvstore::KVStore* kv,
+              VertexID src,
+              const std::vector<std::pair<VertexID, EdgeRanking>>& dsts) {
+    cpp2::AddEdgesRequest req;
+    req.space_id = 0;
+    req.overwritable = true;
+    for (auto& dst : dsts) {
+        req.parts[src % 3].emplace_back(
+            apache::thrift::FragileConstructor::FRAGILE,
+            cpp2::EdgeKey(apache::thrift::FragileConstructor::FRAGILE,
+                          src, 101, dst.second, dst.first),
+            "");
+        req.parts[dst.first % 3].emplace_back(
+            apache::thrift::FragileConstructor::FRAGILE,
+            cpp2::EdgeKey(apache::thrift::FragileConstructor::FRAGILE,
+                          dst.first, -101, dst.second, src),
+            "");
+    }
+    auto* processor = AddEdgesProcessor::instance(kv, nullptr);
+    auto f = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(f).get();
+    EXPECT_EQ(0, resp.result.failed_codes.size());
+}
+
+cpp2::DegreeResponse getDegrees(kvstore::KVStore* kv,
+                                const std::vector<VertexID>& vertices,
+                                std::vector<EdgeType> edgeTypes) {
+    cpp2::DegreeRequest req;
+    req.set_space_id(0);
+    for (auto vId : vertices) {
+        req.parts[vId % 3].emplace_back(vId);
+    }
+    req.set_edge_types(std::move(edgeTypes));
+    auto* processor = QueryDegreeProcessor::instance(kv, nullptr);
+    auto f = processor->getFuture();
+    processor->process(req);
+    return std::move(f).get();
+}
+
+}  // Anonymous namespace
+
+TEST(QueryDegreeTest, SimpleTest) {
+    fs::TempDir rootPath("/tmp/QueryDegreeTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv =
+        TestUtils::initKV(rootPath.path(), 6, {0, 0}, nullptr, false, nullptr, true);
+
+    LOG(INFO) << "Add the edges...";
+    addEdges(kv.get(), 1, {{10, 0}, {11, 0}, {12, 0}});
+    // Another rank is another edge, and the duplicated ones in a request count once
+    addEdges(kv.get(), 1, {{10, 1}, {13, 0}, {13, 0}});
+    // Overwrite the existing edges with the new versions
+    addEdges(kv.get(), 1, {{10, 0}, {11, 0}});
+    addEdges(kv.get(), 2, {{10, 0}});
+
+    LOG(INFO) << "Check the degrees...";
+    auto resp = getDegrees(kv.get(), {1, 2, 10, 13, 100}, {101, -101});
+    EXPECT_EQ(0, resp.result.failed_codes.size());
+    std::unordered_map<VertexID, std::vector<int64_t>> degrees;
+    for (auto& vd : resp.get_vertices()) {
+        degrees.emplace(vd.get_vertex_id(), vd.get_degrees());
+    }
+    ASSERT_EQ(5, degrees.size());
+    EXPECT_EQ((std::vector<int64_t>{5, 0}), degrees[1]);
+    EXPECT_EQ((std::vector<int64_t>{1, 0}), degrees[2]);
+    EXPECT_EQ((std::vector<int64_t>{0, 3}), degrees[10]);
+    EXPECT_EQ((std::vector<int64_t>{0, 1}), degrees[13]);
+    EXPECT_EQ((std::vector<int64_t>{0, 0}), degrees[100]);
+
+    LOG(INFO) << "The degree counters are out of the range of the edges...";
+    auto prefix = NebulaKeyUtils::prefix(1 % 3, 1, 101);
+    std::unique_ptr<kvstore::KVIterator> iter;
+    ASSERT_EQ(kvstore::ResultCode::SUCCEEDED, kv->prefix(0, 1 % 3, prefix, &iter));
+    int32_t num = 0;
+    for (; iter->valid(); iter->next()) {
+        EXPECT_TRUE(NebulaKeyUtils::isEdge(iter->key()));
+        num++;
+    }
+    // The latest two edges have two versions
+    EXPECT_EQ(7, num);
+}
+
+TEST(QueryDegreeTest, NotMaintainedTest) {
+    fs::TempDir rootPath("/tmp/QueryDegreeTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path());
+
+    // The space is not created with maintain_degrees
+    addEdges(kv.get(), 1, {{10, 0}, {11, 0}});
+
+    auto resp = getDegrees(kv.get(), {1}, {101});
+    EXPECT_EQ(0, resp.result.failed_codes.size());
+    ASSERT_EQ(1, resp.get_vertices().size());
+    EXPECT_EQ((std::vector<int64_t>{0}), resp.get_vertices()[0].get_degrees());
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -155,6 +155,81 @@ TEST(QueryStatsTest, StatsSimpleTest) {
     checkResponse(resp);
 }
 
+
+
+TEST(QueryStatsTest, MinMaxDistinctPercentileTest) {
+    fs::TempDir rootPath("/tmp/MinMaxDistinctPercentileTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path());
+    auto schemaMan = TestUtils::mockSchemaMan();
+    mockData(kv.get());
+
+    cpp2::GetNeighborsRequest req;
+    buildRequest(req);
+    decltype(req.return_columns) cols;
+    cols.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "_dst", cpp2::StatType::MIN));
+    cols.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "_dst", cpp2::StatType::MAX));
+    cols.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "_dst",
+                                         cpp2::StatType::COUNT_DISTINCT));
+    cols.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "col_10",
+                                         cpp2::StatType::COUNT_DISTINCT));
+    cols.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "_rank",
+                                         cpp2::StatType::PERCENTILE));
+    cols.back().set_percentile(50);
+    cols.emplace_back(TestUtils::propDef(cpp2::PropOwner::SOURCE, "tag_3001_col_1",
+                                         cpp2::StatType::MAX, 3001));
+    req.set_return_columns(std::move(cols));
+
+    // The stats of all the 10 buckets are merged
+    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(3);
+    auto* processor = QueryStatsProcessor::instance(kv.get(), schemaMan.get(), executor.get());
+    auto f = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(f).get();
+
+    EXPECT_EQ(0, resp.result.failed_codes.size());
+    ASSERT_EQ(6, resp.schema.columns.size());
+    auto provider = std::make_shared<ResultSchemaProvider>(resp.schema);
+    auto reader = RowReader::getRowReader(resp.data, provider);
+    std::vector<int64_t> expected = {10001, 10007, 7, 1};
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(nebula::cpp2::SupportedType::INT, provider->getFieldType(i).type);
+        int64_t v;
+        EXPECT_EQ(ResultType::SUCCEEDED, reader->getInt<int64_t>(i, v));
+        EXPECT_EQ(expected[i], v);
+    }
+    // The ranks are 0 to 6 for each vertex
+    EXPECT_EQ(nebula::cpp2::SupportedType::DOUBLE, provider->getFieldType(4).type);
+    double median;
+    EXPECT_EQ(ResultType::SUCCEEDED, reader->getDouble(4, median));
+    EXPECT_NEAR(3, median, 0.5);
+    EXPECT_EQ(nebula::cpp2::SupportedType::INT, provider->getFieldType(5).type);
+    int64_t max;
+    EXPECT_EQ(ResultType::SUCCEEDED, reader->getInt<int64_t>(5, max));
+    EXPECT_EQ(1, max);
+}
+
+
+TEST(QueryStatsTest, ImproperTypeTest) {
+    fs::TempDir rootPath("/tmp/ImproperTypeTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path());
+    auto schemaMan = TestUtils::mockSchemaMan();
+
+    cpp2::GetNeighborsRequest req;
+    buildRequest(req);
+    decltype(req.return_columns) cols;
+    cols.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "col_10",
+                                         cpp2::StatType::PERCENTILE));
+    req.set_return_columns(std::move(cols));
+
+    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(3);
+    auto* processor = QueryStatsProcessor::instance(kv.get(), schemaMan.get(), executor.get());
+    auto f = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(f).get();
+    ASSERT_EQ(3, resp.result.failed_codes.size());
+    EXPECT_EQ(cpp2::ErrorCode::E_IMPROPER_DATA_TYPE, resp.result.failed_codes[0].code);
+}
+
 }  // namespace storage
 }  // namespace nebula
 
@@ -18,6 +18,7 @@
 DECLARE_string(meta_server_addrs);
 DECLARE_int32(load_data_interval_secs);
 DECLARE_int32(heartbeat_interval_secs);
+DECLARE_int32(storage_client_overflow_retry_times);
 
 namespace nebula {
 namespace storage {
@@ -350,7 +351,7 @@ TEST(StorageClientTest, LeaderChangeTest) {
     tsc.parts_.emplace(1, std::move(pm));
 
     folly::Baton<true, std::atomic> baton;
-    tsc.getNeighbors(0, {1, 2, 3}, 0, true, "", {}).via(threadPool.get()).then([&] {
+    tsc.getNeighbors(0, {1, 2, 3}, {0}, true, "", {}).via(threadPool.get()).then([&] {
         baton.post();
     });
     baton.wait();
@@ -358,6 +359,122 @@ TEST(StorageClientTest, LeaderChangeTest) {
     ASSERT_EQ(HostAddr(localIp, 10010), tsc.leaders_[std::make_pair(0, 1)]);
 }
 
+
+// The raft buffer of part 1 never overflows, the one of part 2 overflows only
+// the first time, and the one of part 3 always overflows
+class TestStorageServiceOverflow : public storage::cpp2::StorageServiceSvIf {
+public:
+    folly::Future<cpp2::ExecResponse>
+    future_addVertices(const cpp2::AddVerticesRequest& req) override {
+        cpp2::ExecResponse resp;
+        resp.result.set_latency_in_us(100);
+        for (auto& part : req.get_parts()) {
+            auto times = sent(part.first);
+            if (part.first == 3 || (part.first == 2 && times == 1)) {
+                resp.result.failed_codes.emplace_back(overflow(part.first));
+            }
+        }
+        return resp;
+    }
+
+    folly::Future<cpp2::QueryResponse>
+    future_getOutBound(const cpp2::GetNeighborsRequest& req) override {
+        cpp2::QueryResponse resp;
+        resp.result.set_latency_in_us(100);
+        std::vector<cpp2::VertexData> vertices;
+        for (auto& part : req.get_parts()) {
+            sent(part.first);
+            if (part.first == 1) {
+                for (auto vId : part.second) {
+                    cpp2::VertexData vdata;
+                    vdata.set_vertex_id(vId);
+                    vertices.emplace_back(std::move(vdata));
+                }
+            } else {
+                resp.result.failed_codes.emplace_back(overflow(part.first));
+            }
+        }
+        resp.set_vertices(std::move(vertices));
+        return resp;
+    }
+
+    int32_t sentTimes(PartitionID partId) {
+        std::lock_guard<std::mutex> g(lock_);
+        return sentTimes_[partId];
+    }
+
+private:
+    int32_t sent(PartitionID partId) {
+        std::lock_guard<std::mutex> g(lock_);
+        return ++sentTimes_[partId];
+    }
+
+    cpp2::ResultCode overflow(PartitionID partId) {
+        cpp2::ResultCode code;
+        code.set_part_id(partId);
+        code.set_code(cpp2::ErrorCode::E_BUFFER_OVERFLOW);
+        code.set_retry_after_ms(10);
+        return code;
+    }
+
+    std::mutex lock_;
+    std::unordered_map<PartitionID, int32_t> sentTimes_;
+};
+
+TEST(StorageClientTest, BufferOverflowTest) {
+    IPv4 localIp;
+    network::NetworkUtils::ipv4ToInt("127.0.0.1", localIp);
+
+    auto sc = std::make_unique<test::ServerContext>();
+    auto handler = std::make_shared<TestStorageServiceOverflow>();
+    sc->mockCommon("storage", 0, handler);
+    LOG(INFO) << "Start storage server on " << sc->port_;
+
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(1);
+    TestStorageClient tsc(threadPool);
+    for (PartitionID partId = 1; partId <= 3; partId++) {
+        PartMeta pm;
+        pm.spaceId_ = 1;
+        pm.partId_ = partId;
+        pm.peers_.emplace_back(HostAddr(localIp, sc->port_));
+        tsc.parts_.emplace(partId, std::move(pm));
+    }
+
+    FLAGS_storage_client_overflow_retry_times = 2;
+    {
+        // The vertices fall in all the three parts
+        std::vector<cpp2::Vertex> vertices;
+        for (VertexID vId = 1; vId <= 3; vId++) {
+            cpp2::Vertex v;
+            v.set_id(vId);
+            vertices.emplace_back(std::move(v));
+        }
+        auto resp = tsc.addVertices(0, std::move(vertices), true).get();
+        // Only the parts overflowed are sent again, until the retries are used up
+        ASSERT_EQ(1, handler->sentTimes(1));
+        ASSERT_EQ(2, handler->sentTimes(2));
+        ASSERT_EQ(3, handler->sentTimes(3));
+        // Every response is kept, and only the part overflowed at last fails
+        ASSERT_FALSE(resp.succeeded());
+        ASSERT_EQ(3, resp.responses().size());
+        ASSERT_EQ(1, resp.failedParts().size());
+        ASSERT_EQ(cpp2::ErrorCode::E_BUFFER_OVERFLOW, resp.failedParts()[3]);
+    }
+    {
+        // The reads are not sent again, the rows of the other parts are kept
+        auto resp = tsc.getNeighbors(0, {1, 2, 3}, {0}, true, "", {}).get();
+        ASSERT_EQ(2, handler->sentTimes(1));
+        ASSERT_EQ(3, handler->sentTimes(2));
+        ASSERT_EQ(4, handler->sentTimes(3));
+        ASSERT_EQ(1, resp.responses().size());
+        ASSERT_EQ(1, resp.responses()[0].get_vertices()->size());
+        ASSERT_EQ(2, resp.failedParts().size());
+        ASSERT_EQ(cpp2::ErrorCode::E_BUFFER_OVERFLOW, resp.failedParts()[2]);
+        ASSERT_EQ(cpp2::ErrorCode::E_BUFFER_OVERFLOW, resp.failedParts()[3]);
+    }
+    FLAGS_storage_client_overflow_retry_times = 3;
+}
+
 }  // namespace storage
 }  // namespace nebula
 
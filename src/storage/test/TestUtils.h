@@ -35,7 +35,8 @@ public:
             HostAddr localhost = {0, 0},
             meta::MetaClient* mClient = nullptr,
             bool useMetaServer = false,
-            std::shared_ptr<kvstore::KVCompactionFilterFactory> cfFactory = nullptr) {
+            std::shared_ptr<kvstore::KVCompactionFilterFactory> cfFactory = nullptr,
+            bool maintainDegrees = false) {
         auto ioPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
         auto workers = apache::thrift::concurrency::PriorityThreadManager::newPriorityThreadManager(
                                  1, true /*stats*/);
@@ -56,6 +57,9 @@ public:
             for (auto partId = 0; partId < partitionNumber; partId++) {
                 partsMap[0][partId] = PartMeta();
             }
+            if (maintainDegrees) {
+                memPartMan->degreesSpaces().emplace(0);
+            }
 
             options.partMan_ = std::move(memPartMan);
         }
@@ -0,0 +1,196 @@
+/* Copyright (c) 2019 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "base/Base.h"
+#include "base/NebulaKeyUtils.h"
+#include <gtest/gtest.h>
+#include <rocksdb/db.h>
+#include "fs/TempDir.h"
+#include "storage/test/TestUtils.h"
+#include "storage/TraverseProcessor.h"
+#include "dataman/RowSetReader.h"
+#include "dataman/RowReader.h"
+
+namespace nebula {
+namespace storage {
+
+// Partition 1 ~ 5 are hosted here, vertices in partition 6 and 7 belong to other hosts.
+static constexpr int32_t kPartsNum = 7;
+
+/**
+ * Each vertex v in [0, 20) has two out-edges, to v + 1 and v + 2.
+ * */
+void mockData(kvstore::KVStore* kv) {
+    std::unordered_map<PartitionID, std::vector<kvstore::KV>> data;
+    for (VertexID vId = 0; vId < 20; vId++) {
+        PartitionID partId = vId % kPartsNum + 1;
+        if (partId > 5) {
+            continue;
+        }
+        for (auto dstId = vId + 1; dstId <= vId + 2; dstId++) {
+            auto key = NebulaKeyUtils::edgeKey(partId, vId, 101, 0, dstId, 0);
+            RowWriter writer(nullptr);
+            for (uint64_t numInt = 0; numInt < 10; numInt++) {
+                writer << (dstId + numInt);
+            }
+            for (auto numString = 10; numString < 20; numString++) {
+                writer << folly::stringPrintf("string_col_%d", numString);
+            }
+            data[partId].emplace_back(std::move(key), writer.encode());
+        }
+    }
+    for (auto& part : data) {
+        folly::Baton<true, std::atomic> baton;
+        kv->asyncMultiPut(
+            0, part.first, std::move(part.second),
+            [&](kvstore::ResultCode code) {
+                EXPECT_EQ(code, kvstore::ResultCode::SUCCEEDED);
+                baton.post();
+            });
+        baton.wait();
+    }
+}
+
+
+cpp2::TraverseRequest buildRequest(VertexID start, int32_t steps) {
+    cpp2::TraverseRequest req;
+    req.set_space_id(0);
+    decltype(req.parts) parts;
+    parts[start % kPartsNum + 1].emplace_back(start);
+    req.set_parts(std::move(parts));
+    req.set_edge_type(101);
+    req.set_steps(steps);
+    req.set_parts_num(kPartsNum);
+    decltype(req.return_columns) tmpColumns;
+    tmpColumns.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "_dst"));
+    tmpColumns.emplace_back(TestUtils::propDef(cpp2::PropOwner::EDGE, "col_0"));
+    req.set_return_columns(std::move(tmpColumns));
+    return req;
+}
+
+
+cpp2::QueryResponse traverse(kvstore::KVStore* kv,
+                             meta::SchemaManager* schemaMan,
+                             const cpp2::TraverseRequest& req) {
+    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(3);
+    auto* processor = TraverseProcessor::instance(kv, schemaMan, executor.get());
+    auto f = processor->getFuture();
+    processor->process(req);
+    return std::move(f).get();
+}
+
+
+std::vector<VertexID> dstIds(const cpp2::QueryResponse& resp, VertexID srcId) {
+    std::vector<VertexID> ids;
+    auto provider = std::make_shared<ResultSchemaProvider>(resp.edge_schema);
+    for (auto& vp : resp.vertices) {
+        if (vp.vertex_id != srcId) {
+            continue;
+        }
+        RowSetReader rsReader(provider, vp.edge_data);
+        auto it = rsReader.begin();
+        while (it) {
+            int64_t dstId;
+            EXPECT_EQ(ResultType::SUCCEEDED, it->getInt<int64_t>("_dst", dstId));
+            int64_t col0;
+            EXPECT_EQ(ResultType::SUCCEEDED, it->getInt<int64_t>("col_0", col0));
+            EXPECT_EQ(dstId, col0);
+            ids.emplace_back(dstId);
+            ++it;
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+
+TEST(TraverseTest, LocalStepsTest) {
+    fs::TempDir rootPath("/tmp/TraverseTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path());
+    auto schemaMan = TestUtils::mockSchemaMan();
+    mockData(kv.get());
+
+    // 0 => {1, 2} => {2, 3, 4}, all of which are local
+    auto resp = traverse(kv.get(), schemaMan.get(), buildRequest(0, 3));
+    EXPECT_EQ(0, resp.result.failed_codes.size());
+    EXPECT_EQ(nullptr, resp.get_frontier());
+    ASSERT_EQ(3, resp.vertices.size());
+    EXPECT_EQ(std::vector<VertexID>({3, 4}), dstIds(resp, 2));
+    EXPECT_EQ(std::vector<VertexID>({4, 5}), dstIds(resp, 3));
+    EXPECT_EQ(std::vector<VertexID>({5, 6}), dstIds(resp, 4));
+}
+
+
+TEST(TraverseTest, FrontierTest) {
+    fs::TempDir rootPath("/tmp/TraverseTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path());
+    auto schemaMan = TestUtils::mockSchemaMan();
+    mockData(kv.get());
+
+    // 2 => {3, 4} => {4, 5, 6}, in which 5 and 6 are of the other hosts
+    auto resp = traverse(kv.get(), schemaMan.get(), buildRequest(2, 3));
+    EXPECT_EQ(0, resp.result.failed_codes.size());
+    ASSERT_EQ(1, resp.vertices.size());
+    EXPECT_EQ(std::vector<VertexID>({5, 6}), dstIds(resp, 4));
+    ASSERT_NE(nullptr, resp.get_frontier());
+    auto& frontier = *resp.get_frontier();
+    ASSERT_EQ(1, frontier.size());
+    auto remote = frontier.at(1);
+    std::sort(remote.begin(), remote.end());
+    EXPECT_EQ(std::vector<VertexID>({5, 6}), remote);
+}
+
+
+TEST(TraverseTest, EdgeLimitTest) {
+    fs::TempDir rootPath("/tmp/TraverseTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path());
+    auto schemaMan = TestUtils::mockSchemaMan();
+    mockData(kv.get());
+
+    // Only the first edge of each vertex, 0 => 1 => 2 => 3
+    auto req = buildRequest(0, 3);
+    cpp2::EdgeLimit limit;
+    limit.set_per_vertex(1);
+    req.set_edge_limit(std::move(limit));
+    auto resp = traverse(kv.get(), schemaMan.get(), req);
+    EXPECT_EQ(0, resp.result.failed_codes.size());
+    EXPECT_EQ(nullptr, resp.get_frontier());
+    ASSERT_EQ(1, resp.vertices.size());
+    EXPECT_EQ(std::vector<VertexID>({3}), dstIds(resp, 2));
+}
+
+
+
+TEST(TraverseTest, FailedPartTest) {
+    fs::TempDir rootPath("/tmp/TraverseTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path());
+    auto schemaMan = TestUtils::mockSchemaMan();
+    mockData(kv.get());
+
+    // Partition 7 is not hosted here, so the traverse from 6 fails,
+    // while 0 => {1, 2} => {2, 3, 4} goes on without it
+    auto req = buildRequest(0, 3);
+    req.parts[7].emplace_back(6);
+    auto resp = traverse(kv.get(), schemaMan.get(), req);
+    ASSERT_EQ(1, resp.result.failed_codes.size());
+    EXPECT_EQ(7, resp.result.failed_codes[0].part_id);
+    EXPECT_EQ(nullptr, resp.get_frontier());
+    ASSERT_EQ(3, resp.vertices.size());
+    EXPECT_EQ(std::vector<VertexID>({3, 4}), dstIds(resp, 2));
+    EXPECT_EQ(std::vector<VertexID>({4, 5}), dstIds(resp, 3));
+    EXPECT_EQ(std::vector<VertexID>({5, 6}), dstIds(resp, 4));
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -215,7 +215,7 @@ private:
     void getNeighborsTask() {
         auto* evb = threadPool_->getEventBase();
         auto f = client_->getNeighbors(spaceId_, randomVertices(),
-                                       edgeType_, true, "", randomCols())
+                                       {edgeType_}, true, "", randomCols())
                             .via(evb).then([this](auto&& resps) {
                                 if (!resps.succeeded()) {
                                     LOG(ERROR) << "Request failed!";